@@ -0,0 +1,194 @@
+// approach_predictor_test.cc
+// Feeds ApproachPredictor scripted tracks and checks what it predicts:
+//   - a person on a known ramp is fitted to its speed and depth, and the time to the threshold
+//     follows from them, also when the millisecond clock wraps during the ramp
+//   - a ToF sample newer than the caller's clock (fit_ms > now_ms) counts as no time elapsed
+//   - a track nobody continued for kTrackTimeoutMs is dropped and its slot reused; with every
+//     slot live a new person replaces the stalest track
+//   - approaches slower than min_speed_mm_s or faster than kMaxSpeedMmS, receding tracks and
+//     disabled prediction never predict a crossing
+//
+//   andon_approach_predictor_test   (exit status 0 when every check passes; also run by ctest)
+#include <cmath>
+#include <cstdio>
+
+#include "m7/approach_predictor.hh"
+
+namespace coralmicro {
+namespace {
+
+    constexpr uint32_t kSampleMs = 16;     // ToF frames at 60 Hz
+    constexpr float kThresholdMm = 600.0f; // Stop distance of the default zone
+
+    int g_failures = 0;
+
+    void check(bool ok, const char* what, const char* test) {
+        if (!ok) {
+            printf("FAIL %s: %s\n", test, what);
+            g_failures++;
+        }
+    }
+
+    bool near(float value, float expected, float tolerance) {
+        return std::fabs(value - expected) <= tolerance;
+    }
+
+    // A box of its own per person, none overlapping another
+    tensorflow::Object person(int index) {
+        float x = 10.0f + 30.0f * static_cast<float>(index);
+        return tensorflow::Object{0, 0.9f, {20.0f, x, 200.0f, x + 25.0f}};
+    }
+
+    // One detector result for the person, then a depth at every ToF frame of the ramp.
+    // Returns the time of the last sample
+    uint32_t ramp(ApproachPredictor& predictor, int index, uint32_t start_ms, float start_mm, float speed_mm_s,
+                  uint32_t samples) {
+        tensorflow::Object object = person(index);
+        predictor.on_detections(&object, 1, start_ms);
+        uint32_t sample_ms = start_ms;
+        for (uint32_t i = 0; i < samples; i++) {
+            sample_ms = start_ms + i * kSampleMs;
+            float depth = start_mm - speed_mm_s * static_cast<float>(i * kSampleMs) / 1000.0f;
+            predictor.on_depths(&depth, &kThresholdMm, 1, sample_ms);
+        }
+        return sample_ms;
+    }
+
+    void known_ramp(uint32_t start_ms, const char* test) {
+        ApproachPredictor predictor;
+        ApproachParams params;
+        uint32_t last_ms = ramp(predictor, 0, start_ms, 3000.0f, 1000.0f, 20);
+        float last_mm = 3000.0f - 1000.0f * static_cast<float>(19 * kSampleMs) / 1000.0f; // 2696 mm
+
+        ApproachPrediction prediction = predictor.predict(params, last_ms);
+        check(prediction.approaching, "a 1 m/s approach isn't predicted", test);
+        check(near(prediction.speed_mm_s, 1000.0f, 1.0f), "fitted speed", test);
+        check(near(prediction.depth_mm, last_mm, 1.0f), "fitted depth at the newest sample", test);
+        check(near(static_cast<float>(prediction.time_to_threshold_ms), last_mm - kThresholdMm, 2.0f),
+              "time to the threshold", test);
+
+        // Carried forward: 500 ms later the person is 500 mm closer
+        prediction = predictor.predict(params, last_ms + 500);
+        check(near(prediction.depth_mm, last_mm - 500.0f, 1.0f), "depth carried forward to now", test);
+        check(near(static_cast<float>(prediction.time_to_threshold_ms), last_mm - 500.0f - kThresholdMm, 2.0f),
+              "time to the threshold carried forward", test);
+
+        // Past the threshold the crossing is due now
+        prediction = predictor.predict(params, last_ms + 2500);
+        check(prediction.approaching && prediction.time_to_threshold_ms == 0, "crossing past the threshold", test);
+    }
+
+    void sample_newer_than_now() {
+        const char* test = "fit_ms > now_ms";
+        ApproachPredictor predictor;
+        ApproachParams params;
+        uint32_t last_ms = ramp(predictor, 0, 1000, 3000.0f, 1000.0f, 20);
+
+        // The caller read its clock just before the newest ToF frame was published
+        ApproachPrediction prediction = predictor.predict(params, last_ms - 5);
+        ApproachPrediction at_sample = predictor.predict(params, last_ms);
+        check(prediction.approaching, "not approaching", test);
+        check(prediction.time_to_threshold_ms == at_sample.time_to_threshold_ms,
+              "a sample newer than now isn't treated as no time elapsed", test);
+        check(prediction.time_to_threshold_ms > params.stop_budget_ms, "an approach 2 m away is due now", test);
+    }
+
+    void track_timeout() {
+        const char* test = "track timeout";
+        ApproachPredictor predictor;
+        tensorflow::Object first = person(0);
+        tensorflow::Object second = person(1);
+
+        predictor.on_detections(&first, 1, 1000);
+        predictor.on_detections(&second, 1, 1000 + ApproachConfig::kTrackTimeoutMs);
+        check(predictor.track_count() == 2, "a track dropped before its timeout", test);
+
+        predictor.on_detections(&second, 1, 1001 + ApproachConfig::kTrackTimeoutMs);
+        check(predictor.track_count() == 1, "a track kept past its timeout", test);
+
+        // The same box again starts a new track in the freed slot
+        predictor.on_detections(&first, 1, 1002 + ApproachConfig::kTrackTimeoutMs);
+        check(predictor.track_count() == 2, "a person back after the timeout isn't tracked", test);
+    }
+
+    void slot_reuse() {
+        const char* test = "slot reuse";
+        ApproachPredictor predictor;
+        ApproachParams params;
+
+        // Person 0 fast, person 1 slower, both approaching; then everyone else in turn
+        tensorflow::Object both[2] = {person(0), person(1)};
+        uint32_t now_ms = 1000;
+        for (uint32_t i = 0; i < 20; i++, now_ms += kSampleMs) {
+            predictor.on_detections(both, 2, now_ms);
+            float depths[2] = {3000.0f - 1.5f * static_cast<float>(i * kSampleMs),
+                               3000.0f - 0.5f * static_cast<float>(i * kSampleMs)};
+            float thresholds[2] = {kThresholdMm, kThresholdMm};
+            predictor.on_depths(depths, thresholds, 2, now_ms);
+        }
+        predictor.on_detections(&both[1], 1, now_ms++);
+        for (int index = 2; index < static_cast<int>(ApproachConfig::kMaxTracks); index++) {
+            tensorflow::Object object = person(index);
+            predictor.on_detections(&object, 1, now_ms++);
+        }
+        check(predictor.track_count() == ApproachConfig::kMaxTracks, "every slot live", test);
+        check(near(predictor.predict(params, now_ms).speed_mm_s, 1500.0f, 1.0f), "the faster person is soonest",
+              test);
+
+        // One person more than there are slots: the stalest track (person 0) makes way
+        tensorflow::Object newcomer = person(static_cast<int>(ApproachConfig::kMaxTracks));
+        predictor.on_detections(&newcomer, 1, now_ms);
+        check(predictor.track_count() == ApproachConfig::kMaxTracks, "track count with every slot taken", test);
+        ApproachPrediction prediction = predictor.predict(params, now_ms);
+        check(prediction.approaching && near(prediction.speed_mm_s, 500.0f, 1.0f),
+              "the stalest track wasn't the one replaced", test);
+    }
+
+    void speed_gating() {
+        const char* test = "speed gating";
+        ApproachParams params;
+
+        ApproachPredictor slow;
+        uint32_t last_ms = ramp(slow, 0, 1000, 3000.0f, 200.0f, 20);
+        check(!slow.predict(params, last_ms).approaching, "slower than min_speed_mm_s predicted", test);
+        ApproachParams sensitive = params;
+        sensitive.min_speed_mm_s = 150.0f;
+        check(slow.predict(sensitive, last_ms).approaching, "faster than a lowered min_speed_mm_s not predicted",
+              test);
+
+        ApproachPredictor jump;
+        last_ms = ramp(jump, 0, 1000, 3000.0f, ApproachConfig::kMaxSpeedMmS + 500.0f, 20);
+        check(!jump.predict(params, last_ms).approaching, "faster than kMaxSpeedMmS predicted", test);
+
+        ApproachPredictor receding;
+        last_ms = ramp(receding, 0, 1000, 1000.0f, -1000.0f, 20);
+        check(!receding.predict(params, last_ms).approaching, "a receding person predicted", test);
+
+        ApproachPredictor walking;
+        last_ms = ramp(walking, 0, 1000, 3000.0f, 1000.0f, 20);
+        ApproachParams disabled = params;
+        disabled.enabled = false;
+        check(!walking.predict(disabled, last_ms).approaching, "predicted while disabled", test);
+
+        // Too few samples to fit yet
+        ApproachPredictor fresh;
+        last_ms = ramp(fresh, 0, 1000, 3000.0f, 1000.0f, ApproachConfig::kMinSamples - 1);
+        check(!fresh.predict(params, last_ms).approaching, "predicted before kMinSamples", test);
+    }
+
+    void run() {
+        known_ramp(1000, "known ramp");
+        known_ramp(UINT32_MAX - 150, "known ramp across the clock wrap");
+        sample_newer_than_now();
+        track_timeout();
+        slot_reuse();
+        speed_gating();
+        printf("approach predictor: %d failures\n", g_failures);
+    }
+}
+}
+
+int main() {
+    coralmicro::run();
+    return coralmicro::g_failures == 0 ? 0 : 1;
+}
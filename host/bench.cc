@@ -0,0 +1,550 @@
+// bench.cc
+// Micro-benchmarks of the pure per-frame computations, built from the same sources as the
+// device. Reports ns/op and heap allocations per op; --json writes the results in a stable
+// layout for scripts/bench_compare.py to diff between commits.
+//
+//   andon_bench [--json results.json] [--filter substring] [--min-ms 100] [--repeats 5]
+//
+// Host timings rank changes against each other; they are not M7 cycle counts.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "m7/danger_zones.hh"
+#include "m7/depth_estimation.hh"
+#include "m7/detection_postprocess.hh"
+#include "m7/image_convert.hh"
+#include "m7/state_logic.hh"
+#include "m7/tof_intrusion.hh"
+#include "state_machine.hh"
+#include "tof_rgb_mapping.hh"
+
+// Every heap allocation in the process goes through here
+namespace {
+    std::atomic<uint64_t> g_allocs{0};
+    std::atomic<uint64_t> g_alloc_bytes{0};
+}
+
+void* operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace coralmicro {
+namespace {
+
+    constexpr uint16_t kImageSize = 300; // Detector input, the frame the cell regions are mapped onto
+
+    // Keeps a value the optimizer would otherwise drop
+    template <typename T>
+    inline void keep(const T& value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    struct Result {
+        std::string name;
+        std::string grid;   // "4x4", "8x8" or "" when it doesn't apply
+        int detections;     // -1 when it doesn't apply
+        double ns_per_op;
+        double allocs_per_op;
+        double bytes_per_op;
+        uint64_t iterations;
+    };
+
+    struct Options {
+        const char* json = nullptr;
+        const char* filter = nullptr;
+        double min_ms = 100.0;
+        int repeats = 5;
+    };
+
+    // Runs op in batches until a batch takes min_ms, then reports the median of repeats batches
+    Result measure(const Options& options, const std::string& name, const std::string& grid, int detections,
+                   const std::function<void()>& op) {
+        using Clock = std::chrono::steady_clock;
+
+        uint64_t iterations = 1;
+        while (true) {
+            auto start = Clock::now();
+            for (uint64_t i = 0; i < iterations; i++) {
+                op();
+            }
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (ms >= options.min_ms || iterations >= (1ull << 40)) {
+                break;
+            }
+            iterations = ms > 1.0 ? static_cast<uint64_t>(iterations * options.min_ms / ms * 1.1) + 1 : iterations * 10;
+        }
+
+        std::vector<double> ns;
+        ns.reserve(options.repeats); // Growing it between batches would count as op allocations
+        uint64_t allocs = 0;
+        uint64_t bytes = 0;
+        for (int r = 0; r < options.repeats; r++) {
+            uint64_t allocs_before = g_allocs.load();
+            uint64_t bytes_before = g_alloc_bytes.load();
+            auto start = Clock::now();
+            for (uint64_t i = 0; i < iterations; i++) {
+                op();
+            }
+            ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations);
+            allocs += g_allocs.load() - allocs_before;
+            bytes += g_alloc_bytes.load() - bytes_before;
+        }
+        std::sort(ns.begin(), ns.end());
+
+        double runs = static_cast<double>(iterations) * options.repeats;
+        return {name, grid, detections, ns[ns.size() / 2], allocs / runs, bytes / runs, iterations};
+    }
+
+    // Cell regions tiling the middle of the frame like tof_rgb_mapping.hh, side x side of them
+    std::vector<TofCellRegion> make_grid(uint16_t side) {
+        std::vector<TofCellRegion> cells;
+        const uint16_t span = 188; // kTofCellRegions covers x 63..251
+        const uint16_t x0 = 63;
+        const uint16_t y0 = 57;
+        for (uint16_t row = 0; row < side; row++) {
+            for (uint16_t col = 0; col < side; col++) {
+                uint16_t x_min = static_cast<uint16_t>(x0 + span * col / side);
+                uint16_t y_min = static_cast<uint16_t>(y0 + span * row / side);
+                uint16_t x_max = static_cast<uint16_t>(x0 + span * (col + 1) / side);
+                uint16_t y_max = static_cast<uint16_t>(y0 + span * (row + 1) / side);
+                cells.push_back(TofCellRegion{x_min, y_min, x_max, y_max,
+                                              static_cast<uint16_t>((x_min + x_max) / 2),
+                                              static_cast<uint16_t>((y_min + y_max) / 2),
+                                              static_cast<uint32_t>(x_max - x_min) * (y_max - y_min)});
+            }
+        }
+        return cells;
+    }
+
+    // Person boxes spread over the frame, in pixels; some partly outside the ToF field of view
+    std::vector<tensorflow::Object> make_detections(int count) {
+        std::vector<tensorflow::Object> objects;
+        for (int i = 0; i < count; i++) {
+            float x = static_cast<float>((i * 53) % 220);
+            float y = static_cast<float>((i * 37) % 150);
+            objects.push_back(tensorflow::Object{kPersonClassId, 0.9f - 0.05f * i, {y, x, y + 140.0f, x + 70.0f}});
+        }
+        return objects;
+    }
+
+    // A ranging frame: background at 2 m with a near target in some zones
+    TofData make_tof(uint8_t zones) {
+        TofData tof = {};
+        tof.timestamp_us = 1000000;
+        for (size_t sensor = 0; sensor < kTofSensorCount; sensor++) {
+            tof.frame_us[sensor] = tof.timestamp_us;
+            for (uint8_t zone = 0; zone < zones; zone++) {
+                tof.results[sensor].distance_mm[zone] = static_cast<int16_t>(zone % 5 == 0 ? 450 : 2000 + zone);
+                tof.results[sensor].target_status[zone] = 5;
+            }
+        }
+        return tof;
+    }
+
+    // kMaxZones overlapping strips across the ToF cells, each with its own limits
+    DangerZoneSet make_danger_zones() {
+        DangerZoneSet set = {};
+        set.count = DangerZoneConfig::kMaxZones;
+        for (uint8_t z = 0; z < set.count; z++) {
+            DangerZone& zone = set.zones[z];
+            uint16_t x = static_cast<uint16_t>(40 + z * 30);
+            zone.stop_mm = 400.0f + z * 50.0f;
+            zone.warning_mm = 1500.0f;
+            zone.vertex_count = 4;
+            zone.vertices[0] = {x, 0};
+            zone.vertices[1] = {static_cast<uint16_t>(x + 60), 0};
+            zone.vertices[2] = {static_cast<uint16_t>(x + 60), 300};
+            zone.vertices[3] = {x, 300};
+        }
+        return set;
+    }
+
+    const char* grid_name(uint8_t zones) {
+        return zones == 64 ? "8x8" : "4x4";
+    }
+
+    // What the input tasks hand the state controller: pending detection and ToF inputs, as the
+    // queues plus NotifyStateController bits do on the device
+    struct ControllerInbox {
+        std::mutex mutex;
+        std::condition_variable input_ready;
+        std::condition_variable decided;
+        bool detection_pending = false;
+        bool tof_pending = false;
+        bool stop = false;
+        uint64_t published = 0;  // Input sets handed over
+        uint64_t decided_on = 0; // Newest input set a finished decision took in
+    };
+
+    // The controller's side of a reaction: inputs into the real StateLogic, then a decision
+    struct ReactionController {
+        ControllerInbox& inbox;
+        StateLogic logic;
+        std::vector<tensorflow::Object> detections;
+        TofData tof;
+
+        uint32_t now_ms() const {
+            using namespace std::chrono;
+            return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+        }
+
+        void take_detection(uint32_t now) {
+            inbox.detection_pending = false;
+            logic.on_detection(detections.data(), detections.size(), static_cast<uint64_t>(now) * 1000u, now);
+        }
+
+        void take_tof(uint32_t now) {
+            inbox.tof_pending = false;
+            tof.frame_us[0] = static_cast<uint64_t>(now) * 1000u;
+            tof.timestamp_us = tof.frame_us[0];
+            logic.on_tof(tof, 16, now);
+        }
+
+        void decide(uint64_t taken, uint32_t now) {
+            keep(logic.step(now));
+            inbox.decided_on = taken;
+            inbox.decided.notify_all();
+        }
+
+        // state_controller_task: wakes on any input and decides at once
+        void run_event_driven() {
+            std::unique_lock<std::mutex> lock(inbox.mutex);
+            while (true) {
+                inbox.input_ready.wait(lock, [&] { return inbox.stop || inbox.detection_pending || inbox.tof_pending; });
+                if (inbox.stop) {
+                    return;
+                }
+                uint64_t taken = inbox.published;
+                uint32_t now = now_ms();
+                if (inbox.detection_pending) {
+                    take_detection(now);
+                }
+                if (inbox.tof_pending) {
+                    take_tof(now);
+                }
+                decide(taken, now);
+            }
+        }
+
+        // The loop it replaced: a 10 ms delay, then 10 ms blocking receives of the detection
+        // and, with a person in it, the ToF frame
+        void run_polling() {
+            const auto kWait = std::chrono::milliseconds(10);
+            while (true) {
+                std::this_thread::sleep_for(kWait);
+                std::unique_lock<std::mutex> lock(inbox.mutex);
+                if (inbox.stop) {
+                    return;
+                }
+                uint64_t taken = inbox.decided_on;
+                if (inbox.input_ready.wait_for(lock, kWait, [&] { return inbox.stop || inbox.detection_pending; }) &&
+                    !inbox.stop) {
+                    taken = inbox.published;
+                    take_detection(now_ms());
+                    if (inbox.input_ready.wait_for(lock, kWait, [&] { return inbox.stop || inbox.tof_pending; }) &&
+                        !inbox.stop) {
+                        take_tof(now_ms());
+                    }
+                }
+                decide(taken, now_ms());
+            }
+        }
+    };
+
+    // Reaction latency, from a detection and ToF frame being published to the decision that took
+    // them in, with the controller in its own thread. Inputs land at every phase of a 10 ms
+    // cycle; reports the median over at least min_ms * repeats of samples.
+    Result measure_reaction(const Options& options, const std::string& name, bool event_driven) {
+        using Clock = std::chrono::steady_clock;
+        constexpr size_t kMinSamples = 20;
+
+        ControllerInbox inbox;
+        ReactionController controller{inbox, StateLogic(), make_detections(2), make_tof(16)};
+        std::thread thread(event_driven ? &ReactionController::run_event_driven : &ReactionController::run_polling,
+                           &controller);
+
+        std::vector<double> ns;
+        ns.reserve(4096);
+        uint64_t allocs_before = g_allocs.load();
+        uint64_t bytes_before = g_alloc_bytes.load();
+        auto start = Clock::now();
+        while (ns.size() < kMinSamples ||
+               std::chrono::duration<double, std::milli>(Clock::now() - start).count() < options.min_ms * options.repeats) {
+            std::this_thread::sleep_for(std::chrono::microseconds((ns.size() * 3700) % 10000));
+
+            auto published = Clock::now();
+            std::unique_lock<std::mutex> lock(inbox.mutex);
+            inbox.detection_pending = true;
+            inbox.tof_pending = true;
+            uint64_t sequence = ++inbox.published;
+            inbox.input_ready.notify_all();
+            inbox.decided.wait(lock, [&] { return inbox.decided_on >= sequence; });
+            lock.unlock();
+            ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - published).count());
+        }
+        double runs = static_cast<double>(ns.size());
+        double allocs = static_cast<double>(g_allocs.load() - allocs_before);
+        double bytes = static_cast<double>(g_alloc_bytes.load() - bytes_before);
+
+        {
+            std::lock_guard<std::mutex> lock(inbox.mutex);
+            inbox.stop = true;
+            inbox.input_ready.notify_all();
+        }
+        thread.join();
+
+        std::sort(ns.begin(), ns.end());
+        return {name, "4x4", 2, ns[ns.size() / 2], allocs / runs, bytes / runs, ns.size()};
+    }
+
+    void print_result(const Result& r) {
+        printf("%-32s %-4s %3s  %10.1f ns/op  %6.2f allocs/op  %8.1f B/op\n", r.name.c_str(), r.grid.c_str(),
+               r.detections < 0 ? "" : std::to_string(r.detections).c_str(),
+               r.ns_per_op, r.allocs_per_op, r.bytes_per_op);
+        fflush(stdout);
+    }
+
+    void run_all(const Options& options, std::vector<Result>* results) {
+        auto selected = [&](const std::string& name) {
+            return !options.filter || name.find(options.filter) != std::string::npos;
+        };
+        auto add = [&](const std::string& name, const std::string& grid, int detections,
+                       const std::function<void()>& op) {
+            if (!selected(name)) {
+                return;
+            }
+            results->push_back(measure(options, name, grid, detections, op));
+            print_result(results->back());
+        };
+
+        const int kDetectionCounts[] = {1, 2, 5, 10};
+        const uint8_t kZoneCounts[] = {16, 64};
+
+        // One bbox against every cell of a grid, as depth_estimation does per detection
+        for (uint8_t zones : kZoneCounts) {
+            std::vector<TofCellRegion> cells = make_grid(zones == 64 ? 8 : 4);
+            std::vector<tensorflow::Object> boxes = make_detections(10);
+            add("overlap_area", grid_name(zones), 1, [&] {
+                static size_t next = 0;
+                const tensorflow::BBox<float>& b = boxes[next++ % boxes.size()].bbox;
+                uint32_t total = 0;
+                for (const TofCellRegion& c : cells) {
+                    total += overlap_area(static_cast<uint16_t>(b.xmin), static_cast<uint16_t>(b.ymin),
+                                          static_cast<uint16_t>(b.xmax), static_cast<uint16_t>(b.ymax),
+                                          c.x_min, c.y_min, c.x_max, c.y_max);
+                }
+                keep(total);
+            });
+        }
+
+        // The device mapping (kTofSensors) is 4x4, so this one runs at 4x4 only
+        {
+            TofData tof = make_tof(16);
+            for (int count : kDetectionCounts) {
+                std::vector<tensorflow::Object> detections = make_detections(count);
+                float depths[StateLogicConfig::kMaxDetections];
+                add("depth_estimation", "4x4", count, [&] {
+                    depth_estimation(detections.data(), static_cast<uint8_t>(count), tof, depths);
+                    keep(depths);
+                });
+            }
+        }
+
+        // One PackML state classified per op, cycling through all of them
+        {
+            size_t next = 0;
+            add("host_color", "", -1, [&] {
+                HostState state = static_cast<HostState>(next);
+                next = next + 1 < kHostStateCount ? next + 1 : 0;
+                keep(host_color(state));
+            });
+        }
+
+        // One decision per op, cycling through every input combination
+        {
+            size_t bits = 0;
+            add("decide_state", "", -1, [&] {
+                DecisionInputs in{(bits & 0x1) != 0, static_cast<HostColor>((bits >> 1) % 5), (bits & 0x10) != 0,
+                                  (bits & 0x20) != 0, (bits & 0x40) != 0, (bits & 0x80) != 0};
+                bits = (bits + 1) % kDecisionInputCount;
+                keep(decide_state(in));
+            });
+        }
+
+        // Detector output as GetDetectionResults returns it (a fresh vector), every other result a person
+        for (int count : kDetectionCounts) {
+            std::vector<tensorflow::Object> raw;
+            for (int i = 0; i < count; i++) {
+                raw.push_back(tensorflow::Object{i % 2 == 0 ? kPersonClassId : 2, 0.9f, {0.1f, 0.2f, 0.6f, 0.5f}});
+            }
+            tensorflow::Object out[StateLogicConfig::kMaxDetections];
+            add("detection_postprocess", "", count, [&] {
+                std::vector<tensorflow::Object> results(raw);
+                keep(postprocess_detections(results, kImageSize, kImageSize, out, StateLogicConfig::kMaxDetections));
+            });
+        }
+
+        // One ToF frame into the background model
+        for (uint8_t zones : kZoneCounts) {
+            TofData tof = make_tof(zones);
+            TofIntrusionDetector detector;
+            DangerZoneMap zone_map;
+            uint32_t now_ms = 0;
+            add("tof_intrusion_frame", grid_name(zones), -1, [&] {
+                now_ms += 16;
+                keep(detector.on_tof_frame(tof.results[0].distance_mm, tof.results[0].target_status, zones,
+                                           zone_map.cell_stop_mm(0), true, now_ms));
+            });
+        }
+
+        // One box against every danger zone, through the compiled cell tables
+        {
+            DangerZoneMap zone_map;
+            zone_map.compile(make_danger_zones());
+            std::vector<tensorflow::Object> boxes = make_detections(10);
+            add("danger_zone_lookup", "4x4", 1, [&] {
+                static size_t next = 0;
+                keep(zone_map.lookup(boxes[next++ % boxes.size()].bbox));
+            });
+        }
+
+        // A full controller step: a detection result and a ToF frame taken in, then decided on
+        for (uint8_t zones : kZoneCounts) {
+            for (int count : kDetectionCounts) {
+                TofData tof = make_tof(zones);
+                std::vector<tensorflow::Object> detections = make_detections(count);
+                StateLogic logic;
+                uint32_t now_ms = 0;
+                add("state_logic_step", grid_name(zones), count, [&] {
+                    now_ms += 16;
+                    tof.frame_us[0] = static_cast<uint64_t>(now_ms) * 1000u;
+                    tof.timestamp_us = tof.frame_us[0];
+                    logic.on_detection(detections.data(), detections.size(), tof.timestamp_us, now_ms);
+                    logic.on_tof(tof, zones, now_ms);
+                    keep(logic.step(now_ms));
+                });
+            }
+        }
+
+        // The same with every danger zone configured: the per-frame cost must not grow with them
+        for (int count : kDetectionCounts) {
+            TofData tof = make_tof(16);
+            std::vector<tensorflow::Object> detections = make_detections(count);
+            StateLogic logic;
+            logic.set_danger_zones(make_danger_zones());
+            uint32_t now_ms = 0;
+            add("state_logic_step_zones", "4x4", count, [&] {
+                now_ms += 16;
+                tof.frame_us[0] = static_cast<uint64_t>(now_ms) * 1000u;
+                tof.timestamp_us = tof.frame_us[0];
+                logic.on_detection(detections.data(), detections.size(), tof.timestamp_us, now_ms);
+                logic.on_tof(tof, 16, now_ms);
+                keep(logic.step(now_ms));
+            });
+        }
+
+        // One camera frame, raw 324x324 BGGR to the 300x300 RGB model input as CameraConfig asks for it
+        {
+            std::vector<uint8_t> raw(324 * 324);
+            for (size_t i = 0; i < raw.size(); i++) {
+                raw[i] = static_cast<uint8_t>(i * 37 + (i >> 7));
+            }
+            std::vector<uint8_t> rgb(kImageSize * kImageSize * 3);
+            for (ConvertFilter filter : {ConvertFilter::kBilinear, ConvertFilter::kNearest}) {
+                RawConvertParams params{raw.data(), 324, 324, BayerPattern::kBGGR, rgb.data(), kImageSize, kImageSize,
+                                        filter, ConvertRotation::k270, true};
+                std::string suffix = filter == ConvertFilter::kBilinear ? "_bilinear" : "_nearest";
+                add("image_convert" + suffix, "", -1, [&] {
+                    keep(convert_raw_frame(params));
+                    keep(rgb[0]);
+                });
+                add("image_convert_reference" + suffix, "", -1, [&] {
+                    keep(convert_raw_frame_reference(params));
+                    keep(rgb[0]);
+                });
+            }
+        }
+
+        // Publish to decision through each controller wake-up scheme; one op is one reaction
+        for (bool event_driven : {true, false}) {
+            std::string name = event_driven ? "reaction_event" : "reaction_poll_10ms";
+            if (selected(name)) {
+                results->push_back(measure_reaction(options, name, event_driven));
+                print_result(results->back());
+            }
+        }
+    }
+
+    bool write_json(const char* path, const std::vector<Result>& results) {
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            return false;
+        }
+        fprintf(file, "{\n  \"schema\": 1,\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            fprintf(file, "    {\"name\": \"%s\", \"grid\": \"%s\", \"detections\": %d, \"ns_per_op\": %.2f, "
+                          "\"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f, \"iterations\": %llu}%s\n",
+                    r.name.c_str(), r.grid.c_str(), r.detections, r.ns_per_op, r.allocs_per_op, r.bytes_per_op,
+                    static_cast<unsigned long long>(r.iterations), i + 1 < results.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+        fclose(file);
+        return true;
+    }
+}
+}
+
+int main(int argc, char** argv) {
+    using namespace coralmicro;
+
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--json") == 0 && has_value) {
+            options.json = argv[++i];
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && has_value) {
+            options.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--min-ms") == 0 && has_value) {
+            options.min_ms = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--repeats") == 0 && has_value) {
+            options.repeats = std::max(1, atoi(argv[++i]));
+        }
+        else {
+            fprintf(stderr, "usage: %s [--json results.json] [--filter substring] [--min-ms 100] [--repeats 5]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    run_all(options, &results);
+
+    if (options.json && !write_json(options.json, results)) {
+        fprintf(stderr, "ERROR: can't write %s\n", options.json);
+        return 1;
+    }
+    return 0;
+}
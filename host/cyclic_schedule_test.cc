@@ -0,0 +1,133 @@
+// cyclic_schedule_test.cc
+// Compiling this runs the schedule's static_asserts (cyclic_schedule.hh) off target. It then
+// steps the executive's release rules (head_released, chained_released) minor frame by minor
+// frame for a few major frames, every release taking its whole budget, and checks what the
+// compile-time bounds promise:
+//   - time-triggered heads each get a minor frame of their own and run at their period
+//   - inference runs at stage_max_hz(kInference), not faster than the schedule allows
+//   - the busy time per major frame is schedule_utilization_permille()
+//   - no state decision uses camera or ToF data older than worst_case_staleness_ms()
+//
+//   andon_cyclic_schedule_test   (exit status 0 when every check passes; also run by ctest)
+#include <cstdio>
+#include <vector>
+
+#include "m7/cyclic_schedule.hh"
+
+namespace coralmicro {
+namespace {
+
+    constexpr uint32_t kMajorFrames = 5;
+
+    int g_failures = 0;
+
+    void check(bool ok, const char* what, uint32_t frame) {
+        if (!ok) {
+            printf("FAIL frame %u: %s\n", static_cast<unsigned>(frame), what);
+            g_failures++;
+        }
+    }
+
+    // Release time of the newest camera / ToF sample behind a stage's output, -1 before any
+    struct Origins {
+        int64_t camera_ms = -1;
+        int64_t tof_ms = -1;
+    };
+
+    struct Simulation {
+        std::vector<uint32_t> releases_ms[kStageCount];
+        Origins held[kStageCount];  // What each stage last produced from
+        uint64_t busy_ms = 0;
+        int64_t worst_decision_age_ms = 0;
+
+        // Runs a slot's stage for its budget, then what it releases, as stage_complete() does
+        void run(const StageSlot& slot, uint32_t frame, uint32_t start_ms, const Origins& input) {
+            size_t index = static_cast<size_t>(slot.stage);
+            uint32_t finish_ms = start_ms + slot.budget_ms;
+            releases_ms[index].push_back(start_ms);
+            busy_ms += slot.budget_ms;
+
+            Origins& held_origins = held[index];
+            if (input.camera_ms > held_origins.camera_ms) held_origins.camera_ms = input.camera_ms;
+            if (input.tof_ms > held_origins.tof_ms) held_origins.tof_ms = input.tof_ms;
+
+            if (slot.stage == Stage::kStateController && held_origins.camera_ms >= 0 && held_origins.tof_ms >= 0) {
+                int64_t oldest = held_origins.camera_ms < held_origins.tof_ms ? held_origins.camera_ms
+                                                                              : held_origins.tof_ms;
+                if (finish_ms - oldest > worst_decision_age_ms) {
+                    worst_decision_age_ms = finish_ms - oldest;
+                }
+            }
+
+            for (const StageSlot& consumer : kCyclicSchedule) {
+                if (chained_released(consumer, slot.stage, frame)) {
+                    run(consumer, frame, finish_ms, held_origins);
+                }
+            }
+        }
+    };
+
+    // Gaps between consecutive releases are all period_ms
+    bool steady(const std::vector<uint32_t>& releases_ms, uint32_t period_ms) {
+        for (size_t i = 1; i < releases_ms.size(); i++) {
+            if (releases_ms[i] - releases_ms[i - 1] != period_ms) {
+                return false;
+            }
+        }
+        return releases_ms.size() > 1;
+    }
+
+    void run() {
+        Simulation simulation;
+        const uint32_t frames = kMajorFrames * CyclicConfig::kFramesPerMajor;
+        for (uint32_t tick = 0; tick < frames; tick++) {
+            uint32_t frame = tick % CyclicConfig::kFramesPerMajor;
+            uint32_t now_ms = tick * CyclicConfig::kMinorFrameMs;
+
+            int heads = 0;
+            for (const StageSlot& slot : kCyclicSchedule) {
+                if (!head_released(slot, frame)) {
+                    continue;
+                }
+                heads++;
+                Origins sample;
+                (slot.stage == Stage::kCamera ? sample.camera_ms : sample.tof_ms) = now_ms;
+                simulation.run(slot, frame, now_ms, sample);
+            }
+            check(heads <= 1, "two time-triggered stages share a minor frame", frame);
+        }
+
+        for (const StageSlot& slot : kCyclicSchedule) {
+            if (slot.producer == Stage::kNone) {
+                check(steady(simulation.releases_ms[static_cast<size_t>(slot.stage)],
+                             slot.period_frames * CyclicConfig::kMinorFrameMs),
+                      "a time-triggered stage doesn't run at its period", 0);
+            }
+        }
+
+        const std::vector<uint32_t>& inference = simulation.releases_ms[static_cast<size_t>(Stage::kInference)];
+        check(steady(inference, 1000 / stage_max_hz(Stage::kInference)), "inference doesn't run at stage_max_hz", 0);
+        check(inference.size() == kMajorFrames * CyclicConfig::kMajorFrameMs * stage_max_hz(Stage::kInference) / 1000,
+              "inference release count", 0);
+
+        uint64_t permille = simulation.busy_ms * 1000 / (frames * CyclicConfig::kMinorFrameMs);
+        check(permille == schedule_utilization_permille(), "busy time differs from schedule_utilization_permille", 0);
+        check(simulation.worst_decision_age_ms > 0 &&
+              simulation.worst_decision_age_ms <= worst_case_staleness_ms(Stage::kStateController),
+              "a decision used data older than worst_case_staleness_ms", 0);
+
+        printf("%u minor frames: utilization %llu permille (limit %u), inference %u Hz, "
+               "oldest decision input %lld ms (bound %u ms), %d failures\n",
+               static_cast<unsigned>(frames), static_cast<unsigned long long>(permille),
+               static_cast<unsigned>(CyclicConfig::kMaxUtilizationPermille),
+               static_cast<unsigned>(stage_max_hz(Stage::kInference)),
+               static_cast<long long>(simulation.worst_decision_age_ms),
+               static_cast<unsigned>(worst_case_staleness_ms(Stage::kStateController)), g_failures);
+    }
+}
+}
+
+int main() {
+    coralmicro::run();
+    return coralmicro::g_failures == 0 ? 0 : 1;
+}
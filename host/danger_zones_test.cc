@@ -0,0 +1,216 @@
+// danger_zones_test.cc
+// Compiles zone sets against the ToF cell regions (tof_rgb_mapping.hh) and checks the result:
+//   - a concave polygon covers the cells its material touches, not the cells in its notch;
+//     polygons meeting a cell only along an edge or at a corner still cover it
+//   - a cell, or a box, under overlapping zones gets the strictest limits: the longest stop
+//     and warning distances, with the stop attributed to the zone it came from
+//   - a box no ToF cell sees fails safe to the strictest limits when it is within the zones'
+//     bounds, and is outside every zone otherwise
+//   - danger_zones_error() rejects sets without area, with warning_mm below stop_mm or NaN limits
+//
+//   andon_danger_zones_test   (exit status 0 when every check passes; also run by ctest)
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+
+#include "m7/danger_zones.hh"
+
+namespace coralmicro {
+namespace {
+
+    // Cells by column of the 4x4 grid, left to right in the image (x 63, 110, 157, 204 to 251)
+    constexpr uint32_t kColumn0 = (1u << 3) | (1u << 7) | (1u << 11) | (1u << 15);
+    constexpr uint32_t kColumn1 = (1u << 2) | (1u << 6) | (1u << 10) | (1u << 14);
+    constexpr uint32_t kColumn2 = (1u << 1) | (1u << 5) | (1u << 9) | (1u << 13);
+    constexpr uint32_t kColumn3 = (1u << 0) | (1u << 4) | (1u << 8) | (1u << 12);
+    constexpr uint32_t kAllCells = kColumn0 | kColumn1 | kColumn2 | kColumn3;
+    constexpr uint32_t kRow1 = (1u << 4) | (1u << 5) | (1u << 6) | (1u << 7); // y 104 to 151
+
+    int g_failures = 0;
+
+    void check(bool ok, const char* what, const char* test) {
+        if (!ok) {
+            printf("FAIL %s: %s\n", test, what);
+            g_failures++;
+        }
+    }
+
+    DangerZone zone(float stop_mm, float warning_mm, std::initializer_list<ZonePoint> vertices) {
+        DangerZone result = {};
+        result.stop_mm = stop_mm;
+        result.warning_mm = warning_mm;
+        for (const ZonePoint& vertex : vertices) {
+            result.vertices[result.vertex_count++] = vertex;
+        }
+        return result;
+    }
+
+    DangerZoneSet zone_set(std::initializer_list<DangerZone> zones) {
+        DangerZoneSet set = {};
+        for (const DangerZone& z : zones) {
+            set.zones[set.count++] = z;
+        }
+        return set;
+    }
+
+    // Compiles a set that must be valid
+    void compile(DangerZoneMap& map, const DangerZoneSet& set, const char* test) {
+        const char* error = danger_zones_error(set);
+        check(error == nullptr, error != nullptr ? error : "", test);
+        map.compile(set);
+    }
+
+    tensorflow::BBox<float> box(float xmin, float ymin, float xmax, float ymax) {
+        return tensorflow::BBox<float>{ymin, xmin, ymax, xmax};
+    }
+
+    bool limits_are(const ZoneLimits& limits, int8_t zone, float stop_mm, float warning_mm) {
+        return limits.in_zone && limits.stop_zone == zone && limits.stop_mm == stop_mm &&
+               limits.warning_mm == warning_mm;
+    }
+
+    void concave_polygon() {
+        const char* test = "concave polygon";
+        // A block over the whole grid with a notch cut up from the bottom around cells 10 and 14
+        // (x 110 to 157, y 151 to 246). Its bounding box covers them; its material doesn't.
+        DangerZoneMap map;
+        compile(map, zone_set({zone(800.0f, 2000.0f, {{60, 50}, {260, 50}, {260, 250}, {162, 250},
+                                                       {162, 148}, {105, 148}, {105, 250}, {60, 250}})}),
+                test);
+        check(map.zone_cells(0, 0) == (kAllCells & ~((1u << 10) | (1u << 14))), "cells of the concave zone", test);
+        check(map.cell_stop_mm(0)[10] == 0.0f && map.cell_stop_mm(0)[14] == 0.0f, "cells in the notch have a limit",
+              test);
+        check(map.cell_stop_mm(0)[6] == 800.0f, "cell above the notch has no limit", test);
+
+        // A person standing in the notch is seen by the ToF, and is in no zone
+        ZoneLimits limits = map.lookup(box(115.0f, 160.0f, 150.0f, 240.0f));
+        check(!limits.in_zone && limits.stop_zone == -1, "a box in the notch is in the zone", test);
+        check(limits_are(map.lookup(box(70.0f, 160.0f, 100.0f, 240.0f)), 0, 800.0f, 2000.0f),
+              "a box beside the notch isn't in the zone", test);
+    }
+
+    void edge_touching_polygons() {
+        const char* test = "edge touching";
+        DangerZoneMap map;
+
+        // Sharing the left column's edge (x = 63) covers it; a pixel short covers nothing
+        compile(map, zone_set({zone(500.0f, 900.0f, {{0, 0}, {63, 0}, {63, 300}, {0, 300}})}), test);
+        check(map.zone_cells(0, 0) == kColumn0, "a zone sharing a cell edge", test);
+        compile(map, zone_set({zone(500.0f, 900.0f, {{0, 0}, {62, 0}, {62, 300}, {0, 300}})}), test);
+        check(map.zone_cells(0, 0) == 0, "a zone left of every cell covers one", test);
+
+        // A thin band crossing row 1 with no vertex or cell corner inside the other
+        compile(map, zone_set({zone(500.0f, 900.0f, {{0, 127}, {300, 127}, {300, 129}, {0, 129}})}), test);
+        check(map.zone_cells(0, 0) == kRow1, "a band crossing a row of cells", test);
+
+        // A triangle meeting cell 0 only at its top right corner (251, 57)
+        compile(map, zone_set({zone(500.0f, 900.0f, {{251, 57}, {300, 0}, {300, 57}})}), test);
+        check(map.zone_cells(0, 0) == (1u << 0), "a zone meeting a cell at a corner", test);
+    }
+
+    void strictest_limits() {
+        const char* test = "strictest limits";
+        // Zone 0 over columns 0 and 1, zone 1 over columns 1 to 3: column 1 is under both
+        DangerZone left = zone(1000.0f, 2500.0f, {{0, 0}, {130, 0}, {130, 300}, {0, 300}});
+        DangerZone right = zone(400.0f, 3000.0f, {{120, 0}, {320, 0}, {320, 300}, {120, 300}});
+
+        DangerZoneMap map;
+        compile(map, zone_set({left, right}), test);
+        check(map.zone_cells(0, 0) == (kColumn0 | kColumn1), "cells of zone 0", test);
+        check(map.zone_cells(1, 0) == (kColumn1 | kColumn2 | kColumn3), "cells of zone 1", test);
+        check(map.cell_stop_mm(0)[3] == 1000.0f && map.cell_stop_mm(0)[1] == 400.0f, "cells under one zone", test);
+        check(map.cell_stop_mm(0)[2] == 1000.0f, "a cell under both zones isn't stopped at the longer distance",
+              test);
+
+        check(limits_are(map.lookup(box(160.0f, 60.0f, 200.0f, 100.0f)), 1, 400.0f, 3000.0f),
+              "a box under zone 1 only", test);
+        check(limits_are(map.lookup(box(115.0f, 60.0f, 150.0f, 100.0f)), 0, 1000.0f, 3000.0f),
+              "a box in the overlap doesn't get the longest of each limit", test);
+        check(limits_are(map.lookup(box(160.0f, 60.0f, 240.0f, 100.0f)), 1, 400.0f, 3000.0f),
+              "a box over columns 2 and 3", test);
+        check(limits_are(map.lookup(box(70.0f, 60.0f, 240.0f, 100.0f)), 0, 1000.0f, 3000.0f),
+              "a box across both zones", test);
+
+        // The zone order only changes which zone the stop is attributed to
+        compile(map, zone_set({right, left}), test);
+        check(map.cell_stop_mm(0)[2] == 1000.0f, "zone order changed the merged stop distance", test);
+        check(limits_are(map.lookup(box(115.0f, 60.0f, 150.0f, 100.0f)), 1, 1000.0f, 3000.0f),
+              "zone order changed the merged limits", test);
+    }
+
+    void uncovered_boxes() {
+        const char* test = "uncovered box";
+        // The cells span x 63 to 251 and y 57 to 246; these boxes are outside all of them
+        const tensorflow::BBox<float> right_of_cells = box(270.0f, 100.0f, 300.0f, 150.0f);
+        const tensorflow::BBox<float> below_cells = box(100.0f, 260.0f, 150.0f, 300.0f);
+
+        DangerZoneMap map; // The default zone: the whole image
+        check(limits_are(map.lookup(right_of_cells), 0, DangerZoneConfig::kDefaultStopMm,
+                         DangerZoneConfig::kUnlimitedMm),
+              "an unseen box under the default zone", test);
+
+        // Within the bounds of the zones: the strictest limits of all, whichever zone it is near
+        compile(map, zone_set({zone(500.0f, 900.0f, {{0, 0}, {150, 0}, {150, 320}, {0, 320}}),
+                               zone(1200.0f, 1500.0f, {{200, 0}, {320, 0}, {320, 100}, {200, 100}}),
+                               zone(300.0f, 2000.0f, {{160, 150}, {190, 150}, {190, 200}})}),
+                test);
+        check(limits_are(map.lookup(right_of_cells), 1, 1200.0f, 2000.0f),
+              "an unseen box doesn't get the strictest limits", test);
+        check(limits_are(map.lookup(below_cells), 1, 1200.0f, 2000.0f),
+              "an unseen box under the lenient zone doesn't get the strictest limits", test);
+        check(limits_are(map.lookup(box(-40.0f, -40.0f, 5.0f, 5.0f)), 1, 1200.0f, 2000.0f),
+              "an unseen box at the zones' corner", test);
+
+        // Outside the zones' bounds nothing applies
+        compile(map, zone_set({zone(500.0f, 900.0f, {{60, 50}, {200, 50}, {200, 250}, {60, 250}})}), test);
+        ZoneLimits limits = map.lookup(right_of_cells);
+        check(!limits.in_zone && limits.stop_zone == -1, "an unseen box beyond every zone is in one", test);
+
+        // Sharing an edge with a zone still fails safe: no pixel of the zone is measurable there
+        compile(map, zone_set({zone(500.0f, 900.0f, {{0, 0}, {62, 0}, {62, 300}, {0, 300}})}), test);
+        check(limits_are(map.lookup(box(30.0f, 100.0f, 62.0f, 150.0f)), 0, 500.0f, 900.0f),
+              "an unseen box in a zone no cell sees", test);
+    }
+
+    void rejected_sets() {
+        const char* test = "danger_zones_error";
+        const DangerZone valid = zone(500.0f, 900.0f, {{0, 0}, {100, 0}, {100, 100}});
+        check(danger_zones_error(default_danger_zones()) == nullptr, "the default set is rejected", test);
+        check(danger_zones_error(zone_set({valid})) == nullptr, "a valid set is rejected", test);
+
+        check(danger_zones_error(DangerZoneSet{}) != nullptr, "a set without zones", test);
+        check(danger_zones_error(zone_set({zone(500.0f, 900.0f, {{0, 0}, {100, 0}})})) != nullptr,
+              "two vertices", test);
+        check(danger_zones_error(zone_set({valid, zone(500.0f, 900.0f, {{0, 0}, {50, 50}, {100, 100}})})) !=
+                  nullptr,
+              "collinear vertices (zero area)", test);
+        check(danger_zones_error(zone_set({zone(500.0f, 900.0f, {{10, 10}, {10, 10}, {10, 10}, {10, 10}})})) !=
+                  nullptr,
+              "a point (zero area)", test);
+        check(danger_zones_error(zone_set({zone(900.0f, 500.0f, {{0, 0}, {100, 0}, {100, 100}})})) != nullptr,
+              "warning_mm below stop_mm", test);
+        check(danger_zones_error(zone_set({zone(0.0f, 900.0f, {{0, 0}, {100, 0}, {100, 100}})})) != nullptr,
+              "stop_mm zero", test);
+        check(danger_zones_error(zone_set({zone(NAN, 900.0f, {{0, 0}, {100, 0}, {100, 100}})})) != nullptr,
+              "stop_mm NaN", test);
+        check(danger_zones_error(zone_set({zone(500.0f, NAN, {{0, 0}, {100, 0}, {100, 100}})})) != nullptr,
+              "warning_mm NaN", test);
+        check(danger_zones_error(zone_set({zone(INFINITY, INFINITY, {{0, 0}, {100, 0}, {100, 100}})})) != nullptr,
+              "infinite limits", test);
+    }
+
+    void run() {
+        concave_polygon();
+        edge_touching_polygons();
+        strictest_limits();
+        uncovered_boxes();
+        rejected_sets();
+        printf("danger zones: %d failures\n", g_failures);
+    }
+}
+}
+
+int main() {
+    coralmicro::run();
+    return coralmicro::g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,563 @@
+// evaluate.cc
+// Scores the perception pipeline on a labeled capture: the capture is replayed through the
+// detection post-processing, depth_estimation and the state logic, and the outcome is held
+// against the ground truth scripts/label_recording.py added to it.
+//
+//   andon_eval capture.andr [--detector device|reference] [--iou 0.5] [--max-detections 1]
+//              [--label-gap-ms 3000] [--approach on|off] [--stop-budget-ms N] [--min-speed-mm-s N]
+//              [--json]
+//
+// --detector device (default) replays the detections the EdgeTPU model gave on the device.
+// --detector reference swaps in, for every frame that has one, the raw output of the CPU
+// TFLite model scripts/reference_detect.py added, run through the device's post-processing.
+// Timing is always the device's: a swapped result arrives when the device's result did.
+//
+// The approach prediction runs with the tuning the capture recorded unless any of --approach,
+// --stop-budget-ms or --min-speed-mm-s is given; the rest then keep their defaults. Sweeping
+// the stop budget over an installation's captures trades reaction time against false STOPs.
+//
+// Reported: detection recall and precision on the labeled frames (IoU matching), depth error
+// of the matched persons, false STOP rate and the reaction time from a person entering the
+// stop distance of their danger zone to STOPPED. Labels are held against the zones the capture
+// recorded, as the device held its detections. scripts/eval_compare.py diffs two --json runs.
+//
+// Exit status: 0 with a report, 2 on a bad file or one without labels.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "m7/detection_postprocess.hh"
+#include "replay_driver.hh"
+
+namespace coralmicro {
+namespace {
+
+    constexpr size_t kMaxLabeledPersons = 32; // Per frame
+
+    struct EvalOptions {
+        bool reference = false;
+        float iou = 0.5f;             // Overlap for a detection to count as finding a labeled person
+        size_t max_detections = 1;    // g_max_detections_per_inference, what detect_objects keeps
+        uint32_t label_gap_ms = 3000; // How long before a STOP a labeled danger still justifies it
+        bool approach_override = false;
+        ApproachParams approach;
+        bool json = false;
+    };
+
+    struct LabeledFrame {
+        std::vector<GroundTruthPerson> persons;
+        bool in_danger = false; // A person within the stop distance of their danger zone
+    };
+
+    struct FrameSize {
+        uint16_t width;
+        uint16_t height;
+    };
+
+    // Everything added on the host, keyed by capture time. Collected before the replay,
+    // as the tools append it after the device's chunks.
+    struct Annotations {
+        std::map<uint64_t, LabeledFrame> labels;
+        std::map<uint64_t, std::vector<tensorflow::Object>> reference; // Normalized, every class
+        std::map<uint64_t, FrameSize> frame_sizes;                      // Of the camera frames
+        std::map<uint64_t, DangerZoneSet> zones;                        // By the time the device took them up
+        uint32_t malformed = 0;
+    };
+
+    void collect_annotations(const std::vector<uint8_t>& data, Annotations* annotations) {
+        ChunkReader reader = recording_chunks(data);
+        ChunkHeader header;
+        const uint8_t* payload;
+        while (reader.next(&header, &payload)) {
+            switch (header.type) {
+                case ChunkType::kGroundTruth: {
+                    GroundTruthPerson persons[kMaxLabeledPersons];
+                    uint8_t count;
+                    uint64_t capture_us;
+                    if (!unpack_ground_truth(payload, header.length, persons, kMaxLabeledPersons, &count,
+                                             &capture_us)) {
+                        annotations->malformed++;
+                        break;
+                    }
+                    annotations->labels[capture_us].persons.assign(persons, persons + count);
+                    break;
+                }
+
+                case ChunkType::kDangerZones: {
+                    DangerZoneSet zones;
+                    if (!unpack_danger_zones(payload, header.length, &zones) || danger_zones_error(zones)) {
+                        annotations->malformed++;
+                        break;
+                    }
+                    annotations->zones[header.timestamp_us] = zones;
+                    break;
+                }
+
+                case ChunkType::kReferenceDetections: {
+                    tensorflow::Object objects[UINT8_MAX];
+                    uint8_t count;
+                    uint64_t capture_us;
+                    if (!unpack_detections(payload, header.length, objects, UINT8_MAX, &count, &capture_us)) {
+                        annotations->malformed++;
+                        break;
+                    }
+                    annotations->reference[capture_us].assign(objects, objects + count);
+                    break;
+                }
+
+                case ChunkType::kCameraFrame: {
+                    uint16_t width, height;
+                    const uint8_t* pixels;
+                    size_t pixel_bytes;
+                    if (!unpack_camera_frame(payload, header.length, &width, &height, &pixels, &pixel_bytes)) {
+                        annotations->malformed++;
+                        break;
+                    }
+                    annotations->frame_sizes[header.timestamp_us] = {width, height};
+                    break;
+                }
+
+                default:
+                    break;
+            }
+        }
+
+        // Each labeled person is held against the zones in effect when their frame was taken
+        DangerZoneMap zone_map;
+        auto next_zones = annotations->zones.begin();
+        for (auto& [capture_us, frame] : annotations->labels) {
+            for (; next_zones != annotations->zones.end() && next_zones->first <= capture_us; ++next_zones) {
+                zone_map.compile(next_zones->second);
+            }
+            frame.in_danger = false;
+            for (const GroundTruthPerson& person : frame.persons) {
+                ZoneLimits limits = zone_map.lookup(person.bbox);
+                frame.in_danger |= limits.in_zone && person.distance_mm <= limits.stop_mm;
+            }
+        }
+    }
+
+    float iou(const tensorflow::BBox<float>& a, const tensorflow::BBox<float>& b) {
+        float w = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
+        float h = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
+        if (w <= 0.0f || h <= 0.0f) {
+            return 0.0f;
+        }
+        float overlap = w * h;
+        float area_a = (a.xmax - a.xmin) * (a.ymax - a.ymin);
+        float area_b = (b.xmax - b.xmin) * (b.ymax - b.ymin);
+        return overlap / (area_a + area_b - overlap);
+    }
+
+    // Nearest rank; values must not be empty
+    float percentile(std::vector<float> values, float p) {
+        std::sort(values.begin(), values.end());
+        size_t rank = static_cast<size_t>(p / 100.0f * static_cast<float>(values.size()) + 0.999f);
+        rank = std::min(std::max(rank, static_cast<size_t>(1)), values.size());
+        return values[rank - 1];
+    }
+
+    struct Distribution {
+        size_t count = 0;
+        float mean = 0.0f;
+        float p50 = 0.0f;
+        float p90 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+
+        static Distribution of(const std::vector<float>& values) {
+            Distribution d;
+            d.count = values.size();
+            if (values.empty()) {
+                return d;
+            }
+            double sum = 0.0;
+            for (float v : values) {
+                sum += v;
+            }
+            d.mean = static_cast<float>(sum / values.size());
+            d.p50 = percentile(values, 50.0f);
+            d.p90 = percentile(values, 90.0f);
+            d.p95 = percentile(values, 95.0f);
+            d.p99 = percentile(values, 99.0f);
+            d.max = *std::max_element(values.begin(), values.end());
+            return d;
+        }
+
+        void print_json(const char* name) const {
+            if (count == 0) {
+                printf("\"%s\":null", name);
+                return;
+            }
+            printf("\"%s\":{\"count\":%zu,\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p95\":%.3f,\"p99\":%.3f,"
+                   "\"max\":%.3f}",
+                   name, count, mean, p50, p90, p95, p99, max);
+        }
+
+        void print_text(const char* name, const char* unit) const {
+            if (count == 0) {
+                printf("  %-18s -\n", name);
+                return;
+            }
+            printf("  %-18s mean %.1f  p50 %.1f  p90 %.1f  p95 %.1f  p99 %.1f  max %.1f %s  (n=%zu)\n",
+                   name, mean, p50, p90, p95, p99, max, unit, count);
+        }
+    };
+
+    class Evaluation : public ReplayDriver {
+    public:
+        Evaluation(const Annotations& annotations, const EvalOptions& options)
+            : annotations_(annotations), options_(options) {}
+
+        void report(uint64_t end_us) const {
+            // Detection
+            float recall = persons_ ? static_cast<float>(true_positives_) / persons_ : 0.0f;
+            size_t detected = true_positives_ + false_positives_;
+            float precision = detected ? static_cast<float>(true_positives_) / detected : 0.0f;
+
+            // Depth, of the persons the detector found
+            std::vector<float> abs_errors;
+            double signed_sum = 0.0;
+            for (float error : depth_errors_) {
+                abs_errors.push_back(std::fabs(error));
+                signed_sum += error;
+            }
+            Distribution depth = Distribution::of(abs_errors);
+            float bias = depth_errors_.empty() ? 0.0f : static_cast<float>(signed_sum / depth_errors_.size());
+
+            // STOPs the perception side took (the host's RED is the host's call). One is false when
+            // no labeled frame from label_gap before it until it ends has anyone in danger; a stop
+            // called ahead of the crossing is justified by the person crossing while it holds.
+            size_t stops = 0, judged_stops = 0, false_stops = 0;
+            for (size_t i = 0; i < changes_.size(); i++) {
+                const Change& change = changes_[i];
+                if (change.to != SystemState::STOPPED || change.host_connected) {
+                    continue;
+                }
+                stops++;
+                uint64_t gap_us = static_cast<uint64_t>(options_.label_gap_ms) * 1000u;
+                uint64_t from_us = change.timestamp_us > gap_us ? change.timestamp_us - gap_us : 0;
+                uint64_t until_us = i + 1 < changes_.size() ? changes_[i + 1].timestamp_us : end_us;
+
+                bool judged = false;
+                bool danger = false;
+                for (auto label = annotations_.labels.lower_bound(from_us);
+                     label != annotations_.labels.end() && label->first <= until_us; ++label) {
+                    judged = true;
+                    danger = danger || label->second.in_danger;
+                }
+                judged_stops += judged ? 1 : 0;
+                false_stops += judged && !danger ? 1 : 0;
+            }
+            float false_stop_rate = judged_stops ? static_cast<float>(false_stops) / judged_stops : 0.0f;
+
+            // Reaction: from the capture of the first labeled frame with someone in danger to STOPPED,
+            // missed if the labels show them out of danger again (or the capture ends) first
+            std::vector<float> reactions_ms;
+            size_t onsets = 0, missed = 0;
+            bool previous_in_danger = true; // The first frame's onset time is unknown
+            for (auto label = annotations_.labels.begin(); label != annotations_.labels.end(); ++label) {
+                bool onset = label->second.in_danger && !previous_in_danger;
+                previous_in_danger = label->second.in_danger;
+                if (!onset || label->first > end_us) {
+                    continue;
+                }
+                onsets++;
+
+                uint64_t until_us = end_us;
+                for (auto next = std::next(label); next != annotations_.labels.end(); ++next) {
+                    if (!next->second.in_danger) {
+                        until_us = next->first;
+                        break;
+                    }
+                }
+
+                // Already stopped counts from when that stop began, so a stop ahead of the
+                // crossing (approach prediction) comes out negative
+                const Change* stop = nullptr;
+                for (const Change& change : changes_) {
+                    if (change.timestamp_us <= label->first) {
+                        stop = change.to == SystemState::STOPPED ? &change : nullptr;
+                        continue;
+                    }
+                    if (stop != nullptr || change.timestamp_us > until_us) {
+                        break;
+                    }
+                    if (change.to == SystemState::STOPPED) {
+                        stop = &change;
+                        break;
+                    }
+                }
+                if (stop == nullptr) {
+                    missed++;
+                    continue;
+                }
+                reactions_ms.push_back((static_cast<int64_t>(stop->timestamp_us) -
+                                        static_cast<int64_t>(label->first)) / 1000.0f);
+            }
+            Distribution reaction = Distribution::of(reactions_ms);
+
+            const ApproachParams& approach = logic().approach_params();
+            if (options_.json) {
+                printf("{\"schema\":1,\"detector\":\"%s\",\"iou\":%.2f,", options_.reference ? "reference" : "device",
+                       options_.iou);
+                printf("\"approach\":{\"enabled\":%s,\"stop_budget_ms\":%u,\"min_speed_mm_s\":%.1f,"
+                       "\"predicted_stops\":%zu},",
+                       approach.enabled ? "true" : "false", approach.stop_budget_ms, approach.min_speed_mm_s,
+                       predicted_stops_);
+                printf("\"danger_zones\":%u,", static_cast<unsigned>(logic().danger_zones().count));
+                printf("\"frames\":{\"labeled\":%zu,\"evaluated\":%zu,\"substituted\":%zu,\"unsubstituted\":%zu},",
+                       annotations_.labels.size(), evaluated_frames_, substituted_, unsubstituted_);
+                printf("\"detection\":{\"persons\":%zu,\"true_positives\":%zu,\"false_positives\":%zu,"
+                       "\"recall\":%.4f,\"precision\":%.4f},",
+                       persons_, true_positives_, false_positives_, recall, precision);
+                printf("\"depth\":{\"matched\":%zu,\"unknown\":%zu,\"bias_mm\":%.3f,", depth_errors_.size(),
+                       depth_unknown_, bias);
+                depth.print_json("abs_error_mm");
+                printf("},");
+                printf("\"stops\":{\"entries\":%zu,\"judged\":%zu,\"false\":%zu,\"false_rate\":%.4f},", stops,
+                       judged_stops, false_stops, false_stop_rate);
+                printf("\"reaction\":{\"onsets\":%zu,\"missed\":%zu,", onsets, missed);
+                reaction.print_json("ms");
+                printf("}}\n");
+                return;
+            }
+
+            print_counts();
+            printf("detector: %s (%zu results swapped in, %zu kept from the device)\n",
+                   options_.reference ? "reference" : "device", substituted_, unsubstituted_);
+            printf("approach prediction: %s, stop budget %u ms, min speed %.0f mm/s (%s), %zu predicted dangers\n",
+                   approach.enabled ? "on" : "off", approach.stop_budget_ms, approach.min_speed_mm_s,
+                   options_.approach_override ? "overridden" : "as recorded", predicted_stops_);
+            printf("labeled frames: %zu, with a detector result in the capture: %zu\n",
+                   annotations_.labels.size(), evaluated_frames_);
+            printf("detection (IoU >= %.2f):\n", options_.iou);
+            printf("  recall             %.4f  (%zu of %zu persons)\n", recall, true_positives_, persons_);
+            printf("  precision          %.4f  (%zu false positives)\n", precision, false_positives_);
+            printf("depth of matched persons (%zu estimated, %zu unknown), bias %+.1f mm:\n",
+                   depth_errors_.size(), depth_unknown_, bias);
+            depth.print_text("abs error", "mm");
+            printf("STOP entries (perception): %zu, judged by a label: %zu, false: %zu, false STOP rate %.4f\n",
+                   stops, judged_stops, false_stops, false_stop_rate);
+            printf("danger zones: %u at the end\n", static_cast<unsigned>(logic().danger_zones().count));
+            printf("reaction to entering a stop distance: %zu onsets, %zu missed\n", onsets, missed);
+            reaction.print_text("to STOPPED", "ms");
+        }
+
+    private:
+        struct Change {
+            uint64_t timestamp_us;
+            SystemState to;
+            bool host_connected;
+        };
+
+        uint8_t detections_for(uint64_t capture_us, tensorflow::Object* objects, uint8_t count) override {
+            pending_capture_us_ = capture_us;
+            pending_ = true;
+            if (!options_.reference) {
+                return count;
+            }
+
+            auto reference = annotations_.reference.find(capture_us);
+            auto size = annotations_.frame_sizes.find(capture_us);
+            if (reference == annotations_.reference.end() || size == annotations_.frame_sizes.end()) {
+                unsubstituted_++;
+                return count;
+            }
+            substituted_++;
+            return postprocess_detections(reference->second, size->second.width, size->second.height, objects,
+                                          std::min(options_.max_detections, StateLogicConfig::kMaxDetections));
+        }
+
+        void on_step(uint64_t now_us, SystemState from, SystemState to) override {
+            if (pending_) {
+                pending_ = false;
+                evaluate_frame(pending_capture_us_);
+            }
+            if (logic().approach_stop() && !approach_stop_) {
+                predicted_stops_++;
+            }
+            approach_stop_ = logic().approach_stop();
+            if (to != from) {
+                changes_.push_back({now_us, to, logic().inputs().host_connected});
+            }
+        }
+
+        // What the step just taken did with the result of a labeled frame
+        void evaluate_frame(uint64_t capture_us) {
+            auto label = annotations_.labels.find(capture_us);
+            if (label == annotations_.labels.end()) {
+                return;
+            }
+            evaluated_frames_++;
+            const std::vector<GroundTruthPerson>& persons = label->second.persons;
+            const tensorflow::Object* detections = logic().detections();
+            uint8_t count = logic().detection_count();
+
+            // Greedy one-to-one matching, best overlap first
+            struct Pair {
+                float iou;
+                size_t person;
+                uint8_t detection;
+            };
+            std::vector<Pair> pairs;
+            for (size_t p = 0; p < persons.size(); p++) {
+                for (uint8_t d = 0; d < count; d++) {
+                    float overlap = iou(persons[p].bbox, detections[d].bbox);
+                    if (overlap >= options_.iou) {
+                        pairs.push_back({overlap, p, d});
+                    }
+                }
+            }
+            std::sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b) { return a.iou > b.iou; });
+
+            std::vector<bool> person_matched(persons.size(), false);
+            std::vector<bool> detection_matched(count, false);
+            size_t matched = 0;
+            for (const Pair& pair : pairs) {
+                if (person_matched[pair.person] || detection_matched[pair.detection]) {
+                    continue;
+                }
+                person_matched[pair.person] = true;
+                detection_matched[pair.detection] = true;
+                matched++;
+
+                float depth = logic().depth_updated() ? logic().depths()[pair.detection] : -1.0f;
+                if (depth < 0.0f) {
+                    depth_unknown_++;
+                }
+                else {
+                    depth_errors_.push_back(depth - persons[pair.person].distance_mm);
+                }
+            }
+
+            persons_ += persons.size();
+            true_positives_ += matched;
+            false_positives_ += count - matched;
+        }
+
+        const Annotations& annotations_;
+        EvalOptions options_;
+
+        bool pending_ = false;
+        uint64_t pending_capture_us_ = 0;
+        size_t substituted_ = 0;
+        size_t unsubstituted_ = 0;
+
+        size_t evaluated_frames_ = 0;
+        size_t persons_ = 0;
+        size_t true_positives_ = 0;
+        size_t false_positives_ = 0;
+        std::vector<float> depth_errors_; // Estimated minus labeled
+        size_t depth_unknown_ = 0;
+
+        bool approach_stop_ = false;
+        size_t predicted_stops_ = 0; // Dangers the approach prediction called before the distance was reached
+        std::vector<Change> changes_;
+    };
+}
+}
+
+int main(int argc, char** argv) {
+    using namespace coralmicro;
+
+    const char* path = nullptr;
+    EvalOptions options;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        }
+        else if (strcmp(argv[i], "--detector") == 0 && has_value) {
+            const char* detector = argv[++i];
+            if (strcmp(detector, "reference") != 0 && strcmp(detector, "device") != 0) {
+                fprintf(stderr, "ERROR: unknown detector %s\n", detector);
+                return 2;
+            }
+            options.reference = strcmp(detector, "reference") == 0;
+        }
+        else if (strcmp(argv[i], "--iou") == 0 && has_value) {
+            options.iou = strtof(argv[++i], nullptr);
+        }
+        else if (strcmp(argv[i], "--max-detections") == 0 && has_value) {
+            options.max_detections = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--label-gap-ms") == 0 && has_value) {
+            options.label_gap_ms = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--approach") == 0 && has_value) {
+            options.approach_override = true;
+            options.approach.enabled = strcmp(argv[++i], "off") != 0;
+        }
+        else if (strcmp(argv[i], "--stop-budget-ms") == 0 && has_value) {
+            options.approach_override = true;
+            options.approach.stop_budget_ms = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--min-speed-mm-s") == 0 && has_value) {
+            options.approach_override = true;
+            options.approach.min_speed_mm_s = strtof(argv[++i], nullptr);
+        }
+        else if (argv[i][0] != '-') {
+            path = argv[i];
+        }
+        else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (path == nullptr) {
+        fprintf(stderr,
+                "usage: %s capture.andr [--detector device|reference] [--iou 0.5] [--max-detections 1]\n"
+                "       [--label-gap-ms 3000] [--approach on|off] [--stop-budget-ms N] [--min-speed-mm-s N] [--json]\n",
+                argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> data;
+    if (!load_recording(path, &data)) {
+        return 2;
+    }
+
+    Annotations annotations;
+    collect_annotations(data, &annotations);
+    if (annotations.labels.empty()) {
+        fprintf(stderr, "ERROR: %s has no ground truth (scripts/label_recording.py apply)\n", path);
+        return 2;
+    }
+    if (options.reference && annotations.reference.empty()) {
+        fprintf(stderr, "ERROR: %s has no reference detections (scripts/reference_detect.py)\n", path);
+        return 2;
+    }
+
+    Evaluation evaluation(annotations, options);
+    if (options.approach_override) {
+        evaluation.override_approach_params(options.approach);
+    }
+    ChunkReader reader = recording_chunks(data);
+    ChunkHeader header;
+    const uint8_t* payload;
+    uint64_t end_us = 0;
+    while (reader.next(&header, &payload)) {
+        evaluation.on_chunk(header, payload);
+        bool device_chunk = header.type != ChunkType::kGroundTruth && header.type != ChunkType::kReferenceDetections;
+        if (device_chunk && header.timestamp_us > end_us) {
+            end_us = header.timestamp_us;
+        }
+    }
+
+    if (reader.truncated() && !options.json) {
+        printf("warning: recording ends inside a chunk at byte %zu\n",
+               RecordingFormat::kFileHeaderBytes + reader.offset());
+    }
+    if (annotations.malformed != 0 && !options.json) {
+        printf("warning: %u malformed label or reference chunks skipped\n", annotations.malformed);
+    }
+    evaluation.report(end_us);
+    return 0;
+}
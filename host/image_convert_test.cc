@@ -0,0 +1,300 @@
+// image_convert_test.cc
+// Checks the single-pass raw frame conversion (image_convert.hh):
+//   - convert_raw_frame matches convert_raw_frame_reference byte for byte over every Bayer
+//     pattern, filter, rotation and letterbox setting, on the camera's geometry and odd ones.
+//     The host runs the portable lane code; __ARM_FEATURE_DSP swaps only the byte unpacking.
+//   - Against an independent demosaic: a flat colour field comes out as that colour, a 1:1
+//     nearest conversion is the per-window demosaic rotated clockwise as asked, and a 2:1
+//     bilinear one blends neighbouring windows with the rounding image_convert.hh documents.
+//   - Letterbox bars are black and the content keeps the source aspect ratio.
+//
+//   andon_image_convert_test   (exit status 0 when every check passes; also run by ctest)
+#include <cstdio>
+#include <vector>
+
+#include "m7/image_convert.hh"
+
+namespace coralmicro {
+namespace {
+
+    int g_failures = 0;
+
+    void check(bool ok, const char* what, const char* config) {
+        if (!ok) {
+            printf("FAIL %s: %s\n", config, what);
+            g_failures++;
+        }
+    }
+
+    const BayerPattern kPatterns[] = {BayerPattern::kRGGB, BayerPattern::kBGGR, BayerPattern::kGRBG, BayerPattern::kGBRG};
+    const ConvertFilter kFilters[] = {ConvertFilter::kNearest, ConvertFilter::kBilinear};
+    const ConvertRotation kRotations[] = {ConvertRotation::k0, ConvertRotation::k90, ConvertRotation::k180,
+                                          ConvertRotation::k270};
+
+    // Colour a photosite of the pattern sees: 0 = R, 1 = G, 2 = B
+    int site_channel(BayerPattern pattern, uint32_t x, uint32_t y) {
+        bool odd_x = x & 1;
+        bool odd_y = y & 1;
+        switch (pattern) {
+            case BayerPattern::kRGGB: return odd_x == odd_y ? (odd_x ? 2 : 0) : 1;
+            case BayerPattern::kBGGR: return odd_x == odd_y ? (odd_x ? 0 : 2) : 1;
+            case BayerPattern::kGRBG: return odd_x == odd_y ? 1 : (odd_x ? 0 : 2);
+            case BayerPattern::kGBRG: return odd_x == odd_y ? 1 : (odd_x ? 2 : 0);
+        }
+        return 1;
+    }
+
+    // RGB of the 2x2 photosite window at (x, y): its R and B, and its two G averaged rounding up
+    void demosaic_window(const std::vector<uint8_t>& raw, uint32_t width, BayerPattern pattern,
+                         uint32_t x, uint32_t y, uint8_t rgb[3]) {
+        uint32_t green = 0;
+        for (uint32_t dy = 0; dy < 2; dy++) {
+            for (uint32_t dx = 0; dx < 2; dx++) {
+                uint8_t value = raw[(y + dy) * width + x + dx];
+                int channel = site_channel(pattern, x + dx, y + dy);
+                if (channel == 1) {
+                    green += value;
+                }
+                else {
+                    rgb[channel] = value;
+                }
+            }
+        }
+        rgb[1] = static_cast<uint8_t>((green + 1) >> 1);
+    }
+
+    // Deterministic photosite noise
+    std::vector<uint8_t> make_raw(uint32_t width, uint32_t height, uint32_t seed) {
+        std::vector<uint8_t> raw(width * height);
+        uint32_t state = seed * 2654435761u + 1;
+        for (uint8_t& site : raw) {
+            state = state * 1664525u + 1013904223u;
+            site = static_cast<uint8_t>(state >> 24);
+        }
+        return raw;
+    }
+
+    RawConvertParams make_params(const std::vector<uint8_t>& raw, uint32_t raw_width, uint32_t raw_height,
+                                 std::vector<uint8_t>* rgb, uint32_t out_width, uint32_t out_height,
+                                 BayerPattern pattern, ConvertFilter filter, ConvertRotation rotation,
+                                 bool preserve_ratio) {
+        rgb->assign(out_width * out_height * 3, 0xAA); // Anything left unwritten shows
+        return RawConvertParams{raw.data(), raw_width, raw_height, pattern, rgb->data(), out_width, out_height,
+                                filter, rotation, preserve_ratio};
+    }
+
+    void check_packed_matches_reference() {
+        struct Size { uint32_t raw_width, raw_height, out_width, out_height; };
+        const Size kSizes[] = {
+            {324, 324, 300, 300}, // The camera (CameraConfig)
+            {324, 244, 300, 300}, // Letterboxed either way after rotation
+            {64, 48, 96, 96},     // Upscaling
+            {7, 5, 3, 11},        // Odd sizes, clamped edges
+        };
+
+        char config[96];
+        for (const Size& size : kSizes) {
+            std::vector<uint8_t> raw = make_raw(size.raw_width, size.raw_height, size.raw_width);
+            for (BayerPattern pattern : kPatterns) {
+                for (ConvertFilter filter : kFilters) {
+                    for (ConvertRotation rotation : kRotations) {
+                        for (bool preserve_ratio : {false, true}) {
+                            snprintf(config, sizeof(config), "%ux%u->%ux%u pattern %d filter %d rotation %d ratio %d",
+                                     size.raw_width, size.raw_height, size.out_width, size.out_height,
+                                     static_cast<int>(pattern), static_cast<int>(filter),
+                                     static_cast<int>(rotation), preserve_ratio);
+                            std::vector<uint8_t> packed, reference;
+                            RawConvertParams a = make_params(raw, size.raw_width, size.raw_height, &packed,
+                                                             size.out_width, size.out_height, pattern, filter,
+                                                             rotation, preserve_ratio);
+                            RawConvertParams b = make_params(raw, size.raw_width, size.raw_height, &reference,
+                                                             size.out_width, size.out_height, pattern, filter,
+                                                             rotation, preserve_ratio);
+                            check(convert_raw_frame(a) && convert_raw_frame_reference(b), "conversion failed", config);
+                            check(packed == reference, "packed and reference outputs differ", config);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void check_flat_field() {
+        const uint8_t kColor[3] = {200, 90, 30};
+        const uint32_t kRawWidth = 324, kRawHeight = 244, kOut = 300;
+
+        char config[64];
+        for (BayerPattern pattern : kPatterns) {
+            std::vector<uint8_t> raw(kRawWidth * kRawHeight);
+            for (uint32_t y = 0; y < kRawHeight; y++) {
+                for (uint32_t x = 0; x < kRawWidth; x++) {
+                    raw[y * kRawWidth + x] = kColor[site_channel(pattern, x, y)];
+                }
+            }
+
+            for (ConvertFilter filter : kFilters) {
+                for (ConvertRotation rotation : kRotations) {
+                    snprintf(config, sizeof(config), "flat pattern %d filter %d rotation %d",
+                             static_cast<int>(pattern), static_cast<int>(filter), static_cast<int>(rotation));
+                    std::vector<uint8_t> rgb;
+                    RawConvertParams params = make_params(raw, kRawWidth, kRawHeight, &rgb, kOut, kOut, pattern,
+                                                          filter, rotation, true);
+                    check(convert_raw_frame(params), "conversion failed", config);
+
+                    // 324x244 fits 300x226 upright, 226x300 on its side, centred
+                    bool upright = rotation == ConvertRotation::k0 || rotation == ConvertRotation::k180;
+                    uint32_t width = upright ? 300 : 226;
+                    uint32_t height = upright ? 226 : 300;
+                    uint32_t x0 = (kOut - width) / 2, y0 = (kOut - height) / 2;
+
+                    bool content_ok = true, bars_ok = true;
+                    for (uint32_t y = 0; y < kOut; y++) {
+                        for (uint32_t x = 0; x < kOut; x++) {
+                            const uint8_t* px = &rgb[(y * kOut + x) * 3];
+                            bool content = x >= x0 && x < x0 + width && y >= y0 && y < y0 + height;
+                            for (int c = 0; c < 3; c++) {
+                                content_ok = content_ok && (!content || px[c] == kColor[c]);
+                                bars_ok = bars_ok && (content || px[c] == 0);
+                            }
+                        }
+                    }
+                    check(content_ok, "flat colour changed", config);
+                    check(bars_ok, "letterbox bars aren't black or are misplaced", config);
+                }
+            }
+        }
+    }
+
+    void check_nearest_identity() {
+        const uint32_t kWidth = 20, kHeight = 14;
+        std::vector<uint8_t> raw = make_raw(kWidth, kHeight, 7);
+
+        char config[64];
+        for (BayerPattern pattern : kPatterns) {
+            for (ConvertRotation rotation : kRotations) {
+                snprintf(config, sizeof(config), "1:1 nearest pattern %d rotation %d",
+                         static_cast<int>(pattern), static_cast<int>(rotation));
+                bool upright = rotation == ConvertRotation::k0 || rotation == ConvertRotation::k180;
+                uint32_t out_width = upright ? kWidth : kHeight;
+                uint32_t out_height = upright ? kHeight : kWidth;
+
+                std::vector<uint8_t> rgb;
+                RawConvertParams params = make_params(raw, kWidth, kHeight, &rgb, out_width, out_height, pattern,
+                                                      ConvertFilter::kNearest, rotation, false);
+                check(convert_raw_frame(params), "conversion failed", config);
+
+                bool ok = true;
+                for (uint32_t oy = 0; oy < out_height; oy++) {
+                    for (uint32_t ox = 0; ox < out_width; ox++) {
+                        // The photosite each output pixel shows, turning the image clockwise
+                        uint32_t sx, sy;
+                        switch (rotation) {
+                            case ConvertRotation::k90:  sx = oy;              sy = kHeight - 1 - ox; break;
+                            case ConvertRotation::k180: sx = kWidth - 1 - ox; sy = kHeight - 1 - oy; break;
+                            case ConvertRotation::k270: sx = kWidth - 1 - oy; sy = ox;               break;
+                            default:                    sx = ox;              sy = oy;               break;
+                        }
+                        // Windows start at most one photosite before the edge
+                        uint8_t expected[3];
+                        demosaic_window(raw, kWidth, pattern, sx < kWidth - 1 ? sx : kWidth - 2,
+                                        sy < kHeight - 1 ? sy : kHeight - 2, expected);
+                        const uint8_t* px = &rgb[(oy * out_width + ox) * 3];
+                        ok = ok && px[0] == expected[0] && px[1] == expected[1] && px[2] == expected[2];
+                    }
+                }
+                check(ok, "output isn't the rotated window demosaic", config);
+            }
+        }
+    }
+
+    uint8_t lerp(uint8_t a, uint8_t b, uint32_t f) {
+        return static_cast<uint8_t>((a * (256 - f) + b * f + 128) >> 8);
+    }
+
+    // A 2:1 bilinear downscale samples halfway between two windows on both axes, so away from
+    // the clamped edges every pixel is the documented separable rounding over four windows
+    void check_bilinear_halving() {
+        const uint32_t kWidth = 20, kHeight = 14;
+        std::vector<uint8_t> raw = make_raw(kWidth, kHeight, 11);
+
+        char config[64];
+        for (BayerPattern pattern : kPatterns) {
+            for (ConvertRotation rotation : kRotations) {
+                snprintf(config, sizeof(config), "2:1 bilinear pattern %d rotation %d",
+                         static_cast<int>(pattern), static_cast<int>(rotation));
+                bool upright = rotation == ConvertRotation::k0 || rotation == ConvertRotation::k180;
+                uint32_t out_width = (upright ? kWidth : kHeight) / 2;
+                uint32_t out_height = (upright ? kHeight : kWidth) / 2;
+
+                std::vector<uint8_t> rgb;
+                RawConvertParams params = make_params(raw, kWidth, kHeight, &rgb, out_width, out_height, pattern,
+                                                      ConvertFilter::kBilinear, rotation, false);
+                check(convert_raw_frame(params), "conversion failed", config);
+
+                bool ok = true;
+                size_t checked = 0;
+                for (uint32_t oy = 0; oy < out_height; oy++) {
+                    for (uint32_t ox = 0; ox < out_width; ox++) {
+                        // Pixel centres land on half photosites: position = 2 * index + 0.5, as 2x
+                        int32_t rx2 = 4 * static_cast<int32_t>(ox) + 1;
+                        int32_t ry2 = 4 * static_cast<int32_t>(oy) + 1;
+                        int32_t w2 = 2 * static_cast<int32_t>(kWidth - 1), h2 = 2 * static_cast<int32_t>(kHeight - 1);
+                        int32_t sx2, sy2;
+                        switch (rotation) {
+                            case ConvertRotation::k90:  sx2 = ry2;      sy2 = h2 - rx2; break;
+                            case ConvertRotation::k180: sx2 = w2 - rx2; sy2 = h2 - ry2; break;
+                            case ConvertRotation::k270: sx2 = w2 - ry2; sy2 = rx2;      break;
+                            default:                    sx2 = rx2;      sy2 = ry2;      break;
+                        }
+                        uint32_t x = static_cast<uint32_t>(sx2 / 2), y = static_cast<uint32_t>(sy2 / 2);
+                        if (x > kWidth - 3 || y > kHeight - 3) {
+                            continue; // Clamped: covered by the reference comparison
+                        }
+
+                        uint8_t c00[3], c10[3], c01[3], c11[3];
+                        demosaic_window(raw, kWidth, pattern, x, y, c00);
+                        demosaic_window(raw, kWidth, pattern, x + 1, y, c10);
+                        demosaic_window(raw, kWidth, pattern, x, y + 1, c01);
+                        demosaic_window(raw, kWidth, pattern, x + 1, y + 1, c11);
+                        const uint8_t* px = &rgb[(oy * out_width + ox) * 3];
+                        for (int c = 0; c < 3; c++) {
+                            uint8_t top = lerp(c00[c], c10[c], 128);
+                            uint8_t bottom = lerp(c01[c], c11[c], 128);
+                            ok = ok && px[c] == lerp(top, bottom, 128);
+                        }
+                        checked++;
+                    }
+                }
+                check(ok, "interior isn't the bilinear blend of the window demosaic", config);
+                check(checked >= (out_width - 1) * (out_height - 1), "too few interior pixels checked", config);
+            }
+        }
+    }
+
+    void check_rejects_bad_params() {
+        std::vector<uint8_t> raw = make_raw(8, 8, 1);
+        std::vector<uint8_t> rgb;
+        RawConvertParams params = make_params(raw, 2, 8, &rgb, 4, 4, BayerPattern::kRGGB, ConvertFilter::kBilinear,
+                                              ConvertRotation::k0, false);
+        check(!convert_raw_frame(params) && !convert_raw_frame_reference(params), "a 2 photosite wide frame converts",
+              "params");
+        params = make_params(raw, 8, 8, &rgb, 0, 4, BayerPattern::kRGGB, ConvertFilter::kBilinear,
+                             ConvertRotation::k0, false);
+        check(!convert_raw_frame(params) && !convert_raw_frame_reference(params), "an empty output converts", "params");
+    }
+
+    void run() {
+        check_packed_matches_reference();
+        check_flat_field();
+        check_nearest_identity();
+        check_bilinear_halving();
+        check_rejects_bad_params();
+        printf("image_convert: %d failures\n", g_failures);
+    }
+}
+}
+
+int main() {
+    coralmicro::run();
+    return coralmicro::g_failures == 0 ? 0 : 1;
+}
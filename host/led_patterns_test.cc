@@ -0,0 +1,170 @@
+// led_patterns_test.cc
+// Checks what the status LEDs show for every state, stepping led_scene and led_render the way
+// the LED task does (a new scene restarts its clock and goes out on the same pass):
+//   - scene per state and host connection: STOPPED solid red, WARNING blinking yellow, the
+//     other states solid while the host is connected and pulsing while it isn't
+//   - STOPPED latches immediately: from any scene at any point of its animation, the first
+//     frame after the change is full red, and it stays full red
+//   - the blink starts on and is off for the second half of each period
+//   - the pulse breathes from kPulseFloor up to 255 at half period and back
+//
+//   andon_led_patterns_test   (exit status 0 when every check passes; also run by ctest)
+#include <cstdio>
+#include <initializer_list>
+
+#include "m7/led_patterns.hh"
+
+namespace coralmicro {
+namespace {
+
+    constexpr size_t kLedCount = 8;
+    constexpr SystemState kStates[] = {
+        SystemState::UNINITIALIZED, SystemState::HOST_READING, SystemState::SCANNING, SystemState::STOPPED,
+        SystemState::WARNING,       SystemState::IDLE,         SystemState::ACTIVE,
+    };
+
+    int g_failures = 0;
+
+    void check(bool ok, const char* what, SystemState state, uint32_t elapsed_ms) {
+        if (!ok) {
+            printf("FAIL state %d at %u ms: %s\n", static_cast<int>(state), static_cast<unsigned>(elapsed_ms), what);
+            g_failures++;
+        }
+    }
+
+    bool same(const LedColor& a, const LedColor& b) {
+        return a.red == b.red && a.green == b.green && a.blue == b.blue;
+    }
+
+    // Renders into kLedCount LEDs, with one more past the end that must stay untouched.
+    // Returns the colour when every LED shows the same one
+    bool render(const LedScene& scene, uint32_t elapsed_ms, LedColor* color) {
+        LedColor frame[kLedCount + 1];
+        frame[kLedCount] = {1, 2, 3};
+        led_render(scene, elapsed_ms, frame, kLedCount);
+        bool uniform = same(frame[kLedCount], {1, 2, 3});
+        for (size_t i = 1; i < kLedCount; i++) {
+            uniform = uniform && same(frame[i], frame[0]);
+        }
+        *color = frame[0];
+        return uniform;
+    }
+
+    // The level a pulse of color is at, from its brightest channel
+    uint32_t level_of(const LedScene& scene, uint32_t elapsed_ms) {
+        LedColor color;
+        render(scene, elapsed_ms, &color);
+        uint8_t brightest = color.red > color.green ? color.red : color.green;
+        return brightest > color.blue ? brightest : color.blue;
+    }
+
+    void scenes() {
+        for (SystemState state : kStates) {
+            for (bool connected : {true, false}) {
+                LedScene scene = led_scene(state, connected);
+                switch (state) {
+                    case SystemState::STOPPED:
+                        check(scene == LedScene{{255, 0, 0}, LedPattern::kSolid, 0}, "STOPPED isn't solid red", state, 0);
+                        break;
+                    case SystemState::WARNING:
+                        check(scene == LedScene{{255, 255, 0}, LedPattern::kBlink, LedPatternConfig::kWarningBlinkMs},
+                              "WARNING doesn't blink yellow", state, 0);
+                        break;
+                    case SystemState::UNINITIALIZED:
+                        check(scene.pattern == LedPattern::kSolid, "UNINITIALIZED animates", state, 0);
+                        break;
+                    default:
+                        check(scene.pattern == (connected ? LedPattern::kSolid : LedPattern::kPulse),
+                              connected ? "animates with the host connected" : "doesn't pulse with the host gone",
+                              state, 0);
+                        check(connected || scene.period_ms == LedPatternConfig::kDisconnectedPulseMs, "pulse period",
+                              state, 0);
+                        break;
+                }
+                check(scene.animated() == (scene.pattern != LedPattern::kSolid), "animated()", state, 0);
+            }
+        }
+        check(same(led_scene(SystemState::IDLE, true).color, {0, 0, 255}), "IDLE isn't blue", SystemState::IDLE, 0);
+        check(same(led_scene(SystemState::ACTIVE, true).color, {0, 255, 0}), "ACTIVE isn't green",
+              SystemState::ACTIVE, 0);
+    }
+
+    void stopped_latches() {
+        const LedColor red = {255, 0, 0};
+        for (SystemState state : kStates) {
+            for (bool connected : {true, false}) {
+                LedScene previous = led_scene(state, connected);
+                uint32_t period = previous.period_ms > 0 ? previous.period_ms : LedPatternConfig::kTickMs;
+                for (uint32_t ms = 0; ms < period; ms += LedPatternConfig::kTickMs / 2) {
+                    // The state changes while the old scene is ms into its animation
+                    LedScene scene = led_scene(SystemState::STOPPED, connected);
+                    uint32_t elapsed_ms = scene != previous ? 0 : ms;
+                    LedColor color;
+                    check(render(scene, elapsed_ms, &color) && same(color, red), "first frame after STOPPED isn't red",
+                          state, ms);
+                    check(!scene.animated(), "STOPPED animates", state, ms);
+                }
+            }
+        }
+
+        LedScene stopped = led_scene(SystemState::STOPPED, false);
+        for (uint32_t ms = 0; ms < 10 * LedPatternConfig::kDisconnectedPulseMs; ms += 7) {
+            LedColor color;
+            check(render(stopped, ms, &color) && same(color, red), "STOPPED isn't red at every time",
+                  SystemState::STOPPED, ms);
+        }
+    }
+
+    void blink() {
+        LedScene scene = led_scene(SystemState::WARNING, true);
+        const uint32_t half = LedPatternConfig::kWarningBlinkMs / 2;
+        for (uint32_t ms = 0; ms < 3 * LedPatternConfig::kWarningBlinkMs; ms++) {
+            bool on = ms % LedPatternConfig::kWarningBlinkMs < half;
+            LedColor color;
+            check(render(scene, ms, &color) && same(color, on ? scene.color : LedColor{0, 0, 0}),
+                  on ? "blink off in its first half" : "blink on in its second half", SystemState::WARNING, ms);
+        }
+    }
+
+    void pulse() {
+        LedScene scene = led_scene(SystemState::ACTIVE, false);
+        const uint32_t period = LedPatternConfig::kDisconnectedPulseMs;
+        check(level_of(scene, 0) == LedPatternConfig::kPulseFloor, "pulse doesn't start at the floor",
+              SystemState::ACTIVE, 0);
+        check(level_of(scene, period / 2) == 255, "pulse doesn't peak at half period", SystemState::ACTIVE,
+              period / 2);
+        check(level_of(scene, period) == LedPatternConfig::kPulseFloor, "pulse doesn't repeat", SystemState::ACTIVE,
+              period);
+
+        uint32_t last = level_of(scene, 0);
+        for (uint32_t ms = 1; ms < 2 * period; ms++) {
+            uint32_t level = level_of(scene, ms);
+            bool rising = ms % period <= period / 2 && ms % period != 0;
+            check(level >= LedPatternConfig::kPulseFloor && level <= 255, "pulse out of range", SystemState::ACTIVE, ms);
+            check(rising ? level >= last : level <= last, rising ? "pulse dims while rising" : "pulse brightens while falling",
+                  SystemState::ACTIVE, ms);
+            last = level;
+        }
+
+        // Every channel is scaled alike: HOST_READING's white pulse stays white
+        LedScene white = led_scene(SystemState::HOST_READING, false);
+        LedColor color;
+        render(white, period / 4, &color);
+        check(color.red == color.green && color.green == color.blue && color.red > LedPatternConfig::kPulseFloor,
+              "channels scaled differently", SystemState::HOST_READING, period / 4);
+    }
+
+    void run() {
+        scenes();
+        stopped_latches();
+        blink();
+        pulse();
+        printf("led patterns: %d failures\n", g_failures);
+    }
+}
+}
+
+int main() {
+    coralmicro::run();
+    return coralmicro::g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+// replay.cc
+// Feeds a capture (scripts/fetch_recording.py) back through depth_estimation and the state
+// logic, step by step as the device took them, and checks the result against what the device
+// recorded: every state transition and every depth estimate.
+//
+//   andon_replay capture.andr [--verbose]
+//
+// Exit status: 0 when the replay matches, 1 on a mismatch, 2 on a bad file.
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "replay_driver.hh"
+
+namespace coralmicro {
+namespace {
+
+    constexpr float kDepthToleranceMm = 0.5f; // Float rounding between the M7 (-ffast-math) and the host
+
+    struct Transition {
+        uint64_t timestamp_us;
+        StateTransitionRecord record;
+    };
+
+    class Replay : public ReplayDriver {
+    public:
+        explicit Replay(bool verbose) : verbose_(verbose) {}
+
+        // Prints the report, returns whether the replay matched the device
+        bool report() const {
+            print_counts();
+
+            bool match = true;
+
+            // Transitions, in order
+            size_t pairs = recorded_.size() < replayed_.size() ? recorded_.size() : replayed_.size();
+            size_t first_mismatch = pairs;
+            uint64_t max_skew_us = 0;
+            for (size_t i = 0; i < pairs; i++) {
+                const Transition& a = recorded_[i];
+                const Transition& b = replayed_[i];
+                if (a.record.from != b.record.from || a.record.to != b.record.to) {
+                    first_mismatch = i;
+                    break;
+                }
+                uint64_t skew = a.timestamp_us > b.timestamp_us ? a.timestamp_us - b.timestamp_us
+                                                                : b.timestamp_us - a.timestamp_us;
+                if (skew > max_skew_us) {
+                    max_skew_us = skew;
+                }
+            }
+            printf("transitions: recorded %zu, replayed %zu, max time skew %llu us\n",
+                   recorded_.size(), replayed_.size(), static_cast<unsigned long long>(max_skew_us));
+            if (first_mismatch < pairs || recorded_.size() != replayed_.size()) {
+                match = false;
+                size_t i = first_mismatch;
+                printf("MISMATCH at transition %zu:\n", i);
+                if (i < recorded_.size()) {
+                    print_transition("  device", recorded_[i]);
+                }
+                if (i < replayed_.size()) {
+                    print_transition("  replay", replayed_[i]);
+                }
+            }
+
+            // Depth estimates, in order
+            size_t depth_pairs = recorded_depths_.size() < replayed_depths_.size() ? recorded_depths_.size()
+                                                                                   : replayed_depths_.size();
+            float max_error_mm = 0.0f;
+            size_t depth_mismatches = 0;
+            for (size_t i = 0; i < depth_pairs; i++) {
+                const DepthSet& a = recorded_depths_[i];
+                const DepthSet& b = replayed_depths_[i];
+                bool same = a.count == b.count;
+                for (uint8_t j = 0; same && j < a.count; j++) {
+                    float error = std::fabs(a.mm[j] - b.mm[j]);
+                    max_error_mm = error > max_error_mm ? error : max_error_mm;
+                    same = error <= kDepthToleranceMm;
+                }
+                depth_mismatches += same ? 0 : 1;
+            }
+            printf("depth estimates: recorded %zu, replayed %zu, max error %.3f mm, mismatches %zu\n",
+                   recorded_depths_.size(), replayed_depths_.size(), max_error_mm, depth_mismatches);
+            if (depth_mismatches != 0 || recorded_depths_.size() != replayed_depths_.size()) {
+                match = false;
+            }
+
+            printf("%s\n", match ? "MATCH" : "MISMATCH");
+            return match;
+        }
+
+    private:
+        struct DepthSet {
+            float mm[StateLogicConfig::kMaxDetections];
+            uint8_t count;
+        };
+
+        static void print_transition(const char* who, const Transition& t) {
+            printf("%s %10.3f s  %s -> %s  (inputs 0x%02x)\n", who, t.timestamp_us / 1e6,
+                   state_label(t.record.from), state_label(t.record.to), t.record.inputs);
+        }
+
+        void on_other_chunk(const ChunkHeader& header, const uint8_t* payload) override {
+            switch (header.type) {
+                case ChunkType::kDepthEstimates: {
+                    DepthSet depths;
+                    if (!unpack_depths(payload, header.length, depths.mm, StateLogicConfig::kMaxDetections,
+                                       &depths.count)) {
+                        count_malformed();
+                        break;
+                    }
+                    recorded_depths_.push_back(depths);
+                    break;
+                }
+
+                case ChunkType::kStateTransition: {
+                    Transition t{header.timestamp_us, {}};
+                    if (!unpack_state_transition(payload, header.length, &t.record)) {
+                        count_malformed();
+                        break;
+                    }
+                    recorded_.push_back(t);
+                    break;
+                }
+
+                default:
+                    break; // Camera frames and labels only count here
+            }
+        }
+
+        void on_step(uint64_t now_us, SystemState from, SystemState to) override {
+            if (logic().depth_updated()) {
+                DepthSet depths;
+                depths.count = logic().detection_count();
+                for (uint8_t i = 0; i < depths.count; i++) {
+                    depths.mm[i] = logic().depths()[i];
+                }
+                replayed_depths_.push_back(depths);
+            }
+
+            if (to != from) {
+                Transition t{now_us, {from, to, encode_inputs(logic().inputs())}};
+                replayed_.push_back(t);
+                if (verbose_) {
+                    print_transition("replay", t);
+                }
+            }
+        }
+
+        bool verbose_;
+        std::vector<Transition> recorded_;
+        std::vector<Transition> replayed_;
+        std::vector<DepthSet> recorded_depths_;
+        std::vector<DepthSet> replayed_depths_;
+    };
+}
+}
+
+int main(int argc, char** argv) {
+    using namespace coralmicro;
+
+    const char* path = nullptr;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        }
+        else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr) {
+        fprintf(stderr, "usage: %s capture.andr [--verbose]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> data;
+    if (!load_recording(path, &data)) {
+        return 2;
+    }
+
+    Replay replay(verbose);
+    ChunkReader reader = recording_chunks(data);
+    ChunkHeader header;
+    const uint8_t* payload;
+    while (reader.next(&header, &payload)) {
+        replay.on_chunk(header, payload);
+    }
+
+    if (reader.truncated()) {
+        printf("warning: recording ends inside a chunk at byte %zu\n",
+               RecordingFormat::kFileHeaderBytes + reader.offset());
+    }
+    return replay.report() ? 0 : 1;
+}
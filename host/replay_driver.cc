@@ -0,0 +1,190 @@
+// replay_driver.cc
+#include "replay_driver.hh"
+
+#include <cstdio>
+
+#include "m7/metrics.hh"
+
+namespace coralmicro {
+
+    bool load_recording(const char* path, std::vector<uint8_t>* data) {
+        FILE* file = fopen(path, "rb");
+        if (!file) {
+            fprintf(stderr, "ERROR: can't read %s\n", path);
+            return false;
+        }
+        uint8_t buffer[65536];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            data->insert(data->end(), buffer, buffer + n);
+        }
+        fclose(file);
+
+        uint16_t version = 0;
+        if (!unpack_file_header(data->data(), data->size(), &version)) {
+            fprintf(stderr, "ERROR: %s is not a recording\n", path);
+            return false;
+        }
+        if (version != RecordingFormat::kVersion) {
+            fprintf(stderr, "ERROR: recording version %u, this tool reads %u\n",
+                    static_cast<unsigned>(version), static_cast<unsigned>(RecordingFormat::kVersion));
+            return false;
+        }
+        return true;
+    }
+
+    const char* state_label(SystemState state) {
+        size_t index = static_cast<size_t>(state);
+        return index < kSystemStateCount ? kSystemStateLabels[index] : "?";
+    }
+
+    void ReplayDriver::print_counts() const {
+        static const char* kTypeNames[] = {
+            "", "camera_frame", "tof_frame", "detections", "depth_estimates", "host_state",
+            "host_heartbeat", "state_transition", "ground_truth", "reference_detections", "approach_params",
+            "danger_zones",
+        };
+        static_assert(sizeof(kTypeNames) / sizeof(kTypeNames[0]) == sizeof(ChunkCounts::by_type) / sizeof(uint32_t),
+                      "one name per chunk type");
+        printf("chunks:");
+        for (size_t i = 1; i < sizeof(kTypeNames) / sizeof(kTypeNames[0]); i++) {
+            printf(" %s=%u", kTypeNames[i], counts_.by_type[i]);
+        }
+        printf(" unknown=%u malformed=%u\n", counts_.unknown, counts_.malformed);
+        printf("steps: %u (%u on input memory deadlines)\n", steps_, deadline_steps_);
+    }
+
+    void ReplayDriver::on_chunk(const ChunkHeader& header, const uint8_t* payload) {
+        size_t type = static_cast<size_t>(header.type);
+        if (type < sizeof(counts_.by_type) / sizeof(counts_.by_type[0]) && type != 0) {
+            counts_.by_type[type]++;
+        }
+        else {
+            counts_.unknown++;
+            return;
+        }
+
+        // The device stamps everything one wake-up took in with the same time
+        bool input = header.type == ChunkType::kHostHeartbeat || header.type == ChunkType::kHostState ||
+                     header.type == ChunkType::kDetections || header.type == ChunkType::kTofFrame ||
+                     header.type == ChunkType::kApproachParams || header.type == ChunkType::kDangerZones;
+        if (input && group_open_ && header.timestamp_us != group_us_) {
+            step_group();
+        }
+
+        switch (header.type) {
+            case ChunkType::kHostHeartbeat:
+                open_group(header.timestamp_us);
+                logic_.on_host_heartbeat(group_ms());
+                break;
+
+            case ChunkType::kHostState: {
+                HostState state;
+                if (!unpack_host_state(payload, header.length, &state)) {
+                    counts_.malformed++;
+                    break;
+                }
+                open_group(header.timestamp_us);
+                logic_.on_host_state(state);
+                break;
+            }
+
+            case ChunkType::kDetections: {
+                tensorflow::Object objects[StateLogicConfig::kMaxDetections];
+                uint8_t count;
+                uint64_t capture_us;
+                if (!unpack_detections(payload, header.length, objects, StateLogicConfig::kMaxDetections,
+                                       &count, &capture_us)) {
+                    counts_.malformed++;
+                    break;
+                }
+                open_group(header.timestamp_us);
+                count = detections_for(capture_us, objects, count);
+                logic_.on_detection(objects, count, capture_us, group_ms());
+                break;
+            }
+
+            case ChunkType::kTofFrame: {
+                uint64_t frame_us;
+                uint8_t zone_count;
+                if (header.aux >= kTofSensorCount ||
+                    !unpack_tof_frame(payload, header.length, &tof_data_.results[header.aux], &frame_us,
+                                      &zone_count)) {
+                    counts_.malformed++;
+                    break;
+                }
+                tof_data_.frame_us[header.aux] = frame_us;
+                if (frame_us > tof_data_.timestamp_us) {
+                    tof_data_.timestamp_us = frame_us;
+                }
+                tof_zone_count_ = zone_count;
+                open_group(header.timestamp_us);
+                tof_pending_ = true;
+                break;
+            }
+
+            case ChunkType::kApproachParams: {
+                ApproachParams params;
+                if (!unpack_approach_params(payload, header.length, &params)) {
+                    counts_.malformed++;
+                    break;
+                }
+                open_group(header.timestamp_us);
+                if (!approach_override_) {
+                    logic_.set_approach_params(params);
+                }
+                break;
+            }
+
+            case ChunkType::kDangerZones: {
+                DangerZoneSet zones;
+                if (!unpack_danger_zones(payload, header.length, &zones) || danger_zones_error(zones)) {
+                    counts_.malformed++;
+                    break;
+                }
+                open_group(header.timestamp_us);
+                logic_.set_danger_zones(zones);
+                break;
+            }
+
+            default:
+                on_other_chunk(header, payload);
+                break;
+        }
+    }
+
+    void ReplayDriver::open_group(uint64_t timestamp_us) {
+        if (group_open_) {
+            return;
+        }
+        // Wake-ups the device had in between on its own, when an input memory ran out
+        uint32_t now_ms = static_cast<uint32_t>(timestamp_us / 1000u);
+        uint32_t deadline_ms;
+        while (steps_ > 0 && logic_.next_deadline_ms(last_step_ms_, &deadline_ms) &&
+               static_cast<int32_t>(deadline_ms - now_ms) <= 0) {
+            step(deadline_ms, static_cast<uint64_t>(deadline_ms) * 1000u);
+            deadline_steps_++;
+        }
+        group_open_ = true;
+        group_us_ = timestamp_us;
+    }
+
+    void ReplayDriver::step_group() {
+        if (tof_pending_) {
+            logic_.on_tof(tof_data_, tof_zone_count_, group_ms());
+            tof_pending_ = false;
+        }
+        step(group_ms(), group_us_);
+        group_open_ = false;
+    }
+
+    void ReplayDriver::step(uint32_t now_ms, uint64_t now_us) {
+        SystemState next = logic_.step(now_ms);
+        steps_++;
+        last_step_ms_ = now_ms;
+
+        SystemState previous = state_;
+        state_ = next;
+        on_step(now_us, previous, next);
+    }
+}
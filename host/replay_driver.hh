@@ -0,0 +1,101 @@
+// replay_driver.hh
+// Steps a capture through StateLogic the way the device's state controller took it, for the
+// host tools built on a replay (replay.cc, evaluate.cc).
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "m7/recording_format.hh"
+#include "m7/state_logic.hh"
+
+namespace coralmicro {
+
+    struct ChunkCounts {
+        uint32_t by_type[12] = {}; // Indexed by ChunkType
+        uint32_t unknown = 0;
+        uint32_t malformed = 0;
+    };
+
+    // Reads a recording and checks its header and version, printing why on failure
+    bool load_recording(const char* path, std::vector<uint8_t>* data);
+
+    // The chunks of a buffer load_recording() accepted
+    inline ChunkReader recording_chunks(const std::vector<uint8_t>& data) {
+        return ChunkReader(data.data() + RecordingFormat::kFileHeaderBytes,
+                           data.size() - RecordingFormat::kFileHeaderBytes);
+    }
+
+    const char* state_label(SystemState state);
+
+    // Inputs the device stamped with the same time were taken in one wake-up, so they are fed
+    // together and stepped once. The wake-ups in between that only an input memory running out
+    // caused are stepped too. Feed every chunk in file order; the last wake-up is left unstepped,
+    // as the capture may end before its outputs were fetched.
+    class ReplayDriver {
+    public:
+        virtual ~ReplayDriver() = default;
+
+        void on_chunk(const ChunkHeader& header, const uint8_t* payload);
+
+        const ChunkCounts& counts() const { return counts_; }
+        uint32_t steps() const { return steps_; }
+        uint32_t deadline_steps() const { return deadline_steps_; }
+        void print_counts() const;
+
+        // Runs with these instead of the approach tuning the capture recorded
+        void override_approach_params(const ApproachParams& params) {
+            approach_override_ = true;
+            logic_.set_approach_params(params);
+        }
+
+    protected:
+        // The detections a wake-up feeds the logic, what the device had by default.
+        // May rewrite objects (room for StateLogicConfig::kMaxDetections); returns the count.
+        virtual uint8_t detections_for(uint64_t capture_us, tensorflow::Object* objects, uint8_t count) {
+            (void)capture_us;
+            (void)objects;
+            return count;
+        }
+
+        // After every step: its time and the state before and after it (equal when it held)
+        virtual void on_step(uint64_t now_us, SystemState from, SystemState to) {
+            (void)now_us;
+            (void)from;
+            (void)to;
+        }
+
+        // Every chunk that is not a state controller input (outputs, camera frames, labels)
+        virtual void on_other_chunk(const ChunkHeader& header, const uint8_t* payload) {
+            (void)header;
+            (void)payload;
+        }
+
+        void count_malformed() { counts_.malformed++; }
+        const StateLogic& logic() const { return logic_; }
+
+    private:
+        uint32_t group_ms() const { return static_cast<uint32_t>(group_us_ / 1000u); }
+
+        void open_group(uint64_t timestamp_us);
+        void step_group();
+        void step(uint32_t now_ms, uint64_t now_us);
+
+        StateLogic logic_;
+        SystemState state_ = SystemState::HOST_READING; // Where the device controller starts
+
+        TofData tof_data_ = {};
+        uint8_t tof_zone_count_ = 0;
+        bool tof_pending_ = false;
+
+        bool group_open_ = false;
+        uint64_t group_us_ = 0;
+        uint32_t last_step_ms_ = 0;
+        uint32_t steps_ = 0;
+        uint32_t deadline_steps_ = 0;
+
+        bool approach_override_ = false;
+        ChunkCounts counts_;
+    };
+}
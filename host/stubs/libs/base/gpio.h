@@ -0,0 +1,11 @@
+// gpio.h (host build)
+// Just the pin names tof_sensors.hh refers to; nothing drives them on the host.
+#pragma once
+
+namespace coralmicro {
+
+    enum class Gpio {
+        kPwm0,
+        kPwm1,
+    };
+}
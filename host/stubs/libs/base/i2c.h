@@ -0,0 +1,11 @@
+// i2c.h (host build)
+// Just the bus names tof_sensors.hh refers to.
+#pragma once
+
+namespace coralmicro {
+
+    enum class I2c {
+        kI2c1,
+        kI2c6,
+    };
+}
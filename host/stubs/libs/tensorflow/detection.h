@@ -0,0 +1,22 @@
+// detection.h (host build)
+// The detection types of coralmicro's libs/tensorflow/detection.h, without TFLite.
+#pragma once
+
+namespace coralmicro {
+namespace tensorflow {
+
+    template <typename T>
+    struct BBox {
+        T ymin;
+        T xmin;
+        T ymax;
+        T xmax;
+    };
+
+    struct Object {
+        int id;
+        float score;
+        BBox<float> bbox;
+    };
+}
+}
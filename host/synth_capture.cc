@@ -0,0 +1,213 @@
+// synth_capture.cc
+// Writes a labeled capture of a scripted person, recorded by the host's StateLogic the way the
+// device's state controller records one, for tests of the replay and evaluation tools without a
+// board. Every 8 s cycle the person appears at 3.5 m, walks in at --speed-mm-s to --hold-mm
+// (by default inside the default zone's 600 mm stop distance), stays there for 1 s, walks back
+// out and leaves. The 4x4 ToF sensor ranges at 60 Hz with ±20 mm noise, every fifth frame
+// stamped just after the step that takes it in. The detector gives a result every fourth frame
+// (15 Hz) whose box grows as the person comes closer, and every result carries a ground truth
+// label with the true distance.
+// No camera frames are written; the detections stand in for them.
+//
+//   andon_synth_capture out.andr [--speed-mm-s 1200] [--hold-mm 400] [--seconds 32]
+//
+// Exit status: 0 when written, 2 on bad arguments or a write error.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "m7/recording_format.hh"
+#include "m7/state_logic.hh"
+
+namespace coralmicro {
+namespace {
+
+    constexpr uint64_t kStartUs = 1000000;
+    constexpr uint64_t kTofPeriodUs = 16667;        // 60 Hz
+    constexpr uint32_t kFramesPerDetection = 4;     // 15 Hz detector
+    constexpr uint64_t kDetectionLatencyUs = 30000; // Capture to result
+    constexpr uint64_t kTofReadLatencyUs = 2000;    // Ranging to read
+    constexpr uint32_t kTofLateEvery = 5;           // Frames published just after the step read its clock
+    constexpr uint64_t kTofLateUs = 1000;
+    constexpr uint8_t kZoneCount = 16;
+
+    constexpr double kCycleS = 8.0;
+    constexpr float kEnterMm = 3500.0f;
+    constexpr float kAbsentMm = 5000.0f;     // Nobody there; the sensor sees the far wall
+    constexpr float kSensorRangeMm = 3800.0f;
+    constexpr float kFrameSize = 320.0f;
+
+    struct SynthOptions {
+        float speed_mm_s = 1200.0f;
+        float hold_mm = 400.0f;
+        uint32_t seconds = 32;
+    };
+
+    // Distance of the person at t seconds into the capture
+    float distance_mm(double t, const SynthOptions& options) {
+        double c = std::fmod(t, kCycleS);
+        double walk_s = (kEnterMm - options.hold_mm) / options.speed_mm_s;
+        if (c < 1.0) {
+            return kAbsentMm;
+        }
+        c -= 1.0;
+        if (c < walk_s) {
+            return kEnterMm - static_cast<float>(options.speed_mm_s * c);
+        }
+        c -= walk_s;
+        if (c < 1.0) {
+            return options.hold_mm;
+        }
+        c -= 1.0;
+        if (c < walk_s) {
+            return options.hold_mm + static_cast<float>(options.speed_mm_s * c);
+        }
+        return kAbsentMm;
+    }
+
+    class CaptureWriter {
+    public:
+        CaptureWriter() {
+            uint8_t header[RecordingFormat::kFileHeaderBytes];
+            pack_file_header(header, sizeof(header));
+            out_.insert(out_.end(), header, header + sizeof(header));
+        }
+
+        void chunk(ChunkType type, uint64_t timestamp_us, const uint8_t* payload, size_t size) {
+            uint8_t header[RecordingFormat::kChunkHeaderBytes];
+            pack_chunk_header({type, 0, static_cast<uint32_t>(size), timestamp_us}, header, sizeof(header));
+            out_.insert(out_.end(), header, header + sizeof(header));
+            out_.insert(out_.end(), payload, payload + size);
+        }
+
+        // Labels go last, as scripts/label_recording.py appends them
+        void label(uint64_t capture_us, const uint8_t* payload, size_t size) {
+            labels_.emplace_back(capture_us, std::vector<uint8_t>(payload, payload + size));
+        }
+
+        bool write(const char* path) {
+            for (const auto& label : labels_) {
+                chunk(ChunkType::kGroundTruth, label.first, label.second.data(), label.second.size());
+            }
+            FILE* file = fopen(path, "wb");
+            if (file == nullptr) {
+                return false;
+            }
+            bool ok = fwrite(out_.data(), 1, out_.size(), file) == out_.size();
+            return fclose(file) == 0 && ok;
+        }
+
+    private:
+        std::vector<uint8_t> out_;
+        std::vector<std::pair<uint64_t, std::vector<uint8_t>>> labels_;
+    };
+
+    bool synthesize(const SynthOptions& options, const char* path) {
+        CaptureWriter writer;
+        StateLogic logic;
+        SystemState state = SystemState::HOST_READING;
+        TofData tof = {};
+        uint32_t seed = 1;
+        uint8_t buffer[512];
+
+        size_t size = pack_approach_params(logic.approach_params(), buffer, sizeof(buffer));
+        writer.chunk(ChunkType::kApproachParams, kStartUs, buffer, size);
+
+        uint32_t frames = static_cast<uint32_t>(options.seconds * 1000000ull / kTofPeriodUs);
+        for (uint32_t i = 0; i < frames; i++) {
+            uint64_t now_us = kStartUs + static_cast<uint64_t>(i) * kTofPeriodUs;
+            uint32_t now_ms = static_cast<uint32_t>(now_us / 1000);
+
+            if (i % kFramesPerDetection == 0) {
+                uint64_t capture_us = now_us - kDetectionLatencyUs;
+                float distance = distance_mm((capture_us - kStartUs) / 1e6, options);
+                bool person = distance < kAbsentMm;
+
+                // Box height from the distance, as a pinhole camera would see it
+                float height = std::min(kFrameSize - 20.0f, kFrameSize * 800.0f / distance);
+                float center = kFrameSize / 2.0f;
+                tensorflow::Object object{0, 0.9f, {center - height / 2.0f, center - height / 4.0f,
+                                                    center + height / 2.0f, center + height / 4.0f}};
+                uint8_t count = person ? 1 : 0;
+                logic.on_detection(&object, count, capture_us, now_ms);
+                size = pack_detections(&object, count, capture_us, buffer, sizeof(buffer));
+                writer.chunk(ChunkType::kDetections, now_us, buffer, size);
+
+                GroundTruthPerson truth{object.bbox, distance};
+                size = pack_ground_truth(&truth, count, capture_us, buffer, sizeof(buffer));
+                writer.label(capture_us, buffer, size);
+            }
+
+            // Some frames are stamped after the step's clock, as on the device when one is
+            // published between the state controller waking and taking its inputs
+            uint64_t frame_us = i % kTofLateEvery == 0 ? now_us + kTofLateUs : now_us - kTofReadLatencyUs;
+            float distance = std::min(distance_mm((frame_us - kStartUs) / 1e6, options), kSensorRangeMm);
+            tof.frame_us[0] = frame_us;
+            tof.timestamp_us = frame_us;
+            for (uint8_t zone = 0; zone < kZoneCount; zone++) {
+                seed = seed * 1103515245u + 12345u;
+                float noise = static_cast<float>((seed >> 16) % 41) - 20.0f;
+                tof.results[0].distance_mm[zone] = static_cast<int16_t>(distance + noise);
+                tof.results[0].target_status[zone] = 5;
+            }
+            logic.on_tof(tof, kZoneCount, now_ms);
+            size = pack_tof_frame(tof.results[0], frame_us, kZoneCount, buffer, sizeof(buffer));
+            writer.chunk(ChunkType::kTofFrame, now_us, buffer, size);
+
+            // Outputs as the state controller records them after the step
+            SystemState next = logic.step(now_ms);
+            if (logic.depth_updated()) {
+                size = pack_depths(logic.depths(), logic.detection_count(), buffer, sizeof(buffer));
+                writer.chunk(ChunkType::kDepthEstimates, now_us + 50, buffer, size);
+            }
+            if (next != state) {
+                size = pack_state_transition({state, next, encode_inputs(logic.inputs())}, buffer, sizeof(buffer));
+                writer.chunk(ChunkType::kStateTransition, now_us + 60, buffer, size);
+                state = next;
+            }
+        }
+        return writer.write(path);
+    }
+}
+}
+
+int main(int argc, char** argv) {
+    using namespace coralmicro;
+
+    SynthOptions options;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--speed-mm-s") == 0 && has_value) {
+            options.speed_mm_s = strtof(argv[++i], nullptr);
+        }
+        else if (strcmp(argv[i], "--hold-mm") == 0 && has_value) {
+            options.hold_mm = strtof(argv[++i], nullptr);
+        }
+        else if (strcmp(argv[i], "--seconds") == 0 && has_value) {
+            options.seconds = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        }
+        else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (path == nullptr || !(options.speed_mm_s > 0.0f) || !(options.hold_mm > 0.0f) ||
+        options.hold_mm >= kEnterMm || options.seconds == 0) {
+        fprintf(stderr, "usage: %s out.andr [--speed-mm-s 1200] [--hold-mm 400] [--seconds 32]\n", argv[0]);
+        return 2;
+    }
+
+    if (!synthesize(options, path)) {
+        fprintf(stderr, "%s: can't write\n", path);
+        return 2;
+    }
+    return 0;
+}
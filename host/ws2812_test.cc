@@ -0,0 +1,135 @@
+// ws2812_test.cc
+// Decodes ws2812_encode output the way a WS2812B reads the line: the toggle words are replayed
+// into levels, every high/low pair is timed against the datasheet and turned back into a bit,
+// and the bits into GRB colours. Frames come from led_render, so every LED scene goes through.
+//
+//   andon_ws2812_test   (exit status 0 when every check passes; also run by ctest)
+#include <cstdio>
+#include <vector>
+
+#include "m7/led_patterns.hh"
+#include "m7/ws2812.hh"
+
+namespace coralmicro {
+namespace {
+
+    constexpr uint32_t kPinMask = 1u << 31; // GPIO2_IO31, as ws2812.cc drives it
+
+    int g_failures = 0;
+
+    void check(bool ok, const char* what, size_t frame, size_t index) {
+        if (!ok) {
+            printf("FAIL frame %zu [%zu]: %s\n", frame, index, what);
+            g_failures++;
+        }
+    }
+
+    bool in_spec(uint32_t ns, uint32_t nominal_ns) {
+        return ns + Ws2812Timing::kToleranceNs >= nominal_ns && ns <= nominal_ns + Ws2812Timing::kToleranceNs;
+    }
+
+    // Levels of the line slot by slot, which starts low
+    std::vector<bool> replay_line(const uint32_t* slots, size_t count, size_t frame) {
+        std::vector<bool> levels;
+        bool level = false;
+        for (size_t i = 0; i < count; i++) {
+            check((slots[i] & ~kPinMask) == 0, "toggles a pin other than the data line", frame, i);
+            if (slots[i] & kPinMask) {
+                level = !level;
+            }
+            levels.push_back(level);
+        }
+        return levels;
+    }
+
+    // Decodes the encoded frame and checks it against the colours it came from
+    void check_frame(const LedColor* colors, size_t count, size_t frame) {
+        uint32_t slots[Ws2812Config::kMaxSlots];
+        size_t written = ws2812_encode(colors, count, kPinMask, slots, Ws2812Config::kMaxSlots);
+        check(written == count * Ws2812Config::kBitsPerLed * Ws2812Config::kSlotsPerBit, "slot count", frame, 0);
+
+        std::vector<bool> levels = replay_line(slots, written, frame);
+        check(levels.empty() || !levels.back(), "line doesn't end low", frame, written);
+
+        // Every bit is a high pulse followed by a low gap; the gap of the last one runs into the reset
+        std::vector<uint8_t> bits;
+        size_t i = 0;
+        while (i < levels.size()) {
+            size_t high = 0;
+            while (i < levels.size() && levels[i]) {
+                high++;
+                i++;
+            }
+            size_t low = 0;
+            while (i < levels.size() && !levels[i]) {
+                low++;
+                i++;
+            }
+            uint32_t high_ns = static_cast<uint32_t>(high) * kWs2812SlotNs;
+            uint32_t low_ns = static_cast<uint32_t>(low) * kWs2812SlotNs;
+
+            bool zero = in_spec(high_ns, Ws2812Timing::kT0HighNs) && in_spec(low_ns, Ws2812Timing::kT0LowNs);
+            bool one = in_spec(high_ns, Ws2812Timing::kT1HighNs) && in_spec(low_ns, Ws2812Timing::kT1LowNs);
+            check(zero != one, "pulse widths are neither a 0 nor a 1 bit", frame, bits.size());
+            bits.push_back(one ? 1 : 0);
+        }
+        check(bits.size() == count * Ws2812Config::kBitsPerLed, "bit count", frame, bits.size());
+
+        // GRB, MSB first
+        for (size_t led = 0; led < count && (led + 1) * Ws2812Config::kBitsPerLed <= bits.size(); led++) {
+            uint8_t grb[3] = {};
+            for (size_t b = 0; b < Ws2812Config::kBitsPerLed; b++) {
+                grb[b / 8] = static_cast<uint8_t>((grb[b / 8] << 1) | bits[led * Ws2812Config::kBitsPerLed + b]);
+            }
+            check(grb[0] == colors[led].green, "green", frame, led);
+            check(grb[1] == colors[led].red, "red", frame, led);
+            check(grb[2] == colors[led].blue, "blue", frame, led);
+        }
+    }
+
+    void run() {
+        size_t frame = 0;
+
+        // Distinct channels, all-zero and all-one bytes, single set bits at both ends
+        const LedColor kEdgeColors[] = {
+            {0x12, 0x34, 0x56}, {0x00, 0x00, 0x00}, {0xFF, 0xFF, 0xFF}, {0x80, 0x01, 0x80},
+            {0x01, 0x80, 0x01}, {0xA5, 0x5A, 0xC3}, {0x0F, 0xF0, 0x3C}, {0xFE, 0x7F, 0x00},
+        };
+        static_assert(sizeof(kEdgeColors) / sizeof(kEdgeColors[0]) == Ws2812Config::kMaxLeds, "Fill the chain");
+        for (size_t count = 1; count <= Ws2812Config::kMaxLeds; count++) {
+            check_frame(kEdgeColors, count, frame++);
+        }
+
+        // Every scene the LED task shows, across its animation
+        const SystemState kStates[] = {
+            SystemState::UNINITIALIZED, SystemState::HOST_READING, SystemState::SCANNING, SystemState::IDLE,
+            SystemState::ACTIVE, SystemState::WARNING, SystemState::STOPPED,
+        };
+        for (SystemState state : kStates) {
+            for (bool host_connected : {true, false}) {
+                LedScene scene = led_scene(state, host_connected);
+                for (uint32_t elapsed_ms = 0; elapsed_ms < 2 * LedPatternConfig::kDisconnectedPulseMs;
+                     elapsed_ms += LedPatternConfig::kTickMs * 7) {
+                    LedColor leds[Ws2812Config::kMaxLeds];
+                    led_render(scene, elapsed_ms, leds, Ws2812Config::kMaxLeds);
+                    check_frame(leds, Ws2812Config::kMaxLeds, frame++);
+                }
+            }
+        }
+
+        // Nothing is written when the frame doesn't fit
+        uint32_t slots[Ws2812Config::kMaxSlots];
+        check(ws2812_encode(kEdgeColors, Ws2812Config::kMaxLeds, kPinMask, slots, Ws2812Config::kMaxSlots - 1) == 0,
+              "a frame over capacity is encoded", frame, 0);
+        check(ws2812_encode(kEdgeColors, 0, kPinMask, slots, Ws2812Config::kMaxSlots) == 0,
+              "an empty frame has slots", frame, 0);
+
+        printf("%zu frames checked, %d failures\n", frame, g_failures);
+    }
+}
+}
+
+int main() {
+    coralmicro::run();
+    return coralmicro::g_failures == 0 ? 0 : 1;
+}
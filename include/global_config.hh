@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 extern "C" {
 #include "vl53l8cx_api.h"
@@ -10,6 +11,7 @@ extern "C" {
 
 #include "system_enums.hh"
 #include "libs/tpu/edgetpu_manager.h"
+#include "m7/model_config_m7.hh"
 
 // Global configuration values
 namespace coralmicro {
@@ -17,16 +19,26 @@ namespace coralmicro {
     // TOF config
     constexpr std::atomic<uint8_t> g_tof_resolution{VL53L8CX_RESOLUTION_4X4};  // Default to 4x4
 
-    // Model config
+    // Model config (generated from the .tflite, see model_config_m7.hh)
     inline std::vector<uint8_t> g_model_data;
-    constexpr int g_tensor_arena_size = 8 * 1024 * 1024;
+    constexpr size_t g_tensor_arena_size = ModelConfig::kArenaSize;
     inline uint8_t* g_tensor_arena = nullptr;
-    inline char const* g_model_path = "/apps/coralmicro_in_tree_andon_system/models/tf2_ssd_mobilenet_v2_coco17_ptq_edgetpu.tflite";
+    inline char const* g_model_path = ModelConfig::kModelPath;
+
+    // Person gate model config (optional, see cascade_gate.hh), runs on the M7 in its own arena
+    inline std::vector<uint8_t> g_gate_model_data;
+    constexpr int g_gate_tensor_arena_size = 256 * 1024;
+    inline uint8_t* g_gate_tensor_arena = nullptr;
+    inline char const* g_gate_model_path = "/apps/coralmicro_in_tree_andon_system/models/person_gate.tflite";
 
     // Inference config
     constexpr uint8_t g_max_detections_per_inference = 1;  // Max number of detection
 
+    // Scheduling config
+    constexpr bool g_use_cyclic_executive = false;  // Phase-aligned time-triggered schedule (see cyclic_executive.hh)
+
     // TPU context (global to keep alive between tasks)
     inline EdgeTpuManager* g_tpu_manager_singleton = nullptr;
+    inline std::shared_ptr<EdgeTpuContext> g_tpu_context;
 
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+// approach_predictor.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "libs/tensorflow/detection.h"
+
+namespace coralmicro {
+
+    struct ApproachConfig {
+        static constexpr size_t kMaxTracks = 10;          // Persons followed at once
+        static constexpr size_t kHistory = 24;            // Depth samples kept per track (400 ms at 60 Hz)
+        static constexpr uint32_t kWindowMs = 600;        // Samples older than this (from the newest) aren't fitted
+        static constexpr uint8_t kMinSamples = 4;         // Before a track has a velocity
+        static constexpr uint32_t kMinSpanMs = 150;       // Time the fitted samples must cover
+        static constexpr float kMatchIou = 0.3f;          // Overlap for a detection to continue a track
+        static constexpr uint32_t kTrackTimeoutMs = 1000; // A track nobody continued for this long is dropped
+        static constexpr float kMaxSpeedMmS = 3000.0f;    // Faster is the box jumping onto another surface
+
+        // Defaults of the per-installation tuning (ApproachParams)
+        static constexpr bool kDefaultEnabled = true;
+        static constexpr uint32_t kDefaultStopBudgetMs = 500; // Reaction plus machine stopping time
+        static constexpr float kDefaultMinSpeedMmS = 250.0f;  // Slower approaches are measurement noise
+    };
+
+    // Tuning the prediction runs with
+    struct ApproachParams {
+        bool enabled = ApproachConfig::kDefaultEnabled;
+        uint32_t stop_budget_ms = ApproachConfig::kDefaultStopBudgetMs; // Stop when the threshold is this close
+        float min_speed_mm_s = ApproachConfig::kDefaultMinSpeedMmS;
+
+        bool operator==(const ApproachParams& other) const {
+            return enabled == other.enabled && stop_budget_ms == other.stop_budget_ms &&
+                   min_speed_mm_s == other.min_speed_mm_s;
+        }
+        bool operator!=(const ApproachParams& other) const { return !(*this == other); }
+    };
+
+    // The soonest predicted crossing of a track's distance threshold
+    struct ApproachPrediction {
+        bool approaching;              // A track is closing in faster than min_speed_mm_s
+        uint32_t time_to_threshold_ms; // 0 once the fitted depth is at or inside the threshold
+        float speed_mm_s;              // Closing speed of that track
+        float depth_mm;                // Its fitted depth now
+    };
+
+    // Follows each detected person from result to result by box overlap, keeps the depth
+    // measured under their box at every ToF frame, and fits a closing speed over the last
+    // samples (least squares). From that it predicts when each track reaches its distance, so
+    // a stop can be called while the machine still has time to halt before the person does.
+    class ApproachPredictor {
+    public:
+        void reset();
+
+        // A new detector result (pixel boxes): continues the tracks it overlaps, starts the rest
+        void on_detections(const tensorflow::Object* detections, uint8_t count, uint32_t now_ms);
+
+        // depth_estimation output for the detections of the last result, measured from the ToF
+        // frame read at sample_ms, and the distance each one must not reach (its danger zone's;
+        // 0 or less for none). Negative depths are unknown and skipped.
+        void on_depths(const float* depths, const float* threshold_mm, uint8_t count, uint32_t sample_ms);
+
+        // Soonest crossing of any track's threshold
+        ApproachPrediction predict(const ApproachParams& params, uint32_t now_ms) const;
+
+        size_t track_count() const;
+
+    private:
+        struct Track {
+            bool live;
+            tensorflow::BBox<float> bbox;
+            uint32_t last_seen_ms;
+            float threshold_mm; // Of the last depth, 0 or less when none applies
+            uint32_t sample_ms[ApproachConfig::kHistory];
+            float depth_mm[ApproachConfig::kHistory];
+            uint8_t samples; // Stored, up to kHistory
+            uint8_t next;    // Ring position of the next sample
+
+            // Fit over the samples, redone when one is added
+            bool fitted;
+            float fit_depth_mm; // At the newest sample
+            float fit_speed_mm_s;
+            uint32_t fit_ms;    // Time of the newest sample
+        };
+
+        // Least-squares depth and speed at the newest sample; unfitted without enough history
+        static void fit(Track& track);
+
+        Track tracks_[ApproachConfig::kMaxTracks] = {};
+        int8_t detection_track_[ApproachConfig::kMaxTracks] = {}; // Track of each detection of the last result
+        uint8_t detection_count_ = 0;
+    };
+}
@@ -0,0 +1,117 @@
+// boot.hh
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/freertos_kernel/include/event_groups.h"
+
+#include "system_enums.hh"
+
+namespace coralmicro {
+
+    struct BootConfig {
+        static constexpr uint32_t kWorkerStackSize = configMINIMAL_STACK_SIZE * 8; // LFS reads and TPU open run on these
+        static constexpr UBaseType_t kWorkerPriority = configMAX_PRIORITIES - 2;
+        static constexpr uint32_t kPollMs = 2;                   // Readiness polling period
+    };
+
+    // Resources the boot branches bring up, as event group bits. Tasks wait only on what they use
+    enum BootResource : uint32_t {
+        kBootModel    = (1u << 0), // Detector (and gate) model in memory
+        kBootTpu      = (1u << 1), // EdgeTPU open
+        kBootTof      = (1u << 2), // Sensor firmware loaded and configured, not yet ranging
+        kBootCamera   = (1u << 3), // Streaming, auto-exposure settled
+        kBootDecision = (1u << 4), // State controller decided on live camera and ToF inputs
+    };
+
+    constexpr uint32_t kBootFailedShift = 8; // A failed branch sets its resource bits shifted up by this
+
+    // Boot timeline, in timebase_us. Phases have a start and an end; milestones only an end
+    enum class BootPhase : uint8_t {
+        kQueues,
+        kModelLoad,
+        kGateModelLoad,
+        kTpuOpen,
+        kTofReset,
+        kTofFirmware,
+        kTofConfig,
+        kCameraPower,
+        kCameraWarmup,
+        kTaskCreate,
+        kFirstCameraFrame,
+        kFirstTofFrame,
+        kFirstDetection,
+        kFirstDecision,
+        kCount,
+    };
+
+    constexpr size_t kBootPhaseCount = static_cast<size_t>(BootPhase::kCount);
+    constexpr const char* kBootPhaseNames[kBootPhaseCount] = {
+        "queues", "model_load", "gate_model_load", "tpu_open", "tof_reset", "tof_firmware", "tof_config",
+        "camera_power", "camera_warmup", "task_create", "first_camera_frame", "first_tof_frame",
+        "first_detection", "first_decision",
+    };
+
+    struct BootPhaseTiming {
+        std::atomic<uint32_t> start_us{0}; // 0 = not reached
+        std::atomic<uint32_t> end_us{0};
+    };
+
+    struct BootStats {
+        BootPhaseTiming phases[kBootPhaseCount];
+        std::atomic<uint32_t> scheduler_ms{0};     // Scheduler uptime when the timebase started
+        std::atomic<int> first_state{-1};          // SystemState of the first decision
+    };
+
+    inline BootStats g_boot_stats;
+
+    // One branch of the boot graph, run on its own worker task
+    struct BootBranch {
+        const char* name;
+        bool (*run)();
+        uint32_t provides; // BootResource bits set when run() succeeds
+    };
+
+    // Creates the readiness event group. Call once, after timebase_init and before any task waits
+    bool boot_init();
+
+    // Starts one worker per branch and returns immediately
+    bool boot_start(const BootBranch* branches, size_t count);
+
+    // Blocks until every resource is up. Returns false if the branch providing one of them failed
+    bool boot_wait(uint32_t resources);
+
+    void boot_phase_begin(BootPhase phase);
+    void boot_phase_end(BootPhase phase);
+
+    // Stamps a milestone the first time it is reached; a single atomic load afterwards
+    inline void boot_milestone(BootPhase phase) {
+        if (g_boot_stats.phases[static_cast<size_t>(phase)].end_us.load(std::memory_order_relaxed) == 0) {
+            boot_phase_end(phase);
+        }
+    }
+
+    void boot_first_decision(SystemState state);
+
+    // Phase table on the console, once the first decision is in
+    void boot_report();
+
+    class BootPhaseScope {
+    public:
+        explicit BootPhaseScope(BootPhase phase) : phase_(phase) {
+            boot_phase_begin(phase_);
+        }
+        ~BootPhaseScope() {
+            boot_phase_end(phase_);
+        }
+
+        BootPhaseScope(const BootPhaseScope&) = delete;
+        BootPhaseScope& operator=(const BootPhaseScope&) = delete;
+
+    private:
+        BootPhase phase_;
+    };
+}
@@ -6,20 +6,62 @@
 #include "third_party/freertos_kernel/include/FreeRTOS.h"
 #include "third_party/freertos_kernel/include/task.h"
 
+#include <atomic>
+
 #include "m7/m7_queues.hh"
+#include "m7/cyclic_executive.hh"
+#include "m7/image_convert.hh"
+#include "m7/cycle_counter.hh"
+#include "m7/model_config_m7.hh"
+#include "m7/metrics.hh"
+#include "m7/boot.hh"
 
 
 namespace coralmicro{
 
     struct CameraConfig{
-        static constexpr CameraFormat kFormat = CameraFormat::kRgb;
+        // Output geometry follows the model input (model_config_m7.hh)
+        static constexpr CameraFormat kFormat = ModelConfig::kInputChannels == 1 ? CameraFormat::kY8 : CameraFormat::kRgb;
         static constexpr CameraFilterMethod filter = CameraFilterMethod::kBilinear;
         static constexpr CameraRotation rotation = CameraRotation::k270;
-        static constexpr uint32_t kWidth = 300;
-        static constexpr uint32_t kHeight = 300;
+        static constexpr uint32_t kWidth = ModelConfig::kInputWidth;
+        static constexpr uint32_t kHeight = ModelConfig::kInputHeight;
         static constexpr bool preserve_ratio = true;
         static constexpr bool auto_white_balance = false;
+
+        // Fetch the raw sensor frame and convert it in one pass (image_convert) instead of the SDK pipeline. RGB only
+        static constexpr bool kFusedConversion = (kFormat == CameraFormat::kRgb);
+        static constexpr BayerPattern kBayerPattern = BayerPattern::kBGGR;
     };
 
+    // Auto-exposure warmup: a small grayscale probe is grabbed until its mean stops moving
+    struct CameraWarmupConfig {
+        static constexpr int kProbeWidth = 32;
+        static constexpr int kProbeHeight = 32;
+        static constexpr uint32_t kMinFrames = 5;
+        static constexpr uint32_t kMaxFrames = 100;  // The old fixed discard count
+        static constexpr uint32_t kSettleDelta = 2;  // Mean luma change per frame still counted as settled
+        static constexpr uint32_t kSettleFrames = 3; // Consecutive settled frames required
+    };
+
+    static_assert(ModelConfig::kInputType == kTfLiteUInt8,
+                  "Camera frames are copied straight into the input tensor, the model must take uint8");
+    static_assert(ModelConfig::kInputChannels == 1 || ModelConfig::kInputChannels == 3,
+                  "Model input must be grayscale or RGB");
+
+    struct CameraStats {
+        std::atomic<uint32_t> frames_captured{0};
+        std::atomic<uint32_t> conversion_cycles_last{0}; // Fused conversion only
+        std::atomic<uint32_t> conversion_cycles_max{0};
+        std::atomic<uint32_t> conversion_cycles_avg{0};  // EMA, 1/16 weight per frame
+        std::atomic<uint32_t> warmup_frames{0};          // Frames until auto-exposure settled
+    };
+
+    inline CameraStats g_camera_stats;
+
+    // Boot steps, run before camera_task starts (main_m7 boot branches)
+    bool camera_power_up();
+    bool camera_warmup();
+
     void camera_task(void* parameters);
 }
\ No newline at end of file
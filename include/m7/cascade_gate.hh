@@ -0,0 +1,54 @@
+// cascade_gate.hh
+#pragma once
+
+#include <cstdint>
+
+namespace coralmicro {
+
+    struct CascadeConfig {
+        static constexpr bool kEnabled = true;            // Falls back to SSD on every frame if the gate model is missing
+        static constexpr float kDefaultFireThreshold = 0.5f; // Gate person score that wakes the SSD
+        static constexpr uint32_t kDefaultRefreshMs = 2000;  // Run the SSD at least this often regardless of the gate
+        static constexpr uint32_t kMaxRefreshMs = 60000;     // Longest refresh interval the RPC accepts
+        static constexpr int kPersonClassIndex = 1;       // Output index of "person" for 2-class gates (no_person, person)
+    };
+
+    // Why the SSD ran (or didn't) on a frame
+    enum class CascadeDecision : uint8_t {
+        kSkip,       // Gate quiet, nothing tracked, refresh not due
+        kGateFired,  // Gate score at or above the fire threshold
+        kTracking,   // Last SSD result had a person; keep boxes fresh for depth estimation
+        kRefresh,    // Periodic SSD run to catch people the gate misses
+    };
+
+    // Decides per frame whether the full detector runs after the person gate, and keeps
+    // hit/miss counts so the gate threshold can be tuned against the SSD.
+    class CascadePolicy {
+    public:
+        CascadeDecision decide(float gate_score, float fire_threshold, uint32_t refresh_ms, uint32_t now_ms);
+
+        // Report the SSD verdict for a frame that decide() didn't skip
+        void on_detector_result(CascadeDecision decision, bool person_detected, uint32_t now_ms);
+
+        uint32_t gate_runs() const { return gate_runs_; }
+        uint32_t gate_fires() const { return gate_fires_; }
+        uint32_t skips() const { return skips_; }
+        uint32_t refreshes() const { return refreshes_; }
+        uint32_t hits() const { return hits_; }                 // Gate fired, SSD found a person
+        uint32_t false_alarms() const { return false_alarms_; } // Gate fired, SSD found nobody
+        uint32_t misses() const { return misses_; }             // Gate quiet, SSD found a person anyway
+
+    private:
+        bool detector_has_run_ = false;
+        bool tracking_ = false;
+        uint32_t last_detector_ms_ = 0;
+
+        uint32_t gate_runs_ = 0;
+        uint32_t gate_fires_ = 0;
+        uint32_t skips_ = 0;
+        uint32_t refreshes_ = 0;
+        uint32_t hits_ = 0;
+        uint32_t false_alarms_ = 0;
+        uint32_t misses_ = 0;
+    };
+}
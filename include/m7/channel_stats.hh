@@ -0,0 +1,61 @@
+// channel_stats.hh
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/freertos_kernel/include/queue.h"
+
+namespace coralmicro {
+
+    struct ChannelConfig {
+        static constexpr bool kEnabled = true; // false: the wrappers are plain queue calls
+    };
+
+    // The depth-1 overwrite queues of m7_queues.hh
+    enum class Channel : uint8_t {
+        kTof,
+        kCamera,
+        kDetection,
+        kStateUpdate,
+        kHostConnection,
+        kHostState,
+        kLogging,
+        kGovernor,
+        kProfile,
+        kDangerZones,
+        kCount,
+    };
+
+    constexpr size_t kChannelCount = static_cast<size_t>(Channel::kCount);
+    constexpr const char* kChannelNames[kChannelCount] = {
+        "tof", "camera", "detection", "state_update", "host_connection", "host_state", "logging", "governor", "profile",
+        "danger_zones",
+    };
+
+    struct ChannelStats {
+        std::atomic<uint32_t> writes{0};
+        std::atomic<uint32_t> overwrites{0};  // Writes that replaced a sample no reader had taken
+        std::atomic<uint32_t> reads{0};
+        std::atomic<uint32_t> empty_reads{0}; // Receives and peeks that found the channel empty
+        std::atomic<uint32_t> peeks{0};
+        std::atomic<uint32_t> age_us_last{0}; // Write to receive, of the samples actually consumed
+        std::atomic<uint32_t> age_us_avg{0};  // EMA, 1/16 weight per read
+        std::atomic<uint32_t> age_us_max{0};
+    };
+
+    inline ChannelStats g_channel_stats[kChannelCount];
+
+    // Creates a channel's depth-1 queue. Each item carries its write stamp after the payload,
+    // so a sample and its age always travel together. Called from InitQueues
+    QueueHandle_t channel_create(Channel channel, size_t item_size);
+
+    // Replacements for xQueueOverwrite / xQueueReceive / xQueuePeek. Items are staged with their
+    // stamp in per-channel write and read buffers, so a channel has one writing task and one
+    // reading task, as m7_queues.hh wires them.
+    bool channel_overwrite(Channel channel, const void* item);
+    bool channel_receive(Channel channel, void* item, TickType_t ticks = 0);
+    bool channel_peek(Channel channel, void* item, TickType_t ticks = 0);
+}
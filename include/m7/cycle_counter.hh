@@ -0,0 +1,54 @@
+// cycle_counter.hh
+#pragma once
+
+#include <cstdint>
+
+#if !defined(__arm__)
+#include <chrono>
+#endif
+
+namespace coralmicro {
+
+    // Cortex-M7 DWT cycle counter, counting at the core clock. Wraps every 2^32 cycles (~5.4 s
+    // at 800 MHz), so differences of uint32_t reads are valid for anything shorter than that.
+    // The rate is read from the clock tree by timebase_init() (timebase_cycle_hz()).
+    // Host builds count nanoseconds instead so the same call sites compile and run off target.
+
+#if defined(__arm__)
+    namespace cycle_counter_regs {
+        inline volatile uint32_t& demcr() { return *reinterpret_cast<volatile uint32_t*>(0xE000EDFCu); }
+        inline volatile uint32_t& dwt_ctrl() { return *reinterpret_cast<volatile uint32_t*>(0xE0001000u); }
+        inline volatile uint32_t& dwt_cyccnt() { return *reinterpret_cast<volatile uint32_t*>(0xE0001004u); }
+        inline volatile uint32_t& dwt_lar() { return *reinterpret_cast<volatile uint32_t*>(0xE0001FB0u); }
+
+        constexpr uint32_t kDemcrTrcena = (1u << 24);
+        constexpr uint32_t kDwtCtrlCyccntena = (1u << 0);
+        constexpr uint32_t kDwtLarUnlock = 0xC5ACCE55u;
+    }
+
+    // Safe to call repeatedly, from any task
+    inline void cycle_counter_init() {
+        using namespace cycle_counter_regs;
+        if (dwt_ctrl() & kDwtCtrlCyccntena) {
+            return;
+        }
+        demcr() |= kDemcrTrcena;
+        dwt_lar() = kDwtLarUnlock; // M7 DWT is write-locked out of reset
+        dwt_cyccnt() = 0;
+        dwt_ctrl() |= kDwtCtrlCyccntena;
+    }
+
+    inline uint32_t cycle_counter_read() {
+        return cycle_counter_regs::dwt_cyccnt();
+    }
+#else
+    constexpr uint32_t kHostCycleCounterHz = 1000000000u; // Nanoseconds
+
+    inline void cycle_counter_init() {}
+
+    inline uint32_t cycle_counter_read() {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+#endif
+}
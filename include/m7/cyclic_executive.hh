@@ -0,0 +1,48 @@
+// cyclic_executive.hh
+#pragma once
+
+#include <atomic>
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/freertos_kernel/include/task.h"
+
+#include "global_config.hh"
+#include "m7/cyclic_schedule.hh"
+
+namespace coralmicro {
+
+    // Notification bit used for releases, so stages that also wait on other
+    // notification bits (the state controller) can share the notification value
+    constexpr uint32_t kStageReleaseBit = (1u << 31);
+
+    inline TaskHandle_t g_stage_task_handles[kStageCount] = {};
+    inline std::atomic<uint32_t> g_stage_release_frame[kStageCount] = {};
+    inline std::atomic<uint32_t> g_cyclic_frame{0};
+
+    // Called once by each stage task so the executive can release it
+    inline void register_stage(Stage stage) {
+        g_stage_task_handles[static_cast<size_t>(stage)] = xTaskGetCurrentTaskHandle();
+    }
+
+    // Blocks until the executive (or a producer) releases the calling stage
+    inline void block_until_released() {
+        xTaskNotifyWait(0, kStageReleaseBit, nullptr, portMAX_DELAY);
+    }
+
+    // Blocks until the next release; falls back to the task's own period when the executive is disabled
+    inline void wait_for_release(Stage stage, TickType_t* last_wake_time, TickType_t period) {
+        if (g_use_cyclic_executive) {
+            (void)stage;
+            block_until_released();
+            *last_wake_time = xTaskGetTickCount();
+        }
+        else {
+            vTaskDelayUntil(last_wake_time, period);
+        }
+    }
+
+    // Releases the chained consumers of a stage that just finished
+    void stage_complete(Stage stage);
+
+    void cyclic_executive_task(void* parameters);
+}
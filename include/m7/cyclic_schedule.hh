@@ -0,0 +1,204 @@
+// cyclic_schedule.hh
+// The cyclic executive's schedule and its compile-time checks. Free of FreeRTOS so the host
+// build compiles it (and so runs the static_asserts) too; the executive is cyclic_executive.hh.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "m7/inference_governor.hh"
+
+namespace coralmicro {
+
+    // Pipeline stages that can be released by the executive
+    enum class Stage : uint8_t {
+        kCamera,
+        kTof,
+        kInference,
+        kStateController,
+        kLed,
+        kNone, // Marks a time-triggered slot (no producer)
+    };
+
+    constexpr size_t kStageCount = static_cast<size_t>(Stage::kNone);
+
+    struct CyclicConfig {
+        static constexpr uint32_t kMinorFrameMs = 10;         // Executive tick
+        static constexpr uint32_t kFramesPerMajor = 10;       // 100 ms major frame
+        static constexpr uint32_t kMajorFrameMs = kMinorFrameMs * kFramesPerMajor;
+
+        static constexpr uint32_t kMaxStalenessMs = 150;      // Worst-case input age allowed at a decision
+        static constexpr uint32_t kMaxUtilizationPermille = 900;
+    };
+
+    // A release slot. Time-triggered slots (producer == kNone) fire on the minor frame grid,
+    // chained slots fire as soon as their producer completes in a frame matching period/offset.
+    struct StageSlot {
+        Stage stage;
+        Stage producer;
+        uint8_t period_frames;  // Release every N minor frames
+        uint8_t offset_frames;  // Phase within the period
+        uint32_t budget_ms;     // Execution budget, used for the staleness/utilization bounds
+    };
+
+    constexpr std::array<StageSlot, 6> kCyclicSchedule = {{
+        // Time-triggered heads, interleaved so they never share a minor frame
+        {Stage::kCamera,          Stage::kNone,            2,  0, 4},
+        {Stage::kTof,             Stage::kNone,            2,  1, 2},   // Polls data-ready, sensor free-runs at ranging_frequency()
+
+        // Chained stages
+        {Stage::kInference,       Stage::kCamera,          10, 0, 40},  // Right after the frame lands, every 100 ms
+        {Stage::kStateController, Stage::kInference,       1,  0, 1},
+        {Stage::kStateController, Stage::kTof,             1,  0, 1},
+        {Stage::kLed,             Stage::kStateController, 1,  0, 1},
+    }};
+
+    // A time-triggered slot is released in this minor frame
+    constexpr bool head_released(const StageSlot& slot, uint32_t frame) {
+        return slot.producer == Stage::kNone && (frame % slot.period_frames) == slot.offset_frames;
+    }
+
+    // A chained slot is released when its producer finishes work it was released for in this frame
+    constexpr bool chained_released(const StageSlot& slot, Stage producer, uint32_t producer_frame) {
+        return slot.producer == producer && (producer_frame % slot.period_frames) == slot.offset_frames;
+    }
+
+    // ---- Compile-time schedule verification ----
+
+    constexpr size_t kScheduleDepthLimit = kCyclicSchedule.size();
+
+    // Period (ms) at which a slot is actually released
+    constexpr uint32_t slot_period_ms(size_t slot, size_t depth = 0) {
+        const StageSlot& s = kCyclicSchedule[slot];
+        uint32_t own = s.period_frames * CyclicConfig::kMinorFrameMs;
+        if (s.producer == Stage::kNone || depth > kScheduleDepthLimit) {
+            return own;
+        }
+
+        // A chained slot can't fire more often than its fastest producer slot
+        uint32_t producer_period = CyclicConfig::kMajorFrameMs;
+        for (size_t i = 0; i < kCyclicSchedule.size(); i++) {
+            if (kCyclicSchedule[i].stage == s.producer) {
+                uint32_t p = slot_period_ms(i, depth + 1);
+                producer_period = (p < producer_period) ? p : producer_period;
+            }
+        }
+        return (own > producer_period) ? own : producer_period;
+    }
+
+    // Worst-case time from a head release until this slot has finished
+    constexpr uint32_t slot_latency_ms(size_t slot, size_t depth = 0) {
+        const StageSlot& s = kCyclicSchedule[slot];
+        if (s.producer == Stage::kNone || depth > kScheduleDepthLimit) {
+            return s.budget_ms;
+        }
+
+        uint32_t worst_producer = 0;
+        for (size_t i = 0; i < kCyclicSchedule.size(); i++) {
+            if (kCyclicSchedule[i].stage == s.producer) {
+                uint32_t l = slot_latency_ms(i, depth + 1);
+                worst_producer = (l > worst_producer) ? l : worst_producer;
+            }
+        }
+        return worst_producer + s.budget_ms;
+    }
+
+    // Worst-case age of the newest input a stage can see when it runs
+    constexpr uint32_t worst_case_staleness_ms(Stage stage) {
+        uint32_t worst = 0;
+        for (size_t i = 0; i < kCyclicSchedule.size(); i++) {
+            if (kCyclicSchedule[i].stage == stage) {
+                uint32_t age = slot_period_ms(i) + slot_latency_ms(i);
+                worst = (age > worst) ? age : worst;
+            }
+        }
+        return worst;
+    }
+
+    constexpr bool schedule_is_well_formed() {
+        for (size_t i = 0; i < kCyclicSchedule.size(); i++) {
+            const StageSlot& s = kCyclicSchedule[i];
+            if (s.period_frames == 0 || s.offset_frames >= s.period_frames) return false;
+            if (CyclicConfig::kFramesPerMajor % s.period_frames != 0) return false;
+            if (s.producer == s.stage) return false;
+
+            if (s.producer != Stage::kNone) {
+                bool producer_found = false;
+                for (size_t j = 0; j < kCyclicSchedule.size(); j++) {
+                    producer_found |= (kCyclicSchedule[j].stage == s.producer);
+                }
+                if (!producer_found) return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool heads_never_collide() {
+        for (uint32_t frame = 0; frame < CyclicConfig::kFramesPerMajor; frame++) {
+            int released = 0;
+            for (const auto& s : kCyclicSchedule) {
+                if (head_released(s, frame)) {
+                    released++;
+                }
+            }
+            if (released > 1) return false;
+        }
+        return true;
+    }
+
+    // Times a slot is released in a minor frame: once per matching release of each producer slot
+    constexpr uint32_t slot_releases_in_frame(size_t slot, uint32_t frame, size_t depth = 0) {
+        const StageSlot& s = kCyclicSchedule[slot];
+        if (s.producer == Stage::kNone) {
+            return head_released(s, frame) ? 1 : 0;
+        }
+        if (depth > kScheduleDepthLimit || (frame % s.period_frames) != s.offset_frames) {
+            return 0;
+        }
+        uint32_t releases = 0;
+        for (size_t i = 0; i < kCyclicSchedule.size(); i++) {
+            if (kCyclicSchedule[i].stage == s.producer) {
+                releases += slot_releases_in_frame(i, frame, depth + 1);
+            }
+        }
+        return releases;
+    }
+
+    // Budgets of every release in a major frame, against its length
+    constexpr uint32_t schedule_utilization_permille() {
+        uint32_t busy_ms = 0;
+        for (size_t i = 0; i < kCyclicSchedule.size(); i++) {
+            for (uint32_t frame = 0; frame < CyclicConfig::kFramesPerMajor; frame++) {
+                busy_ms += kCyclicSchedule[i].budget_ms * slot_releases_in_frame(i, frame);
+            }
+        }
+        return busy_ms * 1000 / CyclicConfig::kMajorFrameMs;
+    }
+
+    // Highest rate the executive releases a stage at
+    constexpr uint32_t stage_max_hz(Stage stage) {
+        uint32_t shortest = 0;
+        for (size_t i = 0; i < kCyclicSchedule.size(); i++) {
+            if (kCyclicSchedule[i].stage == stage && (shortest == 0 || slot_period_ms(i) < shortest)) {
+                shortest = slot_period_ms(i);
+            }
+        }
+        return shortest == 0 ? 0 : 1000 / shortest;
+    }
+
+    static_assert(schedule_is_well_formed(), "Cyclic schedule has an invalid slot or orphan producer");
+    static_assert(heads_never_collide(), "Two time-triggered stages share a minor frame");
+    static_assert(schedule_utilization_permille() <= CyclicConfig::kMaxUtilizationPermille,
+                  "Cyclic schedule budgets exceed the utilization limit");
+    static_assert(worst_case_staleness_ms(Stage::kStateController) <= CyclicConfig::kMaxStalenessMs,
+                  "State decisions may use data older than kMaxStalenessMs");
+
+    // The executive caps inference at stage_max_hz(kInference), 10 Hz. A faster inference slot
+    // would break the utilization bound above (40 ms budget against 20 ms camera releases), so
+    // with the executive on the governor's ALERT rate (kMaxHz) runs at the cap, the same as NORMAL.
+    // IDLE and NORMAL must fit under it, or the executive would silently slow them as well.
+    static_assert(InferenceGovernorConfig::kNormalHz <= stage_max_hz(Stage::kInference),
+                  "The cyclic schedule releases inference slower than the governor's normal rate");
+
+}
@@ -0,0 +1,94 @@
+// danger_zones.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "libs/tensorflow/detection.h"
+
+#include "m7/tof_sensors.hh"
+
+namespace coralmicro {
+
+    struct DangerZoneConfig {
+        static constexpr size_t kMaxZones = 8;
+        static constexpr size_t kMaxVertices = 8;            // Per polygon
+        static constexpr float kDefaultStopMm = 600.0f;      // The one danger distance before zones
+        static constexpr float kUnlimitedMm = 100000.0f;     // Past any ToF range: a warning distance that always applies
+        static constexpr uint16_t kFullFrame = UINT16_MAX;   // Polygon bound that covers any image size
+    };
+
+    static_assert(kTofCellCount <= 32, "Cell masks are 32 bits");
+
+    struct ZonePoint {
+        uint16_t x; // Image pixels, as the detection boxes
+        uint16_t y;
+    };
+
+    // One region of the camera image with its own limits. A person whose box touches it
+    // is warned about within warning_mm and stopped for within stop_mm.
+    struct DangerZone {
+        float stop_mm;
+        float warning_mm; // At least stop_mm
+        uint8_t vertex_count;
+        ZonePoint vertices[DangerZoneConfig::kMaxVertices];
+    };
+
+    struct DangerZoneSet {
+        uint8_t count;
+        DangerZone zones[DangerZoneConfig::kMaxZones];
+
+        bool operator==(const DangerZoneSet& other) const;
+        bool operator!=(const DangerZoneSet& other) const { return !(*this == other); }
+    };
+
+    // One zone over the whole image: stop within kDefaultStopMm, warn at any distance
+    DangerZoneSet default_danger_zones();
+
+    // Why a set can't be used, nullptr when it can
+    const char* danger_zones_error(const DangerZoneSet& set);
+
+    // The limits that apply to a person, from the zones their box touches
+    struct ZoneLimits {
+        bool in_zone;      // Touches at least one zone; nothing else applies otherwise
+        int8_t stop_zone;  // Zone the stop distance comes from, -1 outside all
+        float stop_mm;     // Longest of the zones touched, so the strictest
+        float warning_mm;  // Likewise
+    };
+
+    // A zone set compiled against the ToF cell regions (tof_rgb_mapping.hh): which cells of
+    // each sensor every zone covers, and per cell the strictest limits of the zones covering
+    // it. Looking up a box or a ToF frame then walks the cells once, however many zones there
+    // are. Compiling is the only slow part and runs when the set changes.
+    class DangerZoneMap {
+    public:
+        DangerZoneMap() { compile(default_danger_zones()); }
+
+        // set must have passed danger_zones_error()
+        void compile(const DangerZoneSet& set);
+
+        const DangerZoneSet& zones() const { return zones_; }
+
+        // Limits for a box in image pixels. Cells it overlaps decide, as in depth_estimation();
+        // a box no ToF cell sees gets the strictest limits when it touches any zone's bounds.
+        ZoneLimits lookup(const tensorflow::BBox<float>& bbox) const;
+
+        // Stop distance per cell of a sensor (kTofCellCount, cell order), 0 where no zone covers it
+        const float* cell_stop_mm(size_t sensor) const { return cell_stop_mm_[sensor]; }
+
+        // Cells of a sensor a zone covers, bit n for cell n
+        uint32_t zone_cells(size_t zone, size_t sensor) const { return zone_cells_[zone][sensor]; }
+
+    private:
+        DangerZoneSet zones_ = {};
+        uint32_t zone_cells_[DangerZoneConfig::kMaxZones][kTofSensorCount] = {};
+
+        float cell_stop_mm_[kTofSensorCount][kTofCellCount] = {};
+        float cell_warning_mm_[kTofSensorCount][kTofCellCount] = {};
+        int8_t cell_stop_zone_[kTofSensorCount][kTofCellCount] = {};
+
+        // Bounds of every zone together, and the strictest limits, for boxes outside the cells
+        float x_min_ = 0.0f, y_min_ = 0.0f, x_max_ = 0.0f, y_max_ = 0.0f;
+        ZoneLimits uncovered_ = {false, -1, 0.0f, 0.0f};
+    };
+}
@@ -0,0 +1,276 @@
+// deferred_log.hh
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "m7/cycle_counter.hh"
+
+namespace coralmicro {
+
+    enum class LogLevel : uint8_t {
+        kDebug,
+        kInfo,
+        kWarn,
+        kError,
+        kOff,
+    };
+
+    enum class LogSink : uint8_t {
+        kBinary, // Framed records on the console, decoded on the host by scripts/decode_log.py
+        kText,   // Formatted by the drain task, readable in a plain serial terminal
+    };
+
+    struct LogConfig {
+        static constexpr LogLevel kMinLevel = LogLevel::kInfo; // Calls below this compile to nothing
+        static constexpr LogSink kSink = LogSink::kBinary;
+        static constexpr size_t kRingBytes = 8192;           // Power of two
+        static constexpr size_t kMaxRecordBytes = 160;       // Format ID + stamp + args
+        static constexpr size_t kMaxStringBytes = 32;        // %s arguments are truncated to this
+        static constexpr uint32_t kDrainPeriodMs = 20;
+        static constexpr bool kMeasureCost = true;           // Time every call with the cycle counter
+    };
+
+    static_assert((LogConfig::kRingBytes & (LogConfig::kRingBytes - 1)) == 0, "Log ring size must be a power of two");
+
+    struct LogStats {
+        std::atomic<uint32_t> records{0};        // Records written to the ring
+        std::atomic<uint32_t> dropped{0};        // Ring full
+        std::atomic<uint32_t> drained_bytes{0};  // Bytes written to the console by the drain task
+        std::atomic<uint32_t> cost_cycles_last{0}; // Per-call cost on the calling task (kMeasureCost)
+        std::atomic<uint32_t> cost_cycles_max{0};
+        std::atomic<uint32_t> cost_cycles_avg{0};  // EMA, 1/16 weight per call
+    };
+
+    inline LogStats g_log_stats;
+
+    constexpr bool log_enabled(LogLevel level) {
+        return static_cast<uint8_t>(level) >= static_cast<uint8_t>(LogConfig::kMinLevel) && level != LogLevel::kOff;
+    }
+
+    // Ring slot claimed by log_reserve; payload is contiguous
+    struct LogSlot {
+        uint32_t index;   // Header word
+        uint8_t* payload;
+        uint32_t bytes;
+    };
+
+    // Lock-free multi-producer reservation (tasks and ISRs). Fails, counting a drop, when the ring is full
+    bool log_reserve(size_t payload_bytes, LogSlot* slot);
+    void log_commit(const LogSlot& slot, LogLevel level);
+    void log_record_cost(uint32_t cycles);
+
+    // Low-priority task that empties the ring to the console
+    void log_drain_task(void* parameters);
+
+    namespace log_detail {
+
+        // How one argument is packed, and what the format string must say for it
+        enum class ArgClass : uint8_t {
+            kNone,
+            kInt,     // 4 bytes: integers up to 32 bits, enums, bool, char
+            kInt64,   // 8 bytes
+            kFloat,   // 4 bytes: float and double both travel as float
+            kString,  // length byte + up to kMaxStringBytes
+            kPointer, // 4 bytes
+        };
+
+        template <typename T>
+        constexpr ArgClass classify() {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+                return ArgClass::kString;
+            }
+            else if constexpr (std::is_pointer_v<U>) {
+                return ArgClass::kPointer;
+            }
+            else if constexpr (std::is_floating_point_v<U>) {
+                return ArgClass::kFloat;
+            }
+            else if constexpr (std::is_enum_v<U> || std::is_integral_v<U>) {
+                return sizeof(U) > 4 ? ArgClass::kInt64 : ArgClass::kInt;
+            }
+            else {
+                return ArgClass::kNone;
+            }
+        }
+
+        constexpr bool is_digit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        // Walks the printf conversions and checks each against the packed argument class
+        constexpr bool format_matches(const char* fmt, const ArgClass* classes, size_t count) {
+            size_t arg = 0;
+            for (size_t i = 0; fmt[i] != '\0'; i++) {
+                if (fmt[i] != '%') {
+                    continue;
+                }
+                i++;
+                if (fmt[i] == '%') {
+                    continue;
+                }
+                while (fmt[i] == '-' || fmt[i] == '+' || fmt[i] == ' ' || fmt[i] == '#' || fmt[i] == '0') i++;
+                while (is_digit(fmt[i])) i++;
+                if (fmt[i] == '.') {
+                    i++;
+                    while (is_digit(fmt[i])) i++;
+                }
+
+                int longs = 0;
+                while (fmt[i] == 'h' || fmt[i] == 'l' || fmt[i] == 'z' || fmt[i] == 'j' || fmt[i] == 't') {
+                    longs += (fmt[i] == 'l') ? 1 : 0;
+                    i++;
+                }
+
+                ArgClass expected = ArgClass::kNone;
+                switch (fmt[i]) {
+                    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+                        // %l is 32-bit on the M7; host builds have 64-bit long
+                        expected = (longs >= 2 || (longs == 1 && sizeof(long) > 4)) ? ArgClass::kInt64 : ArgClass::kInt;
+                        break;
+                    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                        expected = ArgClass::kFloat;
+                        break;
+                    case 's':
+                        expected = ArgClass::kString;
+                        break;
+                    case 'p':
+                        expected = ArgClass::kPointer;
+                        break;
+                    default:
+                        return false; // '*' widths, %n and unknown conversions aren't supported
+                }
+
+                if (arg >= count || classes[arg] != expected) {
+                    return false;
+                }
+                arg++;
+            }
+            return arg == count;
+        }
+
+        template <typename... Args>
+        struct TypeList {};
+
+        // Unevaluated only: turns the macro arguments into a type list
+        template <typename... Args>
+        TypeList<std::decay_t<Args>...> arg_list(const Args&...);
+
+        template <typename List>
+        struct FormatCheck;
+
+        template <typename Fmt, typename... Args>
+        struct FormatCheck<TypeList<Fmt, Args...>> {
+            static constexpr size_t kMaxPayload = 8 + (0 + ... + (classify<Args>() == ArgClass::kString
+                ? 1 + LogConfig::kMaxStringBytes : classify<Args>() == ArgClass::kInt64 ? 8 : 4));
+
+            static constexpr bool matches(const char* fmt) {
+                constexpr ArgClass classes[] = {classify<Args>()..., ArgClass::kNone};
+                return format_matches(fmt, classes, sizeof...(Args));
+            }
+        };
+
+        inline size_t string_length(const char* s) {
+            if (s == nullptr) {
+                return 0;
+            }
+            size_t n = strlen(s);
+            return n < LogConfig::kMaxStringBytes ? n : LogConfig::kMaxStringBytes;
+        }
+
+        template <typename T>
+        size_t arg_size(const T& value) {
+            constexpr ArgClass kClass = classify<T>();
+            if constexpr (kClass == ArgClass::kString) {
+                return 1 + string_length(value);
+            }
+            else {
+                return kClass == ArgClass::kInt64 ? 8 : 4;
+            }
+        }
+
+        template <typename T>
+        void put(uint8_t*& out, const T& value) {
+            constexpr ArgClass kClass = classify<T>();
+            if constexpr (kClass == ArgClass::kString) {
+                uint8_t n = static_cast<uint8_t>(string_length(value));
+                *out++ = n;
+                memcpy(out, value, n);
+                out += n;
+            }
+            else if constexpr (kClass == ArgClass::kFloat) {
+                float f = static_cast<float>(value);
+                memcpy(out, &f, 4);
+                out += 4;
+            }
+            else if constexpr (kClass == ArgClass::kPointer) {
+                uint32_t p = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(value));
+                memcpy(out, &p, 4);
+                out += 4;
+            }
+            else if constexpr (kClass == ArgClass::kInt64) {
+                uint64_t v = static_cast<uint64_t>(value);
+                memcpy(out, &v, 8);
+                out += 8;
+            }
+            else {
+                uint32_t v = static_cast<uint32_t>(value);
+                memcpy(out, &v, 4);
+                out += 4;
+            }
+        }
+    }
+
+    // Packs the format string address, a cycle stamp and the raw arguments. The
+    // string itself never leaves the image; the decoder looks it up in the ELF.
+    template <typename... Args>
+    void log_write(LogLevel level, const char* fmt, const Args&... args) {
+        uint32_t start = cycle_counter_read();
+
+        size_t bytes = 8 + (0 + ... + log_detail::arg_size(args));
+        LogSlot slot;
+        if (!log_reserve(bytes, &slot)) {
+            return;
+        }
+
+        uint8_t* out = slot.payload;
+        uint32_t fmt_id = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(fmt));
+        memcpy(out, &fmt_id, 4);
+        memcpy(out + 4, &start, 4);
+        out += 8;
+        (log_detail::put(out, args), ...);
+
+        log_commit(slot, level);
+
+        if constexpr (LogConfig::kMeasureCost) {
+            log_record_cost(cycle_counter_read() - start);
+        }
+    }
+}
+
+#define DLOG_FORMAT_ARG_INNER(fmt, ...) fmt
+#define DLOG_FORMAT_ARG(...) DLOG_FORMAT_ARG_INNER(__VA_ARGS__, 0)
+
+// DLOG_INFO("fmt", args...): printf-style, checked at compile time. The caller only pays for
+// packing (tx_log_stats reports the cost); arguments aren't evaluated when the level is filtered out.
+#define DLOG_AT(level, ...)                                                                                   \
+    do {                                                                                                      \
+        using DlogCheck_ = ::coralmicro::log_detail::FormatCheck<decltype(                                    \
+            ::coralmicro::log_detail::arg_list(__VA_ARGS__))>;                                                \
+        static_assert(DlogCheck_::matches(DLOG_FORMAT_ARG(__VA_ARGS__)),                                      \
+                      "Log arguments don't match the format string");                                         \
+        static_assert(DlogCheck_::kMaxPayload <= ::coralmicro::LogConfig::kMaxRecordBytes,                    \
+                      "Log record too large");                                                                \
+        if constexpr (::coralmicro::log_enabled(level)) {                                                     \
+            ::coralmicro::log_write(level, __VA_ARGS__);                                                      \
+        }                                                                                                     \
+    } while (0)
+
+#define DLOG_DEBUG(...) DLOG_AT(::coralmicro::LogLevel::kDebug, __VA_ARGS__)
+#define DLOG_INFO(...) DLOG_AT(::coralmicro::LogLevel::kInfo, __VA_ARGS__)
+#define DLOG_WARN(...) DLOG_AT(::coralmicro::LogLevel::kWarn, __VA_ARGS__)
+#define DLOG_ERROR(...) DLOG_AT(::coralmicro::LogLevel::kError, __VA_ARGS__)
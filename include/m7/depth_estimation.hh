@@ -1,11 +1,9 @@
 // depth_estimation.hh
 #pragma once
-#include "third_party/freertos_kernel/include/FreeRTOS.h"
 #include "libs/tensorflow/detection.h"
 #include <cmath>
 
-#include "global_config.hh"
-#include "tof_rgb_mapping.hh"
+#include "m7/tof_data.hh"
 
 
 namespace coralmicro {
@@ -13,7 +11,7 @@ namespace coralmicro {
     void depth_estimation(
         const tensorflow::Object* detections, // array of detections
         const uint8_t detection_count,    // number of detections 
-        const int16_t* distance_mm,   //  array from ToF
+        const TofData& tof_data,      // latest frame of every ToF sensor
         float* depths_out
     );
 } // namespace coralmicro
\ No newline at end of file
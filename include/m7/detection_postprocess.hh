@@ -0,0 +1,19 @@
+// detection_postprocess.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "libs/tensorflow/detection.h"
+
+namespace coralmicro {
+
+    constexpr int kPersonClassId = 0; // COCO "person"
+
+    // Keeps the person results of the detector in the fixed array the pipeline passes around,
+    // scaled from normalized to pixel coordinates, in detector order. Returns how many were kept.
+    // Pure, so it builds and runs on the host as well.
+    uint8_t postprocess_detections(const std::vector<tensorflow::Object>& results, uint32_t width, uint32_t height,
+                                   tensorflow::Object* out, size_t max_count);
+}
@@ -0,0 +1,22 @@
+// edma.hh
+#pragma once
+
+#include <cstdint>
+
+namespace coralmicro {
+
+    // eDMA channel assignment for the whole app; channel n and n + 16 share an interrupt
+    struct EdmaChannels {
+        static constexpr uint32_t kLedStrip = 0;  // PIT periodic triggering only reaches channels 0-3
+        static constexpr uint32_t kTofI2c1Tx = 24;
+        static constexpr uint32_t kTofI2c1Rx = 25;
+        static constexpr uint32_t kTofI2c6Tx = 26;
+        static constexpr uint32_t kTofI2c6Rx = 27;
+    };
+
+    // Clocks and configures eDMA0. Called once from main_m7 before any driver creates a handle.
+    void edma_init();
+
+    // Lowers the channel's interrupt to a priority whose handler may call FreeRTOS FromISR functions
+    void edma_set_irq_priority(uint32_t channel);
+}
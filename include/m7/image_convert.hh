@@ -0,0 +1,56 @@
+// image_convert.hh
+#pragma once
+
+#include <cstdint>
+
+namespace coralmicro {
+
+    // Color filter layout, named by the top-left 2x2 block
+    enum class BayerPattern : uint8_t {
+        kRGGB,
+        kBGGR,
+        kGRBG,
+        kGBRG,
+    };
+
+    enum class ConvertFilter : uint8_t {
+        kNearest,
+        kBilinear,
+    };
+
+    // Clockwise rotation applied to the sensor image
+    enum class ConvertRotation : uint8_t {
+        k0,
+        k90,
+        k180,
+        k270,
+    };
+
+    struct RawConvertParams {
+        const uint8_t* raw;        // Bayer frame, one byte per photosite
+        uint32_t raw_width;
+        uint32_t raw_height;
+        BayerPattern pattern;
+
+        uint8_t* rgb;              // RGB888 output, out_width * out_height * 3 bytes
+        uint32_t out_width;
+        uint32_t out_height;
+
+        ConvertFilter filter;
+        ConvertRotation rotation;
+        bool preserve_ratio;       // Letterbox with black bars instead of stretching
+    };
+
+    // Single pass Bayer -> rotate -> resize -> letterbox into the model input layout.
+    // Each output pixel samples a sliding 2x2 Bayer window (one R, two G, one B) at its
+    // source position, so no intermediate full-size RGB frame is needed.
+    //
+    // Bilinear filtering is separable with one rounding per pass:
+    //   top = (c00 * (256 - fx) + c10 * fx + 128) >> 8, likewise bottom, then the same over fy.
+
+    // Portable scalar reference
+    bool convert_raw_frame_reference(const RawConvertParams& params);
+
+    // Packed-lane version (Cortex-M7 DSP byte unpacking when available), bit-exact with the reference
+    bool convert_raw_frame(const RawConvertParams& params);
+}
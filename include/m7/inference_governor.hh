@@ -0,0 +1,68 @@
+// inference_governor.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "system_enums.hh"
+
+namespace coralmicro {
+
+    enum class InferenceMode : uint8_t {
+        IDLE,   // Empty cell or host STOPPED/HELD: minimum rate
+        NORMAL,
+        ALERT,  // Person near the danger distance or host in EXECUTE: maximum rate
+        COUNT,
+    };
+
+    constexpr size_t kInferenceModeCount = static_cast<size_t>(InferenceMode::COUNT);
+
+    struct InferenceGovernorConfig {
+        static constexpr bool kEnabled = true;
+
+        static constexpr uint32_t kMinHz = 2;
+        static constexpr uint32_t kNormalHz = 10;
+        static constexpr uint32_t kMaxHz = 15;
+        static constexpr uint32_t kModeHz[kInferenceModeCount] = {kMinHz, kNormalHz, kMaxHz};
+
+        static constexpr float kAlertDistanceMm = 1200.0f;  // Person closer than this raises the rate
+        static constexpr uint32_t kDowngradeHoldMs = 3000;  // Minimum time in a mode before lowering it
+    };
+
+    static_assert(InferenceGovernorConfig::kMinHz > 0 &&
+                  InferenceGovernorConfig::kMinHz <= InferenceGovernorConfig::kNormalHz &&
+                  InferenceGovernorConfig::kNormalHz <= InferenceGovernorConfig::kMaxHz,
+                  "Inference rates must satisfy 0 < min <= normal <= max");
+
+    // Published by the state controller after every decision
+    struct GovernorInput {
+        SystemState system_state;
+        HostState host_state;
+        bool host_connected;
+        bool person_present;
+        float nearest_depth_mm;  // Negative when unknown
+        bool tof_intrusion;
+    };
+
+    // Picks the inference rate from scene activity and system state.
+    // Raising the mode is immediate, lowering it waits out kDowngradeHoldMs.
+    class InferenceGovernor {
+    public:
+        InferenceMode update(const GovernorInput& input, uint32_t now_ms);
+
+        InferenceMode mode() const { return mode_; }
+        uint32_t period_ms() const { return 1000 / InferenceGovernorConfig::kModeHz[static_cast<size_t>(mode_)]; }
+        uint32_t time_in_mode_ms(InferenceMode mode) const { return time_in_mode_ms_[static_cast<size_t>(mode)]; }
+        uint32_t mode_changes() const { return mode_changes_; }
+
+        static InferenceMode target_mode(const GovernorInput& input);
+
+    private:
+        InferenceMode mode_ = InferenceMode::NORMAL;
+        uint32_t mode_needed_ms_ = 0;     // Last time the current mode was still the target
+        uint32_t last_update_ms_ = 0;
+        bool started_ = false;
+        uint32_t mode_changes_ = 0;
+        uint32_t time_in_mode_ms_[kInferenceModeCount] = {};
+    };
+}
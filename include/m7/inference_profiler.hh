@@ -0,0 +1,97 @@
+// inference_profiler.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "third_party/tflite-micro/tensorflow/lite/micro/micro_profiler_interface.h"
+
+namespace coralmicro {
+
+    struct InferenceProfilerConfig {
+        static constexpr bool kEnabled = true;
+        static constexpr size_t kWindow = 32;         // Inferences kept in the rolling window
+        static constexpr size_t kMaxOps = 16;         // Distinct op tags tracked
+        static constexpr size_t kMaxEventsPerInvoke = 64;
+    };
+
+    // Parts of one detection, in pipeline order
+    enum class ProfileStage : uint8_t {
+        kGate,        // Person gate model (cascade first stage)
+        kCopy,        // Frame -> input tensor
+        kInvoke,      // Interpreter::Invoke, all ops
+        kPostprocess, // GetDetectionResults + person filter + box scaling
+        kCount,
+    };
+
+    constexpr size_t kProfileStageCount = static_cast<size_t>(ProfileStage::kCount);
+
+    constexpr const char* kProfileStageNames[kProfileStageCount] = {
+        "gate", "copy", "invoke", "postprocess"
+    };
+
+    struct ProfileEntry {
+        const char* tag;       // Op name (static string owned by the op registration)
+        uint32_t samples;      // Inferences in the window that ran this op/stage
+        uint32_t last_cycles;
+        uint32_t mean_cycles;
+        uint32_t max_cycles;
+    };
+
+    // Rolling window summary, published after every profiled inference
+    struct ProfileSummary {
+        uint32_t inferences;   // Total profiled inferences since boot
+        ProfileEntry stages[kProfileStageCount];
+        ProfileEntry ops[InferenceProfilerConfig::kMaxOps];
+        uint8_t op_count;
+        uint32_t dropped_events; // Events beyond kMaxEventsPerInvoke or kMaxOps
+    };
+
+    // Records per-op cycle counts from TFLite Micro (BeginEvent/EndEvent around each
+    // op's Eval) plus the stage breakdown around Invoke, all from the DWT cycle counter.
+    // Ops are summed per tag within one inference, so an op used N times reports its total.
+    class InferenceProfiler : public tflite::MicroProfilerInterface {
+    public:
+        uint32_t BeginEvent(const char* tag) override;
+        void EndEvent(uint32_t event_handle) override;
+
+        void begin_inference();
+        void record_stage(ProfileStage stage, uint32_t cycles);
+        // Folds the inference into the window; returns the updated summary
+        const ProfileSummary& end_inference();
+
+    private:
+        struct Event {
+            const char* tag;
+            uint32_t start;
+            uint32_t cycles;
+        };
+
+        struct Series {
+            const char* tag = nullptr;
+            uint32_t cycles[InferenceProfilerConfig::kWindow] = {};
+            bool present[InferenceProfilerConfig::kWindow] = {};
+        };
+
+        int find_or_add_op(const char* tag);
+        static void summarize(const Series& series, size_t newest, size_t filled, ProfileEntry* entry);
+
+        Event events_[InferenceProfilerConfig::kMaxEventsPerInvoke] = {};
+        size_t event_count_ = 0;
+
+        uint32_t stage_cycles_[kProfileStageCount] = {};
+        bool stage_recorded_[kProfileStageCount] = {};
+
+        Series stage_series_[kProfileStageCount];
+        Series op_series_[InferenceProfilerConfig::kMaxOps];
+        size_t op_count_ = 0;
+
+        size_t slot_ = 0;      // Window slot of the current inference
+        size_t filled_ = 0;    // Slots holding data
+
+        ProfileSummary summary_ = {};
+    };
+
+    // Cycles -> microseconds at the DWT counter rate
+    uint32_t profile_cycles_to_us(uint32_t cycles);
+}
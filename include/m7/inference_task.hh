@@ -2,6 +2,8 @@
 #pragma once
 
 #include <vector>
+#include <atomic>
+#include <memory>
 
 
 #include "third_party/freertos_kernel/include/FreeRTOS.h"
@@ -18,16 +20,66 @@
 #include "third_party/tflite-micro/tensorflow/lite/micro/micro_mutable_op_resolver.h"
 
 #include "m7/m7_queues.hh"
+#include "m7/deferred_log.hh"
+#include "m7/metrics.hh"
+#include "m7/cyclic_executive.hh"
+#include "m7/boot.hh"
 #include "global_config.hh"
+#include "m7/motion_gate.hh"
+#include "m7/inference_governor.hh"
+#include "m7/cascade_gate.hh"
+#include "m7/inference_profiler.hh"
+#include "m7/cycle_counter.hh"
+#include "m7/recorder.hh"
+#include "m7/detection_postprocess.hh"
 
 namespace coralmicro {
     // Task Functions
     void inference_task(void* parameters);
 
+    void update_governor(InferenceGovernor& governor, GovernorInput& governor_input);
+
     bool detect_objects(tflite::MicroInterpreter* interpreter, 
                        const CameraData& camera_data,
-                       DetectionData* detection_data);
+                       DetectionData* detection_data,
+                       InferenceProfiler* profiler = nullptr);
+
+    // Person gate score in [0, 1], or a negative value on failure
+    float run_person_gate(tflite::MicroInterpreter* interpreter, const CameraData& camera_data);
 
     // Settings
     constexpr float kDetectionThreshold = 0.60f;
+
+    // Telemetry, read by the RPC task
+    struct InferenceStats {
+        std::atomic<uint32_t> frames_seen{0};       // Camera frames taken from the queue
+        std::atomic<uint32_t> invocations{0};       // Frames that ran the model
+        std::atomic<uint32_t> motion_skips{0};      // Frames skipped by the motion gate
+        std::atomic<uint32_t> forced_refreshes{0};  // Static frames run because the refresh interval elapsed
+
+        std::atomic<uint8_t> governor_mode{static_cast<uint8_t>(InferenceMode::NORMAL)};
+        std::atomic<uint32_t> governor_mode_changes{0};
+        std::atomic<uint32_t> governor_time_in_mode_ms[kInferenceModeCount] = {};
+
+        std::atomic<bool> cascade_active{false};      // Gate model loaded and running
+        std::atomic<uint32_t> gate_runs{0};
+        std::atomic<uint32_t> gate_fires{0};
+        std::atomic<uint32_t> cascade_skips{0};       // Frames where the SSD was skipped
+        std::atomic<uint32_t> cascade_refreshes{0};
+        std::atomic<uint32_t> cascade_hits{0};
+        std::atomic<uint32_t> cascade_false_alarms{0};
+        std::atomic<uint32_t> cascade_misses{0};
+        std::atomic<uint32_t> gate_time_us{0};        // Last gate Invoke
+        std::atomic<float> gate_score{0.0f};          // Last gate score
+    };
+
+    inline InferenceStats g_inference_stats;
+
+    // Cascade thresholds, writable over RPC
+    struct CascadeSettings {
+        std::atomic<float> fire_threshold{CascadeConfig::kDefaultFireThreshold};
+        std::atomic<uint32_t> refresh_ms{CascadeConfig::kDefaultRefreshMs};
+    };
+
+    inline CascadeSettings g_cascade_settings;
 }
\ No newline at end of file
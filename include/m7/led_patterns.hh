@@ -0,0 +1,44 @@
+// led_patterns.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "system_enums.hh"
+#include "m7/ws2812.hh"
+
+namespace coralmicro {
+
+    struct LedPatternConfig {
+        static constexpr uint32_t kTickMs = 20;                 // Pattern timer period while a scene animates
+        static constexpr uint16_t kWarningBlinkMs = 1000;       // Half on, half off
+        static constexpr uint16_t kDisconnectedPulseMs = 2000;  // Full breath
+        static constexpr uint8_t kPulseFloor = 24;              // Dimmest point of a pulse, out of 255
+    };
+
+    enum class LedPattern : uint8_t {
+        kSolid,
+        kBlink,
+        kPulse,
+    };
+
+    // What the LEDs show for one system state
+    struct LedScene {
+        LedColor color;
+        LedPattern pattern;
+        uint16_t period_ms;
+
+        bool animated() const { return pattern != LedPattern::kSolid; }
+        bool operator==(const LedScene& other) const {
+            return color.red == other.color.red && color.green == other.color.green &&
+                   color.blue == other.color.blue && pattern == other.pattern && period_ms == other.period_ms;
+        }
+        bool operator!=(const LedScene& other) const { return !(*this == other); }
+    };
+
+    // STOPPED is always solid red. WARNING blinks. Any other state pulses while the host is disconnected.
+    LedScene led_scene(SystemState state, bool host_connected);
+
+    // Renders the scene elapsed_ms after it started into every LED of frame. Blinks start on.
+    void led_render(const LedScene& scene, uint32_t elapsed_ms, LedColor* frame, size_t count);
+}
@@ -4,20 +4,19 @@
 
 #include "third_party/freertos_kernel/include/FreeRTOS.h"
 #include "third_party/freertos_kernel/include/task.h"
+#include "third_party/freertos_kernel/include/timers.h"
 #include "libs/base/gpio.h"
 
 
-#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_gpt.h"
-
 #include "m7/m7_queues.hh"
+#include "m7/cyclic_executive.hh"
+#include "m7/ws2812.hh"
+#include "m7/led_patterns.hh"
 #include "system_enums.hh"
 #include "global_config.hh"
 
-// External assembly functions
-extern "C" void _ZN10coralmicro7SendBitEb(bool bit);
-extern "C" void _ZN10coralmicro15InitializeGpioEv();
-extern "C" void _ZN10coralmicro10ResetDelayEv();
-
 namespace coralmicro {
+    static constexpr size_t kLedCount = 3;
+
     void led_task(void* parameters);
 }
\ No newline at end of file
@@ -3,9 +3,11 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
 
 #include "third_party/freertos_kernel/include/FreeRTOS.h"
 #include "third_party/freertos_kernel/include/queue.h"
+#include "third_party/freertos_kernel/include/task.h"
 
 // Camera
 #include "libs/camera/camera.h"
@@ -22,11 +24,18 @@ extern "C" {
 
 #include "system_enums.hh"
 #include "global_config.hh"
+#include "m7/inference_governor.hh"
+#include "m7/inference_profiler.hh"
+#include "m7/timebase.hh"
+#include "m7/zone_profiler.hh"
+#include "m7/channel_stats.hh"
+#include "m7/tof_data.hh"
+#include "m7/danger_zones.hh"
 
 namespace coralmicro {
 
     struct CameraData {
-        TickType_t timestamp_ms; // timestamp_ms of creation (ms)
+        uint64_t timestamp_us; // Capture time (timebase_us)
 
         uint32_t width; 
         uint32_t height;
@@ -37,12 +46,12 @@ namespace coralmicro {
     };
 
     struct DetectionData {
-        TickType_t timestamp_ms;   // timestamp_ms of creation (ms)
+        uint64_t timestamp_us;   // Inference start (timebase_us)
 
         tensorflow::Object detections[g_max_detections_per_inference]; // Array to hold detection results
         uint8_t detection_count; // Actual number of valid detections
         
-        TickType_t inference_time_ms; // time taken for inference
+        uint32_t inference_time_us; // time taken for inference (us)
 
         CameraData camera_data; 
         
@@ -50,20 +59,30 @@ namespace coralmicro {
     };
 
     struct DepthEstimationData {
-        TickType_t timestamp_ms; // timestamp_ms of creation (ms)
+        uint64_t timestamp_us; // Depth estimation start (timebase_us)
 
         float depths[g_max_detections_per_inference]; // Array to hold estimated depths for each detection
 
-        TickType_t depth_estimation_time_ms; // Time taken for depth estimation (ms)
+        uint32_t depth_estimation_time_us; // Time taken for depth estimation (us)
+    };
+
+
+    // What the status LEDs show
+    struct StateUpdate {
+        SystemState system_state;
+        bool host_connected;
     };
 
     struct LoggingData {
-        TickType_t timestamp_ms; // timestamp_ms of creation
+        uint64_t timestamp_us; // timestamp of creation (timebase_us)
 
         SystemState system_state; // Current system state
 
         DetectionData detection_data; // Detection data
         DepthEstimationData depth_estimation_data; // Depth estimation data
+
+        uint32_t reaction_latency_us; // Time from input arrival to state decision (us)
+        bool tof_intrusion; // ToF-only intrusion latched
     };
 
     // Queue handles
@@ -80,23 +99,88 @@ namespace coralmicro {
 
     inline QueueHandle_t g_logging_queue_m7; // Logging data
 
+    inline QueueHandle_t g_governor_queue_m7; // Inference governor inputs
+
+    inline QueueHandle_t g_profile_queue_m7; // Inference profiler summary
+
+    inline QueueHandle_t g_danger_zones_queue_m7; // Danger zones uploaded over RPC (DangerZoneSet)
+
+
+    // State controller wake-up events (task notification bits)
+    enum StateControllerEvent : uint32_t {
+        kEventDetection        = (1u << 0),
+        kEventTof              = (1u << 1),
+        kEventHostState        = (1u << 2),
+        kEventHeartbeat        = (1u << 3),
+        kEventDangerZones      = (1u << 4),
+    };
+
+    inline TaskHandle_t g_state_controller_task_m7 = nullptr;
+    inline std::atomic<uint32_t> g_state_controller_event_us_m7{0}; // Low 32 bits of timebase_us of the oldest unhandled event, 0 = none
+
+    // Wake the state controller after writing one of its input queues
+    inline void NotifyStateController(uint32_t events) {
+        if (g_state_controller_task_m7 == nullptr) {
+            return;
+        }
+
+        // Low bit forced on so a real timestamp never reads as "none"
+        uint32_t expected = 0;
+        g_state_controller_event_us_m7.compare_exchange_strong(expected, static_cast<uint32_t>(timebase_us()) | 1u);
+        xTaskNotify(g_state_controller_task_m7, events, eSetBits);
+    }
+
+    // LED task wake-up events (task notification bits, alongside the executive's release bit)
+    enum LedEvent : uint32_t {
+        kLedEventState = (1u << 0),
+        kLedEventTick  = (1u << 1),
+    };
+
+    inline TaskHandle_t g_led_task_m7 = nullptr;
+
+    // Wake the LED task after writing the state update queue, or for the next pattern frame
+    inline void NotifyLedTask(uint32_t events) {
+        if (g_led_task_m7 == nullptr) {
+            return;
+        }
+        xTaskNotify(g_led_task_m7, events, eSetBits);
+    }
+
 
     // Queue creation
     inline bool InitQueues() {
-        g_tof_queue_m7 = xQueueCreate(1, sizeof(VL53L8CX_ResultsData));
-        g_camera_queue_m7 = xQueueCreate(1, sizeof(CameraData));
+        // Overwrite, read and age accounting (channel_stats.hh)
+        g_tof_queue_m7 = channel_create(Channel::kTof, sizeof(TofData));
+        g_camera_queue_m7 = channel_create(Channel::kCamera, sizeof(CameraData));
 
-        g_detection_output_queue_m7 = xQueueCreate(1, sizeof(DetectionData));
+        g_detection_output_queue_m7 = channel_create(Channel::kDetection, sizeof(DetectionData));
 
-        g_state_update_queue_m7 = xQueueCreate(1, sizeof(SystemState));
+        g_state_update_queue_m7 = channel_create(Channel::kStateUpdate, sizeof(StateUpdate));
 
-        g_logging_queue_m7 = xQueueCreate(1, sizeof(LoggingData));
+        g_logging_queue_m7 = channel_create(Channel::kLogging, sizeof(LoggingData));
 
-        g_host_connection_status_queue_m7 = xQueueCreate(1, sizeof(HostConnectionStatus));
+        g_host_connection_status_queue_m7 = channel_create(Channel::kHostConnection, sizeof(HostConnectionStatus));
 
-        g_host_state_queue_m7 = xQueueCreate(1, sizeof(HostState));
+        g_host_state_queue_m7 = channel_create(Channel::kHostState, sizeof(HostState));
+
+        g_governor_queue_m7 = channel_create(Channel::kGovernor, sizeof(GovernorInput));
+
+        g_profile_queue_m7 = channel_create(Channel::kProfile, sizeof(ProfileSummary));
+
+        g_danger_zones_queue_m7 = channel_create(Channel::kDangerZones, sizeof(DangerZoneSet));
+
+        // Names for the kernel trace ring (trace_hooks.hh)
+        trace_register_object(g_tof_queue_m7, "tof_queue");
+        trace_register_object(g_camera_queue_m7, "camera_queue");
+        trace_register_object(g_detection_output_queue_m7, "detection_queue");
+        trace_register_object(g_state_update_queue_m7, "state_update_queue");
+        trace_register_object(g_logging_queue_m7, "logging_queue");
+        trace_register_object(g_host_connection_status_queue_m7, "host_connection_queue");
+        trace_register_object(g_host_state_queue_m7, "host_state_queue");
+        trace_register_object(g_governor_queue_m7, "governor_queue");
+        trace_register_object(g_profile_queue_m7, "profile_queue");
+        trace_register_object(g_danger_zones_queue_m7, "danger_zones_queue");
 
-        
         return (g_tof_queue_m7 != nullptr && g_camera_queue_m7 != nullptr);
     }
 
@@ -111,5 +195,11 @@ namespace coralmicro {
         if (g_host_state_queue_m7) vQueueDelete(g_host_state_queue_m7);
 
         if (g_logging_queue_m7) vQueueDelete(g_logging_queue_m7);
+
+        if (g_governor_queue_m7) vQueueDelete(g_governor_queue_m7);
+
+        if (g_profile_queue_m7) vQueueDelete(g_profile_queue_m7);
+
+        if (g_danger_zones_queue_m7) vQueueDelete(g_danger_zones_queue_m7);
     }
 }
\ No newline at end of file
@@ -0,0 +1,239 @@
+// metrics.hh
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace coralmicro {
+
+    struct MetricsConfig {
+        static constexpr bool kEnabled = true;
+        static constexpr const char* kUri = "/metrics";       // Served by the RPC task's HTTP server
+        static constexpr size_t kHistogramSubBuckets = 4;      // Linear steps per power of two
+        static constexpr size_t kMaxHistogramBuckets = 64;
+    };
+
+    enum class MetricType : uint8_t {
+        kCounter,
+        kGauge,
+        kHistogram,
+    };
+
+    // Every metric, in registry order (kMetricTable)
+    enum class Metric : uint8_t {
+        kCameraFramesCaptured,
+        kCameraFramesDropped,
+        kInferenceFrames,
+        kInferences,
+        kInferenceSkips,
+        kInferenceSkipRatio,
+        kInferenceMode,
+        kInferenceDuration,
+        kTofFrames,
+        kTofErrors,
+        kRpcCalls,
+        kSystemState,
+        kStateTransitions,
+        kStateTime,
+        kReactionLatency,
+        kCount,
+    };
+
+    // Label values, index = label argument of the metric_* calls
+
+    enum class SkipReason : uint8_t { kMotion, kCascade, kCount };
+    constexpr const char* kSkipReasonLabels[] = {"motion", "cascade"};
+
+    // One per get_error_string case (tof_task.cc)
+    enum class TofErrorLabel : uint8_t {
+        kInvalidParam, kMajor, kTimeout, kCorruptedFrame, kLaserSafety,
+        kXtalkFailed, kFwChecksum, kMcu, kUnknown, kCount,
+    };
+    constexpr const char* kTofErrorLabels[] = {
+        "invalid_param", "major", "timeout", "corrupted_frame", "laser_safety",
+        "xtalk_failed", "fw_checksum", "mcu", "unknown",
+    };
+
+    // Exported JSON-RPC methods; the names here are the ones registered (rpc_task.cc)
+    enum class RpcMethod : uint8_t {
+        kHostHeartbeat, kRxHostState, kTxLogsToHost, kTxInferenceStats, kTxCameraStats,
+        kTxCascadeStats, kRxCascadeConfig, kTxInferenceProfile, kTxTraceInfo, kTxTraceDump,
+        kTxLogStats, kTxChannelStats, kTxBootReport,
+        kTxTofBusStats, kTxTofSensorStats, kTxRecording, kTxApproachStats, kRxApproachConfig,
+        kTxDangerZones, kRxDangerZones, kCount,
+    };
+    constexpr const char* kRpcMethodLabels[] = {
+        "host_heartbeat", "rx_host_state", "tx_logs_to_host", "tx_inference_stats", "tx_camera_stats",
+        "tx_cascade_stats", "rx_cascade_config", "tx_inference_profile", "tx_trace_info", "tx_trace_dump",
+        "tx_log_stats", "tx_channel_stats", "tx_boot_report",
+        "tx_tof_bus_stats", "tx_tof_sensor_stats", "tx_recording", "tx_approach_stats", "rx_approach_config",
+        "tx_danger_zones", "rx_danger_zones",
+    };
+
+    // SystemState order (system_enums.hh)
+    constexpr size_t kSystemStateCount = 7;
+    constexpr const char* kSystemStateLabels[kSystemStateCount] = {
+        "uninitialized", "host_reading", "scanning", "stopped", "warning", "idle", "active",
+    };
+
+    static_assert(sizeof(kSkipReasonLabels) / sizeof(kSkipReasonLabels[0]) == static_cast<size_t>(SkipReason::kCount));
+    static_assert(sizeof(kTofErrorLabels) / sizeof(kTofErrorLabels[0]) == static_cast<size_t>(TofErrorLabel::kCount));
+    static_assert(sizeof(kRpcMethodLabels) / sizeof(kRpcMethodLabels[0]) == static_cast<size_t>(RpcMethod::kCount));
+
+    struct MetricDesc {
+        Metric id;
+        const char* name;
+        const char* help;
+        MetricType type;
+        const char* label = nullptr;              // Label name, nullptr for a single series
+        const char* const* label_values = nullptr;
+        size_t label_count = 1;
+        uint8_t min_pow = 0;                      // Histograms: values below 2^min_pow share the first bucket
+        uint8_t max_pow = 0;                      //             values from 2^(max_pow + 1) go to +Inf
+    };
+
+    // The registry. Storage for every series is laid out from this table at compile time
+    constexpr MetricDesc kMetricTable[] = {
+        {Metric::kCameraFramesCaptured, "andon_camera_frames_captured_total", "Frames captured and published by the camera task",
+            MetricType::kCounter},
+        {Metric::kCameraFramesDropped, "andon_camera_frames_dropped_total", "Frames lost to capture or conversion failures",
+            MetricType::kCounter},
+        {Metric::kInferenceFrames, "andon_inference_frames_total", "Camera frames taken by the inference task",
+            MetricType::kCounter},
+        {Metric::kInferences, "andon_inferences_total", "SSD detector invocations",
+            MetricType::kCounter},
+        {Metric::kInferenceSkips, "andon_inference_skips_total", "Frames where the SSD was skipped",
+            MetricType::kCounter, "reason", kSkipReasonLabels, static_cast<size_t>(SkipReason::kCount)},
+        {Metric::kInferenceSkipRatio, "andon_inference_skip_ratio", "Skipped frames over frames taken since boot",
+            MetricType::kGauge, "reason", kSkipReasonLabels, static_cast<size_t>(SkipReason::kCount)},
+        {Metric::kInferenceMode, "andon_inference_mode", "Inference governor mode (0 idle, 1 normal, 2 alert)",
+            MetricType::kGauge},
+        {Metric::kInferenceDuration, "andon_inference_duration_us", "SSD detection time, copy to postprocess",
+            MetricType::kHistogram, nullptr, nullptr, 1, 10, 19},
+        {Metric::kTofFrames, "andon_tof_frames_total", "ToF ranging frames published",
+            MetricType::kCounter},
+        {Metric::kTofErrors, "andon_tof_errors_total", "ToF driver errors by status",
+            MetricType::kCounter, "error", kTofErrorLabels, static_cast<size_t>(TofErrorLabel::kCount)},
+        {Metric::kRpcCalls, "andon_rpc_calls_total", "JSON-RPC calls by method",
+            MetricType::kCounter, "method", kRpcMethodLabels, static_cast<size_t>(RpcMethod::kCount)},
+        {Metric::kSystemState, "andon_system_state", "Current SystemState",
+            MetricType::kGauge},
+        {Metric::kStateTransitions, "andon_state_transitions_total", "Transitions into each SystemState",
+            MetricType::kCounter, "state", kSystemStateLabels, kSystemStateCount},
+        {Metric::kStateTime, "andon_state_milliseconds_total", "Time spent in each SystemState",
+            MetricType::kCounter, "state", kSystemStateLabels, kSystemStateCount},
+        {Metric::kReactionLatency, "andon_reaction_latency_us", "Input arrival to state decision",
+            MetricType::kHistogram, nullptr, nullptr, 1, 4, 17},
+    };
+
+    constexpr size_t kMetricCount = static_cast<size_t>(Metric::kCount);
+    static_assert(sizeof(kMetricTable) / sizeof(kMetricTable[0]) == kMetricCount, "Every Metric needs a table entry");
+
+    namespace metrics_detail {
+
+        constexpr bool table_in_order() {
+            for (size_t i = 0; i < kMetricCount; i++) {
+                if (static_cast<size_t>(kMetricTable[i].id) != i) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr size_t histogram_buckets(const MetricDesc& desc) {
+            // [0, 2^min_pow), sub-buckets of each power up to max_pow, then +Inf
+            return 1 + (desc.max_pow - desc.min_pow + 1) * MetricsConfig::kHistogramSubBuckets + 1;
+        }
+
+        constexpr bool histograms_valid() {
+            for (size_t i = 0; i < kMetricCount; i++) {
+                const MetricDesc& desc = kMetricTable[i];
+                if (desc.type != MetricType::kHistogram) {
+                    continue;
+                }
+                if (desc.label != nullptr || desc.min_pow < 2 || desc.max_pow < desc.min_pow || desc.max_pow > 30 ||
+                    histogram_buckets(desc) > MetricsConfig::kMaxHistogramBuckets) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // First series of a metric among the metrics of the same type
+        constexpr size_t series_offset(Metric id) {
+            size_t offset = 0;
+            MetricType type = kMetricTable[static_cast<size_t>(id)].type;
+            for (size_t i = 0; i < static_cast<size_t>(id); i++) {
+                if (kMetricTable[i].type == type) {
+                    offset += (type == MetricType::kHistogram) ? 1 : kMetricTable[i].label_count;
+                }
+            }
+            return offset;
+        }
+
+        constexpr size_t series_count(MetricType type) {
+            size_t count = 0;
+            for (size_t i = 0; i < kMetricCount; i++) {
+                if (kMetricTable[i].type == type) {
+                    count += (type == MetricType::kHistogram) ? 1 : kMetricTable[i].label_count;
+                }
+            }
+            return count;
+        }
+
+        constexpr const MetricDesc& desc(Metric id) {
+            return kMetricTable[static_cast<size_t>(id)];
+        }
+    }
+
+    static_assert(metrics_detail::table_in_order(), "kMetricTable must follow the Metric enum order");
+    static_assert(metrics_detail::histograms_valid(), "Histogram ranges must be unlabeled, 2 <= min_pow <= max_pow <= 30 and fit kMaxHistogramBuckets");
+
+    constexpr size_t kCounterSeries = metrics_detail::series_count(MetricType::kCounter);
+    constexpr size_t kGaugeSeries = metrics_detail::series_count(MetricType::kGauge);
+    constexpr size_t kHistogramCount = metrics_detail::series_count(MetricType::kHistogram);
+
+    // Updated under the interrupt mask so the 64-bit sum and the buckets stay consistent
+    struct HistogramSeries {
+        uint32_t buckets[MetricsConfig::kMaxHistogramBuckets];
+        uint32_t count;
+        uint64_t sum;
+    };
+
+    inline std::atomic<uint32_t> g_metric_counters[kCounterSeries];
+    inline std::atomic<float> g_metric_gauges[kGaugeSeries];
+    inline HistogramSeries g_metric_histograms[kHistogramCount];
+
+    template <Metric kId>
+    void metric_inc(size_t label = 0, uint32_t n = 1) {
+        static_assert(metrics_detail::desc(kId).type == MetricType::kCounter, "metric_inc needs a counter");
+        if (MetricsConfig::kEnabled && label < metrics_detail::desc(kId).label_count) {
+            g_metric_counters[metrics_detail::series_offset(kId) + label].fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+
+    template <Metric kId>
+    void metric_set(float value, size_t label = 0) {
+        static_assert(metrics_detail::desc(kId).type == MetricType::kGauge, "metric_set needs a gauge");
+        if (MetricsConfig::kEnabled && label < metrics_detail::desc(kId).label_count) {
+            g_metric_gauges[metrics_detail::series_offset(kId) + label].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Log-linear bucket of a value: bucket 0 below 2^min_pow, then kHistogramSubBuckets per power of two
+    size_t histogram_bucket(const MetricDesc& desc, uint32_t value);
+    void histogram_observe(size_t histogram, const MetricDesc& desc, uint32_t value);
+
+    template <Metric kId>
+    void metric_observe(uint32_t value) {
+        static_assert(metrics_detail::desc(kId).type == MetricType::kHistogram, "metric_observe needs a histogram");
+        if (MetricsConfig::kEnabled) {
+            histogram_observe(metrics_detail::series_offset(kId), metrics_detail::desc(kId), value);
+        }
+    }
+
+    // Whole registry in the Prometheus text exposition format (version 0.0.4)
+    void metrics_render(std::string* out);
+}
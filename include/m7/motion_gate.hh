@@ -0,0 +1,42 @@
+// motion_gate.hh
+#pragma once
+
+#include <cstdint>
+
+namespace coralmicro {
+
+    struct MotionGateConfig {
+        static constexpr bool kEnabled = true;
+
+        static constexpr uint32_t kDecimation = 4;          // Sample every 4th pixel in x and y
+        static constexpr uint32_t kBlockSize = 8;           // Block side, in decimated pixels
+        static constexpr uint32_t kBlockMeanAbsDiff = 6;    // Mean |luma - background| that marks a block as changed
+        static constexpr uint32_t kMinChangedBlocks = 1;    // Changed blocks needed to report motion
+        static constexpr uint32_t kBackgroundShift = 3;     // Background EMA rate of 1/8 per frame
+
+        static constexpr uint32_t kForcedRefreshMs = 1000;  // Run inference at least this often regardless
+
+        static constexpr uint32_t kMaxDecimatedSide = 96;   // Up to 384x384 input frames
+    };
+
+    // Block-wise SAD of a decimated luma plane against a running background
+    class MotionGate {
+    public:
+        // Compare a frame against the background and fold it in.
+        // Returns true if enough blocks changed (always true for the first frame).
+        bool update(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t bytes_per_pixel);
+
+        void reset() { initialized_ = false; }
+        uint32_t changed_blocks() const { return changed_blocks_; }
+
+    private:
+        static constexpr uint32_t kMaxPixels = MotionGateConfig::kMaxDecimatedSide * MotionGateConfig::kMaxDecimatedSide;
+
+        uint8_t background_[kMaxPixels] = {};
+        uint8_t luma_[kMaxPixels] = {};
+        uint32_t width_ = 0;
+        uint32_t height_ = 0;
+        uint32_t changed_blocks_ = 0;
+        bool initialized_ = false;
+    };
+}
@@ -0,0 +1,43 @@
+// recorder.hh
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "m7/recording_format.hh"
+
+namespace coralmicro {
+
+    struct RecorderConfig {
+        static constexpr bool kEnabled = true;
+        static constexpr size_t kRingBytes = 4 * 1024 * 1024; // In SDRAM; over a dozen raw 300x300 frames plus everything between them
+        static constexpr size_t kMaxChunkBytes = kRingBytes / 4;
+        static constexpr uint32_t kCameraEvery = 30;  // Raw frame with every Nth detector run, 0 = no frames
+        static constexpr size_t kRpcBytes = 8192;     // Stream bytes per tx_recording call
+    };
+
+    struct RecorderStats {
+        std::atomic<uint32_t> chunks{0};
+        std::atomic<uint32_t> evicted_chunks{0}; // Dropped from the tail to make room
+        std::atomic<uint32_t> rejected{0};       // Larger than kMaxChunkBytes
+    };
+
+    inline RecorderStats g_recorder_stats;
+
+    // Capture ring: chunks (recording_format.hh) appended by the tasks as things happen,
+    // the oldest whole chunks evicted to make room. Positions are stream offsets that only
+    // grow, so a reader resumes where it left off and can tell when it fell behind.
+    bool recorder_init();
+
+    // Appends one chunk whose payload is head followed by body (either may be empty).
+    // Task context; blocks only for other writers and readers of the ring.
+    bool recorder_write(ChunkType type, uint8_t aux, uint64_t timestamp_us,
+                        const uint8_t* head, size_t head_size,
+                        const uint8_t* body = nullptr, size_t body_size = 0);
+
+    // Copies up to capacity stream bytes from *offset. If *offset has already been evicted it
+    // moves up to the oldest chunk still held (a chunk boundary) and *dropped says by how much.
+    // *end is the stream offset of the next byte to be written. Returns the bytes copied.
+    size_t recorder_read(uint64_t* offset, uint8_t* out, size_t capacity, uint64_t* end, uint64_t* dropped);
+}
@@ -0,0 +1,163 @@
+// recording_format.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "libs/tensorflow/detection.h"
+
+#include "system_enums.hh"
+#include "state_machine.hh"
+#include "m7/tof_data.hh"
+#include "m7/tof_intrusion.hh"
+#include "m7/approach_predictor.hh"
+#include "m7/danger_zones.hh"
+
+namespace coralmicro {
+
+    // Capture file: a file header, then chunks back to back. Every chunk is a fixed
+    // header (type, aux, payload length, timestamp_us) and its payload, all little-endian.
+    // Readers skip chunk types they don't know, so new types don't break old tools.
+    //
+    //   file header   magic "ANDR" u32 | version u16 | reserved u16 | reserved u64
+    //   chunk header  type u8 | aux u8 | reserved u16 | length u32 | timestamp_us u64
+    struct RecordingFormat {
+        static constexpr uint32_t kMagic = 0x52444e41; // "ANDR"
+        static constexpr uint16_t kVersion = 1;
+        static constexpr size_t kFileHeaderBytes = 16;
+        static constexpr size_t kChunkHeaderBytes = 16;
+
+        static constexpr size_t kDetectionsHeaderBytes = 9;        // capture_us u64, count u8
+        static constexpr size_t kObjectBytes = 24;                 // id i32, score f32, bbox ymin/xmin/ymax/xmax f32
+        static constexpr size_t kDepthsHeaderBytes = 1;            // count u8
+        static constexpr size_t kTofZoneBytes = 3;                 // distance_mm i16, target_status u8
+        static constexpr size_t kMaxTofFrameBytes = 9 + TofIntrusionConfig::kMaxZones * kTofZoneBytes; // frame_us u64, zone_count u8, zones
+        static constexpr size_t kCameraHeaderBytes = 4;            // width u16, height u16
+        static constexpr size_t kGroundTruthHeaderBytes = 9;       // capture_us u64, count u8
+        static constexpr size_t kGroundTruthPersonBytes = 20;      // bbox ymin/xmin/ymax/xmax f32, distance_mm f32
+        static constexpr size_t kApproachParamsBytes = 9;          // enabled u8, stop_budget_ms u32, min_speed_mm_s f32
+        static constexpr size_t kDangerZonesHeaderBytes = 1;       // count u8
+        static constexpr size_t kDangerZoneBytes = 9;              // stop_mm f32, warning_mm f32, vertex_count u8
+        static constexpr size_t kZonePointBytes = 4;               // x u16, y u16
+        static constexpr size_t kMaxDangerZonesBytes = kDangerZonesHeaderBytes +
+            DangerZoneConfig::kMaxZones * (kDangerZoneBytes + DangerZoneConfig::kMaxVertices * kZonePointBytes);
+    };
+
+    // Chunk payloads. timestamp_us is timebase_us on the device; the state controller's inputs
+    // carry the time of the wake-up that took them, the same for everything taken together,
+    // which is how a replay knows what the device decided on in one step.
+    //   kCameraFrame      aux CameraEncoding. width u16, height u16, then the pixels or JPEG stream.
+    //                     Stamped with the capture time, which its kDetections chunk repeats
+    //   kTofFrame         aux sensor index. frame_us u64 (read time), zone_count u8, then
+    //                     zone_count x (distance_mm i16, status u8)
+    //   kDetections       capture_us u64, count u8, then count objects (pixel bbox)
+    //   kDepthEstimates   count u8, then count depth_mm f32 (negative = unknown)
+    //   kHostState        state u8 (HostState)
+    //   kHostHeartbeat    empty
+    //   kStateTransition  from u8, to u8, decision inputs u8 (encode_inputs)
+    //   kApproachParams   enabled u8, stop_budget_ms u32, min_speed_mm_s f32. Recorded with the
+    //                     inputs of the first wake-up that runs with them
+    //   kDangerZones      count u8, then count x (stop_mm f32, warning_mm f32, vertex_count u8,
+    //                     vertex_count x (x u16, y u16)). Recorded like kApproachParams
+    //
+    // Added on the host, never by the device (scripts/label_recording.py, reference_detect.py),
+    // both stamped with the capture time of the camera frame they describe:
+    //   kGroundTruth          capture_us u64, count u8, then count persons (pixel bbox, distance_mm f32)
+    //   kReferenceDetections  as kDetections, but the raw detector output: every class, normalized bbox
+    enum class ChunkType : uint8_t {
+        kCameraFrame = 1,
+        kTofFrame,
+        kDetections,
+        kDepthEstimates,
+        kHostState,
+        kHostHeartbeat,
+        kStateTransition,
+        kGroundTruth,
+        kReferenceDetections,
+        kApproachParams,
+        kDangerZones,
+    };
+
+    enum class CameraEncoding : uint8_t {
+        kRgb888,
+        kJpeg,
+    };
+
+    struct ChunkHeader {
+        ChunkType type;
+        uint8_t aux;
+        uint32_t length;       // Payload bytes
+        uint64_t timestamp_us;
+    };
+
+    // A labeled person in a camera frame
+    struct GroundTruthPerson {
+        tensorflow::BBox<float> bbox; // Pixels
+        float distance_mm;
+    };
+
+    struct StateTransitionRecord {
+        SystemState from;
+        SystemState to;
+        uint8_t inputs; // encode_inputs() of the step that took it
+    };
+
+    // Packers write into out and return the bytes written, 0 if capacity is too small.
+    // Unpackers return false on a short or malformed payload.
+    size_t pack_file_header(uint8_t* out, size_t capacity);
+    bool unpack_file_header(const uint8_t* in, size_t size, uint16_t* version);
+
+    size_t pack_chunk_header(const ChunkHeader& header, uint8_t* out, size_t capacity);
+    bool unpack_chunk_header(const uint8_t* in, size_t size, ChunkHeader* header);
+
+    size_t pack_camera_header(uint16_t width, uint16_t height, uint8_t* out, size_t capacity);
+    bool unpack_camera_frame(const uint8_t* in, size_t size, uint16_t* width, uint16_t* height,
+                             const uint8_t** data, size_t* data_size);
+
+    size_t pack_tof_frame(const VL53L8CX_ResultsData& results, uint64_t frame_us, uint8_t zone_count,
+                          uint8_t* out, size_t capacity);
+    bool unpack_tof_frame(const uint8_t* in, size_t size, VL53L8CX_ResultsData* results, uint64_t* frame_us,
+                          uint8_t* zone_count);
+
+    size_t pack_detections(const tensorflow::Object* objects, uint8_t count, uint64_t capture_us,
+                           uint8_t* out, size_t capacity);
+    bool unpack_detections(const uint8_t* in, size_t size, tensorflow::Object* objects, size_t max_count,
+                           uint8_t* count, uint64_t* capture_us);
+
+    size_t pack_depths(const float* depths, uint8_t count, uint8_t* out, size_t capacity);
+    bool unpack_depths(const uint8_t* in, size_t size, float* depths, size_t max_count, uint8_t* count);
+
+    size_t pack_host_state(HostState state, uint8_t* out, size_t capacity);
+    bool unpack_host_state(const uint8_t* in, size_t size, HostState* state);
+
+    size_t pack_state_transition(const StateTransitionRecord& record, uint8_t* out, size_t capacity);
+    bool unpack_state_transition(const uint8_t* in, size_t size, StateTransitionRecord* record);
+
+    size_t pack_approach_params(const ApproachParams& params, uint8_t* out, size_t capacity);
+    bool unpack_approach_params(const uint8_t* in, size_t size, ApproachParams* params);
+
+    size_t pack_danger_zones(const DangerZoneSet& set, uint8_t* out, size_t capacity);
+    bool unpack_danger_zones(const uint8_t* in, size_t size, DangerZoneSet* set);
+
+    size_t pack_ground_truth(const GroundTruthPerson* persons, uint8_t count, uint64_t capture_us,
+                             uint8_t* out, size_t capacity);
+    bool unpack_ground_truth(const uint8_t* in, size_t size, GroundTruthPerson* persons, size_t max_count,
+                             uint8_t* count, uint64_t* capture_us);
+
+    // Walks the chunks of a buffer (the file minus its header). Stops at the first chunk
+    // that runs past the end, which truncated() then reports.
+    class ChunkReader {
+    public:
+        ChunkReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+        bool next(ChunkHeader* header, const uint8_t** payload);
+
+        size_t offset() const { return offset_; }
+        bool truncated() const { return offset_ < size_; }
+
+    private:
+        const uint8_t* data_;
+        size_t size_;
+        size_t offset_ = 0;
+    };
+}
@@ -6,6 +6,17 @@
 #include "third_party/mjson/src/mjson.h"
 
 #include "m7/m7_queues.hh"
+#include "m7/inference_task.hh"
+#include "m7/camera_task.hh"
+#include "m7/zone_profiler.hh"
+#include "m7/timebase.hh"
+#include "m7/deferred_log.hh"
+#include "m7/metrics.hh"
+#include "m7/boot.hh"
+#include "m7/tof_platform.hh"
+#include "m7/tof_sensors.hh"
+#include "m7/recorder.hh"
+#include "m7/state_controller_task.hh"
 #include "system_enums.hh"
 
 #include "global_config.hh"
@@ -16,6 +27,23 @@ namespace coralmicro {
     // RPC Callbacks    
     void tx_logs_to_host(struct jsonrpc_request* request);
     void rx_from_host(struct jsonrpc_request* request);
+    void tx_inference_stats(struct jsonrpc_request* request);
+    void tx_camera_stats(struct jsonrpc_request* request);
+    void tx_cascade_stats(struct jsonrpc_request* request);
+    void rx_cascade_config(struct jsonrpc_request* request);
+    void tx_inference_profile(struct jsonrpc_request* request);
+    void tx_trace_info(struct jsonrpc_request* request);
+    void tx_trace_dump(struct jsonrpc_request* request);
+    void tx_log_stats(struct jsonrpc_request* request);
+    void tx_channel_stats(struct jsonrpc_request* request);
+    void tx_boot_report(struct jsonrpc_request* request);
+    void tx_tof_bus_stats(struct jsonrpc_request* request);
+    void tx_tof_sensor_stats(struct jsonrpc_request* request);
+    void tx_recording(struct jsonrpc_request* request);
+    void tx_approach_stats(struct jsonrpc_request* request);
+    void rx_approach_config(struct jsonrpc_request* request);
+    void tx_danger_zones(struct jsonrpc_request* request);
+    void rx_danger_zones(struct jsonrpc_request* request);
 
     // Task
     void rpc_task(void* parameters);
@@ -2,26 +2,57 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "third_party/freertos_kernel/include/FreeRTOS.h"
 #include "third_party/freertos_kernel/include/task.h"
 
 
 #include "m7/m7_queues.hh"
+#include "m7/deferred_log.hh"
+#include "m7/metrics.hh"
 #include "global_config.hh"
 #include "system_enums.hh"
 #include "depth_estimation.hh"
+#include "m7/cyclic_executive.hh"
+#include "m7/boot.hh"
+#include "state_machine.hh"
+#include "m7/tof_intrusion.hh"
+#include "m7/state_logic.hh"
+#include "m7/recorder.hh"
 
 namespace coralmicro {
 
     void state_controller_task(void* parameters);
 
-    // Timeout limit in ticks - 3 seconds (assuming 1ms tick rate)
-    constexpr TickType_t kValidConnectionLimitTicks = pdMS_TO_TICKS(3000); 
+    // Approach prediction tuning, writable over RPC; taken up at the next wake-up
+    struct ApproachSettings {
+        std::atomic<bool> enabled{ApproachConfig::kDefaultEnabled};
+        std::atomic<uint32_t> stop_budget_ms{ApproachConfig::kDefaultStopBudgetMs};
+        std::atomic<float> min_speed_mm_s{ApproachConfig::kDefaultMinSpeedMmS};
+    };
+
+    inline ApproachSettings g_approach_settings;
+
+    struct ApproachStats {
+        std::atomic<uint32_t> predicted_stops{0};      // Dangers called by the prediction before the distance was reached
+        std::atomic<uint32_t> tracks{0};               // Persons followed at the last depth update
+        std::atomic<bool> approaching{false};          // Someone closing in at the last depth update
+        std::atomic<uint32_t> time_to_threshold_ms{0}; // Of the soonest one
+        std::atomic<float> speed_mm_s{0.0f};
+    };
 
-    // Add detection memory timeouts
-    constexpr TickType_t kDetectionMemoryTimeoutMs = 1000;  // 1 second memory for detections
-    constexpr TickType_t kTofMemoryTimeoutMs = 1000;        // 1 second memory for TOF data
-    constexpr TickType_t kHostConnectionTimeoutMs = 3000; // 3 seconds memory for host connection
+    inline ApproachStats g_approach_stats;
 
-    constexpr float danger_depth_mm = 600.0f; // Danger distance in mm
+    // The danger zones the state controller runs with; rx_danger_zones uploads new ones
+    struct DangerZoneStats {
+        std::atomic<uint32_t> updates{0};                                          // Zone sets taken up, the boot default included
+        std::atomic<uint32_t> cells[DangerZoneConfig::kMaxZones][kTofSensorCount]; // ToF cells each zone covers, bit n for cell n
+        std::atomic<uint32_t> stops[DangerZoneConfig::kMaxZones];                  // Persons coming within the zone's stop distance
+    };
+
+    inline DangerZoneStats g_danger_zone_stats;
+
+    // Timeout limit in ticks - 3 seconds (assuming 1ms tick rate)
+    constexpr TickType_t kValidConnectionLimitTicks = pdMS_TO_TICKS(3000);
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+// state_logic.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "libs/tensorflow/detection.h"
+
+#include "system_enums.hh"
+#include "state_machine.hh"
+#include "m7/tof_data.hh"
+#include "m7/tof_intrusion.hh"
+#include "m7/approach_predictor.hh"
+#include "m7/danger_zones.hh"
+
+namespace coralmicro {
+
+    // Input memory: how long each input keeps counting after it last arrived
+    constexpr uint32_t kDetectionMemoryTimeoutMs = 1000;  // 1 second memory for detections
+    constexpr uint32_t kTofMemoryTimeoutMs = 1000;        // 1 second memory for TOF data
+    constexpr uint32_t kHostConnectionTimeoutMs = 3000;   // 3 seconds memory for host connection
+
+    struct StateLogicConfig {
+        static constexpr size_t kMaxDetections = 10; // Detections kept per result (more are dropped)
+    };
+
+    // The state controller's decision logic with time passed in: input memory, ToF intrusion,
+    // depth fusion, the danger zones and the decision table. No RTOS calls, so a recording replayed through it
+    // on the host (host/replay.cc) takes the same decisions the device did.
+    //
+    // Feed whatever arrived with the on_* calls, then step() once to decide. Times are
+    // timebase_ms on the device and recording time on the host.
+    class StateLogic {
+    public:
+        void on_host_heartbeat(uint32_t now_ms);
+        void on_host_state(HostState state);
+
+        // Latest detector result; capture_us is when its camera frame was taken
+        void on_detection(const tensorflow::Object* objects, size_t count, uint64_t capture_us, uint32_t now_ms);
+
+        // Latest ToF frames; zone_count is the sensors' resolution (16 or 64)
+        void on_tof(const TofData& tof_data, uint8_t zone_count, uint32_t now_ms);
+
+        // Danger zones the limits come from, kept until changed (default_danger_zones() at first).
+        // set must have passed danger_zones_error().
+        void set_danger_zones(const DangerZoneSet& set);
+        const DangerZoneSet& danger_zones() const { return zone_map_.zones(); }
+        const DangerZoneMap& zone_map() const { return zone_map_; }
+
+        // Tuning of the approach prediction, kept until changed
+        void set_approach_params(const ApproachParams& params) { approach_params_ = params; }
+        const ApproachParams& approach_params() const { return approach_params_; }
+
+        // One decision over everything fed since the last step
+        SystemState step(uint32_t now_ms);
+
+        // Earliest time an input memory runs out (the next step that can change the state
+        // without new input). False when nothing is held.
+        bool next_deadline_ms(uint32_t now_ms, uint32_t* deadline_ms) const;
+
+        // Results of the last step
+        const DecisionInputs& inputs() const { return inputs_; }
+        HostState host_state() const { return host_state_; }
+        bool depth_updated() const { return depth_updated_; }
+        bool tof_intrusion_active() const { return tof_intrusion_active_; }
+        bool new_detection() const { return stepped_detection_; }
+        bool new_tof() const { return stepped_tof_; }
+        bool person_present() const { return person_present_; } // Fresh detection, inside a zone or not
+        int8_t danger_zone() const { return danger_zone_; }     // Zone whose stop distance a person is within, -1 if none
+
+        const tensorflow::Object* detections() const { return detections_; }
+        uint8_t detection_count() const { return detection_count_; }
+        const float* depths() const { return depths_; } // One per detection, negative = unknown
+        const TofData& tof_data() const { return tof_data_; }
+
+        // Soonest predicted crossing of a stop distance, and whether it alone called the danger
+        const ApproachPrediction& approach() const { return approach_; }
+        bool approach_stop() const { return approach_stop_; }
+        size_t approach_tracks() const { return approach_predictor_.track_count(); }
+
+    private:
+        // A memory is live until now_ms reaches its deadline (wrap-safe)
+        static bool live(bool valid, uint32_t deadline_ms, uint32_t now_ms) {
+            return valid && static_cast<int32_t>(deadline_ms - now_ms) > 0;
+        }
+
+        void update_intrusion(bool person_fresh);
+        void update_zone_limits();
+
+        HostState host_state_ = HostState::UNDEFINED;
+        bool host_seen_ = false;
+        uint32_t host_deadline_ms_ = 0;
+
+        tensorflow::Object detections_[StateLogicConfig::kMaxDetections] = {};
+        uint8_t detection_count_ = 0;
+        ZoneLimits detection_limits_[StateLogicConfig::kMaxDetections] = {}; // Zone lookup of each box
+        uint64_t detection_capture_us_ = 0;
+        bool detection_seen_ = false;
+        uint32_t detection_deadline_ms_ = 0;
+
+        TofData tof_data_ = {};
+        uint8_t tof_zone_count_ = 0;
+        bool tof_seen_ = false;
+        uint32_t tof_deadline_ms_ = 0;
+
+        bool new_detection_ = false; // Arrived since the last step
+        bool new_tof_ = false;
+        bool stepped_detection_ = false; // What the last step consumed
+        bool stepped_tof_ = false;
+
+        TofIntrusionDetector tof_intrusion_[kTofSensorCount]; // One background model per sensor
+        uint64_t tof_intrusion_frame_us_[kTofSensorCount] = {}; // Last frame each detector has seen
+        bool tof_intrusion_active_ = false;
+
+        DangerZoneMap zone_map_;
+
+        float depths_[StateLogicConfig::kMaxDetections] = {};
+        bool person_present_ = false;
+        bool person_warning_ = false;
+        bool person_in_danger_ = false;
+        int8_t danger_zone_ = -1;
+        bool depth_updated_ = false;
+
+        ApproachPredictor approach_predictor_;
+        ApproachParams approach_params_;
+        ApproachPrediction approach_ = {false, UINT32_MAX, 0.0f, -1.0f};
+        bool approach_stop_ = false;
+
+        DecisionInputs inputs_ = {};
+    };
+}
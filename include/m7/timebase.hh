@@ -0,0 +1,50 @@
+// timebase.hh
+#pragma once
+
+#include <cstdint>
+
+#include "m7/cycle_counter.hh"
+
+namespace coralmicro {
+
+    struct TimebaseConfig {
+        static constexpr uint32_t kWrapGuardMs = 1000; // Guard sample period, well under the counter wrap (~5.4 s at 800 MHz)
+    };
+
+    // Extends a wrapping 32-bit counter to 64 bits. Must see at least one sample per wrap,
+    // which the wrap guard timer guarantees even when nothing else reads the clock.
+    class CounterExtender {
+    public:
+        uint64_t extend(uint32_t now) {
+            if (now < last_) {
+                high_ += (1ull << 32);
+            }
+            last_ = now;
+            return high_ | now;
+        }
+
+    private:
+        uint64_t high_ = 0;
+        uint32_t last_ = 0;
+    };
+
+    // Reads the core clock the cycle counter runs at, starts the counter and the wrap guard
+    // timer. Call once before any task stamps data. Fails when the clock is too fast for the
+    // guard to see every wrap.
+    bool timebase_init();
+
+    // Cycle counter rate from the clock tree, and the whole cycles per microsecond the timebase
+    // divides by (the rate rounded to MHz). 0 before timebase_init().
+    uint32_t timebase_cycle_hz();
+    uint32_t timebase_cycles_per_us();
+
+    // Monotonic microseconds since boot, from the DWT cycle counter. Callable from tasks and from
+    // ISRs at or below configMAX_SYSCALL_INTERRUPT_PRIORITY. Host builds use std::chrono::steady_clock.
+    uint64_t timebase_us();
+
+    // Millisecond view for the ms-granularity policies (governor, cascade, intrusion latch).
+    // Wraps after ~49 days; those only ever compare differences.
+    inline uint32_t timebase_ms() {
+        return static_cast<uint32_t>(timebase_us() / 1000u);
+    }
+}
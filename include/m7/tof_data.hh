@@ -0,0 +1,28 @@
+// tof_data.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include "vl53l8cx_api.h"
+}
+
+#include "m7/tof_sensors.hh"
+
+namespace coralmicro {
+
+    // Latest frame of every sensor (kTofSensors order), republished whenever any of them reads one
+    struct TofData {
+        uint64_t timestamp_us; // Newest ranging frame read time (timebase_us)
+
+        uint64_t frame_us[kTofSensorCount]; // Read time of each sensor's frame, 0 = none yet
+        VL53L8CX_ResultsData results[kTofSensorCount];
+
+        // Has a frame recent enough to be fused with the newest one
+        bool frame_fresh(size_t sensor) const {
+            return frame_us[sensor] != 0 &&
+                   timestamp_us - frame_us[sensor] <= TofSensorsConfig::kFrameStaleMs * 1000ull;
+        }
+    };
+}
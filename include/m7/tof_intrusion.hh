@@ -0,0 +1,76 @@
+// tof_intrusion.hh
+#pragma once
+
+#include <cstdint>
+
+namespace coralmicro {
+
+    struct TofIntrusionConfig {
+        static constexpr bool kEnabled = true;
+
+        static constexpr uint8_t kMaxZones = 64;                // 8x8
+        static constexpr float kMarginMm = 150.0f;              // Must be this much closer than background
+        static constexpr float kNoTargetBackgroundMm = 4000.0f; // Background of zones that never saw a target
+        static constexpr uint16_t kLearnFrames = 60;            // Idle frames to seed the background (~1 s at 60 Hz)
+        static constexpr float kLearnRate = 0.02f;              // Background EMA rate while idle
+        static constexpr uint8_t kConfirmFrames = 2;            // Consecutive hits before a zone is flagged
+        static constexpr uint8_t kReleaseFrames = 6;            // Consecutive clean frames before the latch drops
+        static constexpr uint8_t kClearVerdicts = 3;            // Consecutive "no person" camera results before a clear
+    };
+
+    // VL53L8CX target status 5 and 9 are the fully valid range measurements
+    constexpr bool tof_target_status_valid(uint8_t status) {
+        return status == 5 || status == 9;
+    }
+
+    // Fastest ranging the sensor allows at a resolution (zone count): 60 Hz at 4x4, 15 Hz at 8x8
+    constexpr uint8_t tof_max_ranging_frequency(uint8_t zone_count) {
+        return zone_count == 64 ? 15 : 60;
+    }
+
+    // 4x4 cell (tof_rgb_mapping.hh order) a zone of a 16- or 64-zone frame lies in
+    constexpr uint8_t tof_zone_cell(uint8_t zone, uint8_t zone_count) {
+        return static_cast<uint8_t>(zone_count == 64 ? (zone / 16) * 4 + (zone % 8) / 2 : zone % 16);
+    }
+
+    // Per-zone background model learned while the cell is idle. Flags any zone whose
+    // range drops well below background and inside the danger distance of its cell, and latches an
+    // intrusion until the ToF clears or a later camera verdict says there's nobody there.
+    class TofIntrusionDetector {
+    public:
+        void reset();
+
+        // Feed one ToF frame. cell_danger_mm is the danger distance of each 4x4 cell (0 never flags it).
+        // learning_allowed should be false while a person is known to be present.
+        // Returns true while an intrusion is latched.
+        bool on_tof_frame(const int16_t* distance_mm, const uint8_t* target_status, uint8_t zone_count,
+                          const float* cell_danger_mm, bool learning_allowed, uint32_t now_ms);
+
+        // A detection result from a frame captured after the intrusion began confirms or clears it.
+        // kClearVerdicts "no person" results in a row clear it, so one missed detection can't; the
+        // clear absorbs the flagged zones' current ranges into the background (e.g. a parked cart).
+        void on_camera_verdict(bool person_detected, uint32_t capture_ms,
+                               const int16_t* distance_mm, const uint8_t* target_status);
+
+        bool active() const { return active_; }
+        bool confirmed() const { return confirmed_; }
+        bool ready() const { return learned_frames_ >= TofIntrusionConfig::kLearnFrames; }
+        uint64_t flagged_zones() const { return flagged_; }
+        uint32_t onset_ms() const { return onset_ms_; }
+
+    private:
+        float background_mm_[TofIntrusionConfig::kMaxZones] = {};
+        uint16_t seed_count_[TofIntrusionConfig::kMaxZones] = {};
+        uint8_t hits_[TofIntrusionConfig::kMaxZones] = {};
+
+        uint16_t learned_frames_ = 0;
+        uint64_t flagged_ = 0;
+        uint8_t clean_frames_ = 0;
+        uint8_t clear_verdicts_ = 0;
+        uint8_t zone_count_ = 0;
+
+        bool active_ = false;
+        bool confirmed_ = false;
+        uint32_t onset_ms_ = 0;
+    };
+}
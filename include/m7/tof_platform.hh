@@ -0,0 +1,55 @@
+// tof_platform.hh
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "libs/base/gpio.h"
+#include "libs/base/i2c.h"
+
+extern "C" {
+#include "vl53l8cx_api.h"
+}
+
+namespace coralmicro {
+
+    struct TofPlatformConfig {
+        static constexpr uint32_t kBaudHz = 1000000;        // Fast-mode Plus; the bus pull-ups must be sized for it
+        static constexpr size_t kDmaMinBytes = 32;          // Shorter transfers poll: cheaper than DMA setup and two context switches
+        static constexpr size_t kBounceBytes = 2048;        // Non-cacheable DMA buffer per bus; longer writes are split
+        static constexpr size_t kReadChunkBytes = 256;      // Longest read one LPI2C receive command can take
+        static constexpr uint32_t kTransferTimeoutMs = 100;
+    };
+
+    // Buses a sensor can sit on, indexes the per-bus state and stats
+    enum class TofBus : uint8_t {
+        kI2c1,
+        kI2c6,
+        kCount,
+    };
+
+    constexpr size_t kTofBusCount = static_cast<size_t>(TofBus::kCount);
+    constexpr const char* kTofBusNames[kTofBusCount] = {"i2c1", "i2c6"};
+
+    constexpr TofBus tof_bus(I2c bus) {
+        return bus == I2c::kI2c6 ? TofBus::kI2c6 : TofBus::kI2c1;
+    }
+
+    struct TofBusStats {
+        std::atomic<uint32_t> transfers{0};
+        std::atomic<uint32_t> dma_transfers{0};  // Transfers of kDmaMinBytes or more, CPU free while they run
+        std::atomic<uint32_t> bytes_read{0};
+        std::atomic<uint32_t> bytes_written{0};
+        std::atomic<uint32_t> errors{0};         // NACKs, arbitration loss, timeouts
+        std::atomic<uint32_t> timeouts{0};
+        std::atomic<uint32_t> busy_us{0};        // Time spent in transfers, wraps after ~71 minutes
+        std::atomic<uint32_t> transfer_us_last{0};
+        std::atomic<uint32_t> transfer_us_max{0};
+    };
+
+    inline TofBusStats g_tof_bus_stats[kTofBusCount];
+
+    // Brings up the bus (once per bus) and fills in the ULD platform for one sensor at a 7-bit address
+    bool tof_platform_init(VL53L8CX_Platform* platform, I2c bus, uint16_t address, Gpio lpn_pin);
+}
@@ -0,0 +1,50 @@
+// tof_sensors.hh
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "libs/base/gpio.h"
+#include "libs/base/i2c.h"
+
+#include "tof_rgb_mapping.hh"
+
+namespace coralmicro {
+
+    struct TofSensorsConfig {
+        static constexpr uint16_t kDefaultAddress = 0x29;      // 7-bit address every sensor answers on out of reset
+        static constexpr uint32_t kFrameStaleMs = 250;         // Older frames are left out of depth fusion
+        static constexpr uint32_t kUtilizationWindowMs = 1000; // Window for the per-sensor bus utilization
+    };
+
+    // One VL53L8CX. Sensors come out of reset on kDefaultAddress; at boot they are released
+    // one at a time through LPn and moved to their own address before the next one wakes up.
+    struct TofSensorConfig {
+        const char* name;
+        I2c bus;
+        Gpio lpn_pin;
+        uint16_t address;                  // 7-bit; must be unique on the bus, kDefaultAddress skips the move
+        const TofCellRegion* cell_regions; // Zone to image mapping (4x4, row-major as the ULD reports them)
+        const float* cell_weights;         // Per-zone fusion weight (1/RMSE)
+    };
+
+    // Boot order is table order. To add a sensor, give it its own LPn pin and address, and
+    // generate its mapping like tof_rgb_mapping.hh; sensors on separate buses are read back to back.
+    inline constexpr TofSensorConfig kTofSensors[] = {
+        {"tof0", I2c::kI2c1, Gpio::kPwm0, TofSensorsConfig::kDefaultAddress, kTofCellRegions.data(), kTofCellWeights},
+    };
+
+    constexpr size_t kTofSensorCount = sizeof(kTofSensors) / sizeof(kTofSensors[0]);
+
+    struct TofSensorStats {
+        std::atomic<uint32_t> frames{0};
+        std::atomic<uint32_t> errors{0};
+        std::atomic<uint32_t> read_us_last{0};        // Data-ready poll plus frame read
+        std::atomic<uint32_t> read_us_max{0};
+        std::atomic<uint32_t> frame_interval_us{0};   // Between the last two frames
+        std::atomic<uint32_t> busy_permille{0};       // Share of the last window spent on this sensor's bus traffic
+    };
+
+    inline TofSensorStats g_tof_sensor_stats[kTofSensorCount];
+}
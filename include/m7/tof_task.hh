@@ -11,39 +11,50 @@
 extern "C" {
 #include "vl53l8cx_api.h"
 }
-#include "platform.hpp"
+#include "m7/tof_platform.hh"
+#include "m7/tof_sensors.hh"
 
 // C++ standard library
 #include <stdio.h>
 #include <memory>
 
 #include "m7/m7_queues.hh"
+#include "m7/deferred_log.hh"
+#include "m7/metrics.hh"
+#include "m7/cyclic_executive.hh"
+#include "m7/boot.hh"
 
 #include "global_config.hh"
+#include "m7/tof_intrusion.hh"
 
 namespace coralmicro {
 
-    inline std::unique_ptr<VL53L8CX_Configuration> g_tof_device;
-    inline std::unique_ptr<VL53L8CX_ResultsData> g_tof_results;
+    inline std::unique_ptr<VL53L8CX_Configuration> g_tof_devices[kTofSensorCount]; // kTofSensors order
+    inline std::unique_ptr<TofData> g_tof_results;
 
     // Task
     void tof_task(void* parameters);
 
-    // Initialization
-    bool init_sensor(VL53L8CX_Configuration* dev);
+    // Initialization, in boot order
     bool init_gpio();
+    bool wait_sensor_alive(VL53L8CX_Configuration* dev);
+    bool assign_sensor_address(VL53L8CX_Configuration* dev, uint16_t address);
+    bool load_sensor_firmware(VL53L8CX_Configuration* dev);
+    bool configure_sensor(VL53L8CX_Configuration* dev);
 
     // Helper functions
     const char* get_error_string(uint8_t status);
+    TofErrorLabel get_error_label(uint8_t status); // metrics label of the same status
     void print_sensor_error(const char* operation, uint8_t status);
     void print_results(VL53L8CX_ResultsData* results);
 
 
-    // Constants
-    static constexpr Gpio kLpnPin = Gpio::kPwm0;
-    static constexpr I2c kI2c = I2c::kI2c1;
-    
-    static constexpr uint16_t kAddress = 0x29; // 0x58 >> 1
-    static constexpr uint8_t kRangingFrequency = 15; // Hz
+    // Constants (sensor buses, pins and addresses are in kTofSensors)
+    static constexpr uint32_t kLpnResetMs = 2;
+    static constexpr uint32_t kSensorBootTimeoutMs = 500; // LPn release to I2C answering
+    // Hz at a resolution (zone count); the intrusion fast path runs at the sensor max for it
+    constexpr uint8_t ranging_frequency(uint8_t resolution) {
+        return TofIntrusionConfig::kEnabled ? tof_max_ranging_frequency(resolution) : 15;
+    }
     static constexpr uint8_t kSharpnerValue = 25; // %
 }
@@ -0,0 +1,50 @@
+// trace_hooks.hh
+// FreeRTOS trace macros feeding the zone profiler's kernel ring (zone_profiler.hh).
+// Plain C so the kernel sources can see it: include it at the end of the SDK's
+// FreeRTOSConfig.h (see README). Without that include the hooks are simply never called, and
+// kernel tracing is off by default. Define TRACE_HOOKS_DECLARATIONS_ONLY for just the hooks.
+#pragma once
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Event codes match coralmicro::TraceEvent
+#define TRACE_HOOK_QUEUE_SEND            3
+#define TRACE_HOOK_QUEUE_RECEIVE         4
+#define TRACE_HOOK_QUEUE_PEEK            5
+#define TRACE_HOOK_QUEUE_SEND_FAILED     6
+#define TRACE_HOOK_QUEUE_RECEIVE_FAILED  7
+#define TRACE_HOOK_QUEUE_BLOCK_RECEIVE   8
+
+void trace_hook_task_switched_in(void* tcb);
+void trace_hook_task_deleted(void* tcb);
+void trace_hook_queue(uint8_t event, void* queue, int from_isr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifndef TRACE_HOOKS_DECLARATIONS_ONLY
+
+#define TRACE_HOOKS_INSTALLED 1
+
+#define traceTASK_SWITCHED_IN()                 trace_hook_task_switched_in((void*)pxCurrentTCB)
+#define traceTASK_DELETE(pxTCB)                 trace_hook_task_deleted((void*)(pxTCB))
+
+#define traceQUEUE_SEND(pxQueue)                trace_hook_queue(TRACE_HOOK_QUEUE_SEND, (void*)(pxQueue), 0)
+#define traceQUEUE_SEND_FAILED(pxQueue)         trace_hook_queue(TRACE_HOOK_QUEUE_SEND_FAILED, (void*)(pxQueue), 0)
+#define traceQUEUE_RECEIVE(pxQueue)             trace_hook_queue(TRACE_HOOK_QUEUE_RECEIVE, (void*)(pxQueue), 0)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)      trace_hook_queue(TRACE_HOOK_QUEUE_RECEIVE_FAILED, (void*)(pxQueue), 0)
+#define traceQUEUE_PEEK(pxQueue)                trace_hook_queue(TRACE_HOOK_QUEUE_PEEK, (void*)(pxQueue), 0)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) trace_hook_queue(TRACE_HOOK_QUEUE_BLOCK_RECEIVE, (void*)(pxQueue), 0)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)       trace_hook_queue(TRACE_HOOK_QUEUE_SEND, (void*)(pxQueue), 1)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)    trace_hook_queue(TRACE_HOOK_QUEUE_RECEIVE, (void*)(pxQueue), 1)
+
+#endif // TRACE_HOOKS_DECLARATIONS_ONLY
+
+#endif // __ASSEMBLER__
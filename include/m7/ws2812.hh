@@ -0,0 +1,60 @@
+// ws2812.hh
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace coralmicro {
+
+    // WS2812B datasheet timing, every edge +-150 ns
+    struct Ws2812Timing {
+        static constexpr uint32_t kT0HighNs = 400;
+        static constexpr uint32_t kT0LowNs = 850;
+        static constexpr uint32_t kT1HighNs = 800;
+        static constexpr uint32_t kT1LowNs = 450;
+        static constexpr uint32_t kToleranceNs = 150;
+        static constexpr uint32_t kResetUs = 280;   // Low time that latches a frame (older parts: 50 us)
+    };
+
+    struct Ws2812Config {
+        static constexpr uint32_t kSlotHz = 2400000;  // Each 1.25 us bit is three slots: high, data, low
+        static constexpr uint32_t kSlotsPerBit = 3;
+        static constexpr size_t kBitsPerLed = 24;
+        static constexpr size_t kMaxLeds = 8;
+        static constexpr size_t kMaxSlots = kMaxLeds * kBitsPerLed * kSlotsPerBit;
+    };
+
+    constexpr uint32_t kWs2812SlotNs = 1000000000u / Ws2812Config::kSlotHz;
+
+    constexpr bool ws2812_in_spec(uint32_t slots, uint32_t nominal_ns) {
+        return slots * kWs2812SlotNs + Ws2812Timing::kToleranceNs >= nominal_ns &&
+               slots * kWs2812SlotNs <= nominal_ns + Ws2812Timing::kToleranceNs;
+    }
+
+    // A 0 is one slot high and two low, a 1 is two slots high and one low
+    static_assert(ws2812_in_spec(1, Ws2812Timing::kT0HighNs), "T0H out of spec");
+    static_assert(ws2812_in_spec(2, Ws2812Timing::kT0LowNs), "T0L out of spec");
+    static_assert(ws2812_in_spec(2, Ws2812Timing::kT1HighNs), "T1H out of spec");
+    static_assert(ws2812_in_spec(1, Ws2812Timing::kT1LowNs), "T1L out of spec");
+
+    struct LedColor {
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+    };
+
+    // Encodes a frame as one GPIO toggle word per slot: pin_mask where the line changes level
+    // at the start of the slot, 0 where it holds. The line starts and ends low. Colours go out
+    // GRB, MSB first. Returns the slots written, or 0 if they don't fit in capacity.
+    // Pure, so it builds and runs on the host as well.
+    size_t ws2812_encode(const LedColor* colors, size_t count, uint32_t pin_mask,
+                         uint32_t* slots, size_t capacity);
+
+    // LED chain on GPIO2_IO31, clocked out by eDMA writing the encoded slots to the GPIO
+    // toggle register on every PIT tick. Interrupts stay enabled and the CPU is free meanwhile.
+    bool ws2812_init();
+
+    // Encodes the frame and starts streaming it, returning at once. False while the previous
+    // frame or its reset gap is still running (try again later), or if the frame is too long.
+    bool ws2812_show(const LedColor* colors, size_t count);
+}
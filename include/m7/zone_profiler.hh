@@ -0,0 +1,115 @@
+// zone_profiler.hh
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace coralmicro {
+
+    struct ZoneProfilerConfig {
+        static constexpr bool kEnabled = true;              // false compiles PROFILE_ZONE out entirely
+        static constexpr size_t kMaxTasks = 12;             // Task rings; registering tasks past this are counted as dropped
+        static constexpr size_t kTaskRingSize = 256;        // Zone records per task (power of two)
+        static constexpr size_t kKernelRingSize = 1024;     // Context switch + queue records (power of two)
+        static constexpr size_t kMaxObjects = 16;           // Named queues
+        static constexpr bool kTraceUnregisteredQueues = false; // SDK mutexes/semaphores are queues too and would flood the kernel ring
+        static constexpr size_t kTaskNameLength = 16;
+    };
+
+    static_assert((ZoneProfilerConfig::kTaskRingSize & (ZoneProfilerConfig::kTaskRingSize - 1)) == 0,
+                  "Task ring size must be a power of two");
+    static_assert((ZoneProfilerConfig::kKernelRingSize & (ZoneProfilerConfig::kKernelRingSize - 1)) == 0,
+                  "Kernel ring size must be a power of two");
+
+    enum class TraceEvent : uint8_t {
+        kZoneBegin = 0,       // ref = zone name
+        kZoneEnd,             // ref = zone name
+        kTaskSwitchedIn,      // ref = ring index of the task now running
+        kQueueSend,           // ref = queue handle, slot = sending task (kIsrSlot from an ISR)
+        kQueueReceive,
+        kQueuePeek,
+        kQueueSendFailed,
+        kQueueReceiveFailed,
+        kQueueBlockReceive,   // Task about to block on an empty queue
+    };
+
+    constexpr uint8_t kIsrSlot = 0xFF;
+
+    // One ring entry. Cycles are the raw 32-bit DWT count; the host unwraps them
+    // against the anchor returned with each dump.
+    struct TraceRecord {
+        uint32_t cycles;
+        TraceEvent type;
+        uint8_t slot;
+        uint16_t reserved;
+        const void* ref;
+    };
+
+    // Kernel ring index, after the task rings
+    constexpr size_t kTraceKernelRing = ZoneProfilerConfig::kMaxTasks;
+    constexpr size_t kTraceRingCount = ZoneProfilerConfig::kMaxTasks + 1;
+
+    struct TraceStats {
+        std::atomic<uint32_t> dropped_tasks{0};   // Registering or zone-opening tasks that found no free ring
+        std::atomic<uint32_t> dropped_objects{0}; // trace_register_object calls past kMaxObjects
+    };
+
+    inline TraceStats g_trace_stats;
+
+    // Zone begin/end from task context. Each task writes only its own ring, so the
+    // hot path is a handle lookup, one cycle counter read and a release store.
+    // Not for ISRs: they'd interleave with the interrupted task's ring.
+    void trace_zone_begin(const char* name);
+    void trace_zone_end(const char* name);
+
+    // Gives the calling task a ring so the kernel ring records its context switches from the start.
+    // The hooks never claim rings themselves: a task that neither registers nor opens a zone has
+    // none, and its switches aren't recorded. A deleted task's ring is reused once none is free.
+    void trace_register_task();
+
+    // Whether FreeRTOSConfig.h includes trace_hooks.hh (README). Off by default: the kernel ring
+    // then stays empty and only zones are recorded.
+    bool trace_kernel_hooks_installed();
+
+    // Names a queue for the kernel ring (and, unless kTraceUnregisteredQueues, opts it in)
+    void trace_register_object(const void* handle, const char* name);
+
+    // Copies up to capacity records of a ring, oldest first, dropping any the writer
+    // lapped during the copy. Lock-free against writers. written = records ever written.
+    size_t trace_snapshot(size_t ring, TraceRecord* out, size_t capacity, uint32_t* written);
+
+    // Task name of a ring ("" if unused, "kernel" for the kernel ring)
+    const char* trace_ring_name(size_t ring);
+
+    size_t trace_object_count();
+    bool trace_object(size_t index, const void** handle, const char** name);
+
+    // RAII zone; use through PROFILE_ZONE so the variable name is unique per line
+    class ProfileZone {
+    public:
+        explicit ProfileZone(const char* name) : name_(name) {
+            if constexpr (ZoneProfilerConfig::kEnabled) {
+                trace_zone_begin(name_);
+            }
+        }
+
+        ~ProfileZone() {
+            if constexpr (ZoneProfilerConfig::kEnabled) {
+                trace_zone_end(name_);
+            }
+        }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+
+    private:
+        const char* name_;
+    };
+}
+
+#define PROFILE_ZONE_CONCAT_INNER(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing scope. name must be a string literal (the pointer is stored)
+#define PROFILE_ZONE(name) ::coralmicro::ProfileZone PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)(name)
@@ -0,0 +1,214 @@
+// state_machine.hh
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "system_enums.hh"
+
+namespace coralmicro {
+
+    // Andon color class of a host (PackML) state
+    enum class HostColor : uint8_t {
+        NONE, // Not part of any color class (e.g. UNSUSPENDING), keeps HOST_READING
+        RED,
+        YELLOW,
+        BLUE,
+        GREEN,
+    };
+
+    // State driven while a ToF-only intrusion is latched (tof_intrusion.hh)
+    constexpr SystemState kTofIntrusionAction = SystemState::STOPPED;
+
+    constexpr size_t kHostStateCount = static_cast<size_t>(HostState::COMPLETE) + 1;
+
+    // HostState -> HostColor, built once from the color state sets
+    constexpr std::array<HostColor, kHostStateCount> kHostStateColors = [] {
+        std::array<HostColor, kHostStateCount> colors{};
+        for (size_t i = 0; i < kHostStateCount; i++) {
+            HostState state = static_cast<HostState>(i);
+            if (RedStates::Contains(state)) colors[i] = HostColor::RED;
+            else if (YellowStates::Contains(state)) colors[i] = HostColor::YELLOW;
+            else if (BlueStates::Contains(state)) colors[i] = HostColor::BLUE;
+            else if (GreenStates::Contains(state)) colors[i] = HostColor::GREEN;
+            else colors[i] = HostColor::NONE;
+        }
+        return colors;
+    }();
+
+    // Out of range values (e.g. from a bad RPC) classify as NONE
+    constexpr HostColor host_color(HostState state) {
+        size_t idx = static_cast<size_t>(state);
+        return idx < kHostStateCount ? kHostStateColors[idx] : HostColor::NONE;
+    }
+
+    // Inputs to one decision step, packed into a table index:
+    //   bit 0     host connected
+    //   bits 1-3  host color
+    //   bit 4     a fresh person detection (within detection memory) inside a danger zone's warning distance
+    //   bit 5     TOF data is fresh (within TOF memory)
+    //   bit 6     a detected person is within the stop distance of their danger zone
+    //   bit 7     ToF-only intrusion latched (camera hasn't cleared it yet)
+    struct DecisionInputs {
+        bool host_connected;
+        HostColor host_color;
+        bool person_warning;
+        bool tof_fresh;
+        bool in_danger;
+        bool tof_intrusion;
+    };
+
+    constexpr uint8_t kGuardHostConnected = (1u << 0);
+    constexpr uint8_t kGuardHostColorShift = 1;
+    constexpr uint8_t kGuardHostColorMask = (0x7u << kGuardHostColorShift);
+    constexpr uint8_t kGuardPersonWarning = (1u << 4);
+    constexpr uint8_t kGuardTofFresh = (1u << 5);
+    constexpr uint8_t kGuardInDanger = (1u << 6);
+    constexpr uint8_t kGuardTofIntrusion = (1u << 7);
+
+    constexpr size_t kDecisionInputCount = 256;
+
+    constexpr uint8_t color_guard(HostColor color) {
+        return static_cast<uint8_t>(static_cast<uint8_t>(color) << kGuardHostColorShift);
+    }
+
+    constexpr uint8_t encode_inputs(const DecisionInputs& in) {
+        return (in.host_connected ? kGuardHostConnected : 0) |
+               color_guard(in.host_color) |
+               (in.person_warning ? kGuardPersonWarning : 0) |
+               (in.tof_fresh ? kGuardTofFresh : 0) |
+               (in.in_danger ? kGuardInDanger : 0) |
+               (in.tof_intrusion ? kGuardTofIntrusion : 0);
+    }
+
+    // A transition fires when (inputs & mask) == value; first match wins
+    struct Transition {
+        uint8_t mask;
+        uint8_t value;
+        SystemState next;
+    };
+
+    constexpr std::array<Transition, 9> kTransitions = {{
+        // HOST DRIVEN LOGIC: the host color decides, detections are only logged
+        {kGuardHostConnected | kGuardHostColorMask, kGuardHostConnected | color_guard(HostColor::RED),    SystemState::STOPPED},
+        {kGuardHostConnected | kGuardHostColorMask, kGuardHostConnected | color_guard(HostColor::YELLOW), SystemState::WARNING},
+        {kGuardHostConnected | kGuardHostColorMask, kGuardHostConnected | color_guard(HostColor::BLUE),   SystemState::IDLE},
+        {kGuardHostConnected | kGuardHostColorMask, kGuardHostConnected | color_guard(HostColor::GREEN),  SystemState::ACTIVE},
+        {kGuardHostConnected,                       kGuardHostConnected,                                   SystemState::HOST_READING},
+
+        // INDEPENDENT LOGIC: person + TOF + danger zone limits decide, a ToF intrusion acts before the camera confirms
+        {kGuardPersonWarning | kGuardTofFresh | kGuardInDanger, kGuardPersonWarning | kGuardTofFresh | kGuardInDanger, SystemState::STOPPED},
+        {kGuardTofIntrusion,                                    kGuardTofIntrusion,                                    kTofIntrusionAction},
+        {kGuardPersonWarning,                                   kGuardPersonWarning,                                   SystemState::WARNING},
+        {0,                                                     0,                                                     SystemState::IDLE},
+    }};
+
+    constexpr std::array<SystemState, kDecisionInputCount> kDecisionTable = [] {
+        std::array<SystemState, kDecisionInputCount> table{};
+        for (size_t idx = 0; idx < kDecisionInputCount; idx++) {
+            table[idx] = SystemState::UNINITIALIZED;
+            for (const auto& t : kTransitions) {
+                if ((idx & t.mask) == t.value) {
+                    table[idx] = t.next;
+                    break;
+                }
+            }
+        }
+        return table;
+    }();
+
+    // One decision step: a single table lookup
+    constexpr SystemState decide_state(const DecisionInputs& in) {
+        return kDecisionTable[encode_inputs(in)];
+    }
+
+    // ---- Compile-time verification ----
+
+    // Hand-picked inputs and the state the original state controller branches chose for them
+    // (state_logic_host_connected / state_logic_host_disconnected), plus the ToF intrusion rule
+    struct DecisionCase {
+        DecisionInputs inputs;
+        SystemState expected;
+    };
+
+    constexpr DecisionCase kDecisionCases[] = {
+        // Host connected: the host color decides, detections and ToF are only logged
+        {{true,  HostColor::RED,    false, false, false, false}, SystemState::STOPPED},
+        {{true,  HostColor::RED,    true,  true,  true,  true},  SystemState::STOPPED},
+        {{true,  HostColor::YELLOW, false, false, false, false}, SystemState::WARNING},
+        {{true,  HostColor::YELLOW, true,  true,  true,  false}, SystemState::WARNING},
+        {{true,  HostColor::BLUE,   false, false, false, false}, SystemState::IDLE},
+        {{true,  HostColor::BLUE,   true,  true,  true,  true},  SystemState::IDLE},
+        {{true,  HostColor::GREEN,  false, true,  false, false}, SystemState::ACTIVE},
+        {{true,  HostColor::GREEN,  true,  true,  true,  true},  SystemState::ACTIVE},
+        // No color class matched: new_state kept its HOST_READING start value
+        {{true,  HostColor::NONE,   false, false, false, false}, SystemState::HOST_READING},
+        {{true,  HostColor::NONE,   true,  true,  true,  true},  SystemState::HOST_READING},
+
+        // Host disconnected: the last host color is ignored
+        {{false, HostColor::NONE,   false, false, false, false}, SystemState::IDLE},
+        {{false, HostColor::RED,    false, true,  false, false}, SystemState::IDLE},
+        {{false, HostColor::GREEN,  false, true,  false, false}, SystemState::IDLE},
+        // No valid detection: IDLE, whatever the cached depths say
+        {{false, HostColor::NONE,   false, true,  true,  false}, SystemState::IDLE},
+        // Person with fresh ToF inside the stop distance
+        {{false, HostColor::NONE,   true,  true,  true,  false}, SystemState::STOPPED},
+        {{false, HostColor::GREEN,  true,  true,  true,  false}, SystemState::STOPPED},
+        // Person outside the stop distance
+        {{false, HostColor::NONE,   true,  true,  false, false}, SystemState::WARNING},
+        // Person without valid ToF data: "assume WARNING"
+        {{false, HostColor::NONE,   true,  false, false, false}, SystemState::WARNING},
+        {{false, HostColor::NONE,   true,  false, true,  false}, SystemState::WARNING},
+
+        // ToF-only intrusion, until the camera confirms or clears it
+        {{false, HostColor::NONE,   false, false, false, true},  kTofIntrusionAction},
+        {{false, HostColor::NONE,   false, true,  false, true},  kTofIntrusionAction},
+        {{false, HostColor::NONE,   true,  true,  false, true},  kTofIntrusionAction},
+        {{false, HostColor::NONE,   true,  true,  true,  true},  SystemState::STOPPED},
+        {{true,  HostColor::GREEN,  false, true,  false, true},  SystemState::ACTIVE},
+    };
+
+    constexpr bool decision_table_matches_cases() {
+        for (const auto& c : kDecisionCases) {
+            if (decide_state(c.inputs) != c.expected) return false;
+        }
+        return true;
+    }
+
+    // Safety invariants over every input combination
+    constexpr bool decision_table_is_safe() {
+        constexpr HostColor kColors[] = {
+            HostColor::NONE, HostColor::RED, HostColor::YELLOW, HostColor::BLUE, HostColor::GREEN
+        };
+
+        for (uint8_t bits = 0; bits < 32; bits++) {
+            for (HostColor color : kColors) {
+                DecisionInputs in{
+                    (bits & 0x1) != 0, color, (bits & 0x2) != 0, (bits & 0x4) != 0, (bits & 0x8) != 0,
+                    (bits & 0x10) != 0
+                };
+                SystemState next = decide_state(in);
+
+                if (!in.host_connected && in.person_warning && in.tof_fresh && in.in_danger &&
+                    next != SystemState::STOPPED) return false;
+                if (in.host_connected && color == HostColor::RED && next != SystemState::STOPPED) return false;
+                if (!in.host_connected && next == SystemState::ACTIVE) return false;
+                if (!in.host_connected && in.tof_intrusion &&
+                    next != SystemState::STOPPED && next != kTofIntrusionAction) return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool decision_table_is_total() {
+        for (const auto& next : kDecisionTable) {
+            if (next == SystemState::UNINITIALIZED) return false;
+        }
+        return true;
+    }
+
+    static_assert(decision_table_is_total(), "Transition table leaves an input combination unhandled");
+    static_assert(decision_table_matches_cases(), "Transition table disagrees with the andon state logic");
+    static_assert(decision_table_is_safe(), "Transition table breaks a safety invariant");
+}
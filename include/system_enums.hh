@@ -32,7 +32,7 @@ struct RedStates {
     static constexpr HostState ABORTED = HostState::ABORTED;
     static constexpr HostState CLEARING = HostState::CLEARING;
 
-    static bool Contains(HostState state) {
+    static constexpr bool Contains(HostState state) {
         return state == UNDEFINED || state == STOPPED || state == STOPPING || 
                state == ABORTING || state == ABORTED || state == CLEARING;
     }
@@ -42,7 +42,7 @@ struct GreenStates {
     static constexpr HostState STARTING = HostState::STARTING;
     static constexpr HostState EXECUTE = HostState::EXECUTE;
 
-    static bool Contains(HostState state) {
+    static constexpr bool Contains(HostState state) {
         return state == STARTING || state == EXECUTE;
     }
 };
@@ -53,7 +53,7 @@ struct YellowStates {
     static constexpr HostState HELD = HostState::HELD;
     static constexpr HostState UNHOLDING = HostState::UNHOLDING;
 
-    static bool Contains(HostState state) {
+    static constexpr bool Contains(HostState state) {
         return state == SUSPENDED || state == HOLDING || 
                state == HELD || state == UNHOLDING;
     }
@@ -65,7 +65,7 @@ struct BlueStates {
     static constexpr HostState COMPLETING = HostState::COMPLETING;
     static constexpr HostState COMPLETE = HostState::COMPLETE;
 
-    static bool Contains(HostState state) {
+    static constexpr bool Contains(HostState state) {
         return state == IDLE || state == RESETTING || 
                state == COMPLETING || state == COMPLETE;
     }
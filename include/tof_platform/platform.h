@@ -0,0 +1,48 @@
+/* platform.h
+ *
+ * VL53L8CX ULD platform layer (the header the ULD API includes). The functions
+ * are implemented in src/m7/tof_platform.cc on top of LPI2C with eDMA.
+ */
+#ifndef TOF_PLATFORM_H_
+#define TOF_PLATFORM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint16_t address; /* 8-bit I2C address as the ULD keeps it (vl53l8cx_set_i2c_address) */
+    uint8_t bus;      /* TofBus index (m7/tof_platform.hh) */
+    uint8_t lpn_pin;  /* coralmicro Gpio driving LPn, used by VL53L8CX_Reset_Sensor */
+} VL53L8CX_Platform;
+
+/* One target per zone; depth estimation and the intrusion check read only
+ * distance and status, so the other outputs are not transferred at all. */
+#define VL53L8CX_NB_TARGET_PER_ZONE 1U
+
+#define VL53L8CX_DISABLE_AMBIENT_PER_SPAD
+#define VL53L8CX_DISABLE_NB_SPADS_ENABLED
+#define VL53L8CX_DISABLE_NB_TARGET_DETECTED
+#define VL53L8CX_DISABLE_SIGNAL_PER_SPAD
+#define VL53L8CX_DISABLE_RANGE_SIGMA_MM
+/* #define VL53L8CX_DISABLE_DISTANCE_MM */
+#define VL53L8CX_DISABLE_REFLECTANCE_PERCENT
+/* #define VL53L8CX_DISABLE_TARGET_STATUS */
+#define VL53L8CX_DISABLE_MOTION_INDICATOR
+
+uint8_t VL53L8CX_RdByte(VL53L8CX_Platform *p_platform, uint16_t RegisterAdress, uint8_t *p_value);
+uint8_t VL53L8CX_WrByte(VL53L8CX_Platform *p_platform, uint16_t RegisterAdress, uint8_t value);
+uint8_t VL53L8CX_RdMulti(VL53L8CX_Platform *p_platform, uint16_t RegisterAdress, uint8_t *p_values, uint32_t size);
+uint8_t VL53L8CX_WrMulti(VL53L8CX_Platform *p_platform, uint16_t RegisterAdress, uint8_t *p_values, uint32_t size);
+uint8_t VL53L8CX_Reset_Sensor(VL53L8CX_Platform *p_platform);
+void VL53L8CX_SwapBuffer(uint8_t *buffer, uint16_t size);
+uint8_t VL53L8CX_WaitMs(VL53L8CX_Platform *p_platform, uint32_t TimeMs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TOF_PLATFORM_H_ */
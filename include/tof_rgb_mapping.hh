@@ -1,5 +1,6 @@
 // Auto-generated TOF cell to RGB pixel mapping
 #pragma once
+#include <algorithm>
 #include <array>
 #include <cstdint>
 
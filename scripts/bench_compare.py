@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Compare two andon_bench --json runs (host/bench.cc), e.g. before and after a change.
+
+Benchmarks are matched on name, grid and detection count. Prints both timings, the change,
+and any change in allocations per op; those are exact, so any increase is flagged.
+
+Usage:
+    bench_compare.py base.json new.json [--threshold 5]
+
+Exits 1 if a benchmark got slower by more than the threshold (percent) or allocates more.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    if data.get("schema") != 1:
+        raise SystemExit("%s: unknown schema %r" % (path, data.get("schema")))
+    return {(b["name"], b["grid"], b["detections"]): b for b in data["benchmarks"]}
+
+
+def label(key):
+    name, grid, detections = key
+    parts = [name]
+    if grid:
+        parts.append(grid)
+    if detections >= 0:
+        parts.append("%d det" % detections)
+    return " ".join(parts)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("base")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=5.0, help="slowdown in percent that counts as a regression")
+    args = parser.parse_args()
+
+    base = load(args.base)
+    new = load(args.new)
+
+    regressed = False
+    print("%-36s %12s %12s %8s  %s" % ("benchmark", "base ns/op", "new ns/op", "change", "allocs/op"))
+    for key in sorted(set(base) | set(new)):
+        if key not in base or key not in new:
+            print("%-36s %s" % (label(key), "only in new" if key in new else "only in base"))
+            continue
+
+        a, b = base[key], new[key]
+        change = (b["ns_per_op"] - a["ns_per_op"]) / a["ns_per_op"] * 100.0 if a["ns_per_op"] > 0 else 0.0
+        allocs = "%.2f" % b["allocs_per_op"]
+        flag = ""
+        if b["allocs_per_op"] > a["allocs_per_op"]:
+            allocs = "%.2f -> %.2f" % (a["allocs_per_op"], b["allocs_per_op"])
+            flag = "  <- allocates more"
+            regressed = True
+        elif change > args.threshold:
+            flag = "  <- slower"
+            regressed = True
+        print("%-36s %12.1f %12.1f %+7.1f%%  %s%s" % (label(key), a["ns_per_op"], b["ns_per_op"], change, allocs, flag))
+
+    sys.exit(1 if regressed else 0)
+
+
+if __name__ == "__main__":
+    main()
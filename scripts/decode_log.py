@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""Decode the deferred logger's binary console output (deferred_log.hh, LogSink::kBinary).
+
+Each record on the wire is 0x00, COBS(level, format address, timestamp_us, args, xor checksum), 0x00.
+The format string is never sent: it is read from the ELF at that address, and the packed
+arguments are formatted against it here. Plain printf text between frames passes through.
+
+Usage:
+    decode_log.py path/to/coralmicro_in_tree_andon_system [--port /dev/ttyUSB0 [--baud 115200]]
+    decode_log.py ELF --input capture.bin
+    picocom -b 115200 /dev/ttyUSB0 --quiet | decode_log.py ELF
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LEVELS = "DIWE"
+
+SPEC = re.compile(r"%(?P<flags>[-+ #0]*)(?P<width>\d*)(?:\.(?P<prec>\d+))?(?P<len>hh|h|ll|l|z|j|t)?(?P<conv>[diuxXocfFeEgGsp%])")
+
+
+class Elf:
+    """Allocated sections of an ELF image, enough to read strings by address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % path)
+
+        is64 = data[4] == 2
+        endian = "<" if data[5] == 1 else ">"
+        if is64:
+            shoff, = struct.unpack_from(endian + "Q", data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + "HH", data, 0x3A)
+            section = endian + "IIQQQQ"
+        else:
+            shoff, = struct.unpack_from(endian + "I", data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + "HH", data, 0x2E)
+            section = endian + "IIIIII"
+
+        self.data = data
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, flags, addr, offset, size = struct.unpack_from(section, data, shoff + i * shentsize)
+            if flags & 0x2 and sh_type != 8 and size > 0:  # SHF_ALLOC, not SHT_NOBITS
+                self.sections.append((addr, offset, size))
+
+    def string_at(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + (address - addr)
+                end = self.data.find(b"\0", start, offset + size)
+                return self.data[start:end if end >= 0 else offset + size].decode("utf-8", "replace")
+        return None
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def format_record(fmt, args):
+    pos = 0
+
+    def take(fmt_struct):
+        nonlocal pos
+        value, = struct.unpack_from(fmt_struct, args, pos)
+        pos += struct.calcsize(fmt_struct)
+        return value
+
+    def replace(match):
+        nonlocal pos
+        conv = match.group("conv")
+        if conv == "%":
+            return "%"
+        spec = "%" + match.group("flags") + match.group("width")
+        if match.group("prec") is not None:
+            spec += "." + match.group("prec")
+
+        if conv == "s":
+            n = args[pos]
+            text = args[pos + 1:pos + 1 + n].decode("utf-8", "replace")
+            pos += 1 + n
+            return (spec + "s") % text
+        if conv in "fFeEgG":
+            return (spec + conv) % take("<f")
+        if conv == "p":
+            return "0x%08x" % take("<I")
+
+        wide = match.group("len") == "ll"
+        if conv in "di":
+            return (spec + "d") % take("<q" if wide else "<i")
+        value = take("<Q" if wide else "<I")
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        return (spec + ("d" if conv == "u" else conv)) % value
+
+    try:
+        return SPEC.sub(replace, fmt)
+    except (struct.error, IndexError, TypeError, ValueError) as e:
+        return "%s <bad args: %s>" % (fmt.rstrip(), e)
+
+
+class Decoder:
+    def __init__(self, elf, out, timestamps=True):
+        self.elf = elf
+        self.out = out
+        self.timestamps = timestamps
+        self.in_frame = False
+        self.frame = bytearray()
+        self.bad_frames = 0
+        self.last_us = None
+        self.wraps = 0
+
+    def feed(self, data):
+        text = bytearray()
+        for byte in data:
+            if not self.in_frame:
+                if byte == 0:
+                    self._flush_text(text)
+                    self.in_frame = True
+                    self.frame.clear()
+                else:
+                    text.append(byte)
+            elif byte == 0:
+                if self.frame:  # Empty means back-to-back frames: this 0x00 opens the next one
+                    self._record(bytes(self.frame))
+                    self.in_frame = False
+            else:
+                self.frame.append(byte)
+        self._flush_text(text)
+
+    def _flush_text(self, text):
+        if text:
+            self.out.write(text.decode("utf-8", "replace"))
+            text.clear()
+
+    def _record(self, encoded):
+        frame = cobs_decode(encoded)
+        checksum = 0
+        for b in frame or b"":
+            checksum ^= b
+        if frame is None or len(frame) < 10 or checksum != 0:
+            self.bad_frames += 1
+            return
+
+        level, fmt_id, timestamp_us = struct.unpack_from("<BII", frame, 0)
+        fmt = self.elf.string_at(fmt_id)
+        if fmt is None:
+            self.bad_frames += 1
+            self.out.write("<unknown format 0x%08x, stale ELF?>\n" % fmt_id)
+            return
+
+        # 32-bit microseconds wrap every ~71 minutes
+        if self.last_us is not None and timestamp_us + 0x80000000 < self.last_us:
+            self.wraps += 1
+        self.last_us = timestamp_us
+        seconds = (self.wraps * (1 << 32) + timestamp_us) / 1e6
+
+        message = format_record(fmt, frame[9:-1])
+        line = message.rstrip("\r\n")
+        if self.timestamps:
+            line = "[%12.6f] %s %s" % (seconds, LEVELS[level] if level < len(LEVELS) else "?", line)
+        self.out.write(line + "\n")
+        self.out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="Firmware ELF the device is running")
+    parser.add_argument("--port", help="Serial port to read (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--input", help="Captured console bytes")
+    parser.add_argument("--no-timestamps", action="store_true")
+    args = parser.parse_args()
+
+    decoder = Decoder(Elf(args.elf), sys.stdout, timestamps=not args.no_timestamps)
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            try:
+                while True:
+                    decoder.feed(port.read(4096))
+            except KeyboardInterrupt:
+                pass
+    else:
+        stream = open(args.input, "rb") if args.input else sys.stdin.buffer
+        with stream:
+            while True:
+                chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+                if not chunk:
+                    break
+                decoder.feed(chunk)
+
+    if decoder.bad_frames:
+        print("%d corrupt or unknown frames skipped" % decoder.bad_frames, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
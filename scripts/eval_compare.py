@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Compare two andon_eval --json runs (host/evaluate.cc), e.g. before and after a change.
+
+Prints each headline metric for both runs and flags the ones that got worse by more than
+their tolerance: recall and precision dropping, depth error, false STOP rate, missed
+reactions and reaction time rising.
+
+Usage:
+    eval_compare.py base.json new.json [--rate-tolerance 0.01] [--depth-tolerance 5] [--reaction-tolerance 10]
+
+Exits 1 if any metric regressed.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    if data.get("schema") != 1:
+        raise SystemExit("%s: unknown schema %r" % (path, data.get("schema")))
+    return data
+
+
+def distribution(data, group, name, field):
+    value = data[group][name]
+    return None if value is None else value[field]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("base")
+    parser.add_argument("new")
+    parser.add_argument("--rate-tolerance", type=float, default=0.01, help="for recall, precision and false STOPs")
+    parser.add_argument("--depth-tolerance", type=float, default=5.0, help="mm of depth error")
+    parser.add_argument("--reaction-tolerance", type=float, default=10.0, help="percent of reaction time")
+    args = parser.parse_args()
+
+    base = load(args.base)
+    new = load(args.new)
+    if base["frames"]["labeled"] != new["frames"]["labeled"]:
+        print("warning: the runs scored %d and %d labeled frames" % (base["frames"]["labeled"], new["frames"]["labeled"]))
+
+    # name, value, better when higher, allowed change in the bad direction (absolute or percent)
+    metrics = [
+        ("recall", lambda d: d["detection"]["recall"], True, args.rate_tolerance, False),
+        ("precision", lambda d: d["detection"]["precision"], True, args.rate_tolerance, False),
+        ("depth abs error mean mm", lambda d: distribution(d, "depth", "abs_error_mm", "mean"), False,
+         args.depth_tolerance, False),
+        ("depth abs error p95 mm", lambda d: distribution(d, "depth", "abs_error_mm", "p95"), False,
+         args.depth_tolerance, False),
+        ("false STOP rate", lambda d: d["stops"]["false_rate"], False, args.rate_tolerance, False),
+        ("missed reactions", lambda d: d["reaction"]["missed"], False, 0, False),
+        ("reaction p50 ms", lambda d: distribution(d, "reaction", "ms", "p50"), False, args.reaction_tolerance, True),
+        ("reaction p90 ms", lambda d: distribution(d, "reaction", "ms", "p90"), False, args.reaction_tolerance, True),
+    ]
+
+    regressed = False
+    print("%-26s %12s %12s  %s" % ("metric", "base", "new", ""))
+    for name, get, higher_better, tolerance, relative in metrics:
+        a, b = get(base), get(new)
+        if a is None or b is None:
+            print("%-26s %12s %12s" % (name, "-" if a is None else "%.4g" % a, "-" if b is None else "%.4g" % b))
+            continue
+        worse = (a - b) if higher_better else (b - a)
+        limit = abs(a) * tolerance / 100.0 if relative else tolerance
+        flag = ""
+        if worse > limit:
+            flag = "  <- worse"
+            regressed = True
+        print("%-26s %12.4g %12.4g%s" % (name, a, b, flag))
+
+    sys.exit(1 if regressed else 0)
+
+
+if __name__ == "__main__":
+    main()
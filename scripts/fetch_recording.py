@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Pull the device capture stream (recorder.hh) into a recording file for host/replay.
+
+Calls tx_recording over JSON-RPC, appending each piece and asking again from where it ended.
+Only whole chunks are written, so the file always ends on a chunk boundary. If the device
+ring overtook the reader (or the device rebooted), the partial chunk is thrown away and the
+gap reported; the file carries on from the oldest chunk the device still holds.
+
+File layout (recording_format.hh):
+    "ANDR" magic u32 | version u16 | reserved u16 | reserved u64, then chunks:
+    type u8 | aux u8 | reserved u16 | length u32 | timestamp_us u64 | payload
+
+Usage:
+    fetch_recording.py --host 10.10.10.1 -o capture.andr              # what the ring holds now
+    fetch_recording.py --host 10.10.10.1 -o capture.andr --follow 60  # and the next 60 s
+"""
+
+import argparse
+import base64
+import json
+import struct
+import sys
+import time
+import urllib.request
+
+FILE_HEADER = struct.Struct("<IHHQ")
+CHUNK_HEADER = struct.Struct("<BBHIQ")
+MAGIC = 0x52444E41  # "ANDR"
+
+
+def rpc(host, method, params=None, request_id=1):
+    body = json.dumps({"id": request_id, "jsonrpc": "2.0", "method": method, "params": params or {}}).encode()
+    req = urllib.request.Request("http://%s/jsonrpc" % host, data=body, headers={"Content-Type": "application/json"})
+    with urllib.request.urlopen(req, timeout=10) as resp:
+        reply = json.loads(resp.read())
+    if "error" in reply:
+        raise RuntimeError("%s failed: %s" % (method, reply["error"]))
+    return reply["result"]
+
+
+def split_chunks(pending):
+    """Length of the whole chunks at the start of pending."""
+    used = 0
+    while len(pending) - used >= CHUNK_HEADER.size:
+        _, _, _, length, _ = CHUNK_HEADER.unpack_from(pending, used)
+        if len(pending) - used - CHUNK_HEADER.size < length:
+            break
+        used += CHUNK_HEADER.size + length
+    return used
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="10.10.10.1", help="device address")
+    parser.add_argument("-o", "--output", required=True, help="recording file to write")
+    parser.add_argument("--follow", type=float, default=0.0, metavar="SECONDS",
+                        help="keep fetching new chunks for this long once caught up")
+    parser.add_argument("--interval", type=float, default=0.2, help="poll period while following (s)")
+    args = parser.parse_args()
+
+    offset = 0
+    pending = b""
+    written = 0
+    version = None
+    stop_at = None
+    request_id = 1
+
+    with open(args.output, "wb") as out:
+        while True:
+            reply = rpc(args.host, "tx_recording", {"offset": offset}, request_id)
+            request_id += 1
+
+            if version is None:
+                version = int(reply["version"])
+                out.write(FILE_HEADER.pack(MAGIC, version, 0, 0))
+
+            start = int(reply["offset"])
+            if start != offset:
+                if pending:
+                    print("dropped a partial chunk of %d bytes" % len(pending), file=sys.stderr)
+                print("gap: stream resumed at %d instead of %d (%d bytes evicted)"
+                      % (start, offset, int(reply["dropped"])), file=sys.stderr)
+                pending = b""
+
+            data = base64.b64decode(reply["data"])
+            pending += data
+            offset = start + len(data)
+
+            whole = split_chunks(pending)
+            out.write(pending[:whole])
+            written += whole
+            pending = pending[whole:]
+
+            if offset < int(reply["end"]):
+                continue
+            if stop_at is None:
+                stop_at = time.monotonic() + args.follow
+            if time.monotonic() >= stop_at:
+                break
+            time.sleep(args.interval)
+
+    print("%d bytes of chunks written to %s (device: %d chunks, %d evicted, %d rejected)"
+          % (written, args.output, reply["chunks"], reply["evicted_chunks"], reply["rejected"]))
+
+
+if __name__ == "__main__":
+    main()
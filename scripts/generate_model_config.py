@@ -0,0 +1,500 @@
+#!/usr/bin/env python3
+"""Generate a constexpr model config header from a .tflite file.
+
+Reads the model flatbuffer directly (no tensorflow/flatbuffers dependency) and emits:
+  - the exact op set as a MicroMutableOpResolver registration function
+  - input shape, type and quantization params
+  - a tensor arena bound from a greedy lifetime plan of the activation tensors and the scratch
+    buffers the ops request in Prepare, planned the way tflite-micro's GreedyMemoryPlanner does
+
+The bound is computed offline from the model; the device prints what the interpreter actually
+used at boot ("arena used N of M bytes"), which must stay below it.
+
+Usage:
+    generate_model_config.py MODEL.tflite OUTPUT.hh --device-path /apps/<app>/models/<file>
+        [--margin-percent 25] [--extra-kb 1024] [--arena-bytes N]
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+# ---- Minimal flatbuffer reader ----
+
+
+class Table:
+    def __init__(self, buf, pos):
+        self.buf = buf
+        self.pos = pos
+        vtable = pos - struct.unpack_from("<i", buf, pos)[0]
+        self.vtable = vtable
+        self.vtable_size = struct.unpack_from("<H", buf, vtable)[0]
+
+    def _field(self, index):
+        entry = 4 + 2 * index
+        if entry >= self.vtable_size:
+            return 0
+        return struct.unpack_from("<H", self.buf, self.vtable + entry)[0]
+
+    def scalar(self, index, fmt, default=0):
+        off = self._field(index)
+        if off == 0:
+            return default
+        return struct.unpack_from("<" + fmt, self.buf, self.pos + off)[0]
+
+    def _indirect(self, index):
+        off = self._field(index)
+        if off == 0:
+            return None
+        pos = self.pos + off
+        return pos + struct.unpack_from("<I", self.buf, pos)[0]
+
+    def table(self, index):
+        pos = self._indirect(index)
+        return Table(self.buf, pos) if pos is not None else None
+
+    def string(self, index):
+        pos = self._indirect(index)
+        if pos is None:
+            return None
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        return self.buf[pos + 4:pos + 4 + length].decode("utf-8")
+
+    def vector_length(self, index):
+        pos = self._indirect(index)
+        return 0 if pos is None else struct.unpack_from("<I", self.buf, pos)[0]
+
+    def scalar_vector(self, index, fmt):
+        pos = self._indirect(index)
+        if pos is None:
+            return []
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        size = struct.calcsize("<" + fmt)
+        return [struct.unpack_from("<" + fmt, self.buf, pos + 4 + i * size)[0] for i in range(length)]
+
+    def table_vector(self, index):
+        pos = self._indirect(index)
+        if pos is None:
+            return []
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        tables = []
+        for i in range(length):
+            elem = pos + 4 + 4 * i
+            tables.append(Table(self.buf, elem + struct.unpack_from("<I", self.buf, elem)[0]))
+        return tables
+
+
+# ---- TFLite schema subset ----
+
+# Model
+MODEL_OPERATOR_CODES = 1
+MODEL_SUBGRAPHS = 2
+MODEL_BUFFERS = 4
+# OperatorCode
+OPCODE_DEPRECATED_BUILTIN = 0
+OPCODE_CUSTOM = 1
+OPCODE_BUILTIN = 3
+# SubGraph
+SUBGRAPH_TENSORS = 0
+SUBGRAPH_INPUTS = 1
+SUBGRAPH_OUTPUTS = 2
+SUBGRAPH_OPERATORS = 3
+# Tensor
+TENSOR_SHAPE = 0
+TENSOR_TYPE = 1
+TENSOR_BUFFER = 2
+TENSOR_NAME = 3
+TENSOR_QUANTIZATION = 4
+TENSOR_IS_VARIABLE = 5
+# QuantizationParameters
+QUANT_SCALE = 2
+QUANT_ZERO_POINT = 3
+# Operator
+OPERATOR_OPCODE_INDEX = 0
+OPERATOR_INPUTS = 1
+OPERATOR_OUTPUTS = 2
+# Buffer
+BUFFER_DATA = 0
+BUFFER_OFFSET = 1
+
+BUILTIN_CUSTOM = 32
+BUILTIN_PLACEHOLDER_FOR_GREATER_OP_CODES = 127
+
+# TensorType -> (TfLiteType, bytes per element)
+TENSOR_TYPES = {
+    0: ("kTfLiteFloat32", 4),
+    1: ("kTfLiteFloat16", 2),
+    2: ("kTfLiteInt32", 4),
+    3: ("kTfLiteUInt8", 1),
+    4: ("kTfLiteInt64", 8),
+    6: ("kTfLiteBool", 1),
+    7: ("kTfLiteInt16", 2),
+    9: ("kTfLiteInt8", 1),
+}
+
+# BuiltinOperator -> MicroMutableOpResolver method
+BUILTIN_OPS = {
+    0: "AddAdd",
+    1: "AddAveragePool2D",
+    2: "AddConcatenation",
+    3: "AddConv2D",
+    4: "AddDepthwiseConv2D",
+    5: "AddDepthToSpace",
+    6: "AddDequantize",
+    8: "AddFloor",
+    9: "AddFullyConnected",
+    11: "AddL2Normalization",
+    12: "AddL2Pool2D",
+    14: "AddLogistic",
+    17: "AddMaxPool2D",
+    18: "AddMul",
+    19: "AddRelu",
+    21: "AddRelu6",
+    22: "AddReshape",
+    23: "AddResizeBilinear",
+    25: "AddSoftmax",
+    26: "AddSpaceToDepth",
+    28: "AddTanh",
+    34: "AddPad",
+    36: "AddGather",
+    37: "AddBatchToSpaceNd",
+    38: "AddSpaceToBatchNd",
+    39: "AddTranspose",
+    40: "AddMean",
+    41: "AddSub",
+    42: "AddDiv",
+    43: "AddSqueeze",
+    45: "AddStridedSlice",
+    47: "AddExp",
+    49: "AddSplit",
+    50: "AddLogSoftmax",
+    53: "AddCast",
+    54: "AddPrelu",
+    55: "AddMaximum",
+    56: "AddArgMax",
+    57: "AddMinimum",
+    58: "AddLess",
+    59: "AddNeg",
+    60: "AddPadV2",
+    61: "AddGreater",
+    62: "AddGreaterEqual",
+    63: "AddLessEqual",
+    64: "AddSelectV2",
+    65: "AddSlice",
+    67: "AddTransposeConv",
+    70: "AddExpandDims",
+    71: "AddEqual",
+    72: "AddNotEqual",
+    73: "AddLog",
+    74: "AddSum",
+    75: "AddSqrt",
+    76: "AddRsqrt",
+    77: "AddShape",
+    79: "AddArgMin",
+    82: "AddReduceMax",
+    83: "AddPack",
+    84: "AddLogicalOr",
+    86: "AddLogicalAnd",
+    87: "AddLogicalNot",
+    88: "AddUnpack",
+    90: "AddFloorDiv",
+    92: "AddSquare",
+    94: "AddFill",
+    95: "AddFloorMod",
+    97: "AddResizeNearestNeighbor",
+    98: "AddLeakyRelu",
+    99: "AddSquaredDifference",
+    100: "AddMirrorPad",
+    101: "AddAbs",
+    102: "AddSplitV",
+    104: "AddCeil",
+    107: "AddGatherNd",
+    108: "AddCos",
+    111: "AddElu",
+    114: "AddQuantize",
+    116: "AddRound",
+    117: "AddHardSwish",
+}
+
+# Custom op name -> registration statement (resolver is named "resolver")
+CUSTOM_OPS = {
+    "edgetpu-custom-op": "resolver.AddCustom(kCustomOp, RegisterCustomOp())",
+    "TFLite_Detection_PostProcess": "resolver.AddDetectionPostprocess()",
+}
+
+ARENA_ALIGNMENT = 16
+FLOAT_BYTES = 4
+INT32_BYTES = 4
+TENSOR_OVERHEAD_BYTES = 64   # TfLiteEvalTensor + allocation records per tensor
+OPERATOR_OVERHEAD_BYTES = 128  # TfLiteNode + registration per operator
+
+
+def align(value, alignment=ARENA_ALIGNMENT):
+    return (value + alignment - 1) // alignment * alignment
+
+
+def fail(message):
+    print(f"generate_model_config: {message}", file=sys.stderr)
+    sys.exit(1)
+
+
+class ModelInfo:
+    def __init__(self, data):
+        if len(data) < 8 or data[4:8] != b"TFL3":
+            fail("not a TFLite flatbuffer (missing TFL3 identifier)")
+
+        self.data = data
+        model = Table(data, struct.unpack_from("<I", data, 0)[0])
+        self.opcodes = model.table_vector(MODEL_OPERATOR_CODES)
+        self.subgraphs = model.table_vector(MODEL_SUBGRAPHS)
+        self.buffers = model.table_vector(MODEL_BUFFERS)
+        if not self.subgraphs:
+            fail("model has no subgraphs")
+
+    def opcode_registration(self, opcode):
+        builtin = opcode.scalar(OPCODE_BUILTIN, "i", 0)
+        deprecated = opcode.scalar(OPCODE_DEPRECATED_BUILTIN, "b", 0)
+        # Newer schemas keep codes < 127 in the deprecated byte and the full value in builtin_code
+        code = max(builtin, deprecated)
+        if code == BUILTIN_PLACEHOLDER_FOR_GREATER_OP_CODES:
+            code = builtin
+
+        if code == BUILTIN_CUSTOM:
+            name = opcode.string(OPCODE_CUSTOM)
+            if name not in CUSTOM_OPS:
+                fail(f"no resolver registration known for custom op '{name}'")
+            return CUSTOM_OPS[name], f"  // {name}"
+
+        if code not in BUILTIN_OPS:
+            fail(f"no resolver registration known for builtin op {code}")
+        return f"resolver.{BUILTIN_OPS[code]}()", ""
+
+    def custom_op_name(self, op):
+        """Custom code of an operator, None for a builtin."""
+        index = op.scalar(OPERATOR_OPCODE_INDEX, "I", 0)
+        if index >= len(self.opcodes):
+            return None
+        opcode = self.opcodes[index]
+        if max(opcode.scalar(OPCODE_BUILTIN, "i", 0), opcode.scalar(OPCODE_DEPRECATED_BUILTIN, "b", 0)) != BUILTIN_CUSTOM:
+            return None
+        return opcode.string(OPCODE_CUSTOM)
+
+    def op_scratch_bytes(self, op, tensors):
+        """Scratch buffers an op requests in Prepare, each live for that op only."""
+        if self.custom_op_name(op) != "TFLite_Detection_PostProcess":
+            return []
+        # Inputs: box encodings [1, boxes, 4], class predictions [1, boxes, classes + background]
+        inputs = op.scalar_vector(OPERATOR_INPUTS, "i")
+        if len(inputs) < 2:
+            fail("TFLite_Detection_PostProcess needs box and class inputs")
+        box_shape = tensors[inputs[0]].scalar_vector(TENSOR_SHAPE, "i")
+        class_shape = tensors[inputs[1]].scalar_vector(TENSOR_SHAPE, "i")
+        if len(box_shape) < 2 or len(class_shape) < 3:
+            fail("TFLite_Detection_PostProcess inputs have unexpected shapes")
+        boxes = box_shape[1]
+        classes = class_shape[2]
+        # As detection_postprocess.cc requests them; max_detections (in the op's options) is at
+        # most the box count, so the NMS score buffer is bounded by twice the boxes
+        return [
+            boxes,                          # active candidates
+            boxes * 4 * FLOAT_BYTES,        # decoded boxes
+            boxes * classes * FLOAT_BYTES,  # dequantized scores
+            boxes * FLOAT_BYTES,            # score buffer
+            boxes * FLOAT_BYTES,            # keep scores
+            2 * boxes * FLOAT_BYTES,        # scores after regular NMS
+            boxes * FLOAT_BYTES,            # sorted values
+            boxes * INT32_BYTES,            # sorted indices
+            boxes * INT32_BYTES,            # keep indices
+            boxes * INT32_BYTES,            # buffer
+            boxes * INT32_BYTES,            # selected
+        ]
+
+    def used_ops(self):
+        """Registrations for opcodes actually referenced by an operator, in first-use order."""
+        seen = []
+        for subgraph in self.subgraphs:
+            for op in subgraph.table_vector(SUBGRAPH_OPERATORS):
+                index = op.scalar(OPERATOR_OPCODE_INDEX, "I", 0)
+                if index >= len(self.opcodes):
+                    fail(f"operator references missing opcode {index}")
+                registration = self.opcode_registration(self.opcodes[index])
+                if registration not in seen:
+                    seen.append(registration)
+        return seen
+
+    def tensor_is_constant(self, tensor):
+        buffer_index = tensor.scalar(TENSOR_BUFFER, "I", 0)
+        if buffer_index == 0 or buffer_index >= len(self.buffers):
+            return False
+        buffer = self.buffers[buffer_index]
+        return buffer.vector_length(BUFFER_DATA) > 0 or buffer.scalar(BUFFER_OFFSET, "Q", 0) > 1
+
+    @staticmethod
+    def tensor_bytes(tensor):
+        type_code = tensor.scalar(TENSOR_TYPE, "b", 0)
+        if type_code not in TENSOR_TYPES:
+            fail(f"unsupported tensor type {type_code}")
+        count = 1
+        for dim in tensor.scalar_vector(TENSOR_SHAPE, "i"):
+            count *= max(dim, 1)
+        return count * TENSOR_TYPES[type_code][1]
+
+    def input_tensor(self):
+        subgraph = self.subgraphs[0]
+        inputs = subgraph.scalar_vector(SUBGRAPH_INPUTS, "i")
+        if len(inputs) != 1:
+            fail(f"expected exactly one model input, found {len(inputs)}")
+        return subgraph.table_vector(SUBGRAPH_TENSORS)[inputs[0]]
+
+    def planned_activation_bytes(self):
+        """Greedy-by-size first-fit over tensor and op scratch lifetimes, like tflite-micro's GreedyMemoryPlanner."""
+        subgraph = self.subgraphs[0]
+        tensors = subgraph.table_vector(SUBGRAPH_TENSORS)
+        operators = subgraph.table_vector(SUBGRAPH_OPERATORS)
+        last_step = len(operators)
+
+        first_use = {}
+        last_use = {}
+
+        def touch(index, step):
+            if index < 0 or self.tensor_is_constant(tensors[index]):
+                return
+            first_use[index] = min(first_use.get(index, step), step)
+            last_use[index] = max(last_use.get(index, step), step)
+
+        for index in subgraph.scalar_vector(SUBGRAPH_INPUTS, "i"):
+            touch(index, 0)
+        for step, op in enumerate(operators):
+            for index in op.scalar_vector(OPERATOR_INPUTS, "i"):
+                touch(index, step)
+            for index in op.scalar_vector(OPERATOR_OUTPUTS, "i"):
+                touch(index, step)
+        for index in subgraph.scalar_vector(SUBGRAPH_OUTPUTS, "i"):
+            touch(index, last_step)
+
+        # Variable tensors live for the whole invocation
+        for index, tensor in enumerate(tensors):
+            if tensor.scalar(TENSOR_IS_VARIABLE, "B", 0):
+                first_use[index] = 0
+                last_use[index] = last_step
+
+        buffers = [(align(self.tensor_bytes(tensors[i])), first_use[i], last_use[i]) for i in first_use]
+        for step, op in enumerate(operators):
+            buffers += [(align(size), step, step) for size in self.op_scratch_bytes(op, tensors)]
+        buffers.sort(key=lambda b: -b[0])
+        placed = []
+        high_water = 0
+        for size, first, last in buffers:
+            live = [(o, s) for o, s, f, l in placed if not (last < f or first > l)]
+            # Lowest gap: either the arena start or the end of a buffer live at the same time
+            offset = min(candidate for candidate in [0] + [align(o + s) for o, s in live]
+                         if all(candidate + size <= o or candidate >= o + s for o, s in live))
+            placed.append((offset, size, first, last))
+            high_water = max(high_water, offset + size)
+
+        overhead = len(tensors) * TENSOR_OVERHEAD_BYTES + len(operators) * OPERATOR_OVERHEAD_BYTES
+        return high_water, overhead
+
+
+def generate(args):
+    with open(args.model, "rb") as f:
+        info = ModelInfo(f.read())
+
+    ops = info.used_ops()
+
+    tensor = info.input_tensor()
+    shape = tensor.scalar_vector(TENSOR_SHAPE, "i")
+    if len(shape) != 4:
+        fail(f"expected a 4D NHWC input, found shape {shape}")
+    input_type = TENSOR_TYPES[tensor.scalar(TENSOR_TYPE, "b", 0)][0]
+
+    scale, zero_point = 0.0, 0
+    quantization = tensor.table(TENSOR_QUANTIZATION)
+    if quantization is not None:
+        scales = quantization.scalar_vector(QUANT_SCALE, "f")
+        zero_points = quantization.scalar_vector(QUANT_ZERO_POINT, "q")
+        scale = scales[0] if scales else 0.0
+        zero_point = zero_points[0] if zero_points else 0
+
+    activations, overhead = info.planned_activation_bytes()
+    if args.arena_bytes:
+        arena = align(args.arena_bytes, 1024)
+        arena_comment = f"Set with --arena-bytes ({args.arena_bytes} bytes), rounded to 1 KiB, instead of the plan"
+    else:
+        raw = activations + overhead + args.extra_kb * 1024
+        arena = align(raw * (100 + args.margin_percent) // 100, 1024)
+        arena_comment = (f"Planned: {activations} B activations and op scratch + {overhead} B bookkeeping + "
+                         f"{args.extra_kb} KiB op state, +{args.margin_percent}%")
+
+    model_name = os.path.basename(args.model)
+    registrations = "\n".join(
+        f"    if ((status = {call}) != kTfLiteOk) return status;{comment}" for call, comment in ops)
+
+    header = f"""// AUTO-GENERATED FILE BY "scripts/generate_model_config.py" FROM "{model_name}"
+// EDIT AT YOUR OWN RISK.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "libs/tpu/edgetpu_op.h"
+#include "third_party/tflite-micro/tensorflow/lite/micro/micro_mutable_op_resolver.h"
+
+namespace coralmicro {{
+
+struct ModelConfig {{
+    static constexpr char const* kModelPath = "{args.device_path}";
+
+    // Input tensor ({shape[0]}x{shape[1]}x{shape[2]}x{shape[3]})
+    static constexpr int kInputHeight = {shape[1]};
+    static constexpr int kInputWidth = {shape[2]};
+    static constexpr int kInputChannels = {shape[3]};
+    static constexpr TfLiteType kInputType = {input_type};
+    static constexpr float kInputScale = {scale!r}f;
+    static constexpr int32_t kInputZeroPoint = {zero_point};
+
+    // {arena_comment}
+    static constexpr size_t kArenaSize = {arena};
+
+    static constexpr unsigned kOpCount = {len(ops)};
+}};
+
+using ModelOpResolver = tflite::MicroMutableOpResolver<ModelConfig::kOpCount>;
+
+// Registers exactly the ops referenced by the model
+inline TfLiteStatus RegisterModelOps(ModelOpResolver& resolver) {{
+    TfLiteStatus status;
+{registrations}
+    return kTfLiteOk;
+}}
+
+}}  // namespace coralmicro
+"""
+
+    # Only touch the output when it changes to avoid needless rebuilds
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    if os.path.exists(args.output):
+        with open(args.output) as f:
+            if f.read() == header:
+                return
+    with open(args.output, "w") as f:
+        f.write(header)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("model", help="Path to the .tflite model")
+    parser.add_argument("output", help="Header to write")
+    parser.add_argument("--device-path", required=True, help="Path of the model on the device filesystem")
+    parser.add_argument("--margin-percent", type=int, default=25, help="Headroom added to the planned arena")
+    parser.add_argument("--extra-kb", type=int, default=1024,
+                        help="Persistent op state the plan can't see from the model (EdgeTPU op, per-op data)")
+    parser.add_argument("--arena-bytes", type=int, default=0,
+                        help="Use a fixed arena size instead of the plan (e.g. a boot log's arena used plus headroom)")
+    generate(parser.parse_args())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Add ground truth to a capture for host/evaluate.cc (andon_eval).
+
+export writes every camera frame of the capture as an image named after its capture time,
+plus a labels file to fill in: for each frame, the persons in it (pixel box) and their
+distance from the sensor in mm, measured or read off a marked floor. A frame whose "persons"
+is left null is unlabeled and not scored; an empty list says nobody is there.
+
+apply stores the labels in the capture as ground-truth chunks, replacing any from before.
+
+Labels file:
+    {"frames": [{"capture_us": 12345678, "image": "12345678.ppm",
+                 "persons": [{"xmin": 80, "ymin": 60, "xmax": 220, "ymax": 250, "distance_mm": 450}]}]}
+
+Usage:
+    label_recording.py export capture.andr frames/     # frames/*.ppm|jpg and frames/labels.json
+    label_recording.py apply capture.andr frames/labels.json
+"""
+
+import argparse
+import json
+import os
+import sys
+
+import recording_file
+
+
+def export(args):
+    chunks = recording_file.read(args.capture)
+    os.makedirs(args.directory, exist_ok=True)
+
+    labels_path = os.path.join(args.directory, "labels.json")
+    labeled = {}
+    if os.path.exists(labels_path):
+        with open(labels_path) as f:
+            labeled = {frame["capture_us"]: frame for frame in json.load(f)["frames"]}
+
+    frames = []
+    for capture_us, width, height, encoding, pixels in recording_file.camera_frames(chunks):
+        if encoding == recording_file.JPEG:
+            name = "%d.jpg" % capture_us
+            with open(os.path.join(args.directory, name), "wb") as f:
+                f.write(pixels)
+        else:
+            if len(pixels) != width * height * 3:
+                print("frame %d: %d bytes for %dx%d RGB, skipped" % (capture_us, len(pixels), width, height),
+                      file=sys.stderr)
+                continue
+            name = "%d.ppm" % capture_us
+            with open(os.path.join(args.directory, name), "wb") as f:
+                f.write(b"P6\n%d %d\n255\n" % (width, height))
+                f.write(pixels)
+        previous = labeled.get(capture_us, {})
+        frames.append({"capture_us": capture_us, "image": name, "width": width, "height": height,
+                       "persons": previous.get("persons")})
+
+    # Labels already made are kept; only new frames start out unlabeled
+    with open(labels_path, "w") as f:
+        json.dump({"frames": frames}, f, indent=1)
+    print("%d frames written to %s, labels in %s" % (len(frames), args.directory, labels_path))
+
+
+def apply(args):
+    with open(args.labels) as f:
+        frames = json.load(f)["frames"]
+
+    captured = {capture_us for capture_us, _, _, _, _ in
+                recording_file.camera_frames(recording_file.read(args.capture))}
+    chunks = []
+    persons_total = 0
+    for frame in frames:
+        if frame.get("persons") is None:
+            continue
+        capture_us = int(frame["capture_us"])
+        if capture_us not in captured:
+            print("frame %d is not in %s, skipped" % (capture_us, args.capture), file=sys.stderr)
+            continue
+        persons = [(p["ymin"], p["xmin"], p["ymax"], p["xmax"], p["distance_mm"]) for p in frame["persons"]]
+        persons_total += len(persons)
+        chunks.append(recording_file.Chunk(recording_file.GROUND_TRUTH, 0, capture_us,
+                                           recording_file.pack_ground_truth(capture_us, persons)))
+
+    recording_file.replace(args.capture, recording_file.GROUND_TRUTH, chunks)
+    print("%d labeled frames (%d persons) stored in %s" % (len(chunks), persons_total, args.capture))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    export_parser = commands.add_parser("export", help="write the camera frames and a labels file")
+    export_parser.add_argument("capture")
+    export_parser.add_argument("directory")
+    export_parser.set_defaults(run=export)
+
+    apply_parser = commands.add_parser("apply", help="store a labels file in the capture")
+    apply_parser.add_argument("capture")
+    apply_parser.add_argument("labels")
+    apply_parser.set_defaults(run=apply)
+
+    args = parser.parse_args()
+    args.run(args)
+
+
+if __name__ == "__main__":
+    main()
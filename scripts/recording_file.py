@@ -0,0 +1,98 @@
+"""Reading and rewriting capture files (include/m7/recording_format.hh) for the host scripts.
+
+A capture is a file header and chunks; see fetch_recording.py for the layout. The host tools
+only ever add chunks of their own types, replacing any they added before, so the device's
+chunks pass through byte for byte.
+"""
+
+import struct
+
+FILE_HEADER = struct.Struct("<IHHQ")
+CHUNK_HEADER = struct.Struct("<BBHIQ")
+MAGIC = 0x52444E41  # "ANDR"
+VERSION = 1
+
+# ChunkType
+CAMERA_FRAME = 1
+DETECTIONS = 3
+GROUND_TRUTH = 8
+REFERENCE_DETECTIONS = 9
+
+# CameraEncoding
+RGB888 = 0
+JPEG = 1
+
+CAMERA_HEADER = struct.Struct("<HH")           # width, height
+DETECTIONS_HEADER = struct.Struct("<QB")       # capture_us, count
+OBJECT = struct.Struct("<ifffff")              # id, score, ymin, xmin, ymax, xmax
+GROUND_TRUTH_PERSON = struct.Struct("<fffff")  # ymin, xmin, ymax, xmax, distance_mm
+
+
+class Chunk:
+    def __init__(self, type, aux, timestamp_us, payload):
+        self.type = type
+        self.aux = aux
+        self.timestamp_us = timestamp_us
+        self.payload = payload
+
+
+def read(path):
+    """The chunks of a capture. A partial chunk at the end is dropped."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < FILE_HEADER.size:
+        raise SystemExit("%s: not a recording" % path)
+    magic, version, _, _ = FILE_HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise SystemExit("%s: not a recording" % path)
+    if version != VERSION:
+        raise SystemExit("%s: recording version %d, this script reads %d" % (path, version, VERSION))
+
+    chunks = []
+    offset = FILE_HEADER.size
+    while len(data) - offset >= CHUNK_HEADER.size:
+        type, aux, _, length, timestamp_us = CHUNK_HEADER.unpack_from(data, offset)
+        start = offset + CHUNK_HEADER.size
+        if len(data) - start < length:
+            break
+        chunks.append(Chunk(type, aux, timestamp_us, data[start:start + length]))
+        offset = start + length
+    return chunks
+
+
+def write(path, chunks):
+    with open(path, "wb") as f:
+        f.write(FILE_HEADER.pack(MAGIC, VERSION, 0, 0))
+        for chunk in chunks:
+            f.write(CHUNK_HEADER.pack(chunk.type, chunk.aux, 0, len(chunk.payload), chunk.timestamp_us))
+            f.write(chunk.payload)
+
+
+def replace(path, chunk_type, new_chunks):
+    """Rewrites a capture without its chunks of chunk_type, with new_chunks appended."""
+    chunks = [c for c in read(path) if c.type != chunk_type]
+    write(path, chunks + list(new_chunks))
+
+
+def camera_frames(chunks):
+    """(capture_us, width, height, encoding, pixels) of every camera frame."""
+    for chunk in chunks:
+        if chunk.type == CAMERA_FRAME:
+            width, height = CAMERA_HEADER.unpack_from(chunk.payload, 0)
+            yield chunk.timestamp_us, width, height, chunk.aux, chunk.payload[CAMERA_HEADER.size:]
+
+
+def pack_detections(capture_us, objects):
+    """objects: (id, score, ymin, xmin, ymax, xmax) tuples."""
+    payload = DETECTIONS_HEADER.pack(capture_us, len(objects))
+    for obj in objects:
+        payload += OBJECT.pack(*obj)
+    return payload
+
+
+def pack_ground_truth(capture_us, persons):
+    """persons: (ymin, xmin, ymax, xmax, distance_mm) tuples, pixels and mm."""
+    payload = DETECTIONS_HEADER.pack(capture_us, len(persons))
+    for person in persons:
+        payload += GROUND_TRUTH_PERSON.pack(*person)
+    return payload
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Run a reference detector over the camera frames of a capture, for andon_eval --detector reference.
+
+The device runs the EdgeTPU build of the SSD; this runs a CPU TFLite build of the same model
+(the .tflite the EdgeTPU compiler was given, not its _edgetpu output) on every recorded camera
+frame, and stores the raw results in the capture as reference-detection chunks, replacing any
+from before. They mirror tensorflow::GetDetectionResults: every class, boxes normalized and
+clamped to [0, 1], the top_k best at or above the threshold. andon_eval runs them through the
+device's post-processing (src/m7/detection_postprocess.cc), so a change to the model or the
+quantization can be scored against the same labels without flashing anything.
+
+Needs numpy and either tflite_runtime or tensorflow; Pillow only for JPEG frames.
+
+Usage:
+    reference_detect.py capture.andr --model tf2_ssd_mobilenet_v2_coco17_ptq.tflite [--threshold 0.6] [--top-k 1]
+"""
+
+import argparse
+import io
+import sys
+
+import numpy as np
+
+import recording_file
+
+try:
+    from tflite_runtime.interpreter import Interpreter
+except ImportError:
+    try:
+        from tensorflow.lite import Interpreter
+    except ImportError:
+        sys.exit("needs tflite_runtime or tensorflow")
+
+
+def decode(width, height, encoding, pixels):
+    if encoding == recording_file.JPEG:
+        from PIL import Image
+        return np.asarray(Image.open(io.BytesIO(pixels)).convert("RGB"))
+    return np.frombuffer(pixels, dtype=np.uint8).reshape(height, width, 3)
+
+
+def fit(image, height, width):
+    """Nearest-neighbour resize to the model input; the device camera already delivers that size."""
+    if image.shape[0] == height and image.shape[1] == width:
+        return image
+    rows = (np.arange(height) * image.shape[0] // height)
+    cols = (np.arange(width) * image.shape[1] // width)
+    return image[rows][:, cols]
+
+
+def output(interpreter, index):
+    detail = interpreter.get_output_details()[index]
+    value = interpreter.get_tensor(detail["index"])
+    scale, zero_point = detail["quantization"]
+    if scale:
+        value = (value.astype(np.float32) - zero_point) * scale
+    return value[0]
+
+
+def detect(interpreter, image, threshold, top_k):
+    detail = interpreter.get_input_details()[0]
+    _, height, width, _ = detail["shape"]
+    tensor = fit(image, height, width)
+    if detail["dtype"] == np.float32:
+        tensor = tensor.astype(np.float32) / 127.5 - 1.0
+    elif detail["dtype"] == np.int8:
+        tensor = (tensor.astype(np.int16) - 128).astype(np.int8)
+    interpreter.set_tensor(detail["index"], tensor[np.newaxis])
+    interpreter.invoke()
+
+    # The two output orders of the TFLite detection post-processing op
+    if output(interpreter, 3).size == 1:
+        boxes, class_ids, scores, count = (output(interpreter, i) for i in range(4))
+    else:
+        scores, boxes, count, class_ids = (output(interpreter, i) for i in range(4))
+
+    objects = []
+    for i in range(int(count)):
+        if scores[i] < threshold:
+            continue
+        ymin, xmin, ymax, xmax = (float(np.clip(v, 0.0, 1.0)) for v in boxes[i])
+        objects.append((int(class_ids[i]), float(scores[i]), ymin, xmin, ymax, xmax))
+    objects.sort(key=lambda obj: obj[1], reverse=True)
+    return objects[:top_k]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture")
+    parser.add_argument("--model", required=True, help="CPU .tflite of the detector")
+    parser.add_argument("--threshold", type=float, default=0.6, help="score threshold (kDetectionThreshold)")
+    parser.add_argument("--top-k", type=int, default=1, help="results kept (g_max_detections_per_inference)")
+    args = parser.parse_args()
+
+    interpreter = Interpreter(model_path=args.model)
+    interpreter.allocate_tensors()
+
+    chunks = []
+    detected = 0
+    for capture_us, width, height, encoding, pixels in recording_file.camera_frames(recording_file.read(args.capture)):
+        objects = detect(interpreter, decode(width, height, encoding, pixels), args.threshold, args.top_k)
+        detected += len(objects)
+        chunks.append(recording_file.Chunk(recording_file.REFERENCE_DETECTIONS, 0, capture_us,
+                                           recording_file.pack_detections(capture_us, objects)))
+
+    recording_file.replace(args.capture, recording_file.REFERENCE_DETECTIONS, chunks)
+    print("%d frames, %d objects stored in %s" % (len(chunks), detected, args.capture))
+
+
+if __name__ == "__main__":
+    main()
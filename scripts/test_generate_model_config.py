@@ -0,0 +1,326 @@
+#!/usr/bin/env python3
+"""Tests for generate_model_config.py, run the way the CMake rule runs it.
+
+Small synthetic models, written by the flatbuffer builder below, check op extraction, custom op
+mapping, input quantization, the lifetime plan with the post-process op's scratch buffers and
+--arena-bytes. The shipped detector model is generated with the CMake arguments too (skipped
+when models/ doesn't hold it).
+
+Usage:
+    test_generate_model_config.py [-v]   (also run by ctest in the host build)
+"""
+
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+SCRIPTS_DIR = os.path.dirname(os.path.abspath(__file__))
+REPO_ROOT = os.path.dirname(SCRIPTS_DIR)
+GENERATOR = os.path.join(SCRIPTS_DIR, "generate_model_config.py")
+
+# As in CMakeLists.txt
+PROJECT_NAME = "coralmicro_in_tree_andon_system"
+DETECTOR_MODEL_NAME = "tf2_ssd_mobilenet_v2_coco17_ptq_edgetpu.tflite"
+DETECTOR_MODEL_FILE = os.path.join(REPO_ROOT, "models", DETECTOR_MODEL_NAME)
+
+
+# ---- Minimal flatbuffer builder ----
+
+
+class Builder:
+    """Writes back to front like the flatbuffers library; positions count from the buffer end."""
+
+    def __init__(self):
+        self.data = bytearray()
+
+    def _pad(self, size, alignment):
+        while (len(self.data) + size) % alignment:
+            self.data[0:0] = b"\0"
+
+    def _prepend(self, raw):
+        self.data[0:0] = raw
+        return len(self.data)
+
+    def _uoffset_to(self, target):
+        # Relative to where the offset itself will sit
+        return self._prepend(struct.pack("<I", len(self.data) + 4 - target))
+
+    def scalars(self, fmt, values):
+        body = b"".join(struct.pack("<" + fmt, v) for v in values)
+        self._pad(len(body), max(4, struct.calcsize("<" + fmt)))
+        self._prepend(body)
+        self._pad(4, 4)
+        return self._prepend(struct.pack("<I", len(values)))
+
+    def string(self, text):
+        raw = text.encode("utf-8") + b"\0"
+        self._pad(len(raw) + 4, 4)
+        self._prepend(raw)
+        return self._prepend(struct.pack("<I", len(raw) - 1))
+
+    def tables(self, positions):
+        self._pad(4 * len(positions) + 4, 4)
+        for position in reversed(positions):
+            self._uoffset_to(position)
+        return self._prepend(struct.pack("<I", len(positions)))
+
+    def table(self, fields):
+        """fields[i] is None, ("scalar", fmt, value) or ("offset", position)."""
+        layout = []
+        size = 4  # soffset to the vtable
+        for field in fields:
+            if field is None:
+                layout.append(0)
+                continue
+            width = 4 if field[0] == "offset" else struct.calcsize("<" + field[1])
+            size = (size + width - 1) // width * width
+            layout.append(size)
+            size += width
+        size = (size + 7) // 8 * 8
+
+        self._pad(size, 8)
+        table_pos = len(self.data) + size
+        body = bytearray(size)
+        for field, offset in zip(fields, layout):
+            if field is None:
+                continue
+            if field[0] == "scalar":
+                struct.pack_into("<" + field[1], body, offset, field[2])
+            else:
+                struct.pack_into("<I", body, offset, table_pos - offset - field[1])
+        self._prepend(bytes(body))
+
+        vtable = struct.pack("<HH", 4 + 2 * len(fields), size) + b"".join(struct.pack("<H", o) for o in layout)
+        self._pad(len(vtable), 2)
+        vtable_pos = self._prepend(vtable)
+        start = len(self.data) - table_pos
+        self.data[start:start + 4] = struct.pack("<i", vtable_pos - table_pos)
+        return table_pos
+
+    def finish(self, root, identifier=b"TFL3"):
+        self._pad(8, 8)
+        self._prepend(identifier)
+        self._uoffset_to(root)
+        return bytes(self.data)
+
+
+def scalar(fmt, value):
+    return ("scalar", fmt, value)
+
+
+def offset(position):
+    return ("offset", position)
+
+
+def synthetic_model(custom_op="edgetpu-custom-op", identifier=b"TFL3"):
+    """int8 1x96x96x1 input -> CONV_2D -> SOFTMAX -> custom op, one constant filter.
+
+    Activation lifetimes (step = operator index, outputs live to step 3):
+      t0 input  9216 B  0..0     t2 conv   18432 B  0..1
+      t3 soft  18432 B  1..2     t4 out       16 B  2..3
+    Greedy by size: t2 at 0, t3 at 18432, t0 at 18432 (t3 not yet live), t4 at 0.
+    """
+    b = Builder()
+    opcodes = [
+        b.table([scalar("b", 3), None, None, scalar("i", 3)]),    # CONV_2D
+        b.table([scalar("b", 25), None, None, scalar("i", 25)]),  # SOFTMAX
+        b.table([scalar("b", 32), offset(b.string(custom_op)), None, scalar("i", 32)]),
+    ]
+
+    def tensor(shape, type_code, buffer, quantization=None):
+        return b.table([offset(b.scalars("i", shape)), scalar("b", type_code), scalar("I", buffer),
+                        offset(b.string("t")), offset(quantization) if quantization else None])
+
+    quantization = b.table([None, None, offset(b.scalars("f", [0.0078125])), offset(b.scalars("q", [-128]))])
+    tensors = [
+        tensor([1, 96, 96, 1], 9, 0, quantization),
+        tensor([3, 3, 1, 8], 9, 1),
+        tensor([1, 48, 48, 8], 9, 0),
+        tensor([1, 48, 48, 8], 9, 0),
+        tensor([1, 2], 9, 0),
+    ]
+    operators = [
+        b.table([scalar("I", 0), offset(b.scalars("i", [0, 1])), offset(b.scalars("i", [2]))]),
+        b.table([scalar("I", 1), offset(b.scalars("i", [2])), offset(b.scalars("i", [3]))]),
+        b.table([scalar("I", 2), offset(b.scalars("i", [3])), offset(b.scalars("i", [4]))]),
+    ]
+    subgraph = b.table([offset(b.tables(tensors)), offset(b.scalars("i", [0])), offset(b.scalars("i", [4])),
+                        offset(b.tables(operators))])
+    buffers = [b.table([]), b.table([offset(b.scalars("B", [1] * 72))])]
+    model = b.table([scalar("I", 3), offset(b.tables(opcodes)), offset(b.tables([subgraph])), None,
+                     offset(b.tables(buffers))])
+    return b.finish(model, identifier)
+
+
+SYNTHETIC_ACTIVATION_BYTES = 36864
+SYNTHETIC_OVERHEAD_BYTES = 5 * 64 + 3 * 128
+
+
+def synthetic_postprocess_model(custom_op="TFLite_Detection_PostProcess"):
+    """float boxes [1,100,4,1] (the model input) and scores [1,100,3] with constant anchors -> one
+    custom op -> 4 outputs.
+
+    One operator, so everything is live at once and the plan is the sum of the aligned sizes:
+      tensors  1600 + 1200 + 160 + 48 + 48 + 16                              = 3072 B
+      scratch  112 + 1600 + 1200 + 400 + 400 + 800 + 5 * 400 (post-process)  = 6512 B
+    """
+    b = Builder()
+    opcodes = [b.table([scalar("b", 32), offset(b.string(custom_op)), None, scalar("i", 32)])]
+
+    def tensor(shape, buffer):
+        return b.table([offset(b.scalars("i", shape)), scalar("b", 0), scalar("I", buffer), offset(b.string("t"))])
+
+    tensors = [
+        tensor([1, 100, 4, 1], 0),
+        tensor([1, 100, 3], 0),
+        tensor([100, 4], 1),
+        tensor([1, 10, 4], 0),
+        tensor([1, 10], 0),
+        tensor([1, 10], 0),
+        tensor([1], 0),
+    ]
+    operators = [b.table([scalar("I", 0), offset(b.scalars("i", [0, 1, 2])), offset(b.scalars("i", [3, 4, 5, 6]))])]
+    subgraph = b.table([offset(b.tables(tensors)), offset(b.scalars("i", [0])), offset(b.scalars("i", [3, 4, 5, 6])),
+                        offset(b.tables(operators))])
+    buffers = [b.table([]), b.table([offset(b.scalars("B", [0] * 1600))])]
+    model = b.table([scalar("I", 3), offset(b.tables(opcodes)), offset(b.tables([subgraph])), None,
+                     offset(b.tables(buffers))])
+    return b.finish(model)
+
+
+POSTPROCESS_TENSOR_BYTES = 3072
+POSTPROCESS_SCRATCH_BYTES = 6512
+
+
+# ---- Tests ----
+
+
+def run_generator(model, output, *extra, device_path="/apps/test/model.tflite"):
+    return subprocess.run([sys.executable, GENERATOR, model, output, "--device-path", device_path, *extra],
+                          capture_output=True, text=True)
+
+
+def constant(header, name):
+    match = re.search(rf"static constexpr \S+(?: const\*)? {name} = (.+);", header)
+    return match.group(1) if match else None
+
+
+class SyntheticModelTest(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.TemporaryDirectory()
+        self.output = os.path.join(self.dir.name, "model_config.hh")
+
+    def tearDown(self):
+        self.dir.cleanup()
+
+    def generate(self, model_bytes, *extra):
+        model = os.path.join(self.dir.name, "model.tflite")
+        with open(model, "wb") as f:
+            f.write(model_bytes)
+        result = run_generator(model, self.output, *extra)
+        header = None
+        if result.returncode == 0:
+            with open(self.output) as f:
+                header = f.read()
+        return result, header
+
+    def test_ops_in_first_use_order(self):
+        result, header = self.generate(synthetic_model())
+        self.assertEqual(result.returncode, 0, result.stderr)
+        calls = re.findall(r"if \(\(status = (.+?)\) != kTfLiteOk\)", header)
+        self.assertEqual(calls, ["resolver.AddConv2D()", "resolver.AddSoftmax()",
+                                 "resolver.AddCustom(kCustomOp, RegisterCustomOp())"])
+        self.assertEqual(constant(header, "kOpCount"), "3")
+
+    def test_input_geometry_and_quantization(self):
+        result, header = self.generate(synthetic_model())
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(constant(header, "kInputHeight"), "96")
+        self.assertEqual(constant(header, "kInputWidth"), "96")
+        self.assertEqual(constant(header, "kInputChannels"), "1")
+        self.assertEqual(constant(header, "kInputType"), "kTfLiteInt8")
+        self.assertEqual(constant(header, "kInputScale"), "0.0078125f")
+        self.assertEqual(constant(header, "kInputZeroPoint"), "-128")
+        self.assertEqual(constant(header, "kModelPath"), '"/apps/test/model.tflite"')
+
+    def test_planned_arena(self):
+        result, header = self.generate(synthetic_model(), "--extra-kb", "0", "--margin-percent", "0")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn(f"Planned: {SYNTHETIC_ACTIVATION_BYTES} B activations and op scratch + "
+                      f"{SYNTHETIC_OVERHEAD_BYTES} B", header)
+        raw = SYNTHETIC_ACTIVATION_BYTES + SYNTHETIC_OVERHEAD_BYTES
+        self.assertEqual(constant(header, "kArenaSize"), str((raw + 1023) // 1024 * 1024))
+
+        result, header = self.generate(synthetic_model(), "--extra-kb", "64", "--margin-percent", "50")
+        raw = (SYNTHETIC_ACTIVATION_BYTES + SYNTHETIC_OVERHEAD_BYTES + 64 * 1024) * 150 // 100
+        self.assertEqual(constant(header, "kArenaSize"), str((raw + 1023) // 1024 * 1024))
+
+    def test_postprocess_scratch_is_planned(self):
+        result, header = self.generate(synthetic_postprocess_model(), "--extra-kb", "0", "--margin-percent", "0")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn(f"Planned: {POSTPROCESS_TENSOR_BYTES + POSTPROCESS_SCRATCH_BYTES} B activations", header)
+
+        # Other custom ops request no scratch the plan knows of
+        result, header = self.generate(synthetic_postprocess_model(custom_op="edgetpu-custom-op"),
+                                       "--extra-kb", "0", "--margin-percent", "0")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn(f"Planned: {POSTPROCESS_TENSOR_BYTES} B activations", header)
+
+    def test_output_directory_is_created(self):
+        model = os.path.join(self.dir.name, "model.tflite")
+        with open(model, "wb") as f:
+            f.write(synthetic_model())
+        output = os.path.join(self.dir.name, "generated", "m7", "model_config_m7.hh")
+        result = run_generator(model, output)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertTrue(os.path.exists(output))
+
+    def test_arena_bytes_pins_the_size(self):
+        result, header = self.generate(synthetic_model(), "--arena-bytes", "1000000")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(constant(header, "kArenaSize"), "1000448")
+        self.assertIn("Set with --arena-bytes (1000000 bytes)", header)
+
+    def test_unchanged_header_is_not_rewritten(self):
+        self.generate(synthetic_model())
+        before = os.stat(self.output).st_mtime_ns
+        os.utime(self.output, ns=(before - 10**9, before - 10**9))
+        self.generate(synthetic_model())
+        self.assertEqual(os.stat(self.output).st_mtime_ns, before - 10**9)
+
+    def test_unknown_custom_op_fails(self):
+        result, header = self.generate(synthetic_model(custom_op="SomeVendorOp"))
+        self.assertNotEqual(result.returncode, 0)
+        self.assertIn("SomeVendorOp", result.stderr)
+        self.assertFalse(os.path.exists(self.output))
+
+    def test_not_a_tflite_file_fails(self):
+        result, header = self.generate(synthetic_model(identifier=b"XXXX"))
+        self.assertNotEqual(result.returncode, 0)
+        self.assertIn("TFL3", result.stderr)
+
+
+@unittest.skipUnless(os.path.exists(DETECTOR_MODEL_FILE), f"{DETECTOR_MODEL_FILE} not present")
+class ShippedModelTest(unittest.TestCase):
+    def test_cmake_arguments(self):
+        with tempfile.TemporaryDirectory() as directory:
+            output = os.path.join(directory, "m7", "model_config_m7.hh")
+            result = run_generator(DETECTOR_MODEL_FILE, output,
+                                   device_path=f"/apps/{PROJECT_NAME}/models/{DETECTOR_MODEL_NAME}")
+            self.assertEqual(result.returncode, 0, result.stderr)
+            with open(output) as f:
+                header = f.read()
+        calls = re.findall(r"if \(\(status = (.+?)\) != kTfLiteOk\)", header)
+        self.assertEqual(calls, ["resolver.AddCustom(kCustomOp, RegisterCustomOp())", "resolver.AddDequantize()",
+                                 "resolver.AddDetectionPostprocess()"])
+        self.assertEqual((constant(header, "kInputHeight"), constant(header, "kInputWidth"),
+                          constant(header, "kInputChannels")), ("300", "300", "3"))
+        self.assertIn("Planned: ", header)
+
+
+if __name__ == "__main__":
+    unittest.main()
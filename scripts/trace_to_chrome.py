@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""Convert the zone profiler trace rings to Chrome trace JSON (chrome://tracing, Perfetto).
+
+Fetches tx_trace_info and one tx_trace_dump per ring over JSON-RPC, or reads a dump saved
+earlier with --save. Each ring carries an anchor (cycle counter + timebase_us read together),
+so the 32-bit cycle stamps are unwrapped backwards from it and all rings share one timeline.
+
+Output tracks:
+  - one thread per task ring with its PROFILE_ZONE begin/end pairs
+  - "cpu": which task was running, from the context switch hook
+  - queue operations as instant events on the task (or "isr") that made them
+
+Usage:
+    trace_to_chrome.py --host 10.10.10.1 -o trace.json [--save dump.json]
+    trace_to_chrome.py --input dump.json -o trace.json
+"""
+
+import argparse
+import base64
+import json
+import struct
+import sys
+import urllib.request
+
+RECORD = struct.Struct("<IIBBH")  # cycles, ref, type, slot, reserved (rpc_task.cc pack_trace_record)
+
+# coralmicro::TraceEvent
+ZONE_BEGIN = 0
+ZONE_END = 1
+TASK_SWITCHED_IN = 2
+QUEUE_EVENTS = {
+    3: "send",
+    4: "receive",
+    5: "peek",
+    6: "send_failed",
+    7: "receive_failed",
+    8: "block_receive",
+}
+
+ISR_SLOT = 0xFF
+PID = 0
+CPU_TID = 1000
+ISR_TID = 1001
+
+
+def rpc(host, method, params=None, request_id=1):
+    body = json.dumps({"id": request_id, "jsonrpc": "2.0", "method": method, "params": params or {}}).encode()
+    req = urllib.request.Request("http://%s/jsonrpc" % host, data=body, headers={"Content-Type": "application/json"})
+    with urllib.request.urlopen(req, timeout=10) as resp:
+        reply = json.loads(resp.read())
+    if "error" in reply:
+        raise RuntimeError("%s failed: %s" % (method, reply["error"]))
+    return reply["result"]
+
+
+def fetch(host):
+    info = rpc(host, "tx_trace_info")
+    rings = [rpc(host, "tx_trace_dump", {"ring": ring["ring"]}, i + 2) for i, ring in enumerate(info["rings"])]
+    return {"info": info, "rings": rings}
+
+
+def decode(dump, cycles_hz):
+    """Records of one ring as (timestamp_us, type, slot, ref), oldest first."""
+    raw = base64.b64decode(dump["records"])
+    records = [RECORD.unpack_from(raw, off) for off in range(0, len(raw) - RECORD.size + 1, RECORD.size)]
+
+    # Walk back from the anchor; each gap is taken mod 2^32, so consecutive
+    # records (and the newest record and the anchor) must be < one wrap apart
+    cycles_per_us = cycles_hz / 1e6
+    later = int(dump["anchor_cycles"])
+    behind = 0
+    out = []
+    for cycles, ref, kind, slot, _ in reversed(records):
+        behind += (later - cycles) & 0xFFFFFFFF
+        later = cycles
+        out.append((dump["anchor_us"] - behind / cycles_per_us, kind, slot, ref))
+    out.reverse()
+    return out
+
+
+def convert(capture):
+    info = capture["info"]
+    cycles_hz = info["cycles_hz"]
+    kernel_ring = info["kernel_ring"]
+    ring_names = {ring["ring"]: ring["name"] for ring in info["rings"]}
+    objects = {obj["ref"]: obj["name"] for obj in info.get("objects", [])}
+
+    events = [{"ph": "M", "pid": PID, "name": "process_name", "args": {"name": "andon m7"}}]
+    for ring, name in ring_names.items():
+        if ring != kernel_ring:
+            events.append({"ph": "M", "pid": PID, "tid": ring, "name": "thread_name", "args": {"name": name}})
+    events.append({"ph": "M", "pid": PID, "tid": CPU_TID, "name": "thread_name", "args": {"name": "cpu"}})
+    events.append({"ph": "M", "pid": PID, "tid": ISR_TID, "name": "thread_name", "args": {"name": "isr"}})
+
+    t0 = None
+    for dump in capture["rings"]:
+        records = decode(dump, cycles_hz)
+        if records and (t0 is None or records[0][0] < t0):
+            t0 = records[0][0]
+    t0 = t0 or 0.0
+
+    for dump in capture["rings"]:
+        ring = dump["ring"]
+        records = decode(dump, cycles_hz)
+
+        if ring == kernel_ring:
+            running = None
+            for ts, kind, slot, ref in records:
+                if kind == TASK_SWITCHED_IN:
+                    if running is not None:
+                        events.append({"ph": "X", "pid": PID, "tid": CPU_TID, "ts": running[0] - t0,
+                                       "dur": ts - running[0], "name": ring_names.get(running[1], "task %d" % running[1])})
+                    running = (ts, slot)
+                elif kind in QUEUE_EVENTS:
+                    queue = objects.get(ref, "0x%08x" % ref)
+                    events.append({"ph": "i", "s": "t", "pid": PID, "tid": ISR_TID if slot == ISR_SLOT else slot,
+                                   "ts": ts - t0, "name": "%s %s" % (QUEUE_EVENTS[kind], queue),
+                                   "args": {"queue": queue}})
+            continue
+
+        # Zones nest per task; drop ends whose begin was overwritten and close what's still open
+        names = dump.get("names", {})
+        depth = 0
+        last_ts = None
+        for ts, kind, _, ref in records:
+            name = names.get(str(ref), "0x%08x" % ref)
+            if kind == ZONE_BEGIN:
+                depth += 1
+                events.append({"ph": "B", "pid": PID, "tid": ring, "ts": ts - t0, "name": name})
+            elif kind == ZONE_END and depth > 0:
+                depth -= 1
+                events.append({"ph": "E", "pid": PID, "tid": ring, "ts": ts - t0, "name": name})
+            last_ts = ts
+        for _ in range(depth):
+            events.append({"ph": "E", "pid": PID, "tid": ring, "ts": last_ts - t0})
+
+    return {"traceEvents": events, "displayTimeUnit": "ns",
+            "otherData": {"dropped_tasks": info.get("dropped_tasks", 0),
+                          "dropped_objects": info.get("dropped_objects", 0)}}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--host", help="Device address serving JSON-RPC (e.g. 10.10.10.1)")
+    source.add_argument("--input", help="Dump saved with --save")
+    parser.add_argument("-o", "--output", required=True, help="Chrome trace JSON to write")
+    parser.add_argument("--save", help="Also write the raw RPC dump here (with --host)")
+    args = parser.parse_args()
+
+    if args.host:
+        capture = fetch(args.host)
+        if args.save:
+            with open(args.save, "w") as f:
+                json.dump(capture, f)
+    else:
+        with open(args.input) as f:
+            capture = json.load(f)
+
+    trace = convert(capture)
+    with open(args.output, "w") as f:
+        json.dump(trace, f)
+
+    if not capture["info"].get("kernel_hooks", True):
+        print("Kernel trace hooks are not installed, so no context switches or queue events "
+              "(see README, Tracing)", file=sys.stderr)
+    zones = sum(1 for e in trace["traceEvents"] if e["ph"] == "B")
+    print("Wrote %d events (%d zones) from %d rings to %s" %
+          (len(trace["traceEvents"]), zones, len(capture["rings"]), args.output), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,183 @@
+// approach_predictor.cc
+#include "m7/approach_predictor.hh"
+
+#include <algorithm>
+
+namespace coralmicro {
+
+    namespace {
+        float box_iou(const tensorflow::BBox<float>& a, const tensorflow::BBox<float>& b) {
+            float w = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
+            float h = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
+            if (w <= 0.0f || h <= 0.0f) {
+                return 0.0f;
+            }
+            float overlap = w * h;
+            float area_a = (a.xmax - a.xmin) * (a.ymax - a.ymin);
+            float area_b = (b.xmax - b.xmin) * (b.ymax - b.ymin);
+            return overlap / (area_a + area_b - overlap);
+        }
+    }
+
+    void ApproachPredictor::reset() {
+        *this = ApproachPredictor();
+    }
+
+    void ApproachPredictor::on_detections(const tensorflow::Object* detections, uint8_t count, uint32_t now_ms) {
+        for (Track& track : tracks_) {
+            if (track.live && now_ms - track.last_seen_ms > ApproachConfig::kTrackTimeoutMs) {
+                track.live = false;
+            }
+        }
+
+        count = static_cast<uint8_t>(std::min<size_t>(count, ApproachConfig::kMaxTracks));
+        bool claimed[ApproachConfig::kMaxTracks] = {};
+        for (uint8_t d = 0; d < count; d++) {
+            // Best overlapping track nobody in this result took yet (a handful of boxes, so greedy)
+            int8_t best = -1;
+            float best_iou = ApproachConfig::kMatchIou;
+            for (size_t t = 0; t < ApproachConfig::kMaxTracks; t++) {
+                if (!tracks_[t].live || claimed[t]) {
+                    continue;
+                }
+                float overlap = box_iou(detections[d].bbox, tracks_[t].bbox);
+                if (overlap >= best_iou) {
+                    best_iou = overlap;
+                    best = static_cast<int8_t>(t);
+                }
+            }
+
+            // Nobody to continue: a new track in a free slot, else in place of the stalest
+            if (best < 0) {
+                size_t slot = 0;
+                for (size_t t = 0; t < ApproachConfig::kMaxTracks; t++) {
+                    if (claimed[t]) {
+                        continue;
+                    }
+                    if (!tracks_[t].live) {
+                        slot = t;
+                        break;
+                    }
+                    if (claimed[slot] || now_ms - tracks_[t].last_seen_ms > now_ms - tracks_[slot].last_seen_ms) {
+                        slot = t;
+                    }
+                }
+                tracks_[slot] = Track{};
+                tracks_[slot].live = true;
+                best = static_cast<int8_t>(slot);
+            }
+
+            Track& track = tracks_[best];
+            claimed[best] = true;
+            track.bbox = detections[d].bbox;
+            track.last_seen_ms = now_ms;
+            detection_track_[d] = best;
+        }
+        detection_count_ = count;
+    }
+
+    void ApproachPredictor::on_depths(const float* depths, const float* threshold_mm, uint8_t count,
+                                      uint32_t sample_ms) {
+        count = std::min(count, detection_count_);
+        for (uint8_t d = 0; d < count; d++) {
+            if (depths[d] < 0.0f || detection_track_[d] < 0) {
+                continue;
+            }
+            Track& track = tracks_[detection_track_[d]];
+            if (!track.live) {
+                continue;
+            }
+            track.threshold_mm = threshold_mm[d];
+
+            // A new box over the same ToF frame replaces that frame's sample
+            uint8_t newest = track.next == 0 ? ApproachConfig::kHistory - 1 : track.next - 1;
+            if (track.samples > 0 && track.sample_ms[newest] == sample_ms) {
+                track.depth_mm[newest] = depths[d];
+            }
+            else {
+                track.sample_ms[track.next] = sample_ms;
+                track.depth_mm[track.next] = depths[d];
+                track.next = track.next + 1 == ApproachConfig::kHistory ? 0 : track.next + 1;
+                if (track.samples < ApproachConfig::kHistory) {
+                    track.samples++;
+                }
+            }
+            fit(track);
+        }
+    }
+
+    void ApproachPredictor::fit(Track& track) {
+        track.fitted = false;
+        if (track.samples < ApproachConfig::kMinSamples) {
+            return;
+        }
+        uint8_t index = track.next == 0 ? ApproachConfig::kHistory - 1 : track.next - 1;
+        uint32_t t0 = track.sample_ms[index];
+
+        // Newest to oldest, times relative to the newest sample keep the sums small
+        float n = 0.0f, sum_t = 0.0f, sum_d = 0.0f, sum_tt = 0.0f, sum_td = 0.0f;
+        uint32_t span_ms = 0;
+        for (uint8_t i = 0; i < track.samples; i++) {
+            uint32_t age_ms = t0 - track.sample_ms[index];
+            if (age_ms > ApproachConfig::kWindowMs) {
+                break;
+            }
+            float t = -static_cast<float>(age_ms); // ms
+            float d = track.depth_mm[index];
+            n += 1.0f;
+            sum_t += t;
+            sum_d += d;
+            sum_tt += t * t;
+            sum_td += t * d;
+            span_ms = age_ms;
+            index = index == 0 ? ApproachConfig::kHistory - 1 : index - 1;
+        }
+        float denominator = n * sum_tt - sum_t * sum_t;
+        if (n < ApproachConfig::kMinSamples || span_ms < ApproachConfig::kMinSpanMs || denominator <= 0.0f) {
+            return;
+        }
+
+        float slope = (n * sum_td - sum_t * sum_d) / denominator; // mm/ms, negative while closing in
+        track.fit_depth_mm = (sum_d - slope * sum_t) / n;         // At the newest sample (t = 0)
+        track.fit_speed_mm_s = -slope * 1000.0f;
+        track.fit_ms = t0;
+        track.fitted = true;
+    }
+
+    ApproachPrediction ApproachPredictor::predict(const ApproachParams& params, uint32_t now_ms) const {
+        ApproachPrediction soonest{false, UINT32_MAX, 0.0f, -1.0f};
+        if (!params.enabled) {
+            return soonest;
+        }
+
+        for (const Track& track : tracks_) {
+            if (!track.live || !track.fitted || track.threshold_mm <= 0.0f) {
+                continue;
+            }
+            float speed_mm_s = track.fit_speed_mm_s;
+            if (speed_mm_s < params.min_speed_mm_s || speed_mm_s > ApproachConfig::kMaxSpeedMmS) {
+                continue;
+            }
+
+            // Carried forward from the newest sample to now. A ToF frame published after the
+            // caller read its clock is newer than now_ms; that counts as no time elapsed
+            int32_t elapsed_ms = std::max(static_cast<int32_t>(now_ms - track.fit_ms), static_cast<int32_t>(0));
+            float elapsed_s = static_cast<float>(elapsed_ms) / 1000.0f;
+            float depth_now = track.fit_depth_mm - speed_mm_s * elapsed_s;
+            float remaining_s = (depth_now - track.threshold_mm) / speed_mm_s;
+            uint32_t time_ms = remaining_s <= 0.0f ? 0u : static_cast<uint32_t>(remaining_s * 1000.0f);
+            if (!soonest.approaching || time_ms < soonest.time_to_threshold_ms) {
+                soonest = ApproachPrediction{true, time_ms, speed_mm_s, depth_now};
+            }
+        }
+        return soonest;
+    }
+
+    size_t ApproachPredictor::track_count() const {
+        size_t count = 0;
+        for (const Track& track : tracks_) {
+            count += track.live ? 1 : 0;
+        }
+        return count;
+    }
+}
@@ -0,0 +1,106 @@
+// boot.cc
+#include "m7/boot.hh"
+
+#include <cstdio>
+
+#include "third_party/freertos_kernel/include/task.h"
+
+#include "m7/timebase.hh"
+
+namespace coralmicro {
+
+    namespace {
+        EventGroupHandle_t g_boot_events = nullptr;
+
+        // 0 is "not reached", so a stamp taken in the first microsecond is nudged to 1
+        uint32_t boot_stamp() {
+            uint32_t now = static_cast<uint32_t>(timebase_us());
+            return now == 0 ? 1 : now;
+        }
+
+        void boot_worker(void* parameters) {
+            const BootBranch* branch = static_cast<const BootBranch*>(parameters);
+
+            if (branch->run()) {
+                xEventGroupSetBits(g_boot_events, branch->provides);
+            }
+            else {
+                printf("ERROR: Boot branch %s failed\r\n", branch->name);
+                xEventGroupSetBits(g_boot_events, branch->provides << kBootFailedShift);
+            }
+
+            vTaskDelete(nullptr);
+        }
+    }
+
+    bool boot_init() {
+        g_boot_events = xEventGroupCreate();
+        g_boot_stats.scheduler_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+        return g_boot_events != nullptr;
+    }
+
+    bool boot_start(const BootBranch* branches, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            if (xTaskCreate(boot_worker, branches[i].name, BootConfig::kWorkerStackSize,
+                            const_cast<BootBranch*>(&branches[i]), BootConfig::kWorkerPriority, nullptr) != pdPASS) {
+                printf("Failed to create boot worker: %s\r\n", branches[i].name);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool boot_wait(uint32_t resources) {
+        uint32_t failed = resources << kBootFailedShift;
+        while (true) {
+            EventBits_t bits = xEventGroupWaitBits(g_boot_events, resources | failed, pdFALSE, pdFALSE, portMAX_DELAY);
+            if (bits & failed) {
+                return false;
+            }
+            if ((bits & resources) == resources) {
+                return true;
+            }
+            // Narrow the mask to what is still pending so the wait doesn't return on bits already set
+            resources &= ~static_cast<uint32_t>(bits);
+            failed = resources << kBootFailedShift;
+        }
+    }
+
+    void boot_phase_begin(BootPhase phase) {
+        g_boot_stats.phases[static_cast<size_t>(phase)].start_us = boot_stamp();
+    }
+
+    void boot_phase_end(BootPhase phase) {
+        g_boot_stats.phases[static_cast<size_t>(phase)].end_us = boot_stamp();
+    }
+
+    void boot_first_decision(SystemState state) {
+        if (g_boot_stats.phases[static_cast<size_t>(BootPhase::kFirstDecision)].end_us.load() != 0) {
+            return;
+        }
+        g_boot_stats.first_state = static_cast<int>(state);
+        boot_phase_end(BootPhase::kFirstDecision);
+        xEventGroupSetBits(g_boot_events, kBootDecision);
+    }
+
+    void boot_report() {
+        printf("Boot timeline (ms since timebase start, scheduler up %lu ms before it):\r\n",
+               static_cast<unsigned long>(g_boot_stats.scheduler_ms.load()));
+        for (size_t i = 0; i < kBootPhaseCount; i++) {
+            const BootPhaseTiming& phase = g_boot_stats.phases[i];
+            uint32_t start = phase.start_us.load();
+            uint32_t end = phase.end_us.load();
+            if (end == 0) {
+                printf("  %-20s not reached\r\n", kBootPhaseNames[i]);
+            }
+            else if (start == 0) {
+                printf("  %-20s at %7.1f\r\n", kBootPhaseNames[i], end / 1000.0);
+            }
+            else {
+                printf("  %-20s %7.1f -> %7.1f (%.1f)\r\n", kBootPhaseNames[i],
+                       start / 1000.0, end / 1000.0, (end - start) / 1000.0);
+            }
+        }
+        printf("First decision: state %d\r\n", g_boot_stats.first_state.load());
+    }
+}
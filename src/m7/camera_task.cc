@@ -1,30 +1,131 @@
 // camera_task.cc
 #include "m7/camera_task.hh"
 
+#include <cstdlib>
+
 namespace coralmicro {
 
 bool first_frame_captured_flag = false;
 
-void camera_task(void* parameters) {
-    (void)parameters;
-    printf("Camera task starting...\r\n");
+namespace {
+    constexpr ConvertFilter convert_filter(CameraFilterMethod filter) {
+        return filter == CameraFilterMethod::kNearestNeighbor ? ConvertFilter::kNearest : ConvertFilter::kBilinear;
+    }
 
+    constexpr ConvertRotation convert_rotation(CameraRotation rotation) {
+        switch (rotation) {
+            case CameraRotation::k90: return ConvertRotation::k90;
+            case CameraRotation::k180: return ConvertRotation::k180;
+            case CameraRotation::k270: return ConvertRotation::k270;
+            default: return ConvertRotation::k0;
+        }
+    }
+
+    // Raw frame -> model input in one pass, timed with the DWT cycle counter
+    bool convert_frame(const std::vector<uint8_t>& raw, uint8_t* rgb) {
+        PROFILE_ZONE("camera_convert");
+        RawConvertParams params{
+            raw.data(),
+            static_cast<uint32_t>(CameraTask::kWidth),
+            static_cast<uint32_t>(CameraTask::kHeight),
+            CameraConfig::kBayerPattern,
+            rgb,
+            CameraConfig::kWidth,
+            CameraConfig::kHeight,
+            convert_filter(CameraConfig::filter),
+            convert_rotation(CameraConfig::rotation),
+            CameraConfig::preserve_ratio
+        };
+
+        uint32_t start = cycle_counter_read();
+        bool ok = convert_raw_frame(params);
+        uint32_t cycles = cycle_counter_read() - start;
+
+        if (ok) {
+            uint32_t avg = g_camera_stats.conversion_cycles_avg.load();
+            avg = (avg == 0) ? cycles : avg - (avg >> 4) + (cycles >> 4);
+            g_camera_stats.conversion_cycles_avg = avg;
+            g_camera_stats.conversion_cycles_last = cycles;
+            if (cycles > g_camera_stats.conversion_cycles_max.load()) {
+                g_camera_stats.conversion_cycles_max = cycles;
+            }
+        }
+        return ok;
+    }
+}
+
+bool camera_power_up() {
     // Initialize camera with proper error checking
     if (!CameraTask::GetSingleton()->SetPower(true)) {
         printf("Failed to power on camera\r\n");
-        vTaskSuspend(nullptr);
-        return;
+        return false;
     }
 
     if (!CameraTask::GetSingleton()->Enable(CameraMode::kStreaming)) {
         printf("Failed to enable camera streaming\r\n");
+        return false;
+    }
+    return true;
+}
+
+// Replaces a fixed 100-frame discard: stop as soon as the exposure has converged
+bool camera_warmup() {
+    static uint8_t probe[CameraWarmupConfig::kProbeWidth * CameraWarmupConfig::kProbeHeight];
+
+    CameraFrameFormat fmt{
+        CameraFormat::kY8,
+        CameraFilterMethod::kBilinear,
+        CameraRotation::k0,
+        CameraWarmupConfig::kProbeWidth,
+        CameraWarmupConfig::kProbeHeight,
+        false,
+        probe,
+        CameraConfig::auto_white_balance
+    };
+
+    int32_t last_mean = -1;
+    uint32_t settled = 0;
+    uint32_t frames = 0;
+    while (frames < CameraWarmupConfig::kMaxFrames) {
+        frames++;
+        if (!CameraTask::GetSingleton()->GetFrame({fmt})) {
+            settled = 0;
+            continue;
+        }
+
+        uint32_t sum = 0;
+        for (uint8_t value : probe) {
+            sum += value;
+        }
+        int32_t mean = static_cast<int32_t>(sum / sizeof(probe));
+
+        uint32_t delta = (last_mean < 0) ? UINT32_MAX : static_cast<uint32_t>(std::abs(mean - last_mean));
+        settled = (delta <= CameraWarmupConfig::kSettleDelta) ? settled + 1 : 0;
+        last_mean = mean;
+
+        if (frames >= CameraWarmupConfig::kMinFrames && settled >= CameraWarmupConfig::kSettleFrames) {
+            break;
+        }
+    }
+
+    // Not settling within kMaxFrames isn't fatal, frames are usable, just as after the old discard
+    g_camera_stats.warmup_frames = frames;
+    printf("Camera warmup: %lu frames\r\n", static_cast<unsigned long>(frames));
+    return true;
+}
+
+void camera_task(void* parameters) {
+    (void)parameters;
+    printf("Camera task starting...\r\n");
+    trace_register_task();
+
+    // Powered, streaming and warmed up by the boot camera branch
+    if (!boot_wait(kBootCamera)) {
+        printf("Camera not available\r\n");
         vTaskSuspend(nullptr);
         return;
     }
 
-    // Discard initial frames to allow auto-exposure calibration
-    CameraTask::GetSingleton()->DiscardFrames(100);
-
     // Create two alternating buffers to ensure data consistency
     std::shared_ptr<std::vector<uint8_t>> buffer1 = std::make_shared<std::vector<uint8_t>>();
     std::shared_ptr<std::vector<uint8_t>> buffer2 = std::make_shared<std::vector<uint8_t>>();
@@ -36,6 +137,13 @@ void camera_task(void* parameters) {
     buffer2->resize(buffer_size);
     
     std::shared_ptr<std::vector<uint8_t>> current_buffer = buffer1;
+
+    // Raw sensor frame for the fused conversion path
+    std::vector<uint8_t> raw_buffer;
+    if (CameraConfig::kFusedConversion) {
+        raw_buffer.resize(CameraTask::kWidth * CameraTask::kHeight);
+        cycle_counter_init();
+    }
     
     CameraData camera_data;
     camera_data.width = CameraConfig::kWidth;
@@ -46,33 +154,65 @@ void camera_task(void* parameters) {
     TickType_t last_wake_time = xTaskGetTickCount();
     const TickType_t capture_period = pdMS_TO_TICKS(10);
 
+    register_stage(Stage::kCamera);
+
     while (true) {
-        // Setup frame format with current buffer
-        CameraFrameFormat fmt{
-            camera_data.format,
-            CameraConfig::filter,
-            CameraConfig::rotation,
-            static_cast<int>(camera_data.width),
-            static_cast<int>(camera_data.height),
-            CameraConfig::preserve_ratio,
-            current_buffer->data(),
-            CameraConfig::auto_white_balance
-        };
+        bool frame_ready = false;
+
+        if (CameraConfig::kFusedConversion) {
+            // Raw frames skip the SDK's format, rotation and resize steps
+            CameraFrameFormat raw_fmt{
+                CameraFormat::kRaw,
+                CameraConfig::filter,
+                CameraRotation::k0,
+                CameraTask::kWidth,
+                CameraTask::kHeight,
+                false,
+                raw_buffer.data(),
+                CameraConfig::auto_white_balance
+            };
+
+            frame_ready = CameraTask::GetSingleton()->GetFrame({raw_fmt}) &&
+                          convert_frame(raw_buffer, current_buffer->data());
+        }
+        else {
+            // Setup frame format with current buffer
+            CameraFrameFormat fmt{
+                camera_data.format,
+                CameraConfig::filter,
+                CameraConfig::rotation,
+                static_cast<int>(camera_data.width),
+                static_cast<int>(camera_data.height),
+                CameraConfig::preserve_ratio,
+                current_buffer->data(),
+                CameraConfig::auto_white_balance
+            };
+
+            frame_ready = CameraTask::GetSingleton()->GetFrame({fmt});
+        }
 
-        if (CameraTask::GetSingleton()->GetFrame({fmt})) {
-            camera_data.timestamp_ms =  xTaskGetTickCount() * (1000/configTICK_RATE_HZ);
+        if (frame_ready) {
+            g_camera_stats.frames_captured++;
+            metric_inc<Metric::kCameraFramesCaptured>();
+            boot_milestone(BootPhase::kFirstCameraFrame);
+            camera_data.timestamp_us = timebase_us();
 
             camera_data.image_data = current_buffer;  // Assign current buffer
             
             // Send to queue
-            if (xQueueOverwrite(g_camera_queue_m7, &camera_data) == pdTRUE) {
+            if (channel_overwrite(Channel::kCamera, &camera_data)) {
                 // Switch buffers only after successful queue write
                 current_buffer = (current_buffer == buffer1) ? buffer2 : buffer1;
             }
         }
-        
-        // Use vTaskDelayUntil for consistent frame timing
-        vTaskDelayUntil(&last_wake_time, capture_period);
+        else {
+            metric_inc<Metric::kCameraFramesDropped>();
+        }
+
+        stage_complete(Stage::kCamera);
+
+        // Use vTaskDelayUntil for consistent frame timing (or wait for the executive)
+        wait_for_release(Stage::kCamera, &last_wake_time, capture_period);
     }
 }
 
@@ -0,0 +1,48 @@
+// cascade_gate.cc
+#include "m7/cascade_gate.hh"
+
+namespace coralmicro {
+
+    CascadeDecision CascadePolicy::decide(float gate_score, float fire_threshold, uint32_t refresh_ms, uint32_t now_ms) {
+        gate_runs_++;
+
+        if (gate_score >= fire_threshold) {
+            gate_fires_++;
+            return CascadeDecision::kGateFired;
+        }
+
+        if (tracking_) {
+            return CascadeDecision::kTracking;
+        }
+
+        if (!detector_has_run_ || (now_ms - last_detector_ms_) >= refresh_ms) {
+            refreshes_++;
+            return CascadeDecision::kRefresh;
+        }
+
+        skips_++;
+        return CascadeDecision::kSkip;
+    }
+
+    void CascadePolicy::on_detector_result(CascadeDecision decision, bool person_detected, uint32_t now_ms) {
+        if (decision == CascadeDecision::kSkip) {
+            return;
+        }
+
+        detector_has_run_ = true;
+        last_detector_ms_ = now_ms;
+        tracking_ = person_detected;
+
+        if (decision == CascadeDecision::kGateFired) {
+            if (person_detected) {
+                hits_++;
+            }
+            else {
+                false_alarms_++;
+            }
+        }
+        else if (person_detected) {
+            misses_++;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+// channel_stats.cc
+#include "m7/channel_stats.hh"
+
+#include <cstring>
+#include <memory>
+
+#include "m7/timebase.hh"
+
+namespace coralmicro {
+
+    namespace {
+        struct ChannelState {
+            QueueHandle_t queue = nullptr;
+            size_t item_size = 0;
+            std::unique_ptr<uint8_t[]> write_buffer; // Payload then stamp, as queued
+            std::unique_ptr<uint8_t[]> read_buffer;
+        };
+
+        ChannelState g_channels[kChannelCount];
+
+        void record_age(ChannelStats& stats, uint32_t age_us) {
+            uint32_t avg = stats.age_us_avg.load();
+            avg = (avg == 0) ? age_us : avg - (avg >> 4) + (age_us >> 4);
+            stats.age_us_avg = avg;
+            stats.age_us_last = age_us;
+            if (age_us > stats.age_us_max.load()) {
+                stats.age_us_max = age_us;
+            }
+        }
+    }
+
+    QueueHandle_t channel_create(Channel channel, size_t item_size) {
+        ChannelState& state = g_channels[static_cast<size_t>(channel)];
+        if (!ChannelConfig::kEnabled) {
+            state.queue = xQueueCreate(1, item_size);
+            return state.queue;
+        }
+
+        size_t queued_size = item_size + sizeof(uint64_t);
+        state.item_size = item_size;
+        state.write_buffer = std::make_unique<uint8_t[]>(queued_size);
+        state.read_buffer = std::make_unique<uint8_t[]>(queued_size);
+        state.queue = xQueueCreate(1, queued_size);
+        return state.queue;
+    }
+
+    bool channel_overwrite(Channel channel, const void* item) {
+        ChannelState& state = g_channels[static_cast<size_t>(channel)];
+        if (!ChannelConfig::kEnabled) {
+            return xQueueOverwrite(state.queue, item) == pdTRUE;
+        }
+
+        uint64_t now_us = timebase_us();
+        memcpy(state.write_buffer.get(), item, state.item_size);
+        memcpy(state.write_buffer.get() + state.item_size, &now_us, sizeof(now_us));
+
+        // A reader taking the sample right after this check still counts it as overwritten
+        bool unread = uxQueueMessagesWaiting(state.queue) != 0;
+        bool written = xQueueOverwrite(state.queue, state.write_buffer.get()) == pdTRUE;
+
+        ChannelStats& stats = g_channel_stats[static_cast<size_t>(channel)];
+        stats.writes++;
+        if (unread) {
+            stats.overwrites++;
+        }
+        return written;
+    }
+
+    bool channel_receive(Channel channel, void* item, TickType_t ticks) {
+        ChannelState& state = g_channels[static_cast<size_t>(channel)];
+        if (!ChannelConfig::kEnabled) {
+            return xQueueReceive(state.queue, item, ticks) == pdTRUE;
+        }
+
+        ChannelStats& stats = g_channel_stats[static_cast<size_t>(channel)];
+        if (xQueueReceive(state.queue, state.read_buffer.get(), ticks) != pdTRUE) {
+            stats.empty_reads++;
+            return false;
+        }
+
+        uint64_t written_us;
+        memcpy(item, state.read_buffer.get(), state.item_size);
+        memcpy(&written_us, state.read_buffer.get() + state.item_size, sizeof(written_us));
+
+        stats.reads++;
+        record_age(stats, static_cast<uint32_t>(timebase_us() - written_us));
+        return true;
+    }
+
+    bool channel_peek(Channel channel, void* item, TickType_t ticks) {
+        ChannelState& state = g_channels[static_cast<size_t>(channel)];
+        if (!ChannelConfig::kEnabled) {
+            return xQueuePeek(state.queue, item, ticks) == pdTRUE;
+        }
+
+        ChannelStats& stats = g_channel_stats[static_cast<size_t>(channel)];
+        if (xQueuePeek(state.queue, state.read_buffer.get(), ticks) != pdTRUE) {
+            stats.empty_reads++;
+            return false;
+        }
+
+        memcpy(item, state.read_buffer.get(), state.item_size);
+        stats.peeks++;
+        return true;
+    }
+}
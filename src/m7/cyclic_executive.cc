@@ -0,0 +1,63 @@
+// cyclic_executive.cc
+#include "m7/cyclic_executive.hh"
+
+namespace coralmicro {
+
+    namespace {
+        void release(Stage stage, uint32_t frame) {
+            size_t idx = static_cast<size_t>(stage);
+            TaskHandle_t handle = g_stage_task_handles[idx];
+            if (handle == nullptr) {
+                return; // Stage not started yet
+            }
+
+            g_stage_release_frame[idx].store(frame);
+            xTaskNotify(handle, kStageReleaseBit, eSetBits);
+        }
+    }
+
+    void stage_complete(Stage stage) {
+        if (!g_use_cyclic_executive) {
+            return;
+        }
+
+        // Gate chained consumers on the frame their producer was released in,
+        // so a long-running producer doesn't shift its consumers' phase
+        uint32_t frame = g_stage_release_frame[static_cast<size_t>(stage)].load();
+
+        for (const auto& slot : kCyclicSchedule) {
+            if (chained_released(slot, stage, frame)) {
+                release(slot.stage, frame);
+            }
+        }
+    }
+
+    void cyclic_executive_task(void* parameters) {
+        (void)parameters;
+
+        if (!g_use_cyclic_executive) {
+            vTaskDelete(nullptr);
+            return;
+        }
+
+        printf("Cyclic executive starting (minor %lu ms, major %lu ms, staleness bound %lu ms)...\r\n",
+            static_cast<unsigned long>(CyclicConfig::kMinorFrameMs),
+            static_cast<unsigned long>(CyclicConfig::kMajorFrameMs),
+            static_cast<unsigned long>(worst_case_staleness_ms(Stage::kStateController)));
+
+        TickType_t last_wake_time = xTaskGetTickCount();
+        const TickType_t minor_frame = pdMS_TO_TICKS(CyclicConfig::kMinorFrameMs);
+
+        while (true) {
+            uint32_t frame = g_cyclic_frame.fetch_add(1) % CyclicConfig::kFramesPerMajor;
+
+            for (const auto& slot : kCyclicSchedule) {
+                if (head_released(slot, frame)) {
+                    release(slot.stage, frame);
+                }
+            }
+
+            vTaskDelayUntil(&last_wake_time, minor_frame);
+        }
+    }
+}
@@ -0,0 +1,223 @@
+// danger_zones.cc
+#include "m7/danger_zones.hh"
+
+#include <algorithm>
+
+namespace coralmicro {
+
+    namespace {
+        float cross(float ax, float ay, float bx, float by, float cx, float cy) {
+            return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+        }
+
+        // Closed segments, touching counts
+        bool segments_meet(float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy) {
+            if (std::max(ax, bx) < std::min(cx, dx) || std::max(cx, dx) < std::min(ax, bx) ||
+                std::max(ay, by) < std::min(cy, dy) || std::max(cy, dy) < std::min(ay, by)) {
+                return false;
+            }
+            float d1 = cross(ax, ay, bx, by, cx, cy);
+            float d2 = cross(ax, ay, bx, by, dx, dy);
+            float d3 = cross(cx, cy, dx, dy, ax, ay);
+            float d4 = cross(cx, cy, dx, dy, bx, by);
+            return d1 * d2 <= 0.0f && d3 * d4 <= 0.0f;
+        }
+
+        // Even-odd rule
+        bool point_in_zone(float x, float y, const DangerZone& zone) {
+            bool inside = false;
+            for (uint8_t i = 0, j = zone.vertex_count - 1; i < zone.vertex_count; j = i++) {
+                float xi = zone.vertices[i].x, yi = zone.vertices[i].y;
+                float xj = zone.vertices[j].x, yj = zone.vertices[j].y;
+                if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi) {
+                    inside = !inside;
+                }
+            }
+            return inside;
+        }
+
+        // The polygon and the rectangle share any point: a corner of one inside the other, or crossing edges
+        bool zone_touches_rect(const DangerZone& zone, float x0, float y0, float x1, float y1) {
+            if (point_in_zone(x0, y0, zone) || point_in_zone(x1, y0, zone) ||
+                point_in_zone(x0, y1, zone) || point_in_zone(x1, y1, zone)) {
+                return true;
+            }
+            for (uint8_t i = 0, j = zone.vertex_count - 1; i < zone.vertex_count; j = i++) {
+                float ax = zone.vertices[j].x, ay = zone.vertices[j].y;
+                float bx = zone.vertices[i].x, by = zone.vertices[i].y;
+                if (bx >= x0 && bx <= x1 && by >= y0 && by <= y1) {
+                    return true;
+                }
+                if (segments_meet(ax, ay, bx, by, x0, y0, x1, y0) || segments_meet(ax, ay, bx, by, x1, y0, x1, y1) ||
+                    segments_meet(ax, ay, bx, by, x1, y1, x0, y1) || segments_meet(ax, ay, bx, by, x0, y1, x0, y0)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        float doubled_area(const DangerZone& zone) {
+            float area = 0.0f;
+            for (uint8_t i = 0, j = zone.vertex_count - 1; i < zone.vertex_count; j = i++) {
+                area += static_cast<float>(zone.vertices[j].x) * zone.vertices[i].y -
+                        static_cast<float>(zone.vertices[i].x) * zone.vertices[j].y;
+            }
+            return area < 0.0f ? -area : area;
+        }
+
+        // Box edges clamped into the cell regions' range, truncated as depth_estimation() does
+        uint16_t to_pixel(float value) {
+            return static_cast<uint16_t>(std::min(std::max(static_cast<int>(value), 0), static_cast<int>(UINT16_MAX)));
+        }
+    }
+
+    bool DangerZoneSet::operator==(const DangerZoneSet& other) const {
+        if (count != other.count) {
+            return false;
+        }
+        for (uint8_t z = 0; z < count; z++) {
+            const DangerZone& a = zones[z];
+            const DangerZone& b = other.zones[z];
+            if (a.stop_mm != b.stop_mm || a.warning_mm != b.warning_mm || a.vertex_count != b.vertex_count) {
+                return false;
+            }
+            for (uint8_t v = 0; v < a.vertex_count; v++) {
+                if (a.vertices[v].x != b.vertices[v].x || a.vertices[v].y != b.vertices[v].y) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    DangerZoneSet default_danger_zones() {
+        DangerZoneSet set = {};
+        set.count = 1;
+        set.zones[0].stop_mm = DangerZoneConfig::kDefaultStopMm;
+        set.zones[0].warning_mm = DangerZoneConfig::kUnlimitedMm;
+        set.zones[0].vertex_count = 4;
+        set.zones[0].vertices[0] = {0, 0};
+        set.zones[0].vertices[1] = {DangerZoneConfig::kFullFrame, 0};
+        set.zones[0].vertices[2] = {DangerZoneConfig::kFullFrame, DangerZoneConfig::kFullFrame};
+        set.zones[0].vertices[3] = {0, DangerZoneConfig::kFullFrame};
+        return set;
+    }
+
+    const char* danger_zones_error(const DangerZoneSet& set) {
+        // Without a zone nobody would ever be stopped for
+        if (set.count == 0) {
+            return "At least one zone is needed";
+        }
+        if (set.count > DangerZoneConfig::kMaxZones) {
+            return "Too many zones";
+        }
+        for (uint8_t z = 0; z < set.count; z++) {
+            const DangerZone& zone = set.zones[z];
+            if (zone.vertex_count < 3 || zone.vertex_count > DangerZoneConfig::kMaxVertices) {
+                return "A zone polygon has too few or too many vertices";
+            }
+            if (doubled_area(zone) <= 0.0f) {
+                return "A zone polygon has no area";
+            }
+            if (!(zone.stop_mm > 0.0f) || zone.stop_mm > DangerZoneConfig::kUnlimitedMm) {
+                return "stop_mm must be positive";
+            }
+            if (!(zone.warning_mm >= zone.stop_mm) || zone.warning_mm > DangerZoneConfig::kUnlimitedMm) {
+                return "warning_mm must not be below stop_mm";
+            }
+        }
+        return nullptr;
+    }
+
+    void DangerZoneMap::compile(const DangerZoneSet& set) {
+        zones_ = set;
+
+        uncovered_ = ZoneLimits{set.count > 0, -1, 0.0f, 0.0f};
+        x_min_ = y_min_ = static_cast<float>(UINT16_MAX);
+        x_max_ = y_max_ = 0.0f;
+        for (uint8_t z = 0; z < set.count; z++) {
+            const DangerZone& zone = set.zones[z];
+            if (zone.stop_mm > uncovered_.stop_mm) {
+                uncovered_.stop_mm = zone.stop_mm;
+                uncovered_.stop_zone = static_cast<int8_t>(z);
+            }
+            uncovered_.warning_mm = std::max(uncovered_.warning_mm, zone.warning_mm);
+            for (uint8_t v = 0; v < zone.vertex_count; v++) {
+                x_min_ = std::min(x_min_, static_cast<float>(zone.vertices[v].x));
+                y_min_ = std::min(y_min_, static_cast<float>(zone.vertices[v].y));
+                x_max_ = std::max(x_max_, static_cast<float>(zone.vertices[v].x));
+                y_max_ = std::max(y_max_, static_cast<float>(zone.vertices[v].y));
+            }
+        }
+
+        for (size_t sensor = 0; sensor < kTofSensorCount; sensor++) {
+            for (size_t z = 0; z < DangerZoneConfig::kMaxZones; z++) {
+                zone_cells_[z][sensor] = 0;
+            }
+            for (uint8_t cell = 0; cell < kTofCellCount; cell++) {
+                const TofCellRegion& region = kTofSensors[sensor].cell_regions[cell];
+                cell_stop_mm_[sensor][cell] = 0.0f;
+                cell_warning_mm_[sensor][cell] = 0.0f;
+                cell_stop_zone_[sensor][cell] = -1;
+
+                for (uint8_t z = 0; z < set.count; z++) {
+                    const DangerZone& zone = set.zones[z];
+                    if (!zone_touches_rect(zone, region.x_min, region.y_min, region.x_max, region.y_max)) {
+                        continue;
+                    }
+                    zone_cells_[z][sensor] |= (1u << cell);
+
+                    // A cell several zones cover takes the strictest of each limit: the
+                    // longest distance, which stops or warns first
+                    if (cell_stop_zone_[sensor][cell] < 0) {
+                        cell_stop_mm_[sensor][cell] = zone.stop_mm;
+                        cell_warning_mm_[sensor][cell] = zone.warning_mm;
+                        cell_stop_zone_[sensor][cell] = static_cast<int8_t>(z);
+                        continue;
+                    }
+                    if (zone.stop_mm > cell_stop_mm_[sensor][cell]) {
+                        cell_stop_mm_[sensor][cell] = zone.stop_mm;
+                        cell_stop_zone_[sensor][cell] = static_cast<int8_t>(z);
+                    }
+                    cell_warning_mm_[sensor][cell] = std::max(cell_warning_mm_[sensor][cell], zone.warning_mm);
+                }
+            }
+        }
+    }
+
+    ZoneLimits DangerZoneMap::lookup(const tensorflow::BBox<float>& bbox) const {
+        uint16_t x_min = to_pixel(bbox.xmin), y_min = to_pixel(bbox.ymin);
+        uint16_t x_max = to_pixel(bbox.xmax), y_max = to_pixel(bbox.ymax);
+
+        ZoneLimits limits{false, -1, 0.0f, 0.0f};
+        bool seen = false;
+        for (size_t sensor = 0; sensor < kTofSensorCount; sensor++) {
+            const TofCellRegion* regions = kTofSensors[sensor].cell_regions;
+            for (uint8_t cell = 0; cell < kTofCellCount; cell++) {
+                const TofCellRegion& region = regions[cell];
+                if (!rectangles_overlap(x_min, y_min, x_max, y_max,
+                                        region.x_min, region.y_min, region.x_max, region.y_max)) {
+                    continue;
+                }
+                seen = true;
+                int8_t zone = cell_stop_zone_[sensor][cell];
+                if (zone < 0) {
+                    continue;
+                }
+                if (!limits.in_zone || cell_stop_mm_[sensor][cell] > limits.stop_mm) {
+                    limits.stop_mm = cell_stop_mm_[sensor][cell];
+                    limits.stop_zone = zone;
+                }
+                limits.warning_mm = limits.in_zone ? std::max(limits.warning_mm, cell_warning_mm_[sensor][cell])
+                                                   : cell_warning_mm_[sensor][cell];
+                limits.in_zone = true;
+            }
+        }
+
+        // No depth can be measured there; fail safe wherever a zone might reach
+        if (!seen && bbox.xmax >= x_min_ && bbox.xmin <= x_max_ && bbox.ymax >= y_min_ && bbox.ymin <= y_max_) {
+            return uncovered_;
+        }
+        return limits;
+    }
+}
@@ -0,0 +1,265 @@
+// deferred_log.cc
+#include "m7/deferred_log.hh"
+
+#include <cstdio>
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/freertos_kernel/include/task.h"
+
+#include "m7/timebase.hh"
+
+namespace coralmicro {
+
+    namespace {
+        // The ring is 32-bit words: a header word, then the payload. Headers are
+        // written with __atomic builtins; a zero header means "reserved, not committed".
+        constexpr uint32_t kRingWords = LogConfig::kRingBytes / 4;
+        constexpr uint32_t kCommitted = (1u << 31);
+        constexpr uint32_t kPadding = (1u << 30);  // Filler to the end of the ring, skipped
+        constexpr uint32_t kLevelShift = 24;
+        constexpr uint32_t kBytesMask = 0xFFFFu;
+
+        alignas(4) uint32_t g_ring[kRingWords];
+        std::atomic<uint32_t> g_reserved{0}; // Words ever reserved
+        std::atomic<uint32_t> g_consumed{0}; // Words ever drained
+
+        constexpr uint32_t words_for(uint32_t payload_bytes) {
+            return 1 + (payload_bytes + 3) / 4;
+        }
+
+        // Binary sink: 0x00, COBS(level, fmt, timestamp_us, args, checksum), 0x00.
+        // Console text never contains 0x00, so the decoder can pick frames out of it.
+        constexpr size_t kFrameBytes = 1 + 4 + 4 + LogConfig::kMaxRecordBytes + 1;
+        constexpr size_t kCobsBytes = kFrameBytes + kFrameBytes / 254 + 3;
+
+        size_t cobs_encode(const uint8_t* in, size_t length, uint8_t* out) {
+            size_t code_at = 0;
+            size_t o = 1;
+            uint8_t code = 1;
+            for (size_t i = 0; i < length; i++) {
+                if (in[i] != 0) {
+                    out[o++] = in[i];
+                    code++;
+                }
+                if (in[i] == 0 || code == 0xFF) {
+                    out[code_at] = code;
+                    code_at = o++;
+                    code = 1;
+                }
+            }
+            out[code_at] = code;
+            return o;
+        }
+
+        void write_binary(LogLevel level, const uint8_t* payload, uint32_t bytes, uint32_t timestamp_us) {
+            static uint8_t frame[kFrameBytes];
+            static uint8_t encoded[kCobsBytes + 2];
+
+            // Payload is fmt, cycle stamp, args; the stamp is replaced by microseconds
+            size_t n = 0;
+            frame[n++] = static_cast<uint8_t>(level);
+            memcpy(frame + n, payload, 4);
+            n += 4;
+            memcpy(frame + n, &timestamp_us, 4);
+            n += 4;
+            memcpy(frame + n, payload + 8, bytes - 8);
+            n += bytes - 8;
+
+            uint8_t checksum = 0;
+            for (size_t i = 0; i < n; i++) {
+                checksum ^= frame[i];
+            }
+            frame[n++] = checksum;
+
+            encoded[0] = 0;
+            size_t length = 1 + cobs_encode(frame, n, encoded + 1);
+            encoded[length++] = 0;
+
+            fwrite(encoded, 1, length, stdout);
+            g_log_stats.drained_bytes += length;
+        }
+
+        // Text sink: replays the arguments through snprintf one conversion at a time
+        void write_text(const uint8_t* payload, uint32_t bytes) {
+            static char line[256];
+
+            uint32_t fmt_id;
+            memcpy(&fmt_id, payload, 4);
+            const char* fmt = reinterpret_cast<const char*>(static_cast<uintptr_t>(fmt_id));
+            const uint8_t* arg = payload + 8;
+            const uint8_t* end = payload + bytes;
+
+            size_t used = 0;
+            for (const char* p = fmt; *p != '\0' && used < sizeof(line) - 1; p++) {
+                if (*p != '%') {
+                    line[used++] = *p;
+                    continue;
+                }
+                if (p[1] == '%') {
+                    line[used++] = '%';
+                    p++;
+                    continue;
+                }
+
+                // Copy the conversion spec without length modifiers, tracking %ll
+                char spec[16];
+                size_t s = 0;
+                int longs = 0;
+                spec[s++] = *p++;
+                while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr && s < sizeof(spec) - 4) {
+                    spec[s++] = *p++;
+                }
+                while (*p == 'h' || *p == 'l' || *p == 'z' || *p == 'j' || *p == 't') {
+                    longs += (*p == 'l') ? 1 : 0;
+                    p++;
+                }
+                char conversion = *p;
+                if (conversion == '\0') {
+                    break;
+                }
+
+                int written = 0;
+                size_t room = sizeof(line) - used;
+                if (conversion == 's') {
+                    uint8_t n = (arg < end) ? *arg++ : 0;
+                    char text[LogConfig::kMaxStringBytes + 1];
+                    memcpy(text, arg, n);
+                    text[n] = '\0';
+                    arg += n;
+                    spec[s++] = 's';
+                    spec[s] = '\0';
+                    written = snprintf(line + used, room, spec, text);
+                }
+                else if (strchr("fFeEgG", conversion) != nullptr) {
+                    float value;
+                    memcpy(&value, arg, 4);
+                    arg += 4;
+                    spec[s++] = conversion;
+                    spec[s] = '\0';
+                    written = snprintf(line + used, room, spec, static_cast<double>(value));
+                }
+                else if (longs >= 2) {
+                    long long value;
+                    memcpy(&value, arg, 8);
+                    arg += 8;
+                    spec[s++] = 'l';
+                    spec[s++] = 'l';
+                    spec[s++] = conversion;
+                    spec[s] = '\0';
+                    written = snprintf(line + used, room, spec, value);
+                }
+                else {
+                    uint32_t value;
+                    memcpy(&value, arg, 4);
+                    arg += 4;
+                    spec[s++] = (conversion == 'p') ? 'x' : conversion;
+                    spec[s] = '\0';
+                    written = snprintf(line + used, room, spec, value);
+                }
+
+                if (written > 0) {
+                    used += (static_cast<size_t>(written) < room) ? static_cast<size_t>(written) : room - 1;
+                }
+            }
+            line[used] = '\0';
+
+            fputs(line, stdout);
+            g_log_stats.drained_bytes += used;
+        }
+    }
+
+    bool log_reserve(size_t payload_bytes, LogSlot* slot) {
+        uint32_t words = words_for(static_cast<uint32_t>(payload_bytes));
+        uint32_t reserved;
+        uint32_t total;
+        uint32_t offset;
+
+        do {
+            reserved = g_reserved.load(std::memory_order_relaxed);
+            offset = reserved & (kRingWords - 1);
+            uint32_t contiguous = kRingWords - offset;
+            // Records never straddle the end; pad to it and start over at 0
+            total = (words <= contiguous) ? words : contiguous + words;
+            if (reserved + total - g_consumed.load(std::memory_order_acquire) > kRingWords) {
+                g_log_stats.dropped++;
+                return false;
+            }
+        } while (!g_reserved.compare_exchange_weak(reserved, reserved + total,
+                                                   std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        if (total != words) {
+            uint32_t pad_words = total - words;
+            __atomic_store_n(&g_ring[offset], kCommitted | kPadding | ((pad_words - 1) * 4), __ATOMIC_RELEASE);
+            offset = 0;
+        }
+
+        slot->index = offset;
+        slot->payload = reinterpret_cast<uint8_t*>(&g_ring[offset + 1]);
+        slot->bytes = static_cast<uint32_t>(payload_bytes);
+        return true;
+    }
+
+    void log_commit(const LogSlot& slot, LogLevel level) {
+        uint32_t header = kCommitted | (static_cast<uint32_t>(level) << kLevelShift) | slot.bytes;
+        __atomic_store_n(&g_ring[slot.index], header, __ATOMIC_RELEASE);
+        g_log_stats.records++;
+    }
+
+    void log_record_cost(uint32_t cycles) {
+        uint32_t avg = g_log_stats.cost_cycles_avg.load();
+        avg = (avg == 0) ? cycles : avg - (avg >> 4) + (cycles >> 4);
+        g_log_stats.cost_cycles_avg = avg;
+        g_log_stats.cost_cycles_last = cycles;
+        if (cycles > g_log_stats.cost_cycles_max.load()) {
+            g_log_stats.cost_cycles_max = cycles;
+        }
+    }
+
+    void log_drain_task(void* parameters) {
+        (void)parameters;
+
+        while (true) {
+            uint32_t consumed = g_consumed.load(std::memory_order_relaxed);
+            bool wrote = false;
+
+            while (consumed != g_reserved.load(std::memory_order_acquire)) {
+                uint32_t offset = consumed & (kRingWords - 1);
+                uint32_t header = __atomic_load_n(&g_ring[offset], __ATOMIC_ACQUIRE);
+                if ((header & kCommitted) == 0) {
+                    break; // Writer still packing, or preempted mid-record; pick it up next round
+                }
+
+                uint32_t bytes = header & kBytesMask;
+                uint32_t words = words_for(bytes);
+
+                if ((header & kPadding) == 0) {
+                    const uint8_t* payload = reinterpret_cast<const uint8_t*>(&g_ring[offset + 1]);
+                    LogLevel level = static_cast<LogLevel>((header >> kLevelShift) & 0x0Fu);
+
+                    if (LogConfig::kSink == LogSink::kBinary) {
+                        // Age in cycles is exact as long as the record is under one counter wrap (~5.4 s) old
+                        uint32_t stamp;
+                        memcpy(&stamp, payload + 4, 4);
+                        uint32_t age_us = (cycle_counter_read() - stamp) / timebase_cycles_per_us();
+                        uint32_t timestamp_us = static_cast<uint32_t>(timebase_us()) - age_us;
+                        write_binary(level, payload, bytes, timestamp_us);
+                    }
+                    else {
+                        write_text(payload, bytes);
+                    }
+                    wrote = true;
+                }
+
+                // Zero the whole record so none of its words reads as a committed header later
+                memset(&g_ring[offset], 0, words * sizeof(uint32_t));
+                consumed += words;
+                g_consumed.store(consumed, std::memory_order_release);
+            }
+
+            if (wrote) {
+                fflush(stdout);
+            }
+            vTaskDelay(pdMS_TO_TICKS(LogConfig::kDrainPeriodMs));
+        }
+    }
+}
@@ -6,11 +6,11 @@ namespace coralmicro {
   void depth_estimation(
         const tensorflow::Object* detections, // array of detections
         const uint8_t detection_count,    // number of detections 
-        const int16_t* distance_mm,   //  array from ToF
+        const TofData& tof_data,      // latest frame of every ToF sensor
         float* depths_out
     ){
         // Check valid inputs
-        if (!detections || detection_count == 0 || !distance_mm || !depths_out) {
+        if (!detections || detection_count == 0 || !depths_out) {
             return;
         }
         
@@ -28,29 +28,38 @@ namespace coralmicro {
             float total_weighted_depth = 0.0f;
             float total_weight = 0.0f;
             
-            // Iterate through all TOF cells to find overlapping regions
-            for (uint8_t cell_idx = 0; cell_idx < kTofCellCount; cell_idx++) {
-                const auto& cell_region = kTofCellRegions[cell_idx];
+            // Iterate through the TOF cells of every sensor with a fresh frame; where
+            // fields of view overlap, all of the overlapping cells contribute
+            for (size_t sensor = 0; sensor < kTofSensorCount; sensor++) {
+                if (!tof_data.frame_fresh(sensor)) {
+                    continue;
+                }
+                const TofSensorConfig& sensor_config = kTofSensors[sensor];
+                const int16_t* distance_mm = tof_data.results[sensor].distance_mm;
+
+                for (uint8_t cell_idx = 0; cell_idx < kTofCellCount; cell_idx++) {
+                    const auto& cell_region = sensor_config.cell_regions[cell_idx];
                 
-                // Calculate overlap area between detection bbox and this TOF cell
-                uint32_t overlap = overlap_area(
-                    detection_x_min, detection_y_min, detection_x_max, detection_y_max,
-                    cell_region.x_min, cell_region.y_min, cell_region.x_max, cell_region.y_max
-                );
+                    // Calculate overlap area between detection bbox and this TOF cell
+                    uint32_t overlap = overlap_area(
+                        detection_x_min, detection_y_min, detection_x_max, detection_y_max,
+                        cell_region.x_min, cell_region.y_min, cell_region.x_max, cell_region.y_max
+                    );
                 
-                // If there's an overlap, add the weighted depth value
-                if (overlap > 0) {
-                    // Get the depth value for this cell
-                    int16_t cell_depth_mm = distance_mm[cell_idx];
+                    // If there's an overlap, add the weighted depth value
+                    if (overlap > 0) {
+                        // Get the depth value for this cell
+                        int16_t cell_depth_mm = distance_mm[cell_idx];
                     
-                    // If cell depth is valid (not 0 or negative), include it in the calculation
-                    if (cell_depth_mm > 0) {
-                        // Combined weight: overlap area * RMSE-based weight
-                        float combined_weight = static_cast<float>(overlap) * kTofCellWeights[cell_idx];
+                        // If cell depth is valid (not 0 or negative), include it in the calculation
+                        if (cell_depth_mm > 0) {
+                            // Combined weight: overlap area * RMSE-based weight
+                            float combined_weight = static_cast<float>(overlap) * sensor_config.cell_weights[cell_idx];
                         
-                        // Add weighted depth value
-                        total_weighted_depth += static_cast<float>(cell_depth_mm) * combined_weight;
-                        total_weight += combined_weight;
+                            // Add weighted depth value
+                            total_weighted_depth += static_cast<float>(cell_depth_mm) * combined_weight;
+                            total_weight += combined_weight;
+                        }
                     }
                 }
             }
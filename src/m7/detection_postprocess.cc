@@ -0,0 +1,27 @@
+// detection_postprocess.cc
+#include "m7/detection_postprocess.hh"
+
+namespace coralmicro {
+
+    uint8_t postprocess_detections(const std::vector<tensorflow::Object>& results, uint32_t width, uint32_t height,
+                                   tensorflow::Object* out, size_t max_count) {
+        // One pass: filter and scale straight into the output, nothing is erased from results
+        size_t count = 0;
+        for (const tensorflow::Object& object : results) {
+            if (count >= max_count || count >= UINT8_MAX) {
+                break;
+            }
+            if (object.id != kPersonClassId) {
+                continue;
+            }
+
+            tensorflow::Object& scaled = out[count++];
+            scaled = object;
+            scaled.bbox.xmin *= width;
+            scaled.bbox.xmax *= width;
+            scaled.bbox.ymin *= height;
+            scaled.bbox.ymax *= height;
+        }
+        return static_cast<uint8_t>(count);
+    }
+}
@@ -0,0 +1,20 @@
+// edma.cc
+#include "m7/edma.hh"
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_edma.h"
+
+namespace coralmicro {
+
+    void edma_init() {
+        edma_config_t config;
+        EDMA_GetDefaultConfig(&config);
+        EDMA_Init(DMA0, &config);
+    }
+
+    void edma_set_irq_priority(uint32_t channel) {
+        // Channel n and n + 16 share an interrupt on the RT1170
+        IRQn_Type irq = static_cast<IRQn_Type>(DMA0_DMA16_IRQn + (channel % 16));
+        NVIC_SetPriority(irq, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+    }
+}
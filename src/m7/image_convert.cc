@@ -0,0 +1,312 @@
+// image_convert.cc
+#include "m7/image_convert.hh"
+
+#include <cstring>
+
+#if defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+#endif
+
+namespace coralmicro {
+
+    namespace {
+
+        constexpr int32_t kOne = 1 << 16; // 16.16 fixed point
+
+        // Channel of each photosite in a 2x2 block, indexed by (y & 1) * 2 + (x & 1). 0 = R, 1 = G, 2 = B
+        constexpr uint8_t kPatternChannels[4][4] = {
+            {0, 1, 1, 2},  // RGGB
+            {2, 1, 1, 0},  // BGGR
+            {1, 0, 2, 1},  // GRBG
+            {1, 2, 0, 1},  // GBRG
+        };
+
+        // Byte offsets of R, G, G, B inside a 2x2 window, for each window origin parity
+        struct WindowOffsets {
+            uint32_t r;
+            uint32_t g0;
+            uint32_t g1;
+            uint32_t b;
+        };
+
+        struct Geometry {
+            // Content rectangle inside the output (the rest is letterbox)
+            uint32_t x0;
+            uint32_t y0;
+            uint32_t width;
+            uint32_t height;
+
+            // 16.16 position in the rotated source for content pixel (0, 0) and per-pixel step
+            int32_t start_x;
+            int32_t start_y;
+            int32_t step_x;
+            int32_t step_y;
+
+            WindowOffsets offsets[4];
+        };
+
+        bool setup_geometry(const RawConvertParams& p, Geometry* g) {
+            if (!p.raw || !p.rgb || p.raw_width < 3 || p.raw_height < 3 || p.out_width == 0 || p.out_height == 0) {
+                return false;
+            }
+
+            bool swap = (p.rotation == ConvertRotation::k90 || p.rotation == ConvertRotation::k270);
+            uint32_t rot_w = swap ? p.raw_height : p.raw_width;
+            uint32_t rot_h = swap ? p.raw_width : p.raw_height;
+
+            g->width = p.out_width;
+            g->height = p.out_height;
+            if (p.preserve_ratio) {
+                // Fit the larger relative side, compare rot_w/out_w vs rot_h/out_h without division
+                if (static_cast<uint64_t>(rot_w) * p.out_height >= static_cast<uint64_t>(rot_h) * p.out_width) {
+                    g->height = static_cast<uint32_t>((static_cast<uint64_t>(p.out_width) * rot_h + rot_w / 2) / rot_w);
+                }
+                else {
+                    g->width = static_cast<uint32_t>((static_cast<uint64_t>(p.out_height) * rot_w + rot_h / 2) / rot_h);
+                }
+            }
+            g->x0 = (p.out_width - g->width) / 2;
+            g->y0 = (p.out_height - g->height) / 2;
+
+            // Pixel-center aligned mapping: src = (dst + 0.5) * scale - 0.5
+            g->step_x = static_cast<int32_t>((static_cast<uint64_t>(rot_w) << 16) / g->width);
+            g->step_y = static_cast<int32_t>((static_cast<uint64_t>(rot_h) << 16) / g->height);
+            g->start_x = g->step_x / 2 - kOne / 2;
+            g->start_y = g->step_y / 2 - kOne / 2;
+
+            const uint8_t* channels = kPatternChannels[static_cast<uint8_t>(p.pattern)];
+            for (uint32_t parity = 0; parity < 4; parity++) {
+                uint32_t px = parity & 1;
+                uint32_t py = parity >> 1;
+                uint32_t site_offsets[4] = {0, 1, p.raw_width, p.raw_width + 1};
+                bool first_green = true;
+
+                for (uint32_t i = 0; i < 4; i++) {
+                    uint32_t dx = i & 1;
+                    uint32_t dy = i >> 1;
+                    uint8_t ch = channels[((py + dy) & 1) * 2 + ((px + dx) & 1)];
+                    if (ch == 0) {
+                        g->offsets[parity].r = site_offsets[i];
+                    }
+                    else if (ch == 2) {
+                        g->offsets[parity].b = site_offsets[i];
+                    }
+                    else if (first_green) {
+                        g->offsets[parity].g0 = site_offsets[i];
+                        first_green = false;
+                    }
+                    else {
+                        g->offsets[parity].g1 = site_offsets[i];
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // Rotated-source 16.16 coordinate -> sensor 16.16 coordinate
+        inline void rotate_to_sensor(const RawConvertParams& p, int32_t rx, int32_t ry, int32_t* sx, int32_t* sy) {
+            const int32_t max_x = static_cast<int32_t>(p.raw_width - 1) << 16;
+            const int32_t max_y = static_cast<int32_t>(p.raw_height - 1) << 16;
+            switch (p.rotation) {
+                case ConvertRotation::k90:
+                    *sx = ry;
+                    *sy = max_y - rx;
+                    break;
+                case ConvertRotation::k180:
+                    *sx = max_x - rx;
+                    *sy = max_y - ry;
+                    break;
+                case ConvertRotation::k270:
+                    *sx = max_x - ry;
+                    *sy = rx;
+                    break;
+                default:
+                    *sx = rx;
+                    *sy = ry;
+                    break;
+            }
+        }
+
+        // Window origin and 8-bit fraction for one axis. The bilinear filter reads windows
+        // at origin and origin + 1, each 2 photosites wide, so the origin stops at size - 3.
+        inline void split_axis(int32_t s, uint32_t size, bool bilinear, uint32_t* origin, uint32_t* frac) {
+            uint32_t max_origin = size - (bilinear ? 3 : 2);
+            if (!bilinear) {
+                s += kOne / 2; // Round to nearest
+            }
+            if (s <= 0) {
+                *origin = 0;
+                *frac = 0;
+                return;
+            }
+
+            uint32_t i = static_cast<uint32_t>(s) >> 16;
+            if (i >= max_origin) {
+                *origin = max_origin;
+                *frac = bilinear && i == max_origin ? ((static_cast<uint32_t>(s) >> 8) & 0xFF) : 0;
+                return;
+            }
+            *origin = i;
+            *frac = bilinear ? ((static_cast<uint32_t>(s) >> 8) & 0xFF) : 0;
+        }
+
+        inline uint32_t window_parity(uint32_t x, uint32_t y) {
+            return ((y & 1) << 1) | (x & 1);
+        }
+
+        // ---- Reference helpers ----
+
+        inline void window_rgb(const RawConvertParams& p, const Geometry& g, uint32_t x, uint32_t y, uint32_t rgb[3]) {
+            const uint8_t* w = p.raw + y * p.raw_width + x;
+            const WindowOffsets& o = g.offsets[window_parity(x, y)];
+            rgb[0] = w[o.r];
+            rgb[1] = (static_cast<uint32_t>(w[o.g0]) + w[o.g1] + 1) >> 1;
+            rgb[2] = w[o.b];
+        }
+
+        inline uint32_t lerp8(uint32_t a, uint32_t b, uint32_t f) {
+            return (a * (256 - f) + b * f + 128) >> 8;
+        }
+
+        // ---- Packed helpers: 0x00BBGGRR per window ----
+
+        inline uint32_t window_packed(const RawConvertParams& p, const Geometry& g, uint32_t x, uint32_t y) {
+            const uint8_t* w = p.raw + y * p.raw_width + x;
+            const WindowOffsets& o = g.offsets[window_parity(x, y)];
+            uint32_t green = (static_cast<uint32_t>(w[o.g0]) + w[o.g1] + 1) >> 1;
+            return static_cast<uint32_t>(w[o.r]) | (green << 8) | (static_cast<uint32_t>(w[o.b]) << 16);
+        }
+
+        // Split 0x00BBGGRR into R/B and G in 16-bit lanes
+        inline uint32_t lanes_rb(uint32_t packed) {
+#if defined(__ARM_FEATURE_DSP)
+            return __uxtb16(packed);
+#else
+            return packed & 0x00FF00FFu;
+#endif
+        }
+
+        inline uint32_t lanes_g(uint32_t packed) {
+#if defined(__ARM_FEATURE_DSP)
+            return __uxtb16(__ror(packed, 8));
+#else
+            return (packed >> 8) & 0x00FF00FFu;
+#endif
+        }
+
+        // Lane-wise (a * (256 - f) + b * f + 128) >> 8. Each lane peaks at 255 * 256 + 128, so lanes never carry.
+        inline uint32_t lerp_lanes(uint32_t a, uint32_t b, uint32_t f) {
+            return ((a * (256 - f) + b * f + 0x00800080u) >> 8) & 0x00FF00FFu;
+        }
+
+        inline void store_rgb(uint8_t* out, uint32_t rb, uint32_t g) {
+            out[0] = static_cast<uint8_t>(rb);
+            out[1] = static_cast<uint8_t>(g);
+            out[2] = static_cast<uint8_t>(rb >> 16);
+        }
+
+        void fill_letterbox(const RawConvertParams& p, const Geometry& g) {
+            const uint32_t stride = p.out_width * 3;
+            if (g.width == p.out_width && g.height == p.out_height) {
+                return;
+            }
+            for (uint32_t y = 0; y < p.out_height; y++) {
+                uint8_t* row = p.rgb + y * stride;
+                if (y < g.y0 || y >= g.y0 + g.height) {
+                    std::memset(row, 0, stride);
+                    continue;
+                }
+                std::memset(row, 0, g.x0 * 3);
+                std::memset(row + (g.x0 + g.width) * 3, 0, (p.out_width - g.x0 - g.width) * 3);
+            }
+        }
+    }
+
+    bool convert_raw_frame_reference(const RawConvertParams& p) {
+        Geometry g;
+        if (!setup_geometry(p, &g)) {
+            return false;
+        }
+        fill_letterbox(p, g);
+
+        const bool bilinear = (p.filter == ConvertFilter::kBilinear);
+        for (uint32_t oy = 0; oy < g.height; oy++) {
+            int32_t ry = g.start_y + static_cast<int32_t>(oy) * g.step_y;
+            uint8_t* out = p.rgb + ((g.y0 + oy) * p.out_width + g.x0) * 3;
+
+            for (uint32_t ox = 0; ox < g.width; ox++, out += 3) {
+                int32_t rx = g.start_x + static_cast<int32_t>(ox) * g.step_x;
+                int32_t sx, sy;
+                rotate_to_sensor(p, rx, ry, &sx, &sy);
+
+                uint32_t x, fx, y, fy;
+                split_axis(sx, p.raw_width, bilinear, &x, &fx);
+                split_axis(sy, p.raw_height, bilinear, &y, &fy);
+
+                uint32_t c00[3];
+                window_rgb(p, g, x, y, c00);
+                if (!bilinear) {
+                    out[0] = static_cast<uint8_t>(c00[0]);
+                    out[1] = static_cast<uint8_t>(c00[1]);
+                    out[2] = static_cast<uint8_t>(c00[2]);
+                    continue;
+                }
+
+                uint32_t c10[3], c01[3], c11[3];
+                window_rgb(p, g, x + 1, y, c10);
+                window_rgb(p, g, x, y + 1, c01);
+                window_rgb(p, g, x + 1, y + 1, c11);
+
+                for (int ch = 0; ch < 3; ch++) {
+                    uint32_t top = lerp8(c00[ch], c10[ch], fx);
+                    uint32_t bottom = lerp8(c01[ch], c11[ch], fx);
+                    out[ch] = static_cast<uint8_t>(lerp8(top, bottom, fy));
+                }
+            }
+        }
+        return true;
+    }
+
+    bool convert_raw_frame(const RawConvertParams& p) {
+        Geometry g;
+        if (!setup_geometry(p, &g)) {
+            return false;
+        }
+        fill_letterbox(p, g);
+
+        const bool bilinear = (p.filter == ConvertFilter::kBilinear);
+        for (uint32_t oy = 0; oy < g.height; oy++) {
+            int32_t ry = g.start_y + static_cast<int32_t>(oy) * g.step_y;
+            int32_t rx = g.start_x;
+            uint8_t* out = p.rgb + ((g.y0 + oy) * p.out_width + g.x0) * 3;
+
+            for (uint32_t ox = 0; ox < g.width; ox++, out += 3, rx += g.step_x) {
+                int32_t sx, sy;
+                rotate_to_sensor(p, rx, ry, &sx, &sy);
+
+                uint32_t x, fx, y, fy;
+                split_axis(sx, p.raw_width, bilinear, &x, &fx);
+                split_axis(sy, p.raw_height, bilinear, &y, &fy);
+
+                uint32_t p00 = window_packed(p, g, x, y);
+                if (!bilinear) {
+                    store_rgb(out, lanes_rb(p00), lanes_g(p00));
+                    continue;
+                }
+
+                uint32_t p10 = window_packed(p, g, x + 1, y);
+                uint32_t p01 = window_packed(p, g, x, y + 1);
+                uint32_t p11 = window_packed(p, g, x + 1, y + 1);
+
+                // R and B share one 32-bit lane pair, G uses the other
+                uint32_t rb = lerp_lanes(lerp_lanes(lanes_rb(p00), lanes_rb(p10), fx),
+                                         lerp_lanes(lanes_rb(p01), lanes_rb(p11), fx), fy);
+                uint32_t gg = lerp_lanes(lerp_lanes(lanes_g(p00), lanes_g(p10), fx),
+                                         lerp_lanes(lanes_g(p01), lanes_g(p11), fx), fy);
+                store_rgb(out, rb, gg);
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,57 @@
+// inference_governor.cc
+#include "m7/inference_governor.hh"
+
+namespace coralmicro {
+
+    InferenceMode InferenceGovernor::target_mode(const GovernorInput& input) {
+        // Safety first: a person near the danger distance always gets the full rate
+        bool person_near = input.person_present &&
+            (input.nearest_depth_mm < 0.0f || input.nearest_depth_mm <= InferenceGovernorConfig::kAlertDistanceMm);
+        if (person_near || input.tof_intrusion) {
+            return InferenceMode::ALERT;
+        }
+
+        if (input.host_connected) {
+            if (input.host_state == HostState::EXECUTE) {
+                return InferenceMode::ALERT;
+            }
+            if (input.host_state == HostState::STOPPED || input.host_state == HostState::HELD) {
+                return InferenceMode::IDLE;
+            }
+        }
+
+        if (!input.person_present && input.system_state == SystemState::IDLE) {
+            return InferenceMode::IDLE;
+        }
+
+        return InferenceMode::NORMAL;
+    }
+
+    InferenceMode InferenceGovernor::update(const GovernorInput& input, uint32_t now_ms) {
+        if (!started_) {
+            started_ = true;
+            mode_needed_ms_ = now_ms;
+            last_update_ms_ = now_ms;
+        }
+
+        // Account the time since the last update to the mode we were in
+        time_in_mode_ms_[static_cast<size_t>(mode_)] += now_ms - last_update_ms_;
+        last_update_ms_ = now_ms;
+
+        InferenceMode target = target_mode(input);
+        bool raise = static_cast<uint8_t>(target) > static_cast<uint8_t>(mode_);
+        bool hold_elapsed = (now_ms - mode_needed_ms_) >= InferenceGovernorConfig::kDowngradeHoldMs;
+
+        if (target != mode_ && (raise || hold_elapsed)) {
+            mode_ = target;
+            mode_needed_ms_ = now_ms;
+            mode_changes_++;
+        }
+        else if (target == mode_) {
+            // Re-arm the hold, so only a sustained lull lowers the rate
+            mode_needed_ms_ = now_ms;
+        }
+
+        return mode_;
+    }
+}
@@ -0,0 +1,131 @@
+// inference_profiler.cc
+#include "m7/inference_profiler.hh"
+
+#include <cstring>
+
+#include "m7/cycle_counter.hh"
+#include "m7/timebase.hh"
+
+namespace coralmicro {
+
+    uint32_t InferenceProfiler::BeginEvent(const char* tag) {
+        if (event_count_ >= InferenceProfilerConfig::kMaxEventsPerInvoke) {
+            summary_.dropped_events++;
+            return UINT32_MAX;
+        }
+
+        Event& event = events_[event_count_];
+        event.tag = tag;
+        event.cycles = 0;
+        event.start = cycle_counter_read();
+        return static_cast<uint32_t>(event_count_++);
+    }
+
+    void InferenceProfiler::EndEvent(uint32_t event_handle) {
+        uint32_t now = cycle_counter_read();
+        if (event_handle >= event_count_) {
+            return;
+        }
+        events_[event_handle].cycles = now - events_[event_handle].start;
+    }
+
+    void InferenceProfiler::begin_inference() {
+        event_count_ = 0;
+        for (size_t i = 0; i < kProfileStageCount; i++) {
+            stage_recorded_[i] = false;
+        }
+    }
+
+    void InferenceProfiler::record_stage(ProfileStage stage, uint32_t cycles) {
+        size_t i = static_cast<size_t>(stage);
+        stage_cycles_[i] = cycles;
+        stage_recorded_[i] = true;
+    }
+
+    int InferenceProfiler::find_or_add_op(const char* tag) {
+        for (size_t i = 0; i < op_count_; i++) {
+            // Tags are static strings, but compare contents in case two registrations share a name
+            if (op_series_[i].tag == tag || std::strcmp(op_series_[i].tag, tag) == 0) {
+                return static_cast<int>(i);
+            }
+        }
+
+        if (op_count_ >= InferenceProfilerConfig::kMaxOps) {
+            return -1;
+        }
+        op_series_[op_count_].tag = tag;
+        return static_cast<int>(op_count_++);
+    }
+
+    const ProfileSummary& InferenceProfiler::end_inference() {
+        // Clear this slot for every series, then fill what this inference produced
+        for (size_t i = 0; i < kProfileStageCount; i++) {
+            stage_series_[i].cycles[slot_] = stage_cycles_[i];
+            stage_series_[i].present[slot_] = stage_recorded_[i];
+        }
+        for (size_t i = 0; i < op_count_; i++) {
+            op_series_[i].cycles[slot_] = 0;
+            op_series_[i].present[slot_] = false;
+        }
+
+        for (size_t e = 0; e < event_count_; e++) {
+            const Event& event = events_[e];
+            if (event.tag == nullptr) {
+                continue;
+            }
+
+            int op = find_or_add_op(event.tag);
+            if (op < 0) {
+                summary_.dropped_events++;
+                continue;
+            }
+            op_series_[op].cycles[slot_] += event.cycles;
+            op_series_[op].present[slot_] = true;
+        }
+
+        if (filled_ < InferenceProfilerConfig::kWindow) {
+            filled_++;
+        }
+
+        summary_.inferences++;
+        for (size_t i = 0; i < kProfileStageCount; i++) {
+            stage_series_[i].tag = kProfileStageNames[i];
+            summarize(stage_series_[i], slot_, filled_, &summary_.stages[i]);
+        }
+        for (size_t i = 0; i < op_count_; i++) {
+            summarize(op_series_[i], slot_, filled_, &summary_.ops[i]);
+        }
+        summary_.op_count = static_cast<uint8_t>(op_count_);
+
+        slot_ = (slot_ + 1) % InferenceProfilerConfig::kWindow;
+        return summary_;
+    }
+
+    void InferenceProfiler::summarize(const Series& series, size_t newest, size_t filled, ProfileEntry* entry) {
+        uint64_t total = 0;
+        uint32_t samples = 0;
+        uint32_t max_cycles = 0;
+
+        for (size_t i = 0; i < filled; i++) {
+            if (!series.present[i]) {
+                continue;
+            }
+            samples++;
+            total += series.cycles[i];
+            if (series.cycles[i] > max_cycles) {
+                max_cycles = series.cycles[i];
+            }
+        }
+
+        entry->tag = series.tag;
+        entry->samples = samples;
+        entry->last_cycles = series.present[newest] ? series.cycles[newest] : 0;
+        entry->mean_cycles = samples > 0 ? static_cast<uint32_t>(total / samples) : 0;
+        entry->max_cycles = max_cycles;
+    }
+
+    uint32_t profile_cycles_to_us(uint32_t cycles) {
+        uint32_t hz = timebase_cycle_hz();
+        return hz > 0 ? static_cast<uint32_t>(static_cast<uint64_t>(cycles) * 1000000u / hz) : 0;
+    }
+}
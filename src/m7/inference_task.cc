@@ -2,73 +2,230 @@
 
 namespace coralmicro {
 
+    namespace {
+        // Ops used by MobileNet / person-detect style gate models
+        using GateOpResolver = tflite::MicroMutableOpResolver<6>;
+
+        bool add_gate_ops(GateOpResolver& resolver) {
+            return resolver.AddConv2D() == kTfLiteOk &&
+                   resolver.AddDepthwiseConv2D() == kTfLiteOk &&
+                   resolver.AddAveragePool2D() == kTfLiteOk &&
+                   resolver.AddReshape() == kTfLiteOk &&
+                   resolver.AddSoftmax() == kTfLiteOk &&
+                   resolver.AddFullyConnected() == kTfLiteOk;
+        }
+
+        // Returns nullptr (cascade off) rather than suspending: the SSD alone still works
+        std::unique_ptr<tflite::MicroInterpreter> create_gate_interpreter(GateOpResolver& resolver,
+                                                                         tflite::ErrorReporter* error_reporter) {
+            if (!add_gate_ops(resolver)) {
+                printf("ERROR: Failed to add gate ops\r\n");
+                return nullptr;
+            }
+
+            const tflite::Model* model = tflite::GetModel(g_gate_model_data.data());
+            if (model == nullptr) {
+                printf("ERROR: Failed to get gate model from data\r\n");
+                return nullptr;
+            }
+
+            auto interpreter = std::make_unique<tflite::MicroInterpreter>(
+                model, resolver, g_gate_tensor_arena, g_gate_tensor_arena_size, error_reporter);
+
+            if (interpreter->AllocateTensors() != kTfLiteOk) {
+                printf("ERROR: Failed to allocate gate tensors\r\n");
+                return nullptr;
+            }
+
+            auto* input = interpreter->input_tensor(0);
+            if (!input || input->dims->size != 4 ||
+                (input->dims->data[3] != 1 && input->dims->data[3] != 3) ||
+                (input->type != kTfLiteUInt8 && input->type != kTfLiteInt8)) {
+                printf("ERROR: Unsupported gate input, expected 1xHxWx1 or 1xHxWx3 uint8/int8\r\n");
+                return nullptr;
+            }
+
+            printf("Person gate ready. Input %dx%dx%d, arena used %u bytes\r\n",
+                input->dims->data[1], input->dims->data[2], input->dims->data[3],
+                static_cast<unsigned>(interpreter->arena_used_bytes()));
+            return interpreter;
+        }
+
+        void publish_cascade_stats(const CascadePolicy& cascade) {
+            g_inference_stats.gate_runs = cascade.gate_runs();
+            g_inference_stats.gate_fires = cascade.gate_fires();
+            g_inference_stats.cascade_skips = cascade.skips();
+            g_inference_stats.cascade_refreshes = cascade.refreshes();
+            g_inference_stats.cascade_hits = cascade.hits();
+            g_inference_stats.cascade_false_alarms = cascade.false_alarms();
+            g_inference_stats.cascade_misses = cascade.misses();
+        }
+
+        void publish_skip_ratios() {
+            uint32_t frames = g_inference_stats.frames_seen.load();
+            if (frames == 0) {
+                return;
+            }
+            metric_set<Metric::kInferenceSkipRatio>(static_cast<float>(g_inference_stats.motion_skips.load()) / frames,
+                                                    static_cast<size_t>(SkipReason::kMotion));
+            metric_set<Metric::kInferenceSkipRatio>(static_cast<float>(g_inference_stats.cascade_skips.load()) / frames,
+                                                    static_cast<size_t>(SkipReason::kCascade));
+        }
+
+        // Raw RGB frame into the capture ring; the state controller records its detections,
+        // stamped with the same capture time
+        void record_camera_frame(const CameraData& camera_data) {
+            if (camera_data.format != CameraFormat::kRgb || !camera_data.image_data) {
+                return;
+            }
+            uint8_t header[RecordingFormat::kCameraHeaderBytes];
+            pack_camera_header(static_cast<uint16_t>(camera_data.width), static_cast<uint16_t>(camera_data.height),
+                               header, sizeof(header));
+            recorder_write(ChunkType::kCameraFrame, static_cast<uint8_t>(CameraEncoding::kRgb888),
+                           camera_data.timestamp_us, header, sizeof(header),
+                           camera_data.image_data->data(), camera_data.image_data->size());
+        }
+    }
+
+    float run_person_gate(tflite::MicroInterpreter* interpreter, const CameraData& camera_data) {
+        PROFILE_ZONE("person_gate");
+        if (!interpreter || !camera_data.image_data) return -1.0f;
+
+        auto* input = interpreter->input_tensor(0);
+        if (!input) return -1.0f;
+
+        // Nearest-neighbour downsample of the SSD input frame into the gate input
+        const int height = input->dims->data[1];
+        const int width = input->dims->data[2];
+        const int channels = input->dims->data[3];
+        const int bpp = CameraFormatBpp(camera_data.format);
+        const bool signed_input = (input->type == kTfLiteInt8);
+        const uint8_t* src = camera_data.image_data->data();
+        uint8_t* dst = tflite::GetTensorData<uint8_t>(input);
+
+        for (int y = 0; y < height; y++) {
+            const uint8_t* row = src + (static_cast<uint32_t>(y) * camera_data.height / height) * camera_data.width * bpp;
+            for (int x = 0; x < width; x++) {
+                const uint8_t* px = row + (static_cast<uint32_t>(x) * camera_data.width / width) * bpp;
+                for (int ch = 0; ch < channels; ch++) {
+                    uint8_t value;
+                    if (channels == 1 && bpp >= 3) {
+                        value = static_cast<uint8_t>((77 * px[0] + 150 * px[1] + 29 * px[2]) >> 8);
+                    }
+                    else {
+                        value = px[bpp >= 3 ? ch : 0];
+                    }
+                    // int8 input is uint8 shifted by -128
+                    *dst++ = signed_input ? static_cast<uint8_t>(value ^ 0x80) : value;
+                }
+            }
+        }
+
+        if (interpreter->Invoke() != kTfLiteOk) {
+            DLOG_ERROR("ERROR: Gate inference failed\r\n");
+            return -1.0f;
+        }
+
+        auto* output = interpreter->output_tensor(0);
+        if (!output || output->dims->size < 1) return -1.0f;
+
+        const int classes = output->dims->data[output->dims->size - 1];
+        const int index = classes > 1 ? CascadeConfig::kPersonClassIndex : 0;
+        if (index >= classes) return -1.0f;
+
+        switch (output->type) {
+            case kTfLiteUInt8:
+                return (tflite::GetTensorData<uint8_t>(output)[index] - output->params.zero_point) * output->params.scale;
+            case kTfLiteInt8:
+                return (tflite::GetTensorData<int8_t>(output)[index] - output->params.zero_point) * output->params.scale;
+            case kTfLiteFloat32:
+                return tflite::GetTensorData<float>(output)[index];
+            default:
+                return -1.0f;
+        }
+    }
+
 
     bool detect_objects(tflite::MicroInterpreter* interpreter, 
                     const CameraData& camera_data,
-                    DetectionData* result) {
+                    DetectionData* result,
+                    InferenceProfiler* profiler) {
+        PROFILE_ZONE("detect_objects");
         if (!result || !camera_data.image_data) return false;
         
         auto* input_tensor = interpreter->input_tensor(0);
         if (!input_tensor) {
-            printf("ERROR: Failed to get input tensor in detect_objects\r\n");
+            DLOG_ERROR("ERROR: Failed to get input tensor in detect_objects\r\n");
             return false;
         }
 
+        uint32_t stage_start = cycle_counter_read();
         std::memcpy(tflite::GetTensorData<uint8_t>(input_tensor), 
                 camera_data.image_data->data(), camera_data.image_data->size());
+        uint32_t copy_end = cycle_counter_read();
         
         TfLiteStatus invoke_status = interpreter->Invoke();
+        uint32_t invoke_end = cycle_counter_read();
+        if (profiler) {
+            profiler->record_stage(ProfileStage::kCopy, copy_end - stage_start);
+            profiler->record_stage(ProfileStage::kInvoke, invoke_end - copy_end);
+        }
         if (invoke_status != kTfLiteOk) {
-            printf("ERROR: Inference failed with status %d\r\n", invoke_status);
+            DLOG_ERROR("ERROR: Inference failed with status %d\r\n", invoke_status);
             return false;
         }
+
+        // Post-processing ends when this function returns
+        struct PostprocessTimer {
+            InferenceProfiler* profiler;
+            uint32_t start;
+            ~PostprocessTimer() {
+                if (profiler) profiler->record_stage(ProfileStage::kPostprocess, cycle_counter_read() - start);
+            }
+        } postprocess_timer{profiler, invoke_end};
         
         // Get results after inference is complete with a temporary vector
         std::vector<tensorflow::Object> temp_results = 
             tensorflow::GetDetectionResults(interpreter, kDetectionThreshold, g_max_detections_per_inference);
 
-        // If no results, return
-        if (temp_results.empty()) {
-            result->detection_count = 0;
-            return false;
-        }
-
-        // Filter for person class (COCO class ID 0)
-        temp_results.erase(
-            std::remove_if(temp_results.begin(), temp_results.end(),
-                        [](const tensorflow::Object& obj) { return obj.id != 0; }),
-            temp_results.end());
-        
-        // If no results after filter, return
-        if (temp_results.empty()) {
-            result->detection_count = 0;
-            return false;
-        }
-
-        // Copy detections to the fixed array and updated bounding box from normalized to camea dimmensions
-        result->detection_count = 0;
-        for (size_t i = 0; i < temp_results.size() && i < g_max_detections_per_inference; i++) {
-            // Convert normalized coordinates to camera dimensions
-            temp_results[i].bbox.xmin *= camera_data.width;
-            temp_results[i].bbox.xmax *= camera_data.width;
-            temp_results[i].bbox.ymin *= camera_data.height;
-            temp_results[i].bbox.ymax *= camera_data.height;
+        // Persons only, bounding boxes from normalized to camera dimensions
+        result->detection_count = postprocess_detections(temp_results, camera_data.width, camera_data.height,
+                                                         result->detections, g_max_detections_per_inference);
+        return result->detection_count > 0;
+    }
 
-            result->detections[i] = temp_results[i];
-            result->detection_count++;
+    void update_governor(InferenceGovernor& governor, GovernorInput& governor_input) {
+        // Keep the last input if the state controller hasn't published a new one
+        channel_receive(Channel::kGovernor, &governor_input);
 
+        InferenceMode previous_mode = governor.mode();
+        InferenceMode mode = governor.update(governor_input, timebase_ms());
 
+        // Only the rate changes. The TPU stays at the clock it was opened with at boot: reopening
+        // it would power-cycle the device under the interpreter's prepared edgetpu op
+        if (mode != previous_mode) {
+            DLOG_INFO("Inference mode %d -> %d (%lu Hz)\r\n", static_cast<int>(previous_mode), static_cast<int>(mode),
+                static_cast<unsigned long>(InferenceGovernorConfig::kModeHz[static_cast<size_t>(mode)]));
         }
 
-        return true;
+        g_inference_stats.governor_mode = static_cast<uint8_t>(mode);
+        metric_set<Metric::kInferenceMode>(static_cast<float>(mode));
+        g_inference_stats.governor_mode_changes = governor.mode_changes();
+        for (size_t i = 0; i < kInferenceModeCount; i++) {
+            g_inference_stats.governor_time_in_mode_ms[i] = governor.time_in_mode_ms(static_cast<InferenceMode>(i));
+        }
     }
 
     void inference_task(void* parameters) {
         (void)parameters;
         printf("Inference task starting...\r\n");
+        trace_register_task();
         
-        // Add delay to ensure TOF task has fully initialized
-        vTaskDelay(pdMS_TO_TICKS(200));
+        // Model and TPU come from separate boot branches; the camera and ToF aren't needed here
+        if (!boot_wait(kBootModel | kBootTpu)) {
+            printf("ERROR: Model or EdgeTPU not available\r\n");
+            vTaskSuspend(nullptr);
+        }
         
         // Check if model data is loaded
         if (g_model_data.empty()) {
@@ -78,18 +235,11 @@ namespace coralmicro {
         
         // Setup TFLite interpreter with proper error handling
         tflite::MicroErrorReporter error_reporter;
-        tflite::MicroMutableOpResolver<3> resolver;
-        
-        if (resolver.AddDequantize() != kTfLiteOk) {
-            printf("ERROR: Failed to add Dequantize op\r\n");
-            vTaskSuspend(nullptr);
-        }
-        if (resolver.AddDetectionPostprocess() != kTfLiteOk) {
-            printf("ERROR: Failed to add DetectionPostprocess op\r\n");
-            vTaskSuspend(nullptr);
-        }
-        if (resolver.AddCustom(kCustomOp, RegisterCustomOp()) != kTfLiteOk) {
-            printf("ERROR: Failed to add EdgeTPU custom op\r\n");
+        ModelOpResolver resolver;
+
+        // Exactly the ops the model uses, generated from the .tflite
+        if (RegisterModelOps(resolver) != kTfLiteOk) {
+            printf("ERROR: Failed to register model ops\r\n");
             vTaskSuspend(nullptr);
         }
 
@@ -100,13 +250,20 @@ namespace coralmicro {
             vTaskSuspend(nullptr);
         }
         
+        // Per-op profiler, hooked into the interpreter when enabled
+        static InferenceProfiler profiler;
+        InferenceProfiler* active_profiler = InferenceProfilerConfig::kEnabled ? &profiler : nullptr;
+        cycle_counter_init();
+
         // Create interpreter
         tflite::MicroInterpreter interpreter(
             model,
             resolver,
             g_tensor_arena,
             g_tensor_arena_size,
-            &error_reporter
+            &error_reporter,
+            nullptr,
+            active_profiler
         );
         
         // Allocate tensors with retry mechanism
@@ -132,46 +289,146 @@ namespace coralmicro {
             vTaskSuspend(nullptr);
         }
 
-        printf("Inference setup complete. Model input dimensions: %dx%d\r\n",
-            input_tensor->dims->data[1], input_tensor->dims->data[2]);
+        printf("Inference setup complete. Model input dimensions: %dx%d, arena used %u of %u bytes\r\n",
+            input_tensor->dims->data[1], input_tensor->dims->data[2],
+            static_cast<unsigned>(interpreter.arena_used_bytes()), static_cast<unsigned>(g_tensor_arena_size));
+
+        if (input_tensor->dims->data[1] != ModelConfig::kInputHeight ||
+            input_tensor->dims->data[2] != ModelConfig::kInputWidth) {
+            printf("ERROR: Model input doesn't match model_config_m7.hh, regenerate it\r\n");
+            vTaskSuspend(nullptr);
+        }
+
+        // Person gate: first cascade stage, the SSD only runs when it fires (or to track/refresh)
+        static GateOpResolver gate_resolver;
+        std::unique_ptr<tflite::MicroInterpreter> gate_interpreter;
+        if (CascadeConfig::kEnabled && !g_gate_model_data.empty()) {
+            gate_interpreter = create_gate_interpreter(gate_resolver, &error_reporter);
+        }
+        g_inference_stats.cascade_active = (gate_interpreter != nullptr);
+
+        CascadePolicy cascade;
+        CascadeDecision cascade_decision = CascadeDecision::kRefresh;
+        uint32_t cascade_now_ms = 0;
         
     // Main inference loop
         static CameraData camera_data;
         static DetectionData detection_result;
         
-        // Inference Hz
-        int Hz = 10;
-        const TickType_t inference_period = pdMS_TO_TICKS(1000 / Hz);
+        InferenceGovernor governor;
+        GovernorInput governor_input{SystemState::UNINITIALIZED, HostState::UNDEFINED, false, false, -1.0f, false};
+
+        // Inference period, adjusted by the governor
+        TickType_t inference_period = pdMS_TO_TICKS(governor.period_ms());
         TickType_t last_wake_time = xTaskGetTickCount();
 
 
         TickType_t detection_start_tick;
-        TickType_t detection_stop_tick;
 
+        // Motion gate state
+        static MotionGate motion_gate;
+        TickType_t last_invoke_tick = 0;
+        bool last_result_had_person = false;
+        uint32_t recorded_runs = 0;
+
+        register_stage(Stage::kInference);
         
         while (true) {
+            // Invoke on a closed EdgeTPU would run the custom op against a dead device
+            if (!g_tpu_context) {
+                printf("ERROR: EdgeTPU context lost, inference stopped\r\n");
+                vTaskSuspend(nullptr);
+            }
+
+            if (InferenceGovernorConfig::kEnabled) {
+                update_governor(governor, governor_input);
+                inference_period = pdMS_TO_TICKS(governor.period_ms());
+            }
+
             // Try to receive camera data
+            bool run_inference = channel_receive(Channel::kCamera, &camera_data);
+
+            // The executive releases us at up to stage_max_hz(kInference) (cyclic_schedule.hh), so
+            // enforce the governor period here; ALERT is capped at that rate
+            if (run_inference && g_use_cyclic_executive && last_invoke_tick != 0 &&
+                (xTaskGetTickCount() - last_invoke_tick) < inference_period) {
+                run_inference = false;
+            }
+
+            if (run_inference) {
+                g_inference_stats.frames_seen++;
+                metric_inc<Metric::kInferenceFrames>();
+            }
+
+            // Skip Invoke on static scenes, unless the last result had a person or a refresh is due
+            if (run_inference && MotionGateConfig::kEnabled) {
+                bool motion = motion_gate.update(camera_data.image_data->data(), camera_data.width,
+                    camera_data.height, CameraFormatBpp(camera_data.format));
+                bool refresh_due = (xTaskGetTickCount() - last_invoke_tick) >= pdMS_TO_TICKS(MotionGateConfig::kForcedRefreshMs);
 
-            if (xQueueReceive(g_camera_queue_m7, &camera_data, 0) == pdTRUE) {
+                if (!motion && !refresh_due && !last_result_had_person) {
+                    g_inference_stats.motion_skips++;
+                    metric_inc<Metric::kInferenceSkips>(static_cast<size_t>(SkipReason::kMotion));
+                    run_inference = false;
+                }
+                else if (!motion && !last_result_had_person) {
+                    g_inference_stats.forced_refreshes++;
+                }
+            }
+
+            bool profiled = run_inference && active_profiler;
+            if (profiled) {
+                active_profiler->begin_inference();
+            }
+
+            // Cheap person gate decides whether the SSD is worth running
+            if (run_inference && gate_interpreter) {
+                uint64_t gate_start_us = timebase_us();
+                uint32_t gate_start_cycles = cycle_counter_read();
+                float gate_score = run_person_gate(gate_interpreter.get(), camera_data);
+                if (profiled) {
+                    active_profiler->record_stage(ProfileStage::kGate, cycle_counter_read() - gate_start_cycles);
+                }
+                uint64_t gate_end_us = timebase_us();
+                cascade_now_ms = static_cast<uint32_t>(gate_end_us / 1000u);
+                g_inference_stats.gate_time_us = static_cast<uint32_t>(gate_end_us - gate_start_us);
+
+                // A failed gate must never hide a person, treat it as firing
+                if (gate_score < 0.0f) {
+                    gate_score = 1.0f;
+                }
+                g_inference_stats.gate_score = gate_score;
+
+                cascade_decision = cascade.decide(gate_score, g_cascade_settings.fire_threshold.load(),
+                    g_cascade_settings.refresh_ms.load(), cascade_now_ms);
+                if (cascade_decision == CascadeDecision::kSkip) {
+                    metric_inc<Metric::kInferenceSkips>(static_cast<size_t>(SkipReason::kCascade));
+                    run_inference = false;
+                }
+                publish_cascade_stats(cascade);
+            }
+            publish_skip_ratios();
+
+            if (run_inference) {
+                g_inference_stats.invocations++;
+                metric_inc<Metric::kInferences>();
 
                 detection_start_tick = xTaskGetTickCount();
-                detection_result.timestamp_ms = detection_start_tick * (1000 / configTICK_RATE_HZ);
+                detection_result.timestamp_us = timebase_us();
 
                 // Copy camera data to detection result
                 detection_result.camera_data = camera_data;
                 
                 // Perform detection
-                if (detect_objects(&interpreter, camera_data, &detection_result)) {
+                if (detect_objects(&interpreter, camera_data, &detection_result, active_profiler)) {
                     // Success - detection_count already set in detect_objects
-                    detection_stop_tick = xTaskGetTickCount() - detection_start_tick;
-
                     // Time taken for inference
-                    detection_result.inference_time_ms = detection_stop_tick * (1000 / configTICK_RATE_HZ);
+                    detection_result.inference_time_us = static_cast<uint32_t>(timebase_us() - detection_result.timestamp_us);
 
                     //DEBUG: Print out detections boudning boxes
                     for (uint8_t i = 0; i < detection_result.detection_count; i++) {
                         const auto& detection = detection_result.detections[i];
-                        printf("Detection %d: [%.2f, %.2f, %.2f, %.2f] (confidence: %.2f)\r\n",
+                        DLOG_DEBUG("Detection %d: [%.2f, %.2f, %.2f, %.2f] (confidence: %.2f)\r\n",
                             i, detection.bbox.xmin, detection.bbox.ymin,
                             detection.bbox.xmax, detection.bbox.ymax,
                             detection.score);
@@ -179,22 +436,43 @@ namespace coralmicro {
 
                 } 
                 else {
-                    detection_stop_tick = xTaskGetTickCount() - detection_start_tick;
-
                     // No detections or error
                     detection_result.detection_count = 0;
-                    detection_result.inference_time_ms = detection_stop_tick * (1000 / configTICK_RATE_HZ);
+                    detection_result.inference_time_us = static_cast<uint32_t>(timebase_us() - detection_result.timestamp_us);
 
                 }
                 
+                metric_observe<Metric::kInferenceDuration>(detection_result.inference_time_us);
+
+                // Every Nth frame the detector ran on goes into the capture ring
+                if (RecorderConfig::kCameraEvery != 0 && ++recorded_runs % RecorderConfig::kCameraEvery == 0) {
+                    record_camera_frame(camera_data);
+                }
+                last_invoke_tick = detection_start_tick;
+                last_result_had_person = (detection_result.detection_count > 0);
+
+                if (gate_interpreter) {
+                    cascade.on_detector_result(cascade_decision, last_result_had_person, cascade_now_ms);
+                    publish_cascade_stats(cascade);
+                }
+
                 // Send results to queue regardless of detection success
-                if (xQueueOverwrite(g_detection_output_queue_m7, &detection_result) != pdTRUE) {
-                    printf("ERROR: Failed to send detection result\r\n");
+                if (!channel_overwrite(Channel::kDetection, &detection_result)) {
+                    DLOG_ERROR("ERROR: Failed to send detection result\r\n");
                 }
+                boot_milestone(BootPhase::kFirstDetection);
+                NotifyStateController(kEventDetection);
             }
 
-            // Use vTaskDelayUntil for more consistent timing
-            vTaskDelayUntil(&last_wake_time, inference_period);
+            // Gate-only frames count too, their SSD stages just stay empty
+            if (profiled) {
+                channel_overwrite(Channel::kProfile, &active_profiler->end_inference());
+            }
+
+            stage_complete(Stage::kInference);
+
+            // Use vTaskDelayUntil for more consistent timing (or wait for the executive)
+            wait_for_release(Stage::kInference, &last_wake_time, inference_period);
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+// led_patterns.cc
+#include "m7/led_patterns.hh"
+
+namespace coralmicro {
+
+    namespace {
+        LedColor state_color(SystemState state) {
+            switch (state) {
+                case SystemState::WARNING:
+                    return {255, 255, 0};   // YELLOW
+                case SystemState::STOPPED:
+                    return {255, 0, 0};     // RED
+                case SystemState::IDLE:
+                    return {0, 0, 255};     // BLUE
+                case SystemState::ACTIVE:
+                    return {0, 255, 0};     // GREEN
+                default:
+                    return {255, 255, 255}; // WHITE for UNINITIALIZED and other states
+            }
+        }
+
+        uint8_t scale(uint8_t channel, uint32_t level) {
+            return static_cast<uint8_t>((channel * level) / 255u);
+        }
+
+        // Triangle wave from kPulseFloor up to 255 and back over one period
+        uint32_t pulse_level(uint32_t elapsed_ms, uint32_t period_ms) {
+            uint32_t half = period_ms / 2;
+            uint32_t phase = elapsed_ms % period_ms;
+            uint32_t ramp = (phase < half) ? phase : period_ms - phase;
+            return LedPatternConfig::kPulseFloor + (ramp * (255u - LedPatternConfig::kPulseFloor)) / half;
+        }
+    }
+
+    LedScene led_scene(SystemState state, bool host_connected) {
+        LedColor color = state_color(state);
+        if (state == SystemState::STOPPED || state == SystemState::UNINITIALIZED) {
+            return {color, LedPattern::kSolid, 0};
+        }
+        if (state == SystemState::WARNING) {
+            return {color, LedPattern::kBlink, LedPatternConfig::kWarningBlinkMs};
+        }
+        if (!host_connected) {
+            return {color, LedPattern::kPulse, LedPatternConfig::kDisconnectedPulseMs};
+        }
+        return {color, LedPattern::kSolid, 0};
+    }
+
+    void led_render(const LedScene& scene, uint32_t elapsed_ms, LedColor* frame, size_t count) {
+        LedColor color = scene.color;
+        switch (scene.pattern) {
+            case LedPattern::kBlink:
+                if (elapsed_ms % scene.period_ms >= scene.period_ms / 2u) {
+                    color = {0, 0, 0};
+                }
+                break;
+
+            case LedPattern::kPulse: {
+                uint32_t level = pulse_level(elapsed_ms, scene.period_ms);
+                color = {scale(color.red, level), scale(color.green, level), scale(color.blue, level)};
+                break;
+            }
+
+            case LedPattern::kSolid:
+                break;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            frame[i] = color;
+        }
+    }
+}
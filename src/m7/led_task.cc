@@ -1,119 +1,77 @@
 // led_task.cc
 #include "m7/led_task.hh"
 
-namespace coralmicro {
-
-    inline void SendBit(bool bit) {
-        _ZN10coralmicro7SendBitEb(bit);
-    }
+#include <cstring>
 
-    inline void InitializeGpio() {
-        _ZN10coralmicro15InitializeGpioEv();
-    }
-
-    inline void ResetDelay() {
-        _ZN10coralmicro10ResetDelayEv();
-    }
+namespace coralmicro {
 
-    inline void SendByte(uint8_t byte) {
-        for (int i = 7; i >= 0; --i) {
-            SendBit(byte & (1 << i));
+    namespace {
+        void on_pattern_tick(TimerHandle_t timer) {
+            (void)timer;
+            NotifyLedTask(kLedEventTick);
         }
     }
 
-    inline void SendColor(uint8_t red, uint8_t green, uint8_t blue) {
-        uint32_t primask = DisableGlobalIRQ();
-        SendByte(green);
-        SendByte(red);
-        SendByte(blue);
-        EnableGlobalIRQ(primask);
-    }
-
     void led_task(void* parameters) {
         (void)parameters;
         
         printf("LED task starting...\r\n");
+        trace_register_task();
         
-        InitializeGpio();
-        
-        // Initialize current state to UNINITIALIZED
-        SystemState current_state = SystemState::UNINITIALIZED;
-        SystemState new_state;
-        
-        // Set initial color to WHITE (UNINITIALIZED)
-        ResetDelay();
-        for (int i = 0; i < 3; i++) {
-            SendColor(255, 255, 255);
+        if (!ws2812_init()) {
+            printf("ERROR: Failed to initialize LED driver\r\n");
+            vTaskSuspend(nullptr);
         }
-        
-        while (true) {
-            // Wait for state updates from the queue with a timeout
-            if (xQueueReceive(g_state_update_queue_m7, &new_state, pdMS_TO_TICKS(10)) == pdTRUE) {
-                
-                // Check
-                if (new_state == current_state) {
-                    continue;
-                }
-                else
-                {
-
-                    // Set delay for new led instructiosn
-                    ResetDelay();
 
-                    // Send same color to all three LEDs
-                    switch (new_state) {
-                        case SystemState::UNINITIALIZED:
-                            // WHITE for UNINITIALIZED
-                            for (int i = 0; i < 3; i++) {
-                                SendColor(255, 255, 255);
-
-                            }
-                            break;
-                            
-                        case SystemState::WARNING:
-                            // YELLOW for WARNING
-                            for (int i = 0; i < 3; i++) {
-                                SendColor(255, 255, 0);
-                            }
-                            break;
-                            
-                        case SystemState::STOPPED:
-                            // RED for ERROR
-                            for (int i = 0; i < 3; i++) {
-                                SendColor(255, 0, 0);
-                            }
-                            break;
+        // Runs only while the scene animates
+        TimerHandle_t pattern_timer = xTimerCreate("led_pattern", pdMS_TO_TICKS(LedPatternConfig::kTickMs),
+            pdTRUE, nullptr, on_pattern_tick);
+        if (!pattern_timer) {
+            printf("ERROR: Failed to create LED pattern timer\r\n");
+            vTaskSuspend(nullptr);
+        }
+        
+        // WHITE (UNINITIALIZED) until the state controller publishes
+        StateUpdate update{SystemState::UNINITIALIZED, false};
+        LedScene scene = led_scene(update.system_state, update.host_connected);
+        uint32_t scene_start_ms = timebase_ms();
 
-                        case SystemState::IDLE:
-                            // BLUE for IDLE
-                            for (int i = 0; i < 3; i++) {
-                                SendColor(0, 0, 255);
-                            }
-                            break;
+        LedColor frame[kLedCount]; // Rendered this pass
+        LedColor shown[kLedCount]; // Last frame the driver took
+        bool shown_valid = false;
 
-                        case SystemState::ACTIVE:
-                            // GREEN for ACTIVE
-                            for (int i = 0; i < 3; i++) {
-                                SendColor(0, 255, 0);
-                            }
-                            break;
-                            
-                        default:
-                            // Default to WHITE for other states
-                            for (int i = 0; i < 3; i++) {
-                                SendColor(255, 255, 255);
-                            }
-                            break;
+        register_stage(Stage::kLed);
+        g_led_task_m7 = xTaskGetCurrentTaskHandle();
+        
+        while (true) {
+            // State changes are taken first, so a new scene goes out on this same pass
+            if (channel_receive(Channel::kStateUpdate, &update)) {
+                LedScene next = led_scene(update.system_state, update.host_connected);
+                if (next != scene) {
+                    scene = next;
+                    scene_start_ms = timebase_ms();
+                    if (scene.animated()) {
+                        xTimerStart(pattern_timer, 0);
+                    }
+                    else {
+                        xTimerStop(pattern_timer, 0);
                     }
-
-                    
-                    // Update current state after change
-                    current_state = new_state;
                 }
             }
-            
-            // Short delay to avoid busy-waiting
-            vTaskDelay(pdMS_TO_TICKS(33));
+
+            led_render(scene, timebase_ms() - scene_start_ms, frame, kLedCount);
+
+            // Only frames that differ from what the LEDs show go out. One the driver
+            // refuses (previous frame still streaming) is retried a tick later.
+            bool pending = !shown_valid || memcmp(frame, shown, sizeof(frame)) != 0;
+            if (pending && ws2812_show(frame, kLedCount)) {
+                memcpy(shown, frame, sizeof(frame));
+                shown_valid = true;
+                pending = false;
+            }
+
+            // Wake on a state update, a pattern tick or an executive release
+            xTaskNotifyWait(0, UINT32_MAX, nullptr, pending ? 1 : portMAX_DELAY);
         }
     }
 }
@@ -8,6 +8,13 @@
 #include "m7/m7_queues.hh"
 #include "global_config.hh"
 #include "m7/tof_task.hh"
+#include "m7/camera_task.hh"
+#include "m7/cascade_gate.hh"
+#include "m7/boot.hh"
+#include "m7/edma.hh"
+#include "m7/recorder.hh"
+#include "m7/cyclic_executive.hh"
+#include "m7/deferred_log.hh"
 
 namespace coralmicro {
 namespace {
@@ -15,10 +22,11 @@ namespace {
     // Properly allocate tensor arena in SDRAM section
     STATIC_TENSOR_ARENA_IN_SDRAM(tensor_arena_buffer, g_tensor_arena_size);
 
-    // Global TPU context to keep it alive
-    std::shared_ptr<EdgeTpuContext> g_tpu_context;
+    // Gate arena is small and touched every frame, keep it in OCRAM
+    STATIC_TENSOR_ARENA_IN_OCRAM(gate_tensor_arena_buffer, g_gate_tensor_arena_size);
 
     bool load_model() {
+        BootPhaseScope phase(BootPhase::kModelLoad);
         printf("Attempting to load model in main...\r\n");
 
         g_tensor_arena = tensor_arena_buffer;
@@ -35,13 +43,27 @@ namespace {
             return false;
         }
 
-        // Add a delay
-        vTaskDelay(pdMS_TO_TICKS(100));
-        
         return true;
     }
 
+    // The gate model is optional: without it the SSD runs on every frame
+    void load_gate_model() {
+        BootPhaseScope phase(BootPhase::kGateModelLoad);
+        g_gate_tensor_arena = gate_tensor_arena_buffer;
+
+        if (!LfsFileExists(g_gate_model_path)) {
+            printf("Gate model not found at %s, cascade disabled\r\n", g_gate_model_path);
+            return;
+        }
+
+        if (!LfsReadFile(g_gate_model_path, &g_gate_model_data)) {
+            printf("ERROR: Failed to load gate model file, cascade disabled\r\n");
+            g_gate_model_data.clear();
+        }
+    }
+
     bool init_tpu() {
+        BootPhaseScope phase(BootPhase::kTpuOpen);
         printf("Initializing EdgeTPU...\r\n");
 
         // Initialize EdgeTPU with max performance and store in global
@@ -54,46 +76,76 @@ namespace {
         // Store TPU context in global space
         g_tpu_manager_singleton = EdgeTpuManager::GetSingleton();
 
+        // OpenDevice returns once the TPU has enumerated and taken its firmware, no settle time needed
         printf("EdgeTPU initialized successfully\r\n");
 
-        // Add a delay to allow the TPU to stabilize
-        vTaskDelay(pdMS_TO_TICKS(200));
-
         return true;
     }
 
     bool init_tof_device() {
+        boot_phase_begin(BootPhase::kTofReset);
 
-        // Initialize GPIO first
+        // Initialize GPIO first (every sensor held in reset)
         if (!init_gpio()) {
             printf("Failed to initialize TOF GPIO\r\n");
             return false;
         }
 
-        // Platform initialization with proper cleanup
-        VL53L8CX_Platform platform = {};
-        if (!vl53l8cx::PlatformInit(&platform, kI2c, kAddress)) {
-            printf("Platform initialization failed\r\n");
-            return false;
-        }
+        // Release the sensors one at a time, each answering on the default address
+        // until it has been moved to its own
+        for (size_t i = 0; i < kTofSensorCount; i++) {
+            const TofSensorConfig& sensor = kTofSensors[i];
+            GpioSet(sensor.lpn_pin, true);
 
+            VL53L8CX_Platform platform = {};
+            if (!tof_platform_init(&platform, sensor.bus, TofSensorsConfig::kDefaultAddress, sensor.lpn_pin)) {
+                printf("Platform initialization failed for %s\r\n", sensor.name);
+                return false;
+            }
 
-        // Create and initialize device instance
-        g_tof_device = std::make_unique<VL53L8CX_Configuration>();
-        if (!g_tof_device) {
-            printf("Failed to allocate device configuration\r\n");
-            return false;
-        }
+            // Create and initialize device instance
+            g_tof_devices[i] = std::make_unique<VL53L8CX_Configuration>();
+            if (!g_tof_devices[i]) {
+                printf("Failed to allocate device configuration\r\n");
+                return false;
+            }
 
-        g_tof_device->platform = platform;
+            g_tof_devices[i]->platform = platform;
 
-        if (!init_sensor(g_tof_device.get())) {
-            printf("Sensor initialization failed\r\n");
-            return false;
+            if (!wait_sensor_alive(g_tof_devices[i].get())) {
+                printf("Sensor %s did not come out of reset\r\n", sensor.name);
+                return false;
+            }
+
+            if (!assign_sensor_address(g_tof_devices[i].get(), sensor.address)) {
+                printf("Sensor %s could not be moved to address 0x%02x\r\n", sensor.name, sensor.address);
+                return false;
+            }
+        }
+        boot_phase_end(BootPhase::kTofReset);
+
+        {
+            BootPhaseScope phase(BootPhase::kTofFirmware);
+            for (size_t i = 0; i < kTofSensorCount; i++) {
+                if (!load_sensor_firmware(g_tof_devices[i].get())) {
+                    printf("Sensor %s initialization failed\r\n", kTofSensors[i].name);
+                    return false;
+                }
+            }
+        }
+
+        {
+            BootPhaseScope phase(BootPhase::kTofConfig);
+            for (size_t i = 0; i < kTofSensorCount; i++) {
+                if (!configure_sensor(g_tof_devices[i].get())) {
+                    printf("Sensor %s configuration failed\r\n", kTofSensors[i].name);
+                    return false;
+                }
+            }
         }
 
         // Allocate results structure on heap
-        g_tof_results = std::make_unique<VL53L8CX_ResultsData>();
+        g_tof_results = std::make_unique<TofData>();
         if (!g_tof_results) {
             printf("Failed to allocate results structure\r\n");
             return false;
@@ -108,6 +160,51 @@ namespace {
         return true;
     }
 
+    bool init_models() {
+        if (!load_model()) {
+            return false;
+        }
+
+        if (CascadeConfig::kEnabled) {
+            load_gate_model();
+        }
+        return true;
+    }
+
+    bool init_camera() {
+        {
+            BootPhaseScope phase(BootPhase::kCameraPower);
+            if (!camera_power_up()) {
+                return false;
+            }
+        }
+
+        BootPhaseScope phase(BootPhase::kCameraWarmup);
+        return camera_warmup();
+    }
+
+    // Independent bring-up paths, run concurrently. Each task waits only on the resources it uses
+    constexpr BootBranch kBootBranches[] = {
+        {"Boot_Model", init_models, kBootModel},
+        {"Boot_TPU", init_tpu, kBootTpu},
+        {"Boot_TOF", init_tof_device, kBootTof},
+        {"Boot_Camera", init_camera, kBootCamera},
+    };
+
+    // Tasks the generator's tasks_config.yaml (in its submodule) doesn't list. task_config_m7.cc
+    // is regenerated from that file on build, so these are created here instead
+    struct AppTask {
+        TaskFunction_t function;
+        const char* name;
+        uint32_t stack_size;
+        UBaseType_t priority;
+    };
+
+    constexpr AppTask kAppTasks[] = {
+        {cyclic_executive_task, "Cyclic_Executive_Task", STACK_SIZE_SMALL, TASK_PRIORITY_HIGH},
+        {log_drain_task, "Log_Drain_Task", STACK_SIZE_LARGE, TASK_PRIORITY_LOW},
+    };
+
     void setup_tasks() {
             printf("Starting M7 task creation...\r\n");
             
@@ -117,40 +214,63 @@ namespace {
                 printf("Failed to create M7 tasks\r\n");
                 vTaskSuspend(nullptr);
             }
+
+            for (const AppTask& task : kAppTasks) {
+                if (xTaskCreate(task.function, task.name, task.stack_size, nullptr, task.priority, nullptr) != pdPASS) {
+                    printf("Failed to create M7 task: %s\r\n", task.name);
+                    vTaskSuspend(nullptr);
+                }
+                printf("Created M7 task: %s\r\n", task.name);
+            }
         }
 
     [[noreturn]] void main_m7() {
         // Print startup banner
         print_startup_banner();
 
-        // Initialize queues first
-        if (!InitQueues()) {
-            printf("Failed to initialize queues\r\n");
+        // Timebase first, everything downstream stamps data with it
+        if (!timebase_init()) {
+            printf("Failed to initialize timebase\r\n");
             vTaskSuspend(nullptr);
         }
 
-        // Add a small delay
+        // Before any driver creates an eDMA handle
+        edma_init();
 
-        if (!load_model()) {
-            printf("Failed to load model\r\n");
+        if (!boot_init()) {
+            printf("Failed to initialize boot orchestrator\r\n");
             vTaskSuspend(nullptr);
         }
 
-        if (!init_tpu()) {
-            printf("Failed to initialize EdgeTPU\r\n");
-            vTaskSuspend(nullptr);
+        // Initialize queues
+        {
+            BootPhaseScope phase(BootPhase::kQueues);
+            if (!InitQueues()) {
+                printf("Failed to initialize queues\r\n");
+                vTaskSuspend(nullptr);
+            }
         }
 
-        if (!init_tof_device()) {
-            printf("Failed to initialize TOF device\r\n");
+        // Capture ring, written by the tasks from their first sample
+        if (!recorder_init()) {
+            printf("Failed to initialize recorder\r\n");
             vTaskSuspend(nullptr);
         }
 
-        vTaskDelay(pdMS_TO_TICKS(500));
+        // Hardware and model bring-up runs in the background
+        if (!boot_start(kBootBranches, sizeof(kBootBranches) / sizeof(kBootBranches[0]))) {
+            vTaskSuspend(nullptr);
+        }
 
-        // Initialize M7 tasks
-        setup_tasks();
+        // Initialize M7 tasks; the ones that need hardware block in boot_wait until it is up
+        {
+            BootPhaseScope phase(BootPhase::kTaskCreate);
+            setup_tasks();
+        }
 
+        if (boot_wait(kBootDecision)) {
+            boot_report();
+        }
 
         while (true) {
             vTaskDelay(pdMS_TO_TICKS(100));
@@ -0,0 +1,137 @@
+// metrics.cc
+#include "m7/metrics.hh"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+
+namespace coralmicro {
+
+    namespace {
+        constexpr uint32_t sub_bucket_bits() {
+            uint32_t bits = 0;
+            while ((1u << bits) < MetricsConfig::kHistogramSubBuckets) {
+                bits++;
+            }
+            return bits;
+        }
+
+        constexpr uint32_t kSubBits = sub_bucket_bits();
+        static_assert((1u << kSubBits) == MetricsConfig::kHistogramSubBuckets, "Sub-buckets must be a power of two");
+
+        uint32_t floor_log2(uint32_t value) {
+            return 31u - static_cast<uint32_t>(__builtin_clz(value));
+        }
+
+        // Largest value counted in bucket `index` (the Prometheus "le" bound)
+        uint32_t bucket_upper(const MetricDesc& desc, size_t index) {
+            if (index == 0) {
+                return (1u << desc.min_pow) - 1;
+            }
+            uint32_t power = desc.min_pow + static_cast<uint32_t>((index - 1) >> kSubBits);
+            uint32_t sub = static_cast<uint32_t>((index - 1) & (MetricsConfig::kHistogramSubBuckets - 1));
+            return (1u << power) + ((sub + 1) << (power - kSubBits)) - 1;
+        }
+
+        __attribute__((format(printf, 2, 3)))
+        void append(std::string* out, const char* fmt, ...) {
+            char line[192];
+            va_list args;
+            va_start(args, fmt);
+            int n = vsnprintf(line, sizeof(line), fmt, args);
+            va_end(args);
+            if (n > 0) {
+                out->append(line, static_cast<size_t>(n) < sizeof(line) ? static_cast<size_t>(n) : sizeof(line) - 1);
+            }
+        }
+
+        void append_header(std::string* out, const MetricDesc& desc) {
+            static constexpr const char* kTypeNames[] = {"counter", "gauge", "histogram"};
+            append(out, "# HELP %s %s\n# TYPE %s %s\n", desc.name, desc.help, desc.name,
+                   kTypeNames[static_cast<size_t>(desc.type)]);
+        }
+
+        // name{label="value"} or bare name
+        void append_series_name(std::string* out, const MetricDesc& desc, size_t label) {
+            if (desc.label == nullptr) {
+                append(out, "%s ", desc.name);
+            }
+            else {
+                append(out, "%s{%s=\"%s\"} ", desc.name, desc.label, desc.label_values[label]);
+            }
+        }
+
+        void render_histogram(std::string* out, const MetricDesc& desc, size_t histogram) {
+            // Snapshot under the same mask the writers use so count, sum and buckets agree
+            static HistogramSeries snapshot;
+            UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+            memcpy(&snapshot, &g_metric_histograms[histogram], sizeof(snapshot));
+            portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+            size_t buckets = metrics_detail::histogram_buckets(desc);
+            uint32_t cumulative = 0;
+            for (size_t i = 0; i + 1 < buckets; i++) {
+                cumulative += snapshot.buckets[i];
+                append(out, "%s_bucket{le=\"%lu\"} %lu\n", desc.name,
+                       static_cast<unsigned long>(bucket_upper(desc, i)), static_cast<unsigned long>(cumulative));
+            }
+            append(out, "%s_bucket{le=\"+Inf\"} %lu\n", desc.name, static_cast<unsigned long>(snapshot.count));
+            append(out, "%s_sum %.0f\n", desc.name, static_cast<double>(snapshot.sum));
+            append(out, "%s_count %lu\n", desc.name, static_cast<unsigned long>(snapshot.count));
+        }
+    }
+
+    size_t histogram_bucket(const MetricDesc& desc, uint32_t value) {
+        if (value < (1u << desc.min_pow)) {
+            return 0;
+        }
+
+        uint32_t power = floor_log2(value);
+        if (power > desc.max_pow) {
+            return metrics_detail::histogram_buckets(desc) - 1;
+        }
+        uint32_t sub = (value >> (power - kSubBits)) & (MetricsConfig::kHistogramSubBuckets - 1);
+        return 1 + (power - desc.min_pow) * MetricsConfig::kHistogramSubBuckets + sub;
+    }
+
+    void histogram_observe(size_t histogram, const MetricDesc& desc, uint32_t value) {
+        size_t bucket = histogram_bucket(desc, value);
+
+        UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        HistogramSeries& series = g_metric_histograms[histogram];
+        series.buckets[bucket]++;
+        series.count++;
+        series.sum += value;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    }
+
+    void metrics_render(std::string* out) {
+        out->clear();
+        out->reserve(10240);
+
+        for (const MetricDesc& desc : kMetricTable) {
+            append_header(out, desc);
+            size_t offset = metrics_detail::series_offset(desc.id);
+
+            switch (desc.type) {
+                case MetricType::kCounter:
+                    for (size_t label = 0; label < desc.label_count; label++) {
+                        append_series_name(out, desc, label);
+                        append(out, "%lu\n", static_cast<unsigned long>(g_metric_counters[offset + label].load()));
+                    }
+                    break;
+                case MetricType::kGauge:
+                    for (size_t label = 0; label < desc.label_count; label++) {
+                        append_series_name(out, desc, label);
+                        append(out, "%g\n", static_cast<double>(g_metric_gauges[offset + label].load()));
+                    }
+                    break;
+                case MetricType::kHistogram:
+                    render_histogram(out, desc, offset);
+                    break;
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+// motion_gate.cc
+#include "m7/motion_gate.hh"
+
+namespace coralmicro {
+
+    namespace {
+        // BT.601 luma in 8.8 fixed point
+        inline uint8_t rgb_to_luma(const uint8_t* px) {
+            return static_cast<uint8_t>((77u * px[0] + 150u * px[1] + 29u * px[2]) >> 8);
+        }
+    }
+
+    bool MotionGate::update(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t bytes_per_pixel) {
+        if (!pixels || (bytes_per_pixel != 1 && bytes_per_pixel < 3)) {
+            return true; // Can't judge, don't gate
+        }
+
+        uint32_t w = width / MotionGateConfig::kDecimation;
+        uint32_t h = height / MotionGateConfig::kDecimation;
+        if (w > MotionGateConfig::kMaxDecimatedSide) w = MotionGateConfig::kMaxDecimatedSide;
+        if (h > MotionGateConfig::kMaxDecimatedSide) h = MotionGateConfig::kMaxDecimatedSide;
+
+        // Decimate to a luma plane
+        const uint32_t row_stride = width * bytes_per_pixel;
+        for (uint32_t y = 0; y < h; y++) {
+            const uint8_t* row = pixels + (y * MotionGateConfig::kDecimation) * row_stride;
+            for (uint32_t x = 0; x < w; x++) {
+                const uint8_t* px = row + (x * MotionGateConfig::kDecimation) * bytes_per_pixel;
+                luma_[y * w + x] = (bytes_per_pixel == 1) ? px[0] : rgb_to_luma(px);
+            }
+        }
+
+        // First frame (or a geometry change) seeds the background
+        if (!initialized_ || w != width_ || h != height_) {
+            for (uint32_t i = 0; i < w * h; i++) {
+                background_[i] = luma_[i];
+            }
+            width_ = w;
+            height_ = h;
+            initialized_ = true;
+            changed_blocks_ = 0;
+            return true;
+        }
+
+        // Block-wise SAD against the background
+        changed_blocks_ = 0;
+        for (uint32_t by = 0; by < h; by += MotionGateConfig::kBlockSize) {
+            for (uint32_t bx = 0; bx < w; bx += MotionGateConfig::kBlockSize) {
+                uint32_t sad = 0;
+                uint32_t count = 0;
+
+                for (uint32_t y = by; y < by + MotionGateConfig::kBlockSize && y < h; y++) {
+                    for (uint32_t x = bx; x < bx + MotionGateConfig::kBlockSize && x < w; x++) {
+                        int diff = static_cast<int>(luma_[y * w + x]) - static_cast<int>(background_[y * w + x]);
+                        sad += static_cast<uint32_t>(diff < 0 ? -diff : diff);
+                        count++;
+                    }
+                }
+
+                if (sad > MotionGateConfig::kBlockMeanAbsDiff * count) {
+                    changed_blocks_++;
+                }
+            }
+        }
+
+        // Fold the frame into the running background
+        for (uint32_t i = 0; i < w * h; i++) {
+            int diff = static_cast<int>(luma_[i]) - static_cast<int>(background_[i]);
+            int step = diff / (1 << MotionGateConfig::kBackgroundShift);
+            if (step == 0 && diff != 0) {
+                step = (diff > 0) ? 1 : -1; // Always converge, small offsets would otherwise read as motion forever
+            }
+            background_[i] = static_cast<uint8_t>(background_[i] + step);
+        }
+
+        return changed_blocks_ >= MotionGateConfig::kMinChangedBlocks;
+    }
+}
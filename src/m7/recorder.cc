@@ -0,0 +1,105 @@
+// recorder.cc
+#include "m7/recorder.hh"
+
+#include <cstring>
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/freertos_kernel/include/semphr.h"
+
+namespace coralmicro {
+
+    namespace {
+        static_assert((RecorderConfig::kRingBytes & (RecorderConfig::kRingBytes - 1)) == 0,
+                      "Recorder ring size must be a power of two");
+
+        // Too big for OCRAM, and only touched by memcpy
+        uint8_t g_ring[RecorderConfig::kRingBytes] __attribute__((aligned(32)))
+            __attribute__((section(".sdram_bss,\"aw\",%nobits @")));
+
+        SemaphoreHandle_t g_lock = nullptr;
+        uint64_t g_head = 0; // Stream offset of the next byte written
+        uint64_t g_tail = 0; // Stream offset of the oldest chunk held, always a chunk boundary
+
+        void ring_copy_in(uint64_t offset, const uint8_t* data, size_t size) {
+            if (size == 0) {
+                return;
+            }
+            size_t pos = static_cast<size_t>(offset & (RecorderConfig::kRingBytes - 1));
+            size_t first = RecorderConfig::kRingBytes - pos < size ? RecorderConfig::kRingBytes - pos : size;
+            memcpy(g_ring + pos, data, first);
+            memcpy(g_ring, data + first, size - first);
+        }
+
+        void ring_copy_out(uint64_t offset, uint8_t* data, size_t size) {
+            size_t pos = static_cast<size_t>(offset & (RecorderConfig::kRingBytes - 1));
+            size_t first = RecorderConfig::kRingBytes - pos < size ? RecorderConfig::kRingBytes - pos : size;
+            memcpy(data, g_ring + pos, first);
+            memcpy(data + first, g_ring, size - first);
+        }
+
+        // Drop whole chunks from the tail until size more bytes fit
+        void make_room(size_t size) {
+            while (g_head + size - g_tail > RecorderConfig::kRingBytes) {
+                uint8_t raw[RecordingFormat::kChunkHeaderBytes];
+                ChunkHeader header;
+                ring_copy_out(g_tail, raw, sizeof(raw));
+                unpack_chunk_header(raw, sizeof(raw), &header);
+                g_tail += RecordingFormat::kChunkHeaderBytes + header.length;
+                g_recorder_stats.evicted_chunks++;
+            }
+        }
+    }
+
+    bool recorder_init() {
+        g_lock = xSemaphoreCreateMutex();
+        return g_lock != nullptr;
+    }
+
+    bool recorder_write(ChunkType type, uint8_t aux, uint64_t timestamp_us,
+                        const uint8_t* head, size_t head_size,
+                        const uint8_t* body, size_t body_size) {
+        if (!RecorderConfig::kEnabled || g_lock == nullptr) {
+            return false;
+        }
+
+        size_t length = head_size + body_size;
+        if (RecordingFormat::kChunkHeaderBytes + length > RecorderConfig::kMaxChunkBytes) {
+            g_recorder_stats.rejected++;
+            return false;
+        }
+
+        uint8_t raw[RecordingFormat::kChunkHeaderBytes];
+        pack_chunk_header(ChunkHeader{type, aux, static_cast<uint32_t>(length), timestamp_us}, raw, sizeof(raw));
+
+        xSemaphoreTake(g_lock, portMAX_DELAY);
+        make_room(sizeof(raw) + length);
+        ring_copy_in(g_head, raw, sizeof(raw));
+        ring_copy_in(g_head + sizeof(raw), head, head_size);
+        ring_copy_in(g_head + sizeof(raw) + head_size, body, body_size);
+        g_head += sizeof(raw) + length;
+        xSemaphoreGive(g_lock);
+
+        g_recorder_stats.chunks++;
+        return true;
+    }
+
+    size_t recorder_read(uint64_t* offset, uint8_t* out, size_t capacity, uint64_t* end, uint64_t* dropped) {
+        *dropped = 0;
+        if (g_lock == nullptr) {
+            *end = 0;
+            return 0;
+        }
+
+        xSemaphoreTake(g_lock, portMAX_DELAY);
+        // A reader from before a reboot can be ahead of the stream; start it over as well
+        if (*offset < g_tail || *offset > g_head) {
+            *dropped = *offset < g_tail ? g_tail - *offset : 0;
+            *offset = g_tail;
+        }
+        size_t size = g_head - *offset < capacity ? static_cast<size_t>(g_head - *offset) : capacity;
+        ring_copy_out(*offset, out, size);
+        *end = g_head;
+        xSemaphoreGive(g_lock);
+        return size;
+    }
+}
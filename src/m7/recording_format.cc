@@ -0,0 +1,331 @@
+// recording_format.cc
+#include "m7/recording_format.hh"
+
+#include <cstring>
+
+namespace coralmicro {
+
+    namespace {
+        // Sequential little-endian field access; the M7 and the hosts that read these are little-endian
+        class Writer {
+        public:
+            Writer(uint8_t* out, size_t capacity) : out_(out), capacity_(capacity) {}
+
+            template <typename T>
+            void put(T value) {
+                if (used_ + sizeof(T) > capacity_) {
+                    overflow_ = true;
+                    return;
+                }
+                memcpy(out_ + used_, &value, sizeof(T));
+                used_ += sizeof(T);
+            }
+
+            size_t finish() const { return overflow_ ? 0 : used_; }
+
+        private:
+            uint8_t* out_;
+            size_t capacity_;
+            size_t used_ = 0;
+            bool overflow_ = false;
+        };
+
+        class Reader {
+        public:
+            Reader(const uint8_t* in, size_t size) : in_(in), size_(size) {}
+
+            template <typename T>
+            T get() {
+                T value{};
+                if (used_ + sizeof(T) > size_) {
+                    short_ = true;
+                    return value;
+                }
+                memcpy(&value, in_ + used_, sizeof(T));
+                used_ += sizeof(T);
+                return value;
+            }
+
+            const uint8_t* rest(size_t* size) const {
+                *size = size_ - used_;
+                return in_ + used_;
+            }
+
+            bool ok() const { return !short_; }
+            bool done() const { return !short_ && used_ == size_; }
+
+        private:
+            const uint8_t* in_;
+            size_t size_;
+            size_t used_ = 0;
+            bool short_ = false;
+        };
+    }
+
+    size_t pack_file_header(uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint32_t>(RecordingFormat::kMagic);
+        w.put<uint16_t>(RecordingFormat::kVersion);
+        w.put<uint16_t>(0);
+        w.put<uint64_t>(0);
+        return w.finish();
+    }
+
+    bool unpack_file_header(const uint8_t* in, size_t size, uint16_t* version) {
+        Reader r(in, size);
+        uint32_t magic = r.get<uint32_t>();
+        *version = r.get<uint16_t>();
+        r.get<uint16_t>();
+        r.get<uint64_t>();
+        return r.ok() && magic == RecordingFormat::kMagic;
+    }
+
+    size_t pack_chunk_header(const ChunkHeader& header, uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint8_t>(static_cast<uint8_t>(header.type));
+        w.put<uint8_t>(header.aux);
+        w.put<uint16_t>(0);
+        w.put<uint32_t>(header.length);
+        w.put<uint64_t>(header.timestamp_us);
+        return w.finish();
+    }
+
+    bool unpack_chunk_header(const uint8_t* in, size_t size, ChunkHeader* header) {
+        Reader r(in, size);
+        header->type = static_cast<ChunkType>(r.get<uint8_t>());
+        header->aux = r.get<uint8_t>();
+        r.get<uint16_t>();
+        header->length = r.get<uint32_t>();
+        header->timestamp_us = r.get<uint64_t>();
+        return r.ok();
+    }
+
+    size_t pack_camera_header(uint16_t width, uint16_t height, uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint16_t>(width);
+        w.put<uint16_t>(height);
+        return w.finish();
+    }
+
+    bool unpack_camera_frame(const uint8_t* in, size_t size, uint16_t* width, uint16_t* height,
+                             const uint8_t** data, size_t* data_size) {
+        Reader r(in, size);
+        *width = r.get<uint16_t>();
+        *height = r.get<uint16_t>();
+        *data = r.rest(data_size);
+        return r.ok();
+    }
+
+    size_t pack_tof_frame(const VL53L8CX_ResultsData& results, uint64_t frame_us, uint8_t zone_count,
+                          uint8_t* out, size_t capacity) {
+        if (zone_count > TofIntrusionConfig::kMaxZones) {
+            return 0;
+        }
+        Writer w(out, capacity);
+        w.put<uint64_t>(frame_us);
+        w.put<uint8_t>(zone_count);
+        for (uint8_t zone = 0; zone < zone_count; zone++) {
+            w.put<int16_t>(results.distance_mm[zone]);
+            w.put<uint8_t>(results.target_status[zone]);
+        }
+        return w.finish();
+    }
+
+    bool unpack_tof_frame(const uint8_t* in, size_t size, VL53L8CX_ResultsData* results, uint64_t* frame_us,
+                          uint8_t* zone_count) {
+        Reader r(in, size);
+        *frame_us = r.get<uint64_t>();
+        *zone_count = r.get<uint8_t>();
+        if (!r.ok() || *zone_count > TofIntrusionConfig::kMaxZones) {
+            return false;
+        }
+        for (uint8_t zone = 0; zone < *zone_count; zone++) {
+            results->distance_mm[zone] = r.get<int16_t>();
+            results->target_status[zone] = r.get<uint8_t>();
+        }
+        return r.done();
+    }
+
+    size_t pack_detections(const tensorflow::Object* objects, uint8_t count, uint64_t capture_us,
+                           uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint64_t>(capture_us);
+        w.put<uint8_t>(count);
+        for (uint8_t i = 0; i < count; i++) {
+            w.put<int32_t>(objects[i].id);
+            w.put<float>(objects[i].score);
+            w.put<float>(objects[i].bbox.ymin);
+            w.put<float>(objects[i].bbox.xmin);
+            w.put<float>(objects[i].bbox.ymax);
+            w.put<float>(objects[i].bbox.xmax);
+        }
+        return w.finish();
+    }
+
+    bool unpack_detections(const uint8_t* in, size_t size, tensorflow::Object* objects, size_t max_count,
+                           uint8_t* count, uint64_t* capture_us) {
+        Reader r(in, size);
+        *capture_us = r.get<uint64_t>();
+        *count = r.get<uint8_t>();
+        if (!r.ok() || *count > max_count) {
+            return false;
+        }
+        for (uint8_t i = 0; i < *count; i++) {
+            objects[i].id = r.get<int32_t>();
+            objects[i].score = r.get<float>();
+            objects[i].bbox.ymin = r.get<float>();
+            objects[i].bbox.xmin = r.get<float>();
+            objects[i].bbox.ymax = r.get<float>();
+            objects[i].bbox.xmax = r.get<float>();
+        }
+        return r.done();
+    }
+
+    size_t pack_depths(const float* depths, uint8_t count, uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint8_t>(count);
+        for (uint8_t i = 0; i < count; i++) {
+            w.put<float>(depths[i]);
+        }
+        return w.finish();
+    }
+
+    bool unpack_depths(const uint8_t* in, size_t size, float* depths, size_t max_count, uint8_t* count) {
+        Reader r(in, size);
+        *count = r.get<uint8_t>();
+        if (!r.ok() || *count > max_count) {
+            return false;
+        }
+        for (uint8_t i = 0; i < *count; i++) {
+            depths[i] = r.get<float>();
+        }
+        return r.done();
+    }
+
+    size_t pack_host_state(HostState state, uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint8_t>(static_cast<uint8_t>(state));
+        return w.finish();
+    }
+
+    bool unpack_host_state(const uint8_t* in, size_t size, HostState* state) {
+        Reader r(in, size);
+        *state = static_cast<HostState>(r.get<uint8_t>());
+        return r.done();
+    }
+
+    size_t pack_state_transition(const StateTransitionRecord& record, uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint8_t>(static_cast<uint8_t>(record.from));
+        w.put<uint8_t>(static_cast<uint8_t>(record.to));
+        w.put<uint8_t>(record.inputs);
+        return w.finish();
+    }
+
+    bool unpack_state_transition(const uint8_t* in, size_t size, StateTransitionRecord* record) {
+        Reader r(in, size);
+        record->from = static_cast<SystemState>(r.get<uint8_t>());
+        record->to = static_cast<SystemState>(r.get<uint8_t>());
+        record->inputs = r.get<uint8_t>();
+        return r.done();
+    }
+
+    size_t pack_approach_params(const ApproachParams& params, uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint8_t>(params.enabled ? 1 : 0);
+        w.put<uint32_t>(params.stop_budget_ms);
+        w.put<float>(params.min_speed_mm_s);
+        return w.finish();
+    }
+
+    bool unpack_approach_params(const uint8_t* in, size_t size, ApproachParams* params) {
+        Reader r(in, size);
+        params->enabled = r.get<uint8_t>() != 0;
+        params->stop_budget_ms = r.get<uint32_t>();
+        params->min_speed_mm_s = r.get<float>();
+        return r.done();
+    }
+
+    size_t pack_danger_zones(const DangerZoneSet& set, uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint8_t>(set.count);
+        for (uint8_t z = 0; z < set.count && z < DangerZoneConfig::kMaxZones; z++) {
+            const DangerZone& zone = set.zones[z];
+            w.put<float>(zone.stop_mm);
+            w.put<float>(zone.warning_mm);
+            w.put<uint8_t>(zone.vertex_count);
+            for (uint8_t v = 0; v < zone.vertex_count && v < DangerZoneConfig::kMaxVertices; v++) {
+                w.put<uint16_t>(zone.vertices[v].x);
+                w.put<uint16_t>(zone.vertices[v].y);
+            }
+        }
+        return w.finish();
+    }
+
+    bool unpack_danger_zones(const uint8_t* in, size_t size, DangerZoneSet* set) {
+        Reader r(in, size);
+        *set = {};
+        set->count = r.get<uint8_t>();
+        if (!r.ok() || set->count > DangerZoneConfig::kMaxZones) {
+            return false;
+        }
+        for (uint8_t z = 0; z < set->count; z++) {
+            DangerZone& zone = set->zones[z];
+            zone.stop_mm = r.get<float>();
+            zone.warning_mm = r.get<float>();
+            zone.vertex_count = r.get<uint8_t>();
+            if (!r.ok() || zone.vertex_count > DangerZoneConfig::kMaxVertices) {
+                return false;
+            }
+            for (uint8_t v = 0; v < zone.vertex_count; v++) {
+                zone.vertices[v].x = r.get<uint16_t>();
+                zone.vertices[v].y = r.get<uint16_t>();
+            }
+        }
+        return r.done();
+    }
+
+    size_t pack_ground_truth(const GroundTruthPerson* persons, uint8_t count, uint64_t capture_us,
+                             uint8_t* out, size_t capacity) {
+        Writer w(out, capacity);
+        w.put<uint64_t>(capture_us);
+        w.put<uint8_t>(count);
+        for (uint8_t i = 0; i < count; i++) {
+            w.put<float>(persons[i].bbox.ymin);
+            w.put<float>(persons[i].bbox.xmin);
+            w.put<float>(persons[i].bbox.ymax);
+            w.put<float>(persons[i].bbox.xmax);
+            w.put<float>(persons[i].distance_mm);
+        }
+        return w.finish();
+    }
+
+    bool unpack_ground_truth(const uint8_t* in, size_t size, GroundTruthPerson* persons, size_t max_count,
+                             uint8_t* count, uint64_t* capture_us) {
+        Reader r(in, size);
+        *capture_us = r.get<uint64_t>();
+        *count = r.get<uint8_t>();
+        if (!r.ok() || *count > max_count) {
+            return false;
+        }
+        for (uint8_t i = 0; i < *count; i++) {
+            persons[i].bbox.ymin = r.get<float>();
+            persons[i].bbox.xmin = r.get<float>();
+            persons[i].bbox.ymax = r.get<float>();
+            persons[i].bbox.xmax = r.get<float>();
+            persons[i].distance_mm = r.get<float>();
+        }
+        return r.done();
+    }
+
+    bool ChunkReader::next(ChunkHeader* header, const uint8_t** payload) {
+        if (size_ - offset_ < RecordingFormat::kChunkHeaderBytes ||
+            !unpack_chunk_header(data_ + offset_, size_ - offset_, header) ||
+            header->length > size_ - offset_ - RecordingFormat::kChunkHeaderBytes) {
+            return false;
+        }
+        *payload = data_ + offset_ + RecordingFormat::kChunkHeaderBytes;
+        offset_ += RecordingFormat::kChunkHeaderBytes + header->length;
+        return true;
+    }
+}
@@ -28,10 +28,11 @@ namespace coralmicro {
             // Set host condition to CONNECTED and send to state controller via queue
             HostConnectionStatus new_condition = HostConnectionStatus::CONNECTED;
 
-            if (xQueueOverwrite(g_host_connection_status_queue_m7, &new_condition) != pdTRUE) {
+            if (!channel_overwrite(Channel::kHostConnection, &new_condition)) {
                 jsonrpc_return_error(request, -1, "Failed to update host condition", NULL);
                 return;
             }
+            NotifyStateController(kEventHeartbeat);
             
             // Return a clean success response
             jsonrpc_return_success(request, "{}");
@@ -63,10 +64,11 @@ namespace coralmicro {
             printf("Parsed host_state value: %d (%f)\r\n", host_state_int, host_state_double);
             
             // Send the properly converted host state to the state controller via queue
-            if (xQueueOverwrite(g_host_state_queue_m7, &host_state_enum) != pdTRUE) {
+            if (!channel_overwrite(Channel::kHostState, &host_state_enum)) {
                 jsonrpc_return_error(request, -1, "Failed to update host state", NULL);
                 return;
             }
+            NotifyStateController(kEventHostState);
             
             // Return a clean success response
             jsonrpc_return_success(request, "{}");
@@ -79,9 +81,10 @@ namespace coralmicro {
     
     void tx_logs_to_host(struct jsonrpc_request* request) {
         // Static instance to hold the data
+        PROFILE_ZONE("rpc_logs");
         static LoggingData logging_data;
 
-        if (xQueueReceive(g_logging_queue_m7, &logging_data, 0) != pdTRUE) {
+        if (!channel_receive(Channel::kLogging, &logging_data)) {
             jsonrpc_return_error(request, -1, "No logging data available", NULL);
             return;
         }
@@ -92,26 +95,649 @@ namespace coralmicro {
         
         // Build response with all the components
         jsonrpc_return_success(request, 
-            "{%Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %V, %Q: %V, %Q: %d, %Q: %d, %Q: %d, %Q: %V}",
-            "log_timestamp_ms", logging_data.timestamp_ms,
+            "{%Q: %g, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %V, %Q: %V, %Q: %g, %Q: %d, %Q: %d, %Q: %V}",
+            "log_timestamp_us", static_cast<double>(logging_data.timestamp_us),
             "system_state", static_cast<int>(logging_data.system_state),
             "detection_count", logging_data.detection_data.detection_count,
-            "inference_time_ms", logging_data.detection_data.inference_time_ms,
-            "depth_estimation_time_ms", logging_data.depth_estimation_data.depth_estimation_time_ms,
+            "inference_time_us", logging_data.detection_data.inference_time_us,
+            "depth_estimation_time_us", logging_data.depth_estimation_data.depth_estimation_time_us,
+            "reaction_latency_us", logging_data.reaction_latency_us,
+            "tof_intrusion", static_cast<int>(logging_data.tof_intrusion),
             "detections", detection_bytes, logging_data.detection_data.detections,
             "depths", depth_bytes, logging_data.depth_estimation_data.depths,
-            "image_capture_timestamp_ms", logging_data.detection_data.camera_data.timestamp_ms,
+            "image_capture_timestamp_us", static_cast<double>(logging_data.detection_data.camera_data.timestamp_us),
             "cam_width", logging_data.detection_data.camera_data.width,
             "cam_height", logging_data.detection_data.camera_data.height,
             "image_data", logging_data.detection_data.camera_data.image_data->size(),  logging_data.detection_data.camera_data.image_data->data()
         );
     }
 
+    void tx_inference_stats(struct jsonrpc_request* request) {
+        uint32_t frames_seen = g_inference_stats.frames_seen.load();
+        uint32_t motion_skips = g_inference_stats.motion_skips.load();
+        double skip_ratio = frames_seen > 0 ? static_cast<double>(motion_skips) / frames_seen : 0.0;
+
+        jsonrpc_return_success(request,
+            "{%Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %g, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d}",
+            "frames_seen", frames_seen,
+            "invocations", g_inference_stats.invocations.load(),
+            "motion_skips", motion_skips,
+            "forced_refreshes", g_inference_stats.forced_refreshes.load(),
+            "skip_ratio", skip_ratio,
+            "governor_mode", g_inference_stats.governor_mode.load(),
+            "governor_mode_changes", g_inference_stats.governor_mode_changes.load(),
+            "idle_mode_ms", g_inference_stats.governor_time_in_mode_ms[static_cast<size_t>(InferenceMode::IDLE)].load(),
+            "normal_mode_ms", g_inference_stats.governor_time_in_mode_ms[static_cast<size_t>(InferenceMode::NORMAL)].load(),
+            "alert_mode_ms", g_inference_stats.governor_time_in_mode_ms[static_cast<size_t>(InferenceMode::ALERT)].load()
+        );
+    }
+
+    void tx_camera_stats(struct jsonrpc_request* request) {
+        jsonrpc_return_success(request,
+            "{%Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %B}",
+            "frames_captured", g_camera_stats.frames_captured.load(),
+            "warmup_frames", g_camera_stats.warmup_frames.load(),
+            "conversion_cycles_last", g_camera_stats.conversion_cycles_last.load(),
+            "conversion_cycles_avg", g_camera_stats.conversion_cycles_avg.load(),
+            "conversion_cycles_max", g_camera_stats.conversion_cycles_max.load(),
+            "fused_conversion", CameraConfig::kFusedConversion
+        );
+    }
+
+    void tx_cascade_stats(struct jsonrpc_request* request) {
+        jsonrpc_return_success(request,
+            "{%Q: %B, %Q: %g, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %g}",
+            "cascade_active", g_inference_stats.cascade_active.load(),
+            "fire_threshold", static_cast<double>(g_cascade_settings.fire_threshold.load()),
+            "refresh_ms", g_cascade_settings.refresh_ms.load(),
+            "gate_runs", g_inference_stats.gate_runs.load(),
+            "gate_fires", g_inference_stats.gate_fires.load(),
+            "ssd_skips", g_inference_stats.cascade_skips.load(),
+            "ssd_refreshes", g_inference_stats.cascade_refreshes.load(),
+            "hits", g_inference_stats.cascade_hits.load(),
+            "false_alarms", g_inference_stats.cascade_false_alarms.load(),
+            "misses", g_inference_stats.cascade_misses.load(),
+            "gate_time_us", g_inference_stats.gate_time_us.load(),
+            "gate_score", static_cast<double>(g_inference_stats.gate_score.load())
+        );
+    }
+
+    // Either parameter may be omitted
+    void rx_cascade_config(struct jsonrpc_request* request) {
+        if (request->params == nullptr) {
+            JsonRpcReturnBadParam(request, "Missing parameters", "fire_threshold");
+            return;
+        }
+
+        size_t params_len = strlen(request->params);
+        double fire_threshold;
+        double refresh_ms;
+        bool has_threshold = mjson_get_number(request->params, params_len, "$.fire_threshold", &fire_threshold);
+        bool has_refresh = mjson_get_number(request->params, params_len, "$.refresh_ms", &refresh_ms);
+
+        if (!has_threshold && !has_refresh) {
+            JsonRpcReturnBadParam(request, "Expected fire_threshold and/or refresh_ms", "fire_threshold");
+            return;
+        }
+        if (has_threshold && (fire_threshold < 0.0 || fire_threshold > 1.0)) {
+            JsonRpcReturnBadParam(request, "fire_threshold must be within [0, 1]", "fire_threshold");
+            return;
+        }
+        if (has_refresh && !(refresh_ms >= 0.0 && refresh_ms <= CascadeConfig::kMaxRefreshMs)) {
+            JsonRpcReturnBadParam(request, "refresh_ms must be within [0, 60000]", "refresh_ms");
+            return;
+        }
+
+        if (has_threshold) {
+            g_cascade_settings.fire_threshold = static_cast<float>(fire_threshold);
+        }
+        if (has_refresh) {
+            g_cascade_settings.refresh_ms = static_cast<uint32_t>(refresh_ms);
+        }
+
+        jsonrpc_return_success(request, "{}");
+    }
+
+    namespace {
+        // {"tag": {...}} entry of a profile summary, cycles and microseconds
+        int print_profile_entry(char* out, size_t size, const ProfileEntry& entry, bool first) {
+            return snprintf(out, size,
+                "%s\"%s\": {\"samples\": %lu, \"last_cycles\": %lu, \"mean_cycles\": %lu, \"max_cycles\": %lu, "
+                "\"mean_us\": %lu, \"max_us\": %lu}",
+                first ? "" : ", ", entry.tag ? entry.tag : "?",
+                static_cast<unsigned long>(entry.samples),
+                static_cast<unsigned long>(entry.last_cycles),
+                static_cast<unsigned long>(entry.mean_cycles),
+                static_cast<unsigned long>(entry.max_cycles),
+                static_cast<unsigned long>(profile_cycles_to_us(entry.mean_cycles)),
+                static_cast<unsigned long>(profile_cycles_to_us(entry.max_cycles)));
+        }
+    }
+
+    void tx_inference_profile(struct jsonrpc_request* request) {
+        static ProfileSummary summary;
+        static char json[3072];
+
+        if (!InferenceProfilerConfig::kEnabled || !channel_peek(Channel::kProfile, &summary)) {
+            jsonrpc_return_error(request, -1, "No profile data available", NULL);
+            return;
+        }
+
+        size_t used = snprintf(json, sizeof(json), "{\"inferences\": %lu, \"window\": %u, \"dropped_events\": %lu, \"stages\": {",
+            static_cast<unsigned long>(summary.inferences),
+            static_cast<unsigned>(InferenceProfilerConfig::kWindow),
+            static_cast<unsigned long>(summary.dropped_events));
+
+        for (size_t i = 0; i < kProfileStageCount && used < sizeof(json); i++) {
+            used += print_profile_entry(json + used, sizeof(json) - used, summary.stages[i], i == 0);
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "}, \"ops\": {");
+        }
+        for (size_t i = 0; i < summary.op_count && used < sizeof(json); i++) {
+            used += print_profile_entry(json + used, sizeof(json) - used, summary.ops[i], i == 0);
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "}}");
+        }
+
+        if (used >= sizeof(json)) {
+            jsonrpc_return_error(request, -1, "Profile summary too large", NULL);
+            return;
+        }
+
+        jsonrpc_return_success(request, "%s", json);
+    }
+
+    // Rings in use and the queue names the kernel ring refers to
+    void tx_trace_info(struct jsonrpc_request* request) {
+        static char json[1536];
+
+        size_t used = snprintf(json, sizeof(json),
+            "{\"cycles_hz\": %lu, \"dropped_tasks\": %lu, \"dropped_objects\": %lu, \"kernel_ring\": %u, "
+            "\"kernel_hooks\": %s, \"rings\": [",
+            static_cast<unsigned long>(timebase_cycle_hz()),
+            static_cast<unsigned long>(g_trace_stats.dropped_tasks.load()),
+            static_cast<unsigned long>(g_trace_stats.dropped_objects.load()),
+            static_cast<unsigned>(kTraceKernelRing),
+            trace_kernel_hooks_installed() ? "true" : "false");
+
+        bool first = true;
+        for (size_t ring = 0; ring < kTraceRingCount && used < sizeof(json); ring++) {
+            const char* name = trace_ring_name(ring);
+            if (name[0] == '\0') {
+                continue;
+            }
+            used += snprintf(json + used, sizeof(json) - used, "%s{\"ring\": %u, \"name\": \"%s\"}",
+                             first ? "" : ", ", static_cast<unsigned>(ring), name);
+            first = false;
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "], \"objects\": [");
+        }
+
+        first = true;
+        for (size_t i = 0; i < trace_object_count() && used < sizeof(json); i++) {
+            const void* handle;
+            const char* name;
+            if (!trace_object(i, &handle, &name)) {
+                continue;
+            }
+            used += snprintf(json + used, sizeof(json) - used, "%s{\"ref\": %lu, \"name\": \"%s\"}",
+                             first ? "" : ", ", static_cast<unsigned long>(reinterpret_cast<uintptr_t>(handle)), name);
+            first = false;
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "]}");
+        }
+
+        if (used >= sizeof(json)) {
+            jsonrpc_return_error(request, -1, "Trace info too large", NULL);
+            return;
+        }
+
+        jsonrpc_return_success(request, "%s", json);
+    }
+
+    namespace {
+        // Little-endian wire record decoded by scripts/trace_to_chrome.py
+        constexpr size_t kTraceWireRecordSize = 12;
+
+        void pack_trace_record(const TraceRecord& record, uint8_t* out) {
+            uint32_t ref = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(record.ref));
+            memcpy(out, &record.cycles, 4);
+            memcpy(out + 4, &ref, 4);
+            out[8] = static_cast<uint8_t>(record.type);
+            out[9] = record.slot;
+            out[10] = 0;
+            out[11] = 0;
+        }
+    }
+
+    // One ring as base64 records plus an anchor pairing the cycle counter with timebase_us
+    void tx_trace_dump(struct jsonrpc_request* request) {
+        static TraceRecord records[ZoneProfilerConfig::kKernelRingSize];
+        static uint8_t wire[ZoneProfilerConfig::kKernelRingSize * kTraceWireRecordSize];
+        static char names[1024];
+        static_assert(ZoneProfilerConfig::kKernelRingSize >= ZoneProfilerConfig::kTaskRingSize,
+                      "Dump buffers are sized for the larger ring");
+
+        double ring_double;
+        if (request->params == nullptr ||
+            !mjson_get_number(request->params, strlen(request->params), "$.ring", &ring_double) ||
+            ring_double < 0 || ring_double >= kTraceRingCount) {
+            JsonRpcReturnBadParam(request, "Missing or invalid ring", "ring");
+            return;
+        }
+        size_t ring = static_cast<size_t>(ring_double);
+
+        uint32_t written = 0;
+        size_t count = trace_snapshot(ring, records, ZoneProfilerConfig::kKernelRingSize, &written);
+        uint32_t anchor_cycles = cycle_counter_read();
+        uint64_t anchor_us = timebase_us();
+
+        // Zone names by ref; kernel records name tasks by ring and queues via tx_trace_info
+        size_t used = snprintf(names, sizeof(names), "{");
+        for (size_t i = 0; i < count; i++) {
+            pack_trace_record(records[i], wire + i * kTraceWireRecordSize);
+
+            if (records[i].type != TraceEvent::kZoneBegin || used >= sizeof(names)) {
+                continue;
+            }
+            bool seen = false;
+            for (size_t j = 0; j < i && !seen; j++) {
+                seen = records[j].type == TraceEvent::kZoneBegin && records[j].ref == records[i].ref;
+            }
+            if (!seen) {
+                used += snprintf(names + used, sizeof(names) - used, "%s\"%lu\": \"%s\"", used > 1 ? ", " : "",
+                                 static_cast<unsigned long>(reinterpret_cast<uintptr_t>(records[i].ref)),
+                                 static_cast<const char*>(records[i].ref));
+            }
+        }
+        if (used < sizeof(names)) {
+            used += snprintf(names + used, sizeof(names) - used, "}");
+        }
+        if (used >= sizeof(names)) {
+            jsonrpc_return_error(request, -1, "Too many zone names", NULL);
+            return;
+        }
+
+        jsonrpc_return_success(request,
+            "{%Q: %d, %Q: %Q, %Q: %g, %Q: %d, %Q: %g, %Q: %g, %Q: %V, %Q: %s}",
+            "ring", static_cast<int>(ring),
+            "name", trace_ring_name(ring),
+            "written", static_cast<double>(written),
+            "count", static_cast<int>(count),
+            "anchor_cycles", static_cast<double>(anchor_cycles),
+            "anchor_us", static_cast<double>(anchor_us),
+            "records", static_cast<int>(count * kTraceWireRecordSize), wire,
+            "names", names
+        );
+    }
+
+    void tx_log_stats(struct jsonrpc_request* request) {
+        jsonrpc_return_success(request,
+            "{%Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %d, %Q: %B}",
+            "records", g_log_stats.records.load(),
+            "dropped", g_log_stats.dropped.load(),
+            "drained_bytes", g_log_stats.drained_bytes.load(),
+            "min_level", static_cast<int>(LogConfig::kMinLevel),
+            "cost_cycles_last", g_log_stats.cost_cycles_last.load(),
+            "cost_cycles_avg", g_log_stats.cost_cycles_avg.load(),
+            "cost_cycles_max", g_log_stats.cost_cycles_max.load(),
+            "binary_sink", LogConfig::kSink == LogSink::kBinary
+        );
+    }
+
+    // Per-channel traffic: overwrites show which consumer falls behind its producer
+    void tx_channel_stats(struct jsonrpc_request* request) {
+        static char json[3072];
+
+        size_t used = snprintf(json, sizeof(json), "{\"enabled\": %s, \"channels\": [",
+                               ChannelConfig::kEnabled ? "true" : "false");
+        for (size_t i = 0; i < kChannelCount && used < sizeof(json); i++) {
+            const ChannelStats& stats = g_channel_stats[i];
+            used += snprintf(json + used, sizeof(json) - used,
+                "%s{\"name\": \"%s\", \"writes\": %lu, \"overwrites\": %lu, \"reads\": %lu, "
+                "\"empty_reads\": %lu, \"peeks\": %lu, \"age_us_last\": %lu, \"age_us_avg\": %lu, \"age_us_max\": %lu}",
+                i == 0 ? "" : ", ", kChannelNames[i],
+                static_cast<unsigned long>(stats.writes.load()),
+                static_cast<unsigned long>(stats.overwrites.load()),
+                static_cast<unsigned long>(stats.reads.load()),
+                static_cast<unsigned long>(stats.empty_reads.load()),
+                static_cast<unsigned long>(stats.peeks.load()),
+                static_cast<unsigned long>(stats.age_us_last.load()),
+                static_cast<unsigned long>(stats.age_us_avg.load()),
+                static_cast<unsigned long>(stats.age_us_max.load()));
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "]}");
+        }
+
+        if (used >= sizeof(json)) {
+            jsonrpc_return_error(request, -1, "Channel stats too large", NULL);
+            return;
+        }
+
+        jsonrpc_return_success(request, "%s", json);
+    }
+
+    // Boot timeline; phases not reached yet report 0
+    void tx_boot_report(struct jsonrpc_request* request) {
+        static char json[2048];
+
+        size_t used = snprintf(json, sizeof(json), "{\"scheduler_ms\": %lu, \"first_state\": %d, \"phases\": [",
+                               static_cast<unsigned long>(g_boot_stats.scheduler_ms.load()),
+                               g_boot_stats.first_state.load());
+        for (size_t i = 0; i < kBootPhaseCount && used < sizeof(json); i++) {
+            used += snprintf(json + used, sizeof(json) - used, "%s{\"name\": \"%s\", \"start_us\": %lu, \"end_us\": %lu}",
+                             i == 0 ? "" : ", ", kBootPhaseNames[i],
+                             static_cast<unsigned long>(g_boot_stats.phases[i].start_us.load()),
+                             static_cast<unsigned long>(g_boot_stats.phases[i].end_us.load()));
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "]}");
+        }
+
+        if (used >= sizeof(json)) {
+            jsonrpc_return_error(request, -1, "Boot report too large", NULL);
+            return;
+        }
+
+        jsonrpc_return_success(request, "%s", json);
+    }
+
+    // ToF I2C traffic per bus
+    void tx_tof_bus_stats(struct jsonrpc_request* request) {
+        static char json[1024];
+
+        size_t used = snprintf(json, sizeof(json), "{\"baud_hz\": %lu, \"buses\": [",
+                               static_cast<unsigned long>(TofPlatformConfig::kBaudHz));
+        for (size_t i = 0; i < kTofBusCount && used < sizeof(json); i++) {
+            const TofBusStats& stats = g_tof_bus_stats[i];
+            used += snprintf(json + used, sizeof(json) - used,
+                "%s{\"name\": \"%s\", \"transfers\": %lu, \"dma_transfers\": %lu, \"bytes_read\": %lu, "
+                "\"bytes_written\": %lu, \"errors\": %lu, \"timeouts\": %lu, \"busy_us\": %lu, "
+                "\"transfer_us_last\": %lu, \"transfer_us_max\": %lu}",
+                i == 0 ? "" : ", ", kTofBusNames[i],
+                static_cast<unsigned long>(stats.transfers.load()),
+                static_cast<unsigned long>(stats.dma_transfers.load()),
+                static_cast<unsigned long>(stats.bytes_read.load()),
+                static_cast<unsigned long>(stats.bytes_written.load()),
+                static_cast<unsigned long>(stats.errors.load()),
+                static_cast<unsigned long>(stats.timeouts.load()),
+                static_cast<unsigned long>(stats.busy_us.load()),
+                static_cast<unsigned long>(stats.transfer_us_last.load()),
+                static_cast<unsigned long>(stats.transfer_us_max.load()));
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "]}");
+        }
+
+        if (used >= sizeof(json)) {
+            jsonrpc_return_error(request, -1, "ToF bus stats too large", NULL);
+            return;
+        }
+
+        jsonrpc_return_success(request, "%s", json);
+    }
+
+    void tx_tof_sensor_stats(struct jsonrpc_request* request) {
+        static char json[1024];
+
+        size_t used = snprintf(json, sizeof(json), "{\"sensors\": [");
+        for (size_t i = 0; i < kTofSensorCount && used < sizeof(json); i++) {
+            const TofSensorConfig& sensor = kTofSensors[i];
+            const TofSensorStats& stats = g_tof_sensor_stats[i];
+            used += snprintf(json + used, sizeof(json) - used,
+                "%s{\"name\": \"%s\", \"bus\": \"%s\", \"address\": %u, \"frames\": %lu, \"errors\": %lu, "
+                "\"read_us_last\": %lu, \"read_us_max\": %lu, \"frame_interval_us\": %lu, \"bus_utilization\": %.3f}",
+                i == 0 ? "" : ", ", sensor.name, kTofBusNames[static_cast<size_t>(tof_bus(sensor.bus))],
+                static_cast<unsigned>(sensor.address),
+                static_cast<unsigned long>(stats.frames.load()),
+                static_cast<unsigned long>(stats.errors.load()),
+                static_cast<unsigned long>(stats.read_us_last.load()),
+                static_cast<unsigned long>(stats.read_us_max.load()),
+                static_cast<unsigned long>(stats.frame_interval_us.load()),
+                stats.busy_permille.load() / 1000.0);
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "]}");
+        }
+
+        if (used >= sizeof(json)) {
+            jsonrpc_return_error(request, -1, "ToF sensor stats too large", NULL);
+            return;
+        }
+
+        jsonrpc_return_success(request, "%s", json);
+    }
+
+    // Next piece of the capture stream from params.offset (0 = oldest held). The host appends
+    // data to its file and asks again from offset + len(data); scripts/fetch_recording.py
+    void tx_recording(struct jsonrpc_request* request) {
+        static uint8_t data[RecorderConfig::kRpcBytes];
+
+        double offset_double = 0;
+        if (request->params != nullptr) {
+            mjson_get_number(request->params, strlen(request->params), "$.offset", &offset_double);
+        }
+        if (offset_double < 0) {
+            JsonRpcReturnBadParam(request, "Invalid offset", "offset");
+            return;
+        }
+
+        uint64_t offset = static_cast<uint64_t>(offset_double);
+        uint64_t end = 0;
+        uint64_t dropped = 0;
+        size_t size = recorder_read(&offset, data, sizeof(data), &end, &dropped);
+
+        jsonrpc_return_success(request,
+            "{%Q: %d, %Q: %g, %Q: %g, %Q: %g, %Q: %d, %Q: %d, %Q: %d, %Q: %V}",
+            "version", static_cast<int>(RecordingFormat::kVersion),
+            "offset", static_cast<double>(offset),
+            "end", static_cast<double>(end),
+            "dropped", static_cast<double>(dropped),
+            "chunks", g_recorder_stats.chunks.load(),
+            "evicted_chunks", g_recorder_stats.evicted_chunks.load(),
+            "rejected", g_recorder_stats.rejected.load(),
+            "data", static_cast<int>(size), data
+        );
+    }
+
+    void tx_approach_stats(struct jsonrpc_request* request) {
+        jsonrpc_return_success(request,
+            "{%Q: %B, %Q: %d, %Q: %g, %Q: %d, %Q: %d, %Q: %B, %Q: %d, %Q: %g}",
+            "enabled", g_approach_settings.enabled.load(),
+            "stop_budget_ms", g_approach_settings.stop_budget_ms.load(),
+            "min_speed_mm_s", static_cast<double>(g_approach_settings.min_speed_mm_s.load()),
+            "predicted_stops", g_approach_stats.predicted_stops.load(),
+            "tracks", g_approach_stats.tracks.load(),
+            "approaching", g_approach_stats.approaching.load(),
+            "time_to_threshold_ms", g_approach_stats.time_to_threshold_ms.load(),
+            "speed_mm_s", static_cast<double>(g_approach_stats.speed_mm_s.load())
+        );
+    }
+
+    // Any of the parameters may be omitted
+    void rx_approach_config(struct jsonrpc_request* request) {
+        if (request->params == nullptr) {
+            JsonRpcReturnBadParam(request, "Missing parameters", "stop_budget_ms");
+            return;
+        }
+
+        size_t params_len = strlen(request->params);
+        int enabled;
+        double stop_budget_ms;
+        double min_speed_mm_s;
+        bool has_enabled = mjson_get_bool(request->params, params_len, "$.enabled", &enabled);
+        bool has_budget = mjson_get_number(request->params, params_len, "$.stop_budget_ms", &stop_budget_ms);
+        bool has_speed = mjson_get_number(request->params, params_len, "$.min_speed_mm_s", &min_speed_mm_s);
+
+        if (!has_enabled && !has_budget && !has_speed) {
+            JsonRpcReturnBadParam(request, "Expected enabled, stop_budget_ms and/or min_speed_mm_s", "stop_budget_ms");
+            return;
+        }
+        if (has_budget && (stop_budget_ms < 0.0 || stop_budget_ms > 10000.0)) {
+            JsonRpcReturnBadParam(request, "stop_budget_ms must be within [0, 10000]", "stop_budget_ms");
+            return;
+        }
+        if (has_speed && (min_speed_mm_s <= 0.0 || min_speed_mm_s > ApproachConfig::kMaxSpeedMmS)) {
+            JsonRpcReturnBadParam(request, "min_speed_mm_s must be positive and below the max speed", "min_speed_mm_s");
+            return;
+        }
+
+        if (has_enabled) {
+            g_approach_settings.enabled = enabled != 0;
+        }
+        if (has_budget) {
+            g_approach_settings.stop_budget_ms = static_cast<uint32_t>(stop_budget_ms);
+        }
+        if (has_speed) {
+            g_approach_settings.min_speed_mm_s = static_cast<float>(min_speed_mm_s);
+        }
+
+        jsonrpc_return_success(request, "{}");
+    }
+
+    namespace {
+        DangerZoneSet g_uploaded_zones = default_danger_zones(); // Last set rx_danger_zones accepted
+    }
+
+    // The zones, the ToF cells each one was compiled to (per sensor, bit n for cell n) and how
+    // often each one stopped someone
+    void tx_danger_zones(struct jsonrpc_request* request) {
+        static char json[2048];
+
+        const DangerZoneSet& set = g_uploaded_zones;
+        size_t used = snprintf(json, sizeof(json), "{\"updates\": %lu, \"zones\": [",
+                               static_cast<unsigned long>(g_danger_zone_stats.updates.load()));
+        for (uint8_t z = 0; z < set.count && used < sizeof(json); z++) {
+            const DangerZone& zone = set.zones[z];
+            used += snprintf(json + used, sizeof(json) - used,
+                "%s{\"stop_mm\": %.0f, \"warning_mm\": %.0f, \"stops\": %lu, \"polygon\": [",
+                z == 0 ? "" : ", ", static_cast<double>(zone.stop_mm), static_cast<double>(zone.warning_mm),
+                static_cast<unsigned long>(g_danger_zone_stats.stops[z].load()));
+            for (uint8_t v = 0; v < zone.vertex_count && used < sizeof(json); v++) {
+                used += snprintf(json + used, sizeof(json) - used, "%s[%u, %u]", v == 0 ? "" : ", ",
+                                 static_cast<unsigned>(zone.vertices[v].x), static_cast<unsigned>(zone.vertices[v].y));
+            }
+            for (size_t sensor = 0; sensor < kTofSensorCount && used < sizeof(json); sensor++) {
+                used += snprintf(json + used, sizeof(json) - used, "%s%lu", sensor == 0 ? "], \"cells\": [" : ", ",
+                                 static_cast<unsigned long>(g_danger_zone_stats.cells[z][sensor].load()));
+            }
+            if (used < sizeof(json)) {
+                used += snprintf(json + used, sizeof(json) - used, "]}");
+            }
+        }
+        if (used < sizeof(json)) {
+            used += snprintf(json + used, sizeof(json) - used, "]}");
+        }
+
+        if (used >= sizeof(json)) {
+            jsonrpc_return_error(request, -1, "Danger zones too large", NULL);
+            return;
+        }
+
+        jsonrpc_return_success(request, "%s", json);
+    }
+
+    // Replaces every zone: {"zones": [{"stop_mm": 600, "warning_mm": 1500, "polygon": [[x, y], ...]}, ...]}
+    // in image pixels. warning_mm may be omitted to warn at any distance.
+    void rx_danger_zones(struct jsonrpc_request* request) {
+        if (request->params == nullptr) {
+            JsonRpcReturnBadParam(request, "Missing parameters", "zones");
+            return;
+        }
+
+        size_t params_len = strlen(request->params);
+        char path[48];
+        static DangerZoneSet set; // Too big for the RPC task's stack
+        set = {};
+        for (uint8_t z = 0; z <= DangerZoneConfig::kMaxZones; z++) {
+            double stop_mm;
+            snprintf(path, sizeof(path), "$.zones[%u].stop_mm", static_cast<unsigned>(z));
+            if (!mjson_get_number(request->params, params_len, path, &stop_mm)) {
+                break;
+            }
+            if (z == DangerZoneConfig::kMaxZones) {
+                JsonRpcReturnBadParam(request, "Too many zones", "zones");
+                return;
+            }
+
+            DangerZone& zone = set.zones[z];
+            double warning_mm = DangerZoneConfig::kUnlimitedMm;
+            snprintf(path, sizeof(path), "$.zones[%u].warning_mm", static_cast<unsigned>(z));
+            mjson_get_number(request->params, params_len, path, &warning_mm);
+            zone.stop_mm = static_cast<float>(stop_mm);
+            zone.warning_mm = static_cast<float>(warning_mm);
+
+            for (uint8_t v = 0; v <= DangerZoneConfig::kMaxVertices; v++) {
+                double x, y;
+                snprintf(path, sizeof(path), "$.zones[%u].polygon[%u][0]", static_cast<unsigned>(z), static_cast<unsigned>(v));
+                bool has_x = mjson_get_number(request->params, params_len, path, &x);
+                snprintf(path, sizeof(path), "$.zones[%u].polygon[%u][1]", static_cast<unsigned>(z), static_cast<unsigned>(v));
+                if (!has_x || !mjson_get_number(request->params, params_len, path, &y)) {
+                    break;
+                }
+                if (v == DangerZoneConfig::kMaxVertices) {
+                    JsonRpcReturnBadParam(request, "Too many polygon vertices", "polygon");
+                    return;
+                }
+                if (x < 0.0 || y < 0.0 || x > UINT16_MAX || y > UINT16_MAX) {
+                    JsonRpcReturnBadParam(request, "Polygon vertices must be image pixels", "polygon");
+                    return;
+                }
+                zone.vertices[v] = {static_cast<uint16_t>(x), static_cast<uint16_t>(y)};
+                zone.vertex_count++;
+            }
+            set.count++;
+        }
+
+        const char* error = danger_zones_error(set);
+        if (error) {
+            JsonRpcReturnBadParam(request, error, "zones");
+            return;
+        }
+
+        if (!channel_overwrite(Channel::kDangerZones, &set)) {
+            jsonrpc_return_error(request, -1, "Failed to update danger zones", NULL);
+            return;
+        }
+        NotifyStateController(kEventDangerZones);
+        g_uploaded_zones = set;
+
+        jsonrpc_return_success(request, "{}");
+    }
+
+    // Counts the call under its method label, then runs the handler
+    template <void (*kHandler)(struct jsonrpc_request*), RpcMethod kMethod>
+    void counted_rpc(struct jsonrpc_request* request) {
+        metric_inc<Metric::kRpcCalls>(static_cast<size_t>(kMethod));
+        kHandler(request);
+    }
+
+    template <void (*kHandler)(struct jsonrpc_request*), RpcMethod kMethod>
+    void export_rpc() {
+        jsonrpc_export(kRpcMethodLabels[static_cast<size_t>(kMethod)], counted_rpc<kHandler, kMethod>);
+    }
+
+    // Prometheus scrape target alongside /jsonrpc
+    HttpServer::Content serve_metrics(const char* uri) {
+        if (strcmp(uri, MetricsConfig::kUri) != 0) {
+            return {};
+        }
+        std::string body;
+        metrics_render(&body);
+        return body;
+    }
+
     // RPC task - only responsible for setting up RPC server and callbacks
     void rpc_task(void* parameters) {
         (void)parameters;
         
         printf("RPC task starting...\r\n");
+        trace_register_task();
         
         std::string usb_ip;
         if (!GetUsbIpAddress(&usb_ip)) {
@@ -124,13 +750,33 @@ namespace coralmicro {
         jsonrpc_init(nullptr, nullptr);
 
         // Register RPC methods
-        jsonrpc_export("host_heartbeat", host_heartbeat);
-        jsonrpc_export("rx_host_state", rx_host_state);
-        jsonrpc_export("tx_logs_to_host", tx_logs_to_host);
+        export_rpc<host_heartbeat, RpcMethod::kHostHeartbeat>();
+        export_rpc<rx_host_state, RpcMethod::kRxHostState>();
+        export_rpc<tx_logs_to_host, RpcMethod::kTxLogsToHost>();
+        export_rpc<tx_inference_stats, RpcMethod::kTxInferenceStats>();
+        export_rpc<tx_camera_stats, RpcMethod::kTxCameraStats>();
+        export_rpc<tx_cascade_stats, RpcMethod::kTxCascadeStats>();
+        export_rpc<rx_cascade_config, RpcMethod::kRxCascadeConfig>();
+        export_rpc<tx_inference_profile, RpcMethod::kTxInferenceProfile>();
+        export_rpc<tx_trace_info, RpcMethod::kTxTraceInfo>();
+        export_rpc<tx_trace_dump, RpcMethod::kTxTraceDump>();
+        export_rpc<tx_log_stats, RpcMethod::kTxLogStats>();
+        export_rpc<tx_channel_stats, RpcMethod::kTxChannelStats>();
+        export_rpc<tx_boot_report, RpcMethod::kTxBootReport>();
+        export_rpc<tx_tof_bus_stats, RpcMethod::kTxTofBusStats>();
+        export_rpc<tx_tof_sensor_stats, RpcMethod::kTxTofSensorStats>();
+        export_rpc<tx_recording, RpcMethod::kTxRecording>();
+        export_rpc<tx_approach_stats, RpcMethod::kTxApproachStats>();
+        export_rpc<rx_approach_config, RpcMethod::kRxApproachConfig>();
+        export_rpc<tx_danger_zones, RpcMethod::kTxDangerZones>();
+        export_rpc<rx_danger_zones, RpcMethod::kRxDangerZones>();
 
         
         // Create HTTP server
         auto server = new JsonRpcHttpServer();
+        if (MetricsConfig::kEnabled) {
+            server->AddUriHandler(serve_metrics);
+        }
         UseHttpServer(server);
         printf("RPC server ready\r\n");
         
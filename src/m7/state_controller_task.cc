@@ -2,375 +2,345 @@
 
 namespace coralmicro{
 
+    static_assert(g_max_detections_per_inference <= StateLogicConfig::kMaxDetections,
+                  "State logic keeps fewer detections than inference produces");
 
-    void state_logic_host_connected(HostState& host_state, 
-        SystemState& current_state, 
-        SystemState& new_state, 
-        DetectionData& detection_data, DepthEstimationData& depth_estimation_data, 
-        VL53L8CX_ResultsData& tof_data, LoggingData& logging_data,
-        TickType_t& last_detection_tick, TickType_t& last_tof_tick) {
+    namespace {
+        // Capture chunk from a packed payload; the packers return 0 when it didn't fit
+        void record(ChunkType type, uint8_t aux, uint64_t timestamp_us, const uint8_t* payload, size_t size) {
+            if (size != 0) {
+                recorder_write(type, aux, timestamp_us, payload, size);
+            }
+        }
+    }
 
-        bool new_detection_received = false;
-        bool new_tof_received = false;
-        TickType_t current_tick = xTaskGetTickCount();
 
-        // For host-connected mode, following the "HOST DRIVEN LOGIC" part of diagram
-        
-        // Get the latest host state
-        if (xQueueReceive(g_host_state_queue_m7, &host_state, 0) == pdTRUE) {
-            // Host state received successfully
-        } 
-
-        // Follow the host-driven logic state transitions according to diagram
-        // Check if host is in RED state
-        if (RedStates::Contains(host_state)) {
-            // If host is in RED state, set system state to STOPPED
-            new_state = SystemState::STOPPED;
-        } 
-        else if (YellowStates::Contains(host_state)) {
-            // If host is in YELLOW state, set system state to WARNING
-            new_state = SystemState::WARNING;
-        }
-        else if (BlueStates::Contains(host_state)) {
-            // If host is in BLUE state, set system state to IDLE
-            new_state = SystemState::IDLE;
-        } 
-        else if (GreenStates::Contains(host_state)) {
-            // If host is in GREEN state, set system state to ACTIVE
-            new_state = SystemState::ACTIVE;
-        } 
-
-        // Update system state if it has changed based on host state
-        if (new_state != current_state) {
-            xQueueOverwrite(g_state_update_queue_m7, &new_state);
-            printf("System State: %i\r\n", static_cast<int>(new_state));
-            current_state = new_state;
+    // Take up changed approach tuning, recorded so a replay runs with it too
+    void apply_approach_settings(StateLogic& logic, uint64_t now_us) {
+        ApproachParams params;
+        params.enabled = g_approach_settings.enabled.load();
+        params.stop_budget_ms = g_approach_settings.stop_budget_ms.load();
+        params.min_speed_mm_s = g_approach_settings.min_speed_mm_s.load();
+
+        static bool recorded = false;
+        if (recorded && params == logic.approach_params()) {
+            return;
         }
+        recorded = true;
+        logic.set_approach_params(params);
 
-        // After updating system state, always proceed to SCANNING as per diagram
-        // to collect detection data for logging purposes (but don't change state)
-        
-        // Check if a person has been detected in the latest detection data
-        if (xQueueReceive(g_detection_output_queue_m7, &detection_data, 10) == pdTRUE) {
-            new_detection_received = true;
-            if (detection_data.detection_count > 0) {
-                last_detection_tick = current_tick; // Update detection timestamp
+        uint8_t payload[RecordingFormat::kApproachParamsBytes];
+        size_t size = pack_approach_params(params, payload, sizeof(payload));
+        record(ChunkType::kApproachParams, 0, now_us, payload, size);
+        DLOG_INFO("Approach prediction %s, stop budget %lu ms, min speed %.0f mm/s\r\n",
+                  params.enabled ? "on" : "off", static_cast<unsigned long>(params.stop_budget_ms),
+                  static_cast<double>(params.min_speed_mm_s));
+    }
+
+    // Take up uploaded danger zones, recorded so a replay holds persons against the same limits
+    void apply_danger_zones(StateLogic& logic, uint64_t now_us) {
+        static DangerZoneSet zones;
+        static bool recorded = false;
+        bool received = channel_receive(Channel::kDangerZones, &zones);
+        if (received) {
+            const char* error = danger_zones_error(zones);
+            if (error) {
+                DLOG_ERROR("ERROR: Danger zones rejected: %s\r\n", error);
+                received = false;
             }
             else {
+                logic.set_danger_zones(zones);
             }
         }
-        else {
-            // Check if we still have a valid detection based on timeout
-            bool detection_valid = (current_tick - last_detection_tick) <= pdMS_TO_TICKS(kDetectionMemoryTimeoutMs);
-            
-            if (detection_valid && detection_data.detection_count > 0) {
-                // use cached detection data
-            }
+        if (recorded && !received) {
+            return;
         }
+        recorded = true;
 
-        TickType_t depth_estimation_start_tick;
-        TickType_t depth_estimation_stop_tick;
-
-        if (detection_data.detection_count > 0)
-        {
-            printf("Checking for danger distance\r\n");
-            // Set depth estimation (DE) timestamp
-            depth_estimation_start_tick = current_tick;
-            depth_estimation_data.timestamp_ms = depth_estimation_start_tick * (1000 / configTICK_RATE_HZ);
-
-            // Get the latest TOF data
-            if (xQueueReceive(g_tof_queue_m7, &tof_data, 10) == pdTRUE) {
-                new_tof_received = true;
-                last_tof_tick = current_tick; // Update TOF timestamp
-
-                // Perform depth estimation
-                depth_estimation(
-                    detection_data.detections, 
-                    detection_data.detection_count, 
-                    tof_data.distance_mm, 
-                    depth_estimation_data.depths
-                );
-
-                printf("Depths for detections: ");
-                for (uint8_t i = 0; i < detection_data.detection_count; i++) {
-                    printf("%f ", depth_estimation_data.depths[i]);
-                }   
-                printf("\r\n");
-            }
-            else {
-                // Check if we still have valid TOF data
-                bool tof_valid = (current_tick - last_tof_tick) <= pdMS_TO_TICKS(kTofMemoryTimeoutMs);
-                
-                if (tof_valid) {
-                    // Use cached TOF data for decisions
-                }
-                else {
-                }
+        const DangerZoneSet& active = logic.danger_zones();
+        static uint8_t payload[RecordingFormat::kMaxDangerZonesBytes];
+        size_t size = pack_danger_zones(active, payload, sizeof(payload));
+        record(ChunkType::kDangerZones, 0, now_us, payload, size);
+
+        for (size_t z = 0; z < DangerZoneConfig::kMaxZones; z++) {
+            for (size_t sensor = 0; sensor < kTofSensorCount; sensor++) {
+                g_danger_zone_stats.cells[z][sensor] = z < active.count ? logic.zone_map().zone_cells(z, sensor) : 0;
             }
+        }
+        g_danger_zone_stats.updates.fetch_add(1);
+        DLOG_INFO("Danger zones: %u\r\n", static_cast<unsigned>(active.count));
+    }
 
-            // Update depth estimation time
-            depth_estimation_stop_tick = xTaskGetTickCount() - depth_estimation_start_tick;
-            depth_estimation_data.depth_estimation_time_ms = depth_estimation_stop_tick * (1000 / configTICK_RATE_HZ);
+    void publish_approach(const StateLogic& logic, bool was_approach_stop) {
+        const ApproachPrediction& approach = logic.approach();
+        g_approach_stats.tracks = static_cast<uint32_t>(logic.approach_tracks());
+        g_approach_stats.approaching = approach.approaching;
+        g_approach_stats.time_to_threshold_ms = approach.time_to_threshold_ms;
+        g_approach_stats.speed_mm_s = approach.speed_mm_s;
+        if (logic.approach_stop() && !was_approach_stop) {
+            g_approach_stats.predicted_stops.fetch_add(1);
+            DLOG_INFO("Approach: %.0f mm/s, %lu ms to the stop distance\r\n",
+                      static_cast<double>(approach.speed_mm_s),
+                      static_cast<unsigned long>(approach.time_to_threshold_ms));
         }
+    }
 
-        // Output logging data structure to queue
-        logging_data.timestamp_ms = xTaskGetTickCount() * (1000 / configTICK_RATE_HZ);
-        logging_data.system_state = current_state;
-        
-        // Only update detection data in logging if we received new data
-        if (new_detection_received) {
-            logging_data.detection_data = detection_data;
+    // Drain the input queues into the state logic, recording what it is fed
+    void fetch_inputs(StateLogic& logic, HostState& host_state, DetectionData& detection_data,
+                      TofData& tof_data, uint64_t now_us,
+                      bool& new_detection_received, bool& new_tof_received) {
+        PROFILE_ZONE("state_fetch_inputs");
+        static uint64_t recorded_frame_us[kTofSensorCount] = {}; // Last frame of each sensor already recorded
+        uint8_t payload[RecordingFormat::kMaxTofFrameBytes];
+        uint32_t now_ms = static_cast<uint32_t>(now_us / 1000u);
+
+        // Get the latest host state (only acted on while the host is connected)
+        if (channel_receive(Channel::kHostState, &host_state)) {
+            logic.on_host_state(host_state);
+            size_t size = pack_host_state(host_state, payload, sizeof(payload));
+            record(ChunkType::kHostState, 0, now_us, payload, size);
         }
-        
-        // Only update depth estimation data if we received new TOF data or performed a new estimation
-        if (new_tof_received || depth_estimation_data.depth_estimation_time_ms > 0) {
-            logging_data.depth_estimation_data = depth_estimation_data;
+
+        // Latest detector result; only results with a person restart the detection memory
+        new_detection_received = channel_receive(Channel::kDetection, &detection_data);
+        if (new_detection_received) {
+            logic.on_detection(detection_data.detections, detection_data.detection_count,
+                               detection_data.camera_data.timestamp_us, now_ms);
+
+            uint8_t detections[RecordingFormat::kDetectionsHeaderBytes + g_max_detections_per_inference * RecordingFormat::kObjectBytes];
+            size_t size = pack_detections(detection_data.detections, detection_data.detection_count,
+                                          detection_data.camera_data.timestamp_us, detections, sizeof(detections));
+            record(ChunkType::kDetections, 0, now_us, detections, size);
         }
-        
-        if (xQueueOverwrite(g_logging_queue_m7, &logging_data) != pdTRUE) {
-            printf("ERROR: Failed to send logging data\r\n");
+
+        // Get the latest TOF data
+        new_tof_received = channel_receive(Channel::kTof, &tof_data);
+        if (new_tof_received) {
+            uint8_t zone_count = g_tof_resolution.load();
+            logic.on_tof(tof_data, zone_count, now_ms);
+
+            // Every sensor's frame is republished until it reads a new one; record each once
+            for (size_t sensor = 0; sensor < kTofSensorCount; sensor++) {
+                if (tof_data.frame_us[sensor] == 0 || tof_data.frame_us[sensor] == recorded_frame_us[sensor]) {
+                    continue;
+                }
+                recorded_frame_us[sensor] = tof_data.frame_us[sensor];
+                size_t size = pack_tof_frame(tof_data.results[sensor], tof_data.frame_us[sensor], zone_count,
+                                             payload, sizeof(payload));
+                record(ChunkType::kTofFrame, static_cast<uint8_t>(sensor), now_us, payload, size);
+            }
         }
     }
 
-    
+    // Copy a fresh depth estimate out of the state logic for the log and the governor.
+    // The timing covers the whole step it was computed in.
+    void publish_depths(const StateLogic& logic, uint64_t step_start_us, uint64_t step_end_us,
+                        DepthEstimationData& depth_estimation_data) {
+        depth_estimation_data.timestamp_us = step_start_us;
+        depth_estimation_data.depth_estimation_time_us = static_cast<uint32_t>(step_end_us - step_start_us);
 
-    void state_logic_host_disconnected(SystemState& current_state, SystemState& new_state, 
-                                     DetectionData& detection_data, DepthEstimationData& depth_estimation_data, 
-                                     VL53L8CX_ResultsData& tof_data, LoggingData& logging_data,
-                                     TickType_t& last_detection_tick, TickType_t& last_tof_tick) {
-        bool new_detection_received = false;
-        bool new_tof_received = false;
-        TickType_t depth_estimation_start_tick;
-        TickType_t depth_estimation_stop_tick;
-        TickType_t current_tick = xTaskGetTickCount();
+        uint8_t count = logic.detection_count();
+        for (uint8_t i = 0; i < count && i < g_max_detections_per_inference; i++) {
+            depth_estimation_data.depths[i] = logic.depths()[i];
+            DLOG_DEBUG("Depth for detection %d: %f\r\n", i, depth_estimation_data.depths[i]);
+        }
 
-        // For host-disconnected mode, following the "INDEPENDENT LOGIC" part of diagram
-        
-        // First transition to SCANNING state as shown in the diagram
-        new_state = SystemState::SCANNING;
-        
-        // Check if a person has been detected in the latest detection data
-        if (xQueueReceive(g_detection_output_queue_m7, &detection_data, 10) == pdTRUE) {
-            new_detection_received = true;
-            if (detection_data.detection_count > 0) {
-                // Person detected
-                last_detection_tick = current_tick; // Update detection timestamp
-                
-                // Now we need to check if the person is in danger distance
-                // to determine if we go to WARNING or STOPPED state
-                
-                printf("Checking for danger distance\r\n");
-                // Set depth estimation (DE) timestamp
-                depth_estimation_start_tick = current_tick;
-                depth_estimation_data.timestamp_ms = depth_estimation_start_tick * (1000 / configTICK_RATE_HZ);
-                
-                bool person_in_danger = false;
-                
-                // Get the latest TOF data
-                if (xQueueReceive(g_tof_queue_m7, &tof_data, 10) == pdTRUE) {
-                    new_tof_received = true;
-                    last_tof_tick = current_tick; // Update TOF timestamp
-
-                    // Perform depth estimation
-                    depth_estimation(
-                        detection_data.detections, 
-                        detection_data.detection_count, 
-                        tof_data.distance_mm, 
-                        depth_estimation_data.depths
-                    );
-
-                    printf("Depths for detections: ");
-                    for (uint8_t i = 0; i < detection_data.detection_count; i++) {
-                        printf("%f ", depth_estimation_data.depths[i]);
-                        
-                        // Check if any depth is below the danger distance threshold
-                        if (depth_estimation_data.depths[i] <= danger_depth_mm) {
-                            person_in_danger = true;
-                        }
-                    }   
-                    printf("\r\n");
-                }
-                else {
-                    // Check if we still have valid TOF data
-                    bool tof_valid = (current_tick - last_tof_tick) <= pdMS_TO_TICKS(kTofMemoryTimeoutMs);
-                    
-                    if (tof_valid) {
-                        // Use cached TOF data for decisions
-                        
-                        // Check cached depth estimations for danger distance
-                        for (uint8_t i = 0; i < detection_data.detection_count; i++) {
-                            if (depth_estimation_data.depths[i] <= danger_depth_mm) {
-                                person_in_danger = true;
-                            }
-                        }
-                    }
-                    else {
-                    }
-                }
+        uint8_t payload[RecordingFormat::kDepthsHeaderBytes + StateLogicConfig::kMaxDetections * sizeof(float)];
+        size_t size = pack_depths(logic.depths(), count, payload, sizeof(payload));
+        record(ChunkType::kDepthEstimates, 0, step_end_us, payload, size);
+    }
 
-                // Update depth estimation time
-                depth_estimation_stop_tick = xTaskGetTickCount() - depth_estimation_start_tick;
-                depth_estimation_data.depth_estimation_time_ms = depth_estimation_stop_tick * (1000 / configTICK_RATE_HZ);
-                
-                // Now set the appropriate state based on whether person is in danger
-                if (person_in_danger) {
-                    new_state = SystemState::STOPPED;
-                } else {
-                    new_state = SystemState::WARNING;
-                }
-            }
-            else {
-                // No person detected in the new frame
-                new_state = SystemState::IDLE;
-            }
-        } 
-        else {
-            // No new detection data received, check if we have a valid cached detection
-            bool detection_valid = (current_tick - last_detection_tick) <= pdMS_TO_TICKS(kDetectionMemoryTimeoutMs);
-            
-            if (detection_valid && detection_data.detection_count > 0) {
-                // We still have a valid detection
-                
-                // Check if person is in danger distance using cached data
-                bool person_in_danger = false;
-                
-                // Check if we have a valid cached TOF data
-                bool tof_valid = (current_tick - last_tof_tick) <= pdMS_TO_TICKS(kTofMemoryTimeoutMs);
-                
-                if (tof_valid) {
-                    // Use cached TOF data for decisions
-                    // Check cached depth estimations for danger distance
-                    for (uint8_t i = 0; i < detection_data.detection_count; i++) {
-                        if (depth_estimation_data.depths[i] <= danger_depth_mm) {
-                            person_in_danger = true;
-                        }
-                    }
-                    
-                    // Set appropriate state based on whether person is in danger
-                    if (person_in_danger) {
-                        new_state = SystemState::STOPPED;
-                    } else {
-                        new_state = SystemState::WARNING;
-                    }
-                }
-                else {
-                    // No valid TOF data, assume WARNING state
-                    new_state = SystemState::WARNING;
-                }
-            }
-            else {
-                // No valid detection data, go to IDLE
-                new_state = SystemState::IDLE;
-            }
+    void record_transition(SystemState from, SystemState to, const DecisionInputs& inputs) {
+        uint8_t payload[3];
+        size_t size = pack_state_transition(StateTransitionRecord{from, to, encode_inputs(inputs)},
+                                            payload, sizeof(payload));
+        record(ChunkType::kStateTransition, 0, timebase_us(), payload, size);
+    }
+
+    void publish_state(SystemState& current_state, SystemState new_state, bool host_connected) {
+        static bool published_host_connected = false;
+
+        // The LEDs follow the host link as well as the state
+        if (new_state != current_state || host_connected != published_host_connected) {
+            StateUpdate update{new_state, host_connected};
+            channel_overwrite(Channel::kStateUpdate, &update);
+            NotifyLedTask(kLedEventState);
+            published_host_connected = host_connected;
         }
 
         // Update system state if it has changed
         if (new_state != current_state) {
-            xQueueOverwrite(g_state_update_queue_m7, &new_state);
-            printf("System State: %i\r\n", static_cast<int>(new_state));
+            DLOG_INFO("System State: %i\r\n", static_cast<int>(new_state));
+            metric_inc<Metric::kStateTransitions>(static_cast<size_t>(new_state));
+            metric_set<Metric::kSystemState>(static_cast<float>(new_state));
             current_state = new_state;
         }
+    }
+
+    // person_present counts everyone detected, inside a danger zone or not
+    void publish_governor_input(SystemState current_state, HostState host_state, const DecisionInputs& inputs,
+                                bool person_present, const DetectionData& detection_data,
+                                const DepthEstimationData& depth_estimation_data) {
+        GovernorInput governor_input{
+            current_state,
+            host_state,
+            inputs.host_connected,
+            person_present,
+            -1.0f,
+            inputs.tof_intrusion
+        };
 
+        // Nearest valid depth, only meaningful while TOF is fresh
+        if (person_present && inputs.tof_fresh) {
+            for (uint8_t i = 0; i < detection_data.detection_count; i++) {
+                float depth = depth_estimation_data.depths[i];
+                if (depth > 0.0f && (governor_input.nearest_depth_mm < 0.0f || depth < governor_input.nearest_depth_mm)) {
+                    governor_input.nearest_depth_mm = depth;
+                }
+            }
+        }
+
+        channel_overwrite(Channel::kGovernor, &governor_input);
+    }
+
+    void publish_log(SystemState current_state, const DetectionData& detection_data,
+                     const DepthEstimationData& depth_estimation_data, LoggingData& logging_data,
+                     bool new_detection_received, bool depth_updated, bool tof_intrusion_active) {
         // Output logging data structure to queue
-        logging_data.timestamp_ms = xTaskGetTickCount() * (1000 / configTICK_RATE_HZ);
+        logging_data.timestamp_us = timebase_us();
         logging_data.system_state = current_state;
+        logging_data.tof_intrusion = tof_intrusion_active;
         
         // Only update detection data in logging if we received new data
         if (new_detection_received) {
             logging_data.detection_data = detection_data;
         }
         
-        // Only update depth estimation data if we received new TOF data or performed a new estimation
-        if (new_tof_received || depth_estimation_data.depth_estimation_time_ms > 0) {
+        // Only update depth estimation data if we performed a new estimation
+        if (depth_updated) {
             logging_data.depth_estimation_data = depth_estimation_data;
         }
         
-        if (xQueueOverwrite(g_logging_queue_m7, &logging_data) != pdTRUE) {
-            printf("ERROR: Failed to send logging data\r\n");
+        if (!channel_overwrite(Channel::kLogging, &logging_data)) {
+            DLOG_ERROR("ERROR: Failed to send logging data\r\n");
         }
     }
 
-
-
     void state_controller_task(void* parameters) {
         (void)parameters;
         printf("State controller task starting...\r\n");
+        trace_register_task();
         
         SystemState current_state = SystemState::UNINITIALIZED;
         
         // Update to HOST_READING if uninitialized
         if (current_state == SystemState::UNINITIALIZED) {
             current_state = SystemState::HOST_READING;
-            xQueueOverwrite(g_state_update_queue_m7, &current_state);
+            StateUpdate update{current_state, false};
+            channel_overwrite(Channel::kStateUpdate, &update);
+            NotifyLedTask(kLedEventState);
             printf("System State: %i\r\n", static_cast<int>(current_state));
+            metric_inc<Metric::kStateTransitions>(static_cast<size_t>(current_state));
+            metric_set<Metric::kSystemState>(static_cast<float>(current_state));
         }
         
         // Setup static data structures to prevent stack overflow
         static DetectionData detection_data;
         static DepthEstimationData depth_estimation_data;
-        static VL53L8CX_ResultsData tof_data;
+        static TofData tof_data;
         static LoggingData logging_data;
 
         static HostConnectionStatus host_condition = HostConnectionStatus::DISCONNECTED;
         static HostState host_state = HostState::UNDEFINED;
-        
-        // Add timestamps for detection and TOF memory
-        static TickType_t last_detection_tick = 0;
-        static TickType_t last_tof_tick = 0;
 
-        // Add timestampe for host connection heartbeat
-        // When timer runs out, it will set the host_condition to DISCONNECTED
-        static TickType_t last_host_tick = 0;
+        // Input memory, ToF intrusion, depth and the decision; host/replay.cc runs the same logic
+        static StateLogic logic;
+
+        register_stage(Stage::kStateController);
+        g_state_controller_task_m7 = xTaskGetCurrentTaskHandle();
+
+        uint32_t state_since_ms = timebase_ms();
+        bool detection_seen = false; // Both inputs live at least once: the boot report's first decision
+        bool tof_seen = false;
         
         while (true) {
-            // Always start with HOST_READING as per the diagram
-            SystemState new_state = SystemState::HOST_READING;
-            
-            // Update to latest host connection status
-            if(xQueueReceive(g_host_connection_status_queue_m7, &host_condition, 0) == pdTRUE) {
-                // Reset the host connection timer
-                last_host_tick = xTaskGetTickCount();
-            } 
-            else {
-                if ((xTaskGetTickCount() - last_host_tick) <= pdMS_TO_TICKS(kHostConnectionTimeoutMs)) {
-                    // Host connection is still valid
-                    host_condition = HostConnectionStatus::CONNECTED;
-                } 
-                else {
-                    // Host connection timed out
-                    host_condition = HostConnectionStatus::DISCONNECTED;
-                }
+            // Time from the oldest pending input to this evaluation
+            uint32_t event_us = g_state_controller_event_us_m7.exchange(0);
+            if (event_us != 0) {
+                logging_data.reaction_latency_us = static_cast<uint32_t>(timebase_us()) - event_us;
+                metric_observe<Metric::kReactionLatency>(logging_data.reaction_latency_us);
             }
 
-            // If host connected, do host connection logic
-            if (host_condition == HostConnectionStatus::CONNECTED) {
-                state_logic_host_connected(
-                    host_state, 
-                    current_state, 
-                    new_state, 
-                    detection_data, 
-                    depth_estimation_data, 
-                    tof_data, 
-                    logging_data,
-                    last_detection_tick,
-                    last_tof_tick
-                );
+            // One time for everything this wake-up takes in and decides on
+            uint64_t now_us = timebase_us();
+            uint32_t now_ms = static_cast<uint32_t>(now_us / 1000u);
+
+            // Any heartbeat restarts the host connection memory
+            if (channel_receive(Channel::kHostConnection, &host_condition)) {
+                logic.on_host_heartbeat(now_ms);
+                recorder_write(ChunkType::kHostHeartbeat, 0, now_us, nullptr, 0);
             }
-            else {
-                state_logic_host_disconnected(
-                    current_state, 
-                    new_state, 
-                    detection_data, 
-                    depth_estimation_data, 
-                    tof_data, 
-                    logging_data,
-                    last_detection_tick,
-                    last_tof_tick
-                );
+
+            apply_approach_settings(logic, now_us);
+            apply_danger_zones(logic, now_us);
+
+            bool new_detection_received = false;
+            bool new_tof_received = false;
+            fetch_inputs(logic, host_state, detection_data, tof_data, now_us, new_detection_received, new_tof_received);
+
+            bool was_intrusion = logic.tof_intrusion_active();
+            bool was_approach_stop = logic.approach_stop();
+            int8_t was_danger_zone = logic.danger_zone();
+            uint64_t step_start_us = timebase_us();
+            SystemState new_state;
+            {
+                PROFILE_ZONE("state_step");
+                new_state = logic.step(now_ms);
             }
+            const DecisionInputs& inputs = logic.inputs();
+            host_condition = inputs.host_connected ? HostConnectionStatus::CONNECTED : HostConnectionStatus::DISCONNECTED;
 
-            // Task delay
-            vTaskDelay(pdMS_TO_TICKS(10));
+            if (logic.tof_intrusion_active() != was_intrusion) {
+                DLOG_INFO("TOF intrusion %s\r\n", logic.tof_intrusion_active() ? "latched" : "cleared");
+            }
+            if (logic.depth_updated()) {
+                publish_depths(logic, step_start_us, timebase_us(), depth_estimation_data);
+                publish_approach(logic, was_approach_stop);
+            }
+            if (logic.danger_zone() >= 0 && logic.danger_zone() != was_danger_zone) {
+                g_danger_zone_stats.stops[logic.danger_zone()].fetch_add(1);
+                DLOG_INFO("Person within the stop distance of danger zone %d\r\n", static_cast<int>(logic.danger_zone()));
+            }
+
+            detection_seen = detection_seen || new_detection_received;
+            tof_seen = tof_seen || new_tof_received;
+            if (detection_seen && tof_seen) {
+                boot_first_decision(new_state);
+            }
+
+            // Time in a state is credited when the controller wakes, so it lags by at most one wait
+            metric_inc<Metric::kStateTime>(static_cast<size_t>(current_state), now_ms - state_since_ms);
+            state_since_ms = now_ms;
+
+            if (new_state != current_state) {
+                record_transition(current_state, new_state, inputs);
+            }
+            publish_state(current_state, new_state, inputs.host_connected);
+            publish_governor_input(current_state, host_state, inputs, logic.person_present(), detection_data,
+                                   depth_estimation_data);
+            publish_log(current_state, detection_data, depth_estimation_data, logging_data,
+                        new_detection_received, logic.depth_updated(), logic.tof_intrusion_active());
+
+            stage_complete(Stage::kStateController);
+
+            // Block until any input arrives or the next input memory runs out, whichever is first
+            TickType_t wait = portMAX_DELAY;
+            uint32_t deadline_ms;
+            uint32_t wait_from_ms = timebase_ms();
+            if (logic.next_deadline_ms(wait_from_ms, &deadline_ms)) {
+                wait = pdMS_TO_TICKS(deadline_ms - wait_from_ms) + 1;
+            }
+            xTaskNotifyWait(0, UINT32_MAX, nullptr, wait);
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,185 @@
+// state_logic.cc
+#include "m7/state_logic.hh"
+
+#include "m7/depth_estimation.hh"
+
+namespace coralmicro {
+
+    void StateLogic::on_host_heartbeat(uint32_t now_ms) {
+        host_seen_ = true;
+        host_deadline_ms_ = now_ms + kHostConnectionTimeoutMs;
+    }
+
+    void StateLogic::on_host_state(HostState state) {
+        host_state_ = state;
+    }
+
+    void StateLogic::on_detection(const tensorflow::Object* objects, size_t count, uint64_t capture_us,
+                                  uint32_t now_ms) {
+        if (count > StateLogicConfig::kMaxDetections) {
+            count = StateLogicConfig::kMaxDetections;
+        }
+        for (size_t i = 0; i < count; i++) {
+            detections_[i] = objects[i];
+        }
+        detection_count_ = static_cast<uint8_t>(count);
+        detection_capture_us_ = capture_us;
+        update_zone_limits();
+        new_detection_ = true;
+        approach_predictor_.on_detections(detections_, detection_count_, now_ms);
+
+        // Only a result with someone in it restarts the detection memory
+        if (count > 0) {
+            detection_seen_ = true;
+            detection_deadline_ms_ = now_ms + kDetectionMemoryTimeoutMs;
+        }
+    }
+
+    void StateLogic::set_danger_zones(const DangerZoneSet& set) {
+        zone_map_.compile(set);
+        update_zone_limits();
+    }
+
+    // Boxes only move with a new result, so their zones are looked up once per result
+    void StateLogic::update_zone_limits() {
+        for (uint8_t i = 0; i < detection_count_; i++) {
+            detection_limits_[i] = zone_map_.lookup(detections_[i].bbox);
+        }
+    }
+
+    void StateLogic::on_tof(const TofData& tof_data, uint8_t zone_count, uint32_t now_ms) {
+        tof_data_ = tof_data;
+        tof_zone_count_ = zone_count;
+        new_tof_ = true;
+        tof_seen_ = true;
+        tof_deadline_ms_ = now_ms + kTofMemoryTimeoutMs;
+    }
+
+    // ToF-only fast path: runs on every ToF frame, camera results confirm or clear it later
+    void StateLogic::update_intrusion(bool person_fresh) {
+        if (!TofIntrusionConfig::kEnabled) {
+            return;
+        }
+
+        tof_intrusion_active_ = false;
+        for (size_t sensor = 0; sensor < kTofSensorCount; sensor++) {
+            const VL53L8CX_ResultsData& results = tof_data_.results[sensor];
+            if (tof_data_.frame_us[sensor] == 0) {
+                continue;
+            }
+
+            if (new_detection_) {
+                tof_intrusion_[sensor].on_camera_verdict(detection_count_ > 0,
+                    static_cast<uint32_t>(detection_capture_us_ / 1000u),
+                    results.distance_mm, results.target_status);
+            }
+            // Only frames this sensor hasn't been fed yet; the others republish its old one
+            if (new_tof_ && tof_data_.frame_us[sensor] != tof_intrusion_frame_us_[sensor]) {
+                tof_intrusion_frame_us_[sensor] = tof_data_.frame_us[sensor];
+                tof_intrusion_[sensor].on_tof_frame(results.distance_mm, results.target_status,
+                    tof_zone_count_, zone_map_.cell_stop_mm(sensor), !person_fresh,
+                    static_cast<uint32_t>(tof_data_.frame_us[sensor] / 1000u));
+            }
+            tof_intrusion_active_ = tof_intrusion_active_ || tof_intrusion_[sensor].active();
+        }
+    }
+
+    SystemState StateLogic::step(uint32_t now_ms) {
+        bool host_connected = live(host_seen_, host_deadline_ms_, now_ms);
+        bool person_fresh = live(detection_seen_, detection_deadline_ms_, now_ms) && detection_count_ > 0;
+        bool tof_fresh = live(tof_seen_, tof_deadline_ms_, now_ms);
+
+        update_intrusion(person_fresh);
+
+        // Depth is estimated in both modes (connected mode only logs it),
+        // and only recomputed when one of its inputs changed
+        depth_updated_ = false;
+        person_present_ = person_fresh;
+        if (!person_fresh) {
+            person_warning_ = false;
+            person_in_danger_ = false;
+            approach_stop_ = false;
+            danger_zone_ = -1;
+        }
+        else if (!tof_fresh) {
+            // No distance to hold against the limits: anyone inside a zone is warned about
+            person_warning_ = false;
+            for (uint8_t i = 0; i < detection_count_; i++) {
+                person_warning_ = person_warning_ || detection_limits_[i].in_zone;
+            }
+            person_in_danger_ = false;
+            approach_stop_ = false;
+            danger_zone_ = -1;
+        }
+        else if (new_detection_ || new_tof_) {
+            depth_estimation(detections_, detection_count_, tof_data_, depths_);
+
+            // Each person is held against the limits of the zones their box touches.
+            // Invalid (negative) depths are within both, failing safe.
+            bool within = false;
+            bool warning = false;
+            float stop_mm[StateLogicConfig::kMaxDetections];
+            danger_zone_ = -1;
+            for (uint8_t i = 0; i < detection_count_; i++) {
+                const ZoneLimits& limits = detection_limits_[i];
+                stop_mm[i] = limits.in_zone ? limits.stop_mm : 0.0f;
+                if (!limits.in_zone) {
+                    continue;
+                }
+                if (depths_[i] <= limits.warning_mm) {
+                    warning = true;
+                }
+                if (depths_[i] <= limits.stop_mm) {
+                    within = true;
+                    if (danger_zone_ < 0) {
+                        danger_zone_ = limits.stop_zone;
+                    }
+                }
+            }
+
+            // Someone closing in who will cross their stop distance before the machine could
+            // react and stop counts as in danger already
+            approach_predictor_.on_depths(depths_, stop_mm, detection_count_,
+                                          static_cast<uint32_t>(tof_data_.timestamp_us / 1000u));
+            approach_ = approach_predictor_.predict(approach_params_, now_ms);
+            approach_stop_ = !within && approach_.approaching &&
+                             approach_.time_to_threshold_ms <= approach_params_.stop_budget_ms;
+
+            person_in_danger_ = within || approach_stop_;
+            person_warning_ = warning || person_in_danger_;
+            depth_updated_ = true;
+        }
+
+        inputs_ = DecisionInputs{
+            host_connected,
+            host_color(host_state_),
+            person_warning_,
+            tof_fresh,
+            person_in_danger_,
+            tof_intrusion_active_
+        };
+
+        stepped_detection_ = new_detection_;
+        stepped_tof_ = new_tof_;
+        new_detection_ = false;
+        new_tof_ = false;
+        return decide_state(inputs_);
+    }
+
+    bool StateLogic::next_deadline_ms(uint32_t now_ms, uint32_t* deadline_ms) const {
+        const bool valid[] = {host_seen_, detection_seen_, tof_seen_};
+        const uint32_t deadlines[] = {host_deadline_ms_, detection_deadline_ms_, tof_deadline_ms_};
+
+        bool found = false;
+        for (size_t i = 0; i < 3; i++) {
+            if (!live(valid[i], deadlines[i], now_ms)) {
+                continue;
+            }
+            if (!found || static_cast<int32_t>(deadlines[i] - *deadline_ms) < 0) {
+                *deadline_ms = deadlines[i];
+                found = true;
+            }
+        }
+        return found;
+    }
+}
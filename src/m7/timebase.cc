@@ -0,0 +1,96 @@
+// timebase.cc
+#include "m7/timebase.hh"
+
+#if defined(__arm__)
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/freertos_kernel/include/timers.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_clock.h"
+
+#include <cstdio>
+
+namespace coralmicro {
+
+    namespace {
+        CounterExtender g_cycle_extender;
+        uint32_t g_cycle_hz = 0;
+        uint32_t g_cycles_per_us = 0;
+
+        void on_wrap_guard(TimerHandle_t timer) {
+            (void)timer;
+            timebase_us();
+        }
+    }
+
+    bool timebase_init() {
+        // The DWT counts core clock cycles, whatever the PLL was set up for
+        uint32_t hz = CLOCK_GetRootClockFreq(kCLOCK_Root_M7);
+        uint64_t wrap_ms = (1ull << 32) * 1000u / (hz > 0 ? hz : 1u);
+        if (hz < 1000000u || wrap_ms <= 2u * TimebaseConfig::kWrapGuardMs) {
+            printf("ERROR: M7 core clock of %lu Hz is unusable for the timebase\r\n", static_cast<unsigned long>(hz));
+            return false;
+        }
+        g_cycle_hz = hz;
+        g_cycles_per_us = (hz + 500000u) / 1000000u;
+        if (hz % 1000000u != 0) {
+            printf("WARNING: M7 core clock of %lu Hz isn't whole MHz, timestamps count %lu cycles per us\r\n",
+                   static_cast<unsigned long>(hz), static_cast<unsigned long>(g_cycles_per_us));
+        }
+        cycle_counter_init();
+
+        TimerHandle_t guard = xTimerCreate("timebase_guard", pdMS_TO_TICKS(TimebaseConfig::kWrapGuardMs),
+                                           pdTRUE, nullptr, on_wrap_guard);
+        if (guard == nullptr || xTimerStart(guard, 0) != pdPASS) {
+            printf("ERROR: Failed to start timebase wrap guard\r\n");
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t timebase_us() {
+        // Read and extend atomically so a preempting reader can't see the wrap twice
+        UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        uint64_t cycles = g_cycle_extender.extend(cycle_counter_read());
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+        return g_cycles_per_us > 0 ? cycles / g_cycles_per_us : 0;
+    }
+
+    uint32_t timebase_cycle_hz() {
+        return g_cycle_hz;
+    }
+
+    uint32_t timebase_cycles_per_us() {
+        return g_cycles_per_us;
+    }
+}
+
+#else
+
+#include <chrono>
+
+namespace coralmicro {
+
+    namespace {
+        const auto g_host_epoch = std::chrono::steady_clock::now();
+    }
+
+    bool timebase_init() {
+        return true;
+    }
+
+    uint64_t timebase_us() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - g_host_epoch).count());
+    }
+
+    uint32_t timebase_cycle_hz() {
+        return kHostCycleCounterHz;
+    }
+
+    uint32_t timebase_cycles_per_us() {
+        return kHostCycleCounterHz / 1000000u;
+    }
+}
+
+#endif
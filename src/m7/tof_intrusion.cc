@@ -0,0 +1,135 @@
+// tof_intrusion.cc
+#include "m7/tof_intrusion.hh"
+
+namespace coralmicro {
+
+    void TofIntrusionDetector::reset() {
+        *this = TofIntrusionDetector();
+    }
+
+    bool TofIntrusionDetector::on_tof_frame(const int16_t* distance_mm, const uint8_t* target_status,
+                                            uint8_t zone_count, const float* cell_danger_mm,
+                                            bool learning_allowed, uint32_t now_ms) {
+        if (!distance_mm || !target_status || !cell_danger_mm) {
+            return active_;
+        }
+
+        if (zone_count > TofIntrusionConfig::kMaxZones) {
+            zone_count = TofIntrusionConfig::kMaxZones;
+        }
+
+        // Resolution change invalidates the model
+        if (zone_count != zone_count_) {
+            reset();
+            zone_count_ = zone_count;
+        }
+
+        // Seed the background from idle frames before flagging anything
+        if (!ready()) {
+            if (!learning_allowed) {
+                return active_;
+            }
+
+            for (uint8_t z = 0; z < zone_count; z++) {
+                if (!tof_target_status_valid(target_status[z]) || distance_mm[z] <= 0) {
+                    continue;
+                }
+
+                // Running mean of the valid samples seen so far
+                seed_count_[z]++;
+                background_mm_[z] += (static_cast<float>(distance_mm[z]) - background_mm_[z]) / seed_count_[z];
+            }
+
+            if (++learned_frames_ == TofIntrusionConfig::kLearnFrames) {
+                for (uint8_t z = 0; z < zone_count; z++) {
+                    if (seed_count_[z] == 0) {
+                        background_mm_[z] = TofIntrusionConfig::kNoTargetBackgroundMm;
+                    }
+                }
+            }
+            return active_;
+        }
+
+        uint64_t flagged = 0;
+        for (uint8_t z = 0; z < zone_count; z++) {
+            if (!tof_target_status_valid(target_status[z]) || distance_mm[z] <= 0) {
+                hits_[z] = 0;
+                continue;
+            }
+
+            float range = static_cast<float>(distance_mm[z]);
+            bool closer = (range < background_mm_[z] - TofIntrusionConfig::kMarginMm) &&
+                          (range <= cell_danger_mm[tof_zone_cell(z, zone_count)]);
+
+            if (closer) {
+                if (hits_[z] < TofIntrusionConfig::kConfirmFrames) {
+                    hits_[z]++;
+                }
+                if (hits_[z] >= TofIntrusionConfig::kConfirmFrames) {
+                    flagged |= (1ull << z);
+                }
+            }
+            else {
+                hits_[z] = 0;
+
+                // Track slow scene changes (lighting, reflectance drift) only while idle
+                if (learning_allowed && !active_) {
+                    background_mm_[z] += TofIntrusionConfig::kLearnRate * (range - background_mm_[z]);
+                }
+            }
+        }
+        flagged_ = flagged;
+
+        // Latch on the first flagged frame, release after a run of clean frames
+        if (flagged != 0) {
+            clean_frames_ = 0;
+            if (!active_) {
+                active_ = true;
+                confirmed_ = false;
+                clear_verdicts_ = 0;
+                onset_ms_ = now_ms;
+            }
+        }
+        else if (active_ && ++clean_frames_ >= TofIntrusionConfig::kReleaseFrames) {
+            active_ = false;
+            confirmed_ = false;
+        }
+
+        return active_;
+    }
+
+    void TofIntrusionDetector::on_camera_verdict(bool person_detected, uint32_t capture_ms,
+                                                 const int16_t* distance_mm, const uint8_t* target_status) {
+        // Only frames captured after the onset can speak for this intrusion
+        if (!active_ || static_cast<int32_t>(capture_ms - onset_ms_) < 0) {
+            return;
+        }
+
+        if (person_detected) {
+            confirmed_ = true;
+            clear_verdicts_ = 0;
+            return;
+        }
+
+        // A single SSD false negative must not erase a real intrusion
+        if (++clear_verdicts_ < TofIntrusionConfig::kClearVerdicts) {
+            return;
+        }
+
+        // Camera sees nobody: take the flagged zones as the new background
+        if (distance_mm && target_status) {
+            for (uint8_t z = 0; z < zone_count_; z++) {
+                if ((flagged_ & (1ull << z)) && tof_target_status_valid(target_status[z]) && distance_mm[z] > 0) {
+                    background_mm_[z] = static_cast<float>(distance_mm[z]);
+                }
+                hits_[z] = 0;
+            }
+        }
+
+        flagged_ = 0;
+        clean_frames_ = 0;
+        clear_verdicts_ = 0;
+        active_ = false;
+        confirmed_ = false;
+    }
+}
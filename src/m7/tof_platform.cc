@@ -0,0 +1,250 @@
+// tof_platform.cc
+#include "m7/tof_platform.hh"
+
+#include <cstring>
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/freertos_kernel/include/semphr.h"
+#include "third_party/freertos_kernel/include/task.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_clock.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_dmamux.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_edma.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_lpi2c.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_lpi2c_edma.h"
+
+#include "m7/edma.hh"
+#include "m7/timebase.hh"
+
+namespace coralmicro {
+
+    namespace {
+        constexpr uint8_t kPlatformError = 255;
+
+        struct BusHardware {
+            LPI2C_Type* base;
+            clock_root_t clock_root;
+            IRQn_Type irq;
+            int32_t tx_request;
+            int32_t rx_request;
+            uint32_t tx_channel; // eDMA channels (EdmaChannels)
+            uint32_t rx_channel;
+        };
+
+        BusHardware bus_hardware(TofBus bus) {
+            if (bus == TofBus::kI2c6) {
+                return {LPI2C6, kCLOCK_Root_Lpi2c6, LPI2C6_IRQn,
+                        kDmaRequestMuxLPI2C6Tx, kDmaRequestMuxLPI2C6Rx,
+                        EdmaChannels::kTofI2c6Tx, EdmaChannels::kTofI2c6Rx};
+            }
+            return {LPI2C1, kCLOCK_Root_Lpi2c1, LPI2C1_IRQn,
+                    kDmaRequestMuxLPI2C1Tx, kDmaRequestMuxLPI2C1Rx,
+                    EdmaChannels::kTofI2c1Tx, EdmaChannels::kTofI2c1Rx};
+        }
+
+        struct BusState {
+            bool initialized = false;
+            lpi2c_master_edma_handle_t handle;
+            edma_handle_t tx_dma;
+            edma_handle_t rx_dma;
+            SemaphoreHandle_t lock = nullptr; // One transfer at a time per bus
+            SemaphoreHandle_t done = nullptr; // Given by the transfer callback
+            volatile status_t result = kStatus_Success;
+        };
+
+        BusState g_buses[kTofBusCount];
+
+        // DMA reads and writes go through here: ULD buffers sit in cached memory and aren't line aligned
+        AT_NONCACHEABLE_SECTION_ALIGN(uint8_t g_bounce[kTofBusCount][TofPlatformConfig::kBounceBytes], 32);
+
+        void on_transfer_done(LPI2C_Type* base, lpi2c_master_edma_handle_t* handle, status_t status, void* user_data) {
+            (void)base;
+            (void)handle;
+            BusState* bus = static_cast<BusState*>(user_data);
+            bus->result = status;
+
+            BaseType_t woken = pdFALSE;
+            xSemaphoreGiveFromISR(bus->done, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
+
+        bool init_bus(TofBus bus) {
+            BusState& state = g_buses[static_cast<size_t>(bus)];
+            if (state.initialized) {
+                return true;
+            }
+
+            BusHardware hw = bus_hardware(bus);
+
+            state.lock = xSemaphoreCreateMutex();
+            state.done = xSemaphoreCreateBinary();
+            if (state.lock == nullptr || state.done == nullptr) {
+                return false;
+            }
+
+            lpi2c_master_config_t config;
+            LPI2C_MasterGetDefaultConfig(&config);
+            config.baudRate_Hz = TofPlatformConfig::kBaudHz;
+            LPI2C_MasterInit(hw.base, &config, CLOCK_GetRootClockFreq(hw.clock_root));
+
+            DMAMUX_SetSource(DMAMUX0, hw.tx_channel, hw.tx_request);
+            DMAMUX_EnableChannel(DMAMUX0, hw.tx_channel);
+            DMAMUX_SetSource(DMAMUX0, hw.rx_channel, hw.rx_request);
+            DMAMUX_EnableChannel(DMAMUX0, hw.rx_channel);
+            EDMA_CreateHandle(&state.tx_dma, DMA0, hw.tx_channel);
+            EDMA_CreateHandle(&state.rx_dma, DMA0, hw.rx_channel);
+
+            // The completion callback gives a semaphore, so both interrupts must be FreeRTOS-safe
+            NVIC_SetPriority(hw.irq, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+            edma_set_irq_priority(hw.tx_channel);
+            edma_set_irq_priority(hw.rx_channel);
+
+            LPI2C_MasterCreateEDMAHandle(hw.base, &state.handle, &state.rx_dma, &state.tx_dma, on_transfer_done, &state);
+
+            state.initialized = true;
+            return true;
+        }
+
+        status_t run_dma(BusState& state, LPI2C_Type* base, lpi2c_master_transfer_t* transfer, TofBusStats& stats) {
+            xSemaphoreTake(state.done, 0); // Drop a completion left over from a timed-out transfer
+
+            status_t status = LPI2C_MasterTransferEDMA(base, &state.handle, transfer);
+            if (status != kStatus_Success) {
+                return status;
+            }
+
+            // The task sleeps here; the bus runs on DMA
+            if (xSemaphoreTake(state.done, pdMS_TO_TICKS(TofPlatformConfig::kTransferTimeoutMs)) != pdTRUE) {
+                LPI2C_MasterTransferAbortEDMA(base, &state.handle);
+                stats.timeouts++;
+                return kStatus_Timeout;
+            }
+            return state.result;
+        }
+
+        // Register reads and writes, split into chunks that continue at the auto-incremented index
+        uint8_t transfer(VL53L8CX_Platform* platform, lpi2c_direction_t direction, uint16_t reg,
+                         uint8_t* data, uint32_t size) {
+            TofBus bus = static_cast<TofBus>(platform->bus);
+            BusState& state = g_buses[static_cast<size_t>(bus)];
+            TofBusStats& stats = g_tof_bus_stats[static_cast<size_t>(bus)];
+            LPI2C_Type* base = bus_hardware(bus).base;
+            uint8_t* bounce = g_bounce[static_cast<size_t>(bus)];
+            size_t max_chunk = (direction == kLPI2C_Read) ? TofPlatformConfig::kReadChunkBytes : TofPlatformConfig::kBounceBytes;
+
+            xSemaphoreTake(state.lock, portMAX_DELAY);
+            uint64_t start_us = timebase_us();
+
+            status_t status = kStatus_Success;
+            bool used_dma = false;
+            for (uint32_t done = 0; done < size && status == kStatus_Success;) {
+                uint32_t chunk = (size - done < max_chunk) ? size - done : static_cast<uint32_t>(max_chunk);
+
+                lpi2c_master_transfer_t xfer;
+                memset(&xfer, 0, sizeof(xfer));
+                xfer.flags = kLPI2C_TransferDefaultFlag;
+                xfer.slaveAddress = platform->address >> 1;
+                xfer.direction = direction;
+                xfer.subaddress = static_cast<uint16_t>(reg + done);
+                xfer.subaddressSize = 2;
+                xfer.dataSize = chunk;
+
+                if (chunk < TofPlatformConfig::kDmaMinBytes) {
+                    xfer.data = data + done;
+                    status = LPI2C_MasterTransferBlocking(base, &xfer);
+                }
+                else {
+                    if (direction == kLPI2C_Write) {
+                        memcpy(bounce, data + done, chunk);
+                    }
+                    xfer.data = bounce;
+                    status = run_dma(state, base, &xfer, stats);
+                    if (status == kStatus_Success && direction == kLPI2C_Read) {
+                        memcpy(data + done, bounce, chunk);
+                    }
+                    used_dma = true;
+                }
+                done += chunk;
+            }
+
+            uint32_t elapsed_us = static_cast<uint32_t>(timebase_us() - start_us);
+            xSemaphoreGive(state.lock);
+
+            stats.transfers++;
+            if (used_dma) {
+                stats.dma_transfers++;
+            }
+            if (direction == kLPI2C_Read) {
+                stats.bytes_read += size;
+            }
+            else {
+                stats.bytes_written += size;
+            }
+            stats.busy_us += elapsed_us;
+            stats.transfer_us_last = elapsed_us;
+            if (elapsed_us > stats.transfer_us_max.load()) {
+                stats.transfer_us_max = elapsed_us;
+            }
+
+            if (status != kStatus_Success) {
+                stats.errors++;
+                return kPlatformError;
+            }
+            return 0;
+        }
+    }
+
+    bool tof_platform_init(VL53L8CX_Platform* platform, I2c bus, uint16_t address, Gpio lpn_pin) {
+        if (!init_bus(tof_bus(bus))) {
+            return false;
+        }
+
+        platform->address = static_cast<uint16_t>(address << 1);
+        platform->bus = static_cast<uint8_t>(tof_bus(bus));
+        platform->lpn_pin = static_cast<uint8_t>(lpn_pin);
+        return true;
+    }
+}
+
+extern "C" {
+
+uint8_t VL53L8CX_RdByte(VL53L8CX_Platform* p_platform, uint16_t RegisterAdress, uint8_t* p_value) {
+    return coralmicro::transfer(p_platform, kLPI2C_Read, RegisterAdress, p_value, 1);
+}
+
+uint8_t VL53L8CX_WrByte(VL53L8CX_Platform* p_platform, uint16_t RegisterAdress, uint8_t value) {
+    return coralmicro::transfer(p_platform, kLPI2C_Write, RegisterAdress, &value, 1);
+}
+
+uint8_t VL53L8CX_RdMulti(VL53L8CX_Platform* p_platform, uint16_t RegisterAdress, uint8_t* p_values, uint32_t size) {
+    return coralmicro::transfer(p_platform, kLPI2C_Read, RegisterAdress, p_values, size);
+}
+
+uint8_t VL53L8CX_WrMulti(VL53L8CX_Platform* p_platform, uint16_t RegisterAdress, uint8_t* p_values, uint32_t size) {
+    return coralmicro::transfer(p_platform, kLPI2C_Write, RegisterAdress, p_values, size);
+}
+
+uint8_t VL53L8CX_Reset_Sensor(VL53L8CX_Platform* p_platform) {
+    coralmicro::Gpio lpn = static_cast<coralmicro::Gpio>(p_platform->lpn_pin);
+    coralmicro::GpioSet(lpn, false);
+    VL53L8CX_WaitMs(p_platform, 100);
+    coralmicro::GpioSet(lpn, true);
+    VL53L8CX_WaitMs(p_platform, 100);
+    return 0;
+}
+
+void VL53L8CX_SwapBuffer(uint8_t* buffer, uint16_t size) {
+    for (uint16_t i = 0; i + 3 < size; i += 4) {
+        uint32_t word;
+        memcpy(&word, buffer + i, 4);
+        word = __builtin_bswap32(word);
+        memcpy(buffer + i, &word, 4);
+    }
+}
+
+uint8_t VL53L8CX_WaitMs(VL53L8CX_Platform* p_platform, uint32_t TimeMs) {
+    (void)p_platform;
+    vTaskDelay(pdMS_TO_TICKS(TimeMs));
+    return 0;
+}
+
+}
@@ -29,9 +29,33 @@ namespace coralmicro {
         }
     }
 
+    TofErrorLabel get_error_label(uint8_t status) {
+        switch(status) {
+            case VL53L8CX_STATUS_INVALID_PARAM:
+                return TofErrorLabel::kInvalidParam;
+            case VL53L8CX_STATUS_ERROR:
+                return TofErrorLabel::kMajor;
+            case VL53L8CX_STATUS_TIMEOUT_ERROR:
+                return TofErrorLabel::kTimeout;
+            case VL53L8CX_STATUS_CORRUPTED_FRAME:
+                return TofErrorLabel::kCorruptedFrame;
+            case VL53L8CX_STATUS_LASER_SAFETY:
+                return TofErrorLabel::kLaserSafety;
+            case VL53L8CX_STATUS_XTALK_FAILED:
+                return TofErrorLabel::kXtalkFailed;
+            case VL53L8CX_STATUS_FW_CHECKSUM_FAIL:
+                return TofErrorLabel::kFwChecksum;
+            case VL53L8CX_MCU_ERROR:
+                return TofErrorLabel::kMcu;
+            default:
+                return TofErrorLabel::kUnknown;
+        }
+    }
+
     void print_sensor_error(const char* operation, uint8_t status) {
+        metric_inc<Metric::kTofErrors>(static_cast<size_t>(get_error_label(status)));
 
-        printf("Error during %s: [%d] %s\r\n", 
+        DLOG_ERROR("Error during %s: [%d] %s\r\n",
             operation, 
             status, 
             get_error_string(status));
@@ -41,44 +65,66 @@ namespace coralmicro {
 
         printf("GPIO Power-on sequence starting...\r\n");
         
-        // Configure LPn pin
-        GpioSetMode(kLpnPin, GpioMode::kOutput);
-        
-        // Reset sequence
-        GpioSet(kLpnPin, false);  // Assert reset
-        vTaskDelay(pdMS_TO_TICKS(100));  // Increased delay
-        GpioSet(kLpnPin, true);   // Release reset
-        vTaskDelay(pdMS_TO_TICKS(100));  // Increased delay
+        // Hold every sensor in reset; they are released one at a time so each
+        // can be moved off the shared default address before the next wakes up
+        for (const TofSensorConfig& sensor : kTofSensors) {
+            GpioSetMode(sensor.lpn_pin, GpioMode::kOutput);
+            GpioSet(sensor.lpn_pin, false);  // Assert reset
+        }
+        vTaskDelay(pdMS_TO_TICKS(kLpnResetMs));
         
         printf("GPIO initialization complete\r\n");
         return true;
     }
 
-    bool init_sensor(VL53L8CX_Configuration* dev) {
-        uint8_t status;
+    bool wait_sensor_alive(VL53L8CX_Configuration* dev) {
+        uint8_t status = VL53L8CX_STATUS_OK;
         uint8_t isAlive = 0;
-        
-        // Check if sensor is alive
-        status = vl53l8cx_is_alive(dev, &isAlive);
-        if (status != VL53L8CX_STATUS_OK || !isAlive) {
-            print_sensor_error("checking sensor alive", status);
+
+        TickType_t start = xTaskGetTickCount();
+        while (xTaskGetTickCount() - start < pdMS_TO_TICKS(kSensorBootTimeoutMs)) {
+            status = vl53l8cx_is_alive(dev, &isAlive);
+            if (status == VL53L8CX_STATUS_OK && isAlive) {
+                printf("Sensor is alive\r\n");
+                return true;
+            }
+            vTaskDelay(pdMS_TO_TICKS(BootConfig::kPollMs));
+        }
+
+        print_sensor_error("checking sensor alive", status);
+        return false;
+    }
+
+    bool assign_sensor_address(VL53L8CX_Configuration* dev, uint16_t address) {
+        if (address == TofSensorsConfig::kDefaultAddress) {
+            return true;
+        }
+
+        // The ULD takes the 8-bit form, like the address it keeps in the platform
+        uint8_t status = vl53l8cx_set_i2c_address(dev, static_cast<uint16_t>(address << 1));
+        if (status != VL53L8CX_STATUS_OK) {
+            print_sensor_error("setting I2C address", status);
             return false;
         }
-        printf("Sensor is alive\r\n");
+        printf("Sensor moved to address 0x%02x\r\n", address);
+        return true;
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(50));  // Allow time for sensor to stabilize
-        
-        // Initialize sensor
-        status = vl53l8cx_init(dev);
+    bool load_sensor_firmware(VL53L8CX_Configuration* dev) {
+        // Uploads the firmware and polls the sensor MCU until it has booted it
+        uint8_t status = vl53l8cx_init(dev);
         if (status != VL53L8CX_STATUS_OK) {
             print_sensor_error("sensor initialization", status);
             return false;
         }
         printf("Sensor initialized\r\n");
+        return true;
+    }
+
+    // Every setter polls the sensor for its answer before returning, so no settle delays are needed
+    bool configure_sensor(VL53L8CX_Configuration* dev) {
+        uint8_t status;
 
-        vTaskDelay(pdMS_TO_TICKS(50));  // Allow time for sensor to stabilize
-        
-        
         status = vl53l8cx_set_resolution(dev, g_tof_resolution.load());
         if (status != VL53L8CX_STATUS_OK) {
             print_sensor_error("setting resolution", status);
@@ -86,8 +132,6 @@ namespace coralmicro {
         }
         printf("Resolution set to 4x4\r\n");
 
-        vTaskDelay(pdMS_TO_TICKS(50));  // Allow time for sensor to stabilize
-
         // Set ranging mode to continuous
         status = vl53l8cx_set_ranging_mode(dev, VL53L8CX_RANGING_MODE_CONTINUOUS);
         if (status != VL53L8CX_STATUS_OK) {
@@ -96,17 +140,14 @@ namespace coralmicro {
         }
         printf("Ranging mode set to continuous\r\n");
 
-        vTaskDelay(pdMS_TO_TICKS(50));  // Allow time for sensor to stabilize
-        
         // Increase ranging frequency for better temporal resolution
-        status = vl53l8cx_set_ranging_frequency_hz(dev, kRangingFrequency); // Max 60Hz for 4x4
+        uint8_t ranging_hz = ranging_frequency(g_tof_resolution.load()); // Max 60Hz for 4x4, 15Hz for 8x8
+        status = vl53l8cx_set_ranging_frequency_hz(dev, ranging_hz);
         if (status != VL53L8CX_STATUS_OK) {
             print_sensor_error("setting ranging frequency", status);
             return false;
         }
-        printf("Ranging frequency set to %i Hz", kRangingFrequency);
-
-        vTaskDelay(pdMS_TO_TICKS(50));  // Allow time for sensor to stabilize
+        printf("Ranging frequency set to %i Hz", ranging_hz);
 
         // Set target order to closest first
         status = vl53l8cx_set_target_order(dev, VL53L8CX_TARGET_ORDER_CLOSEST);
@@ -116,8 +157,6 @@ namespace coralmicro {
         }
         printf("Target order set to closest first\r\n");
 
-        vTaskDelay(pdMS_TO_TICKS(50));  // Allow time for sensor to stabilize
-
         // Reduce sharpener to improve detection of distant objects
         status = vl53l8cx_set_sharpener_percent(dev, kSharpnerValue);
         if (status != VL53L8CX_STATUS_OK) {
@@ -126,25 +165,107 @@ namespace coralmicro {
         }
         printf("Sharpener set to %i%%\r\n", kSharpnerValue);
 
-        vTaskDelay(pdMS_TO_TICKS(100));  // Allow time for sensor to stabilize
-
         return true;
     }
 
 
+    namespace {
+        // Bus time spent on each sensor in the current utilization window
+        uint32_t g_window_busy_us[kTofSensorCount] = {};
+
+        // Polls one sensor and reads its frame into its slot of g_tof_results if one is ready
+        bool read_sensor(size_t sensor) {
+            VL53L8CX_Configuration* dev = g_tof_devices[sensor].get();
+            TofSensorStats& stats = g_tof_sensor_stats[sensor];
+            uint64_t start_us = timebase_us();
+            bool new_frame = false;
+
+            uint8_t isReady = 0;
+            uint8_t status = vl53l8cx_check_data_ready(dev, &isReady);
+
+            if (status == VL53L8CX_STATUS_OK && isReady) {
+                uint64_t read_us = timebase_us();
+                {
+                    PROFILE_ZONE("tof_read");
+                    status = vl53l8cx_get_ranging_data(dev, &g_tof_results->results[sensor]);
+                }
+
+                if (status == VL53L8CX_STATUS_OK) {
+                    uint64_t previous_us = g_tof_results->frame_us[sensor];
+                    if (previous_us != 0) {
+                        stats.frame_interval_us = static_cast<uint32_t>(read_us - previous_us);
+                    }
+                    g_tof_results->frame_us[sensor] = read_us;
+                    g_tof_results->timestamp_us = read_us;
+                    stats.frames++;
+                    new_frame = true;
+                } else {
+                    print_sensor_error("getting ranging data", status);
+                    stats.errors++;
+                }
+            } else if (status != VL53L8CX_STATUS_OK) {
+                print_sensor_error("checking data ready", status);
+                stats.errors++;
+            }
+
+            uint32_t elapsed_us = static_cast<uint32_t>(timebase_us() - start_us);
+            g_window_busy_us[sensor] += elapsed_us;
+            if (new_frame) {
+                stats.read_us_last = elapsed_us;
+                if (elapsed_us > stats.read_us_max.load()) {
+                    stats.read_us_max = elapsed_us;
+                }
+            }
+            return new_frame;
+        }
+
+        void update_utilization(uint64_t& window_start_us) {
+            uint64_t now_us = timebase_us();
+            uint64_t window_us = now_us - window_start_us;
+            if (window_us < TofSensorsConfig::kUtilizationWindowMs * 1000ull) {
+                return;
+            }
+
+            for (size_t i = 0; i < kTofSensorCount; i++) {
+                g_tof_sensor_stats[i].busy_permille = static_cast<uint32_t>(g_window_busy_us[i] * 1000ull / window_us);
+                g_window_busy_us[i] = 0;
+            }
+            window_start_us = now_us;
+        }
+
+        void print_grid(size_t sensor) {
+            const int16_t* distance_mm = g_tof_results->results[sensor].distance_mm;
+            DLOG_DEBUG("\nTOF Grid %s (mm):\r\n", kTofSensors[sensor].name);
+            DLOG_DEBUG("    C0    C1    C2    C3\r\n");
+            for(int row = 0; row < 4; row++) {
+                int idx = row * 4;
+                DLOG_DEBUG("R%d: %4d %4d %4d %4d\r\n", row, distance_mm[idx], distance_mm[idx + 1],
+                           distance_mm[idx + 2], distance_mm[idx + 3]);
+            }
+        }
+    }
+
     void tof_task(void* parameters) {
         (void)parameters;
         
         printf("TOF task starting...\r\n");
+        trace_register_task();
 
-        uint8_t status = vl53l8cx_start_ranging(g_tof_device.get());
-        if (status != VL53L8CX_STATUS_OK) {
-            print_sensor_error("starting ranging", status);
+        if (!boot_wait(kBootTof)) {
+            printf("ERROR: TOF device not available\r\n");
             vTaskSuspend(nullptr);
         }
+
+        for (size_t i = 0; i < kTofSensorCount; i++) {
+            uint8_t status = vl53l8cx_start_ranging(g_tof_devices[i].get());
+            if (status != VL53L8CX_STATUS_OK) {
+                print_sensor_error("starting ranging", status);
+                vTaskSuspend(nullptr);
+            }
+        }
         
 
-        int Hz = kRangingFrequency;
+        int Hz = ranging_frequency(g_tof_resolution.load());
         TickType_t last_wake_time = xTaskGetTickCount();
         const TickType_t frequency = pdMS_TO_TICKS(1000 / Hz);
 
@@ -155,55 +276,55 @@ namespace coralmicro {
 
 
         bool data_sampled_printed_flag = false;
+
+        // Sensors are polled round-robin, starting one further along each cycle so
+        // no sensor always waits behind the others' reads
+        size_t first_sensor = 0;
+        uint64_t window_start_us = timebase_us();
         
 
+       register_stage(Stage::kTof);
+
        printf("TOF task initialized successfully\r\n");
 
         while (true) {
-            uint8_t isReady = 0;
-            
-            // Check if new data is ready
-            status = vl53l8cx_check_data_ready(g_tof_device.get(), &isReady);
-            
-            if (status == VL53L8CX_STATUS_OK && isReady) {
-
-                status = vl53l8cx_get_ranging_data(g_tof_device.get(), g_tof_results.get());
+            bool new_frame = false;
+            for (size_t n = 0; n < kTofSensorCount; n++) {
+                size_t sensor = (first_sensor + n) % kTofSensorCount;
+                new_frame = read_sensor(sensor) || new_frame;
+            }
+            first_sensor = (first_sensor + 1) % kTofSensorCount;
+            update_utilization(window_start_us);
 
-                if (status == VL53L8CX_STATUS_OK) {
+            if (new_frame) {
 
-                    if ((xTaskGetTickCount() - last_data_health_check_time) >= data_health_check_time) {
-                        data_sampled_printed_flag = false;
-                        last_data_health_check_time = xTaskGetTickCount();
-                    }
+                if ((xTaskGetTickCount() - last_data_health_check_time) >= data_health_check_time) {
+                    data_sampled_printed_flag = false;
+                    last_data_health_check_time = xTaskGetTickCount();
+                }
 
-                    // Only print once to reduce console output load
-                    if (!data_sampled_printed_flag) {
-                        printf("\nTOF Grid (mm):\r\n");
-                        printf("    C0    C1    C2    C3\r\n");
-                        for(int row = 0; row < 4; row++) {
-                            printf("R%d:", row);
-                            for(int col = 0; col < 4; col++) {
-                                int idx = row * 4 + col;
-                                printf(" %4d", g_tof_results->distance_mm[idx]);
-                            }
-                            printf("\r\n");
-                        }
-                        data_sampled_printed_flag = true;
+                // Only print once to reduce console output load
+                if (!data_sampled_printed_flag) {
+                    for (size_t i = 0; i < kTofSensorCount; i++) {
+                        print_grid(i);
                     }
+                    data_sampled_printed_flag = true;
+                }
 
-                    // Send data to queue
-                    if (xQueueOverwrite(g_tof_queue_m7, g_tof_results.get()) != pdTRUE) {
-                        printf("Failed to send TOF data to queue\r\n");
-                    }
-                } else {
-                    print_sensor_error("getting ranging data", status);
+                // Send data to queue
+                metric_inc<Metric::kTofFrames>();
+                boot_milestone(BootPhase::kFirstTofFrame);
+                if (!channel_overwrite(Channel::kTof, g_tof_results.get())) {
+                    DLOG_ERROR("Failed to send TOF data to queue\r\n");
                 }
-            } else if (status != VL53L8CX_STATUS_OK) {
-                print_sensor_error("checking data ready", status);
+                NotifyStateController(kEventTof);
             }
-            
-            // Use vTaskDelayUntil for more precise timing
-            vTaskDelayUntil(&last_wake_time, frequency);
+
+
+            stage_complete(Stage::kTof);
+
+            // Use vTaskDelayUntil for more precise timing (or wait for the executive)
+            wait_for_release(Stage::kTof, &last_wake_time, frequency);
         }
     }
-} // namespace coralmicro
\ No newline at end of file
+} // namespace coralmicro
@@ -0,0 +1,125 @@
+// ws2812.cc
+#include "m7/ws2812.hh"
+
+namespace coralmicro {
+
+    size_t ws2812_encode(const LedColor* colors, size_t count, uint32_t pin_mask,
+                         uint32_t* slots, size_t capacity) {
+        size_t needed = count * Ws2812Config::kBitsPerLed * Ws2812Config::kSlotsPerBit;
+        if (needed > capacity) {
+            return 0;
+        }
+
+        size_t written = 0;
+        bool level = false;
+        auto emit = [&](bool high) {
+            slots[written++] = (high != level) ? pin_mask : 0;
+            level = high;
+        };
+
+        for (size_t led = 0; led < count; led++) {
+            uint32_t grb = (static_cast<uint32_t>(colors[led].green) << 16) |
+                           (static_cast<uint32_t>(colors[led].red) << 8) |
+                           colors[led].blue;
+            for (int bit = Ws2812Config::kBitsPerLed - 1; bit >= 0; bit--) {
+                emit(true);
+                emit((grb >> bit) & 1u);
+                emit(false);
+            }
+        }
+        return written;
+    }
+}
+
+#if defined(__arm__)
+
+#include <atomic>
+
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_clock.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_dmamux.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_edma.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_gpio.h"
+#include "third_party/nxp/rt1176-sdk/devices/MIMXRT1176/drivers/fsl_pit.h"
+
+#include "m7/edma.hh"
+#include "m7/timebase.hh"
+
+namespace coralmicro {
+
+    namespace {
+        constexpr uint32_t kPin = 31;  // GPIO_MUX2_IO31, the LED data line
+        constexpr uint32_t kPinMask = 1u << kPin;
+
+        // PIT channel n paces DMAMUX channel n
+        constexpr pit_chnl_t kPitChannel = kPIT_Chnl_0;
+        static_assert(EdmaChannels::kLedStrip == 0, "kPitChannel must match the LED eDMA channel");
+
+        edma_handle_t g_dma;
+        std::atomic<bool> g_busy{false};
+        std::atomic<uint32_t> g_done_us{0}; // Low 32 bits of timebase_us when the last frame finished
+
+        // Read by eDMA, so kept out of the data cache
+        AT_NONCACHEABLE_SECTION_ALIGN(uint32_t g_slots[Ws2812Config::kMaxSlots], 32);
+
+        void on_frame_done(edma_handle_t* handle, void* user_data, bool transfer_done, uint32_t tcds) {
+            (void)handle;
+            (void)user_data;
+            (void)transfer_done;
+            (void)tcds;
+            PIT_StopTimer(PIT1, kPitChannel);
+            g_done_us = static_cast<uint32_t>(timebase_us());
+            g_busy = false;
+        }
+    }
+
+    bool ws2812_init() {
+        gpio_pin_config_t pin_config = {kGPIO_DigitalOutput, 0, kGPIO_NoIntmode};
+        GPIO_PinInit(GPIO2, kPin, &pin_config);
+
+        pit_config_t pit_config;
+        PIT_GetDefaultConfig(&pit_config);
+        PIT_Init(PIT1, &pit_config);
+        PIT_SetTimerPeriod(PIT1, kPitChannel, CLOCK_GetRootClockFreq(kCLOCK_Root_Bus) / Ws2812Config::kSlotHz);
+
+        // Periodic trigger: the channel requests one transfer per PIT tick
+        DMAMUX_EnableAlwaysOn(DMAMUX0, EdmaChannels::kLedStrip, true);
+        DMAMUX_EnablePeriodTrigger(DMAMUX0, EdmaChannels::kLedStrip);
+        DMAMUX_EnableChannel(DMAMUX0, EdmaChannels::kLedStrip);
+
+        EDMA_CreateHandle(&g_dma, DMA0, EdmaChannels::kLedStrip);
+        EDMA_SetCallback(&g_dma, on_frame_done, nullptr);
+        edma_set_irq_priority(EdmaChannels::kLedStrip);
+        return true;
+    }
+
+    bool ws2812_show(const LedColor* colors, size_t count) {
+        if (g_busy.load()) {
+            return false;
+        }
+        // The line has idled low since the last frame; it latches once that has lasted long enough
+        if (static_cast<uint32_t>(timebase_us()) - g_done_us.load() < Ws2812Timing::kResetUs) {
+            return false;
+        }
+
+        size_t slots = ws2812_encode(colors, count, kPinMask, g_slots, Ws2812Config::kMaxSlots);
+        if (slots == 0) {
+            return false;
+        }
+
+        edma_transfer_config_t transfer;
+        EDMA_PrepareTransfer(&transfer, g_slots, sizeof(uint32_t),
+                             const_cast<uint32_t*>(&GPIO2->DR_TOGGLE), sizeof(uint32_t),
+                             sizeof(uint32_t), slots * sizeof(uint32_t), kEDMA_MemoryToPeripheral);
+
+        g_busy = true;
+        if (EDMA_SubmitTransfer(&g_dma, &transfer) != kStatus_Success) {
+            g_busy = false;
+            return false;
+        }
+        EDMA_StartTransfer(&g_dma);
+        PIT_StartTimer(PIT1, kPitChannel);
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,283 @@
+// zone_profiler.cc
+#include "m7/zone_profiler.hh"
+
+#include <cstring>
+
+#include "third_party/freertos_kernel/include/FreeRTOS.h"
+#include "third_party/freertos_kernel/include/task.h"
+
+// FreeRTOSConfig.h pulled in the trace macros if kernel tracing is on (README); either way
+// only the hook declarations are wanted here, not a second definition of the macros
+#ifdef TRACE_HOOKS_INSTALLED
+#define TRACE_HOOKS_KERNEL_HOOKED 1
+#else
+#define TRACE_HOOKS_KERNEL_HOOKED 0
+#endif
+#define TRACE_HOOKS_DECLARATIONS_ONLY
+#include "m7/trace_hooks.hh"
+
+#include "m7/cycle_counter.hh"
+
+namespace coralmicro {
+
+    namespace {
+        struct TaskRing {
+            std::atomic<const void*> handle{nullptr}; // Owning task, nullptr = free
+            char name[ZoneProfilerConfig::kTaskNameLength] = {};
+            std::atomic<uint32_t> head{0};            // Records ever written
+            TraceRecord records[ZoneProfilerConfig::kTaskRingSize] = {};
+        };
+
+        struct KernelRing {
+            std::atomic<uint32_t> head{0};
+            TraceRecord records[ZoneProfilerConfig::kKernelRingSize] = {};
+        };
+
+        struct TraceObject {
+            std::atomic<const void*> handle{nullptr};
+            const char* name = nullptr;
+        };
+
+        TaskRing g_task_rings[ZoneProfilerConfig::kMaxTasks];
+        KernelRing g_kernel_ring;
+
+        TraceObject g_objects[ZoneProfilerConfig::kMaxObjects];
+        std::atomic<size_t> g_object_count{0};
+
+        // A deleted task keeps its ring (and name) for the dump until a new task needs it, but
+        // a new task reusing the TCB memory must not match it
+        const char g_retired_task = 0;
+
+        static_assert(static_cast<uint8_t>(TraceEvent::kQueueSend) == TRACE_HOOK_QUEUE_SEND &&
+                      static_cast<uint8_t>(TraceEvent::kQueueReceive) == TRACE_HOOK_QUEUE_RECEIVE &&
+                      static_cast<uint8_t>(TraceEvent::kQueuePeek) == TRACE_HOOK_QUEUE_PEEK &&
+                      static_cast<uint8_t>(TraceEvent::kQueueSendFailed) == TRACE_HOOK_QUEUE_SEND_FAILED &&
+                      static_cast<uint8_t>(TraceEvent::kQueueReceiveFailed) == TRACE_HOOK_QUEUE_RECEIVE_FAILED &&
+                      static_cast<uint8_t>(TraceEvent::kQueueBlockReceive) == TRACE_HOOK_QUEUE_BLOCK_RECEIVE,
+                      "trace_hooks.hh event codes out of sync with TraceEvent");
+
+        // Fresh name and an empty ring for the task that just claimed ring i
+        void claim_ring(size_t i, const void* handle) {
+            TaskRing& ring = g_task_rings[i];
+            ring.head.store(0, std::memory_order_release);
+            memset(ring.name, 0, sizeof(ring.name));
+            const char* name = pcTaskGetName(static_cast<TaskHandle_t>(const_cast<void*>(handle)));
+            if (name != nullptr) {
+                strncpy(ring.name, name, ZoneProfilerConfig::kTaskNameLength - 1);
+            }
+        }
+
+        // Ring index of a task. With claim, a task without one takes a free ring, else the ring of
+        // a deleted task. Lock-free, so it is safe from the kernel hooks as well as from tasks; the
+        // hooks only look up, so SDK tasks that never register don't use up rings.
+        int find_ring(const void* handle, bool claim) {
+            if (handle == nullptr) {
+                return -1;
+            }
+
+            for (size_t i = 0; i < ZoneProfilerConfig::kMaxTasks; i++) {
+                if (g_task_rings[i].handle.load(std::memory_order_acquire) == handle) {
+                    return static_cast<int>(i);
+                }
+            }
+            if (!claim) {
+                return -1;
+            }
+
+            // Free rings first, so deleted tasks stay in the dump as long as possible
+            const void* const kFreeMarkers[] = {nullptr, &g_retired_task};
+            for (const void* free_marker : kFreeMarkers) {
+                for (size_t i = 0; i < ZoneProfilerConfig::kMaxTasks; i++) {
+                    const void* expected = free_marker;
+                    if (g_task_rings[i].handle.compare_exchange_strong(expected, handle, std::memory_order_acq_rel)) {
+                        claim_ring(i, handle);
+                        return static_cast<int>(i);
+                    }
+                    if (expected == handle) {
+                        return static_cast<int>(i);
+                    }
+                }
+            }
+
+            g_trace_stats.dropped_tasks++;
+            return -1;
+        }
+
+        template <size_t N>
+        void push(std::atomic<uint32_t>& head, TraceRecord (&records)[N], TraceEvent type, uint8_t slot, const void* ref) {
+            uint32_t index = head.load(std::memory_order_relaxed);
+            TraceRecord& record = records[index & (N - 1)];
+            record.cycles = cycle_counter_read();
+            record.type = type;
+            record.slot = slot;
+            record.ref = ref;
+            head.store(index + 1, std::memory_order_release);
+        }
+
+        // Kernel ring writers are the switch hook, tasks and ISRs; masking makes them take turns
+        void push_kernel(TraceEvent type, uint8_t slot, const void* ref) {
+            UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+            push(g_kernel_ring.head, g_kernel_ring.records, type, slot, ref);
+            portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        }
+
+        void push_zone(TraceEvent type, const char* name) {
+            int ring = find_ring(xTaskGetCurrentTaskHandle(), true);
+            if (ring < 0) {
+                return;
+            }
+            push(g_task_rings[ring].head, g_task_rings[ring].records, type, static_cast<uint8_t>(ring), name);
+        }
+
+        bool is_registered(const void* handle) {
+            size_t count = g_object_count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count && i < ZoneProfilerConfig::kMaxObjects; i++) {
+                if (g_objects[i].handle.load(std::memory_order_acquire) == handle) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <size_t N>
+        size_t snapshot(const std::atomic<uint32_t>& head, const TraceRecord (&records)[N],
+                        TraceRecord* out, size_t capacity, uint32_t* written) {
+            uint32_t end = head.load(std::memory_order_acquire);
+            size_t count = end < N ? end : N;
+            if (count > capacity) {
+                count = capacity;
+            }
+            uint32_t start = end - static_cast<uint32_t>(count);
+
+            for (size_t i = 0; i < count; i++) {
+                out[i] = records[(start + i) & (N - 1)];
+            }
+
+            // A writer that has since reached index `now` may be overwriting now - N,
+            // so only indices above that survived the copy intact
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t now = head.load(std::memory_order_relaxed);
+            size_t lapped = static_cast<size_t>(now - start) + 1;
+            size_t skip = lapped > N ? lapped - N : 0;
+            if (skip > count) {
+                skip = count;
+            }
+            if (skip > 0) {
+                memmove(out, out + skip, (count - skip) * sizeof(TraceRecord));
+            }
+
+            *written = end;
+            return count - skip;
+        }
+    }
+
+    void trace_zone_begin(const char* name) {
+        push_zone(TraceEvent::kZoneBegin, name);
+    }
+
+    void trace_zone_end(const char* name) {
+        push_zone(TraceEvent::kZoneEnd, name);
+    }
+
+    void trace_register_task() {
+        if (ZoneProfilerConfig::kEnabled) {
+            find_ring(xTaskGetCurrentTaskHandle(), true);
+        }
+    }
+
+    bool trace_kernel_hooks_installed() {
+        return TRACE_HOOKS_KERNEL_HOOKED != 0;
+    }
+
+    void trace_register_object(const void* handle, const char* name) {
+        if (handle == nullptr) {
+            return;
+        }
+
+        size_t index = g_object_count.fetch_add(1);
+        if (index >= ZoneProfilerConfig::kMaxObjects) {
+            g_object_count = ZoneProfilerConfig::kMaxObjects;
+            g_trace_stats.dropped_objects++;
+            return;
+        }
+        g_objects[index].name = name;
+        g_objects[index].handle.store(handle, std::memory_order_release);
+    }
+
+    size_t trace_snapshot(size_t ring, TraceRecord* out, size_t capacity, uint32_t* written) {
+        if (ring == kTraceKernelRing) {
+            return snapshot(g_kernel_ring.head, g_kernel_ring.records, out, capacity, written);
+        }
+        if (ring < ZoneProfilerConfig::kMaxTasks) {
+            return snapshot(g_task_rings[ring].head, g_task_rings[ring].records, out, capacity, written);
+        }
+        *written = 0;
+        return 0;
+    }
+
+    const char* trace_ring_name(size_t ring) {
+        if (ring == kTraceKernelRing) {
+            return "kernel";
+        }
+        if (ring < ZoneProfilerConfig::kMaxTasks) {
+            return g_task_rings[ring].name;
+        }
+        return "";
+    }
+
+    size_t trace_object_count() {
+        size_t count = g_object_count.load(std::memory_order_acquire);
+        return count < ZoneProfilerConfig::kMaxObjects ? count : ZoneProfilerConfig::kMaxObjects;
+    }
+
+    bool trace_object(size_t index, const void** handle, const char** name) {
+        if (index >= trace_object_count()) {
+            return false;
+        }
+        *handle = g_objects[index].handle.load(std::memory_order_acquire);
+        *name = g_objects[index].name;
+        return *handle != nullptr;
+    }
+}
+
+// FreeRTOS trace hooks (trace_hooks.hh), called from inside the kernel
+
+extern "C" void trace_hook_task_switched_in(void* tcb) {
+    using namespace coralmicro;
+    if (!ZoneProfilerConfig::kEnabled) {
+        return;
+    }
+
+    int ring = find_ring(tcb, false);
+    if (ring < 0) {
+        return;
+    }
+    push_kernel(TraceEvent::kTaskSwitchedIn, static_cast<uint8_t>(ring), reinterpret_cast<const void*>(static_cast<uintptr_t>(ring)));
+}
+
+extern "C" void trace_hook_task_deleted(void* tcb) {
+    using namespace coralmicro;
+    for (size_t i = 0; i < ZoneProfilerConfig::kMaxTasks; i++) {
+        const void* expected = tcb;
+        if (g_task_rings[i].handle.compare_exchange_strong(expected, &g_retired_task)) {
+            return;
+        }
+    }
+}
+
+extern "C" void trace_hook_queue(uint8_t event, void* queue, int from_isr) {
+    using namespace coralmicro;
+    if (!ZoneProfilerConfig::kEnabled) {
+        return;
+    }
+    if (!ZoneProfilerConfig::kTraceUnregisteredQueues && !is_registered(queue)) {
+        return;
+    }
+
+    uint8_t slot = kIsrSlot;
+    if (!from_isr) {
+        int ring = find_ring(xTaskGetCurrentTaskHandle(), false);
+        slot = ring < 0 ? kIsrSlot : static_cast<uint8_t>(ring);
+    }
+    push_kernel(static_cast<TraceEvent>(event), slot, queue);
+}